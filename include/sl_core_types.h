@@ -501,6 +501,17 @@ enum class PreferenceFlags : uint64_t
     //! Optional - Enables loading of plugins downloaded Over The Air (OTA), to
     //! be used in conjunction with the eAllowOTA flag.
     eLoadDownloadedPlugins = 1 << 6,
+    //! Optional - Defers loading of plugins until the feature is first used
+    //!
+    //! Requested plugins which do not register any hooks are only discovered and version checked in 'slInit',
+    //! their DLLs are loaded on the first call to 'slIsFeatureSupported', 'slGetFeatureFunction', 'slEvaluateFeature' etc.
+    //! Discovery relies on a cache populated by previous runs so the very first run always loads all plugins.
+    //!
+    //! NOTE: On Vulkan, when 'vkCreateInstance' and 'vkCreateDevice' go through SL, extensions and features required by all
+    //! plugins depend on the driver and must be known at that point so deferred plugins are loaded there. Integrations which
+    //! create the instance and device themselves (see 'slSetVulkanInfo') query them per feature with 'slGetFeatureRequirements'
+    //! and only load the plugins they ask about.
+    eLoadPluginsOnFirstUse = 1 << 7,
 };
 
 SL_ENUM_OPERATORS_64(PreferenceFlags)
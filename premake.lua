@@ -292,6 +292,16 @@ project "sl.compute"
 			"./source/platforms/sl.chi/vulkan.cpp",
 			"./source/platforms/sl.chi/vulkan.h",
 			"./source/platforms/sl.chi/generic.cpp",
+			"./source/platforms/sl.chi/descriptorBuilder.h",
+			"./source/platforms/sl.chi/kernelCache.h",
+			"./source/platforms/sl.chi/pipelineCache.h",
+			"./source/platforms/sl.chi/pipelineCache.cpp",
+			"./source/platforms/sl.chi/commandStream.h",
+			"./source/platforms/sl.chi/transitionBatch.h",
+			"./source/platforms/sl.chi/uploadAllocator.h",
+			"./source/platforms/sl.chi/fenceTimeline.h",
+			"./source/platforms/sl.chi/transientPlanner.h",
+			"./source/platforms/sl.chi/vramSegments.h",
 			"./source/core/sl.security/**.h",
 			"./source/core/sl.security/**.cpp"
 		}
@@ -308,7 +318,17 @@ project "sl.compute"
 			"./source/platforms/sl.chi/generic.h",		
 			"./source/platforms/sl.chi/vulkan.cpp",
 			"./source/platforms/sl.chi/vulkan.h",
-			"./source/platforms/sl.chi/generic.cpp"	
+			"./source/platforms/sl.chi/generic.cpp",
+			"./source/platforms/sl.chi/descriptorBuilder.h",
+			"./source/platforms/sl.chi/kernelCache.h",
+			"./source/platforms/sl.chi/pipelineCache.h",
+			"./source/platforms/sl.chi/pipelineCache.cpp",
+			"./source/platforms/sl.chi/commandStream.h",
+			"./source/platforms/sl.chi/transitionBatch.h",
+			"./source/platforms/sl.chi/uploadAllocator.h",
+			"./source/platforms/sl.chi/fenceTimeline.h",
+			"./source/platforms/sl.chi/transientPlanner.h",
+			"./source/platforms/sl.chi/vramSegments.h"
 		}
 	end
 
@@ -644,3 +664,25 @@ if (os.isdir("./source/plugins/sl.nvperf")) then
 end
 
 group ""
+
+-- API independent building blocks (timers, allocators, caches, trackers) are unit tested on Linux
+-- where they build without a device or any vendor SDK, run 'sl.tests [filter]' from '_artifacts/sl.tests'
+if os.host() ~= "windows" then
+
+group "tests"
+
+project "sl.tests"
+	kind "ConsoleApp"
+	targetdir (ROOT .. "_artifacts/%{prj.name}/%{cfg.buildcfg}_%{cfg.platform}")
+	objdir (ROOT .. "_artifacts/%{prj.name}/%{cfg.buildcfg}_%{cfg.platform}") 
+
+	files {
+		"./source/tests/**.h",
+		"./source/tests/**.cpp",
+	}
+
+	links { "pthread" }
+
+group ""
+
+end
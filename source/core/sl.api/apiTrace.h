@@ -0,0 +1,739 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <functional>
+
+#include "include/sl.h"
+#include "include/sl_consts.h"
+#include "source/core/sl.file/file.h"
+#include "source/core/sl.file/asyncIO.h"
+#include "source/core/sl.log/log.h"
+
+namespace sl
+{
+namespace api
+{
+namespace trace
+{
+
+//! Binary trace of the public SL API calls
+//!
+//! Enabled with "recordAPITrace" in 'sl.interposer.json', written to 'sl.api.trace'
+//! next to the log. Layout is a FileHeader followed by records, each record is a
+//! RecordHeader followed by 'size' bytes of payload. All values are little endian
+//! and stored in their native width, native handles are stored as 64bit values.
+//!
+//! Readers must skip records with an unknown CallId using the size from the header,
+//! new calls can be added without bumping the version. Changing the payload of an
+//! existing call requires a new version.
+//!
+constexpr uint32_t kTraceMagic = 0x52544c53; // 'SLTR'
+constexpr uint16_t kTraceVersion = 1;
+
+enum class CallId : uint16_t
+{
+    eSetFeatureLoaded,
+    eSetTag,
+    eSetConstants,
+    eAllocateResources,
+    eFreeResources,
+    eEvaluateFeature,
+    eGetNewFrameToken,
+    eGetFeatureFunction,
+    eCount
+};
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+    uint32_t magic = kTraceMagic;
+    uint16_t version = kTraceVersion;
+    uint16_t headerSize = sizeof(FileHeader);
+    uint64_t sdkVersion{};
+    uint32_t constantsSize{};
+    uint32_t reserved{};
+};
+
+struct RecordHeader
+{
+    CallId call{};
+    uint16_t flags{};
+    uint32_t size{};
+    //! Nanoseconds since the trace was started
+    uint64_t timestamp{};
+};
+#pragma pack(pop)
+
+//! Size of Constants as declared by hosts built against kStructVersion1
+inline size_t getConstantsV1Size()
+{
+    // Version 2 appended 'minRelativeLinearDepthObjectSeparation', offsetof is not usable on SL structures
+    static const Constants s_constants{};
+    return (size_t)((const uint8_t*)&s_constants.minRelativeLinearDepthObjectSeparation - (const uint8_t*)&s_constants);
+}
+
+//! Structures which are plain data and can be stored as raw bytes following the BaseStructure header
+//!
+//! Size is the one of the given struct version, hosts built against an older SDK pass smaller
+//! structures so reading sizeof() would run past them. Newer versions only append members so
+//! anything above the version we know about is treated as the latest one.
+//!
+//! Anything not listed here is recorded by type and version only and skipped on replay
+inline size_t getPlainStructSize(const StructType& type, uint32_t version = UINT32_MAX)
+{
+    if (version < kStructVersion1) return 0;
+    if (type == Constants::s_structType) return version >= kStructVersion2 ? sizeof(Constants) : getConstantsV1Size();
+    if (type == PrecisionInfo::s_structType) return sizeof(PrecisionInfo);
+    if (type == ViewportHandle::s_structType) return sizeof(ViewportHandle);
+    return 0;
+}
+
+class Writer
+{
+    std::vector<uint8_t>& m_data;
+
+public:
+    Writer(std::vector<uint8_t>& data) : m_data(data) {}
+
+    inline void bytes(const void* data, size_t size)
+    {
+        auto p = (const uint8_t*)data;
+        m_data.insert(m_data.end(), p, p + size);
+    }
+
+    template<typename T>
+    inline void value(const T& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written directly");
+        bytes(&v, sizeof(T));
+    }
+
+    inline void handle(const void* p) { value((uint64_t)(uintptr_t)p); }
+
+    inline void string(const char* s)
+    {
+        uint32_t size = s ? (uint32_t)strlen(s) : 0;
+        value(size);
+        bytes(s, size);
+    }
+
+    inline void resource(const Resource& r)
+    {
+        value(r.type);
+        handle(r.native);
+        handle(r.memory);
+        handle(r.view);
+        value(r.state);
+        value(r.width);
+        value(r.height);
+        value(r.nativeFormat);
+        value(r.mipLevels);
+        value(r.arrayLayers);
+        value(r.gpuVirtualAddress);
+        value(r.flags);
+        value(r.usage);
+    }
+
+    //! Writes a single structure without its chain
+    inline void structure(const BaseStructure* s)
+    {
+        value(s->structType);
+        value((uint32_t)s->structVersion);
+        if (s->structType == ResourceTag::s_structType)
+        {
+            auto tag = (const ResourceTag*)s;
+            value((uint8_t)(tag->resource != nullptr));
+            if (tag->resource)
+            {
+                resource(*tag->resource);
+            }
+            value(tag->type);
+            value(tag->lifecycle);
+            value(tag->extent);
+            return;
+        }
+        uint32_t size = (uint32_t)getPlainStructSize(s->structType, s->structVersion);
+        auto payload = size ? size - (uint32_t)sizeof(BaseStructure) : 0;
+        value(payload);
+        bytes((const uint8_t*)s + sizeof(BaseStructure), payload);
+    }
+
+    //! Writes a structure followed by everything chained to it
+    inline void chain(const BaseStructure* s)
+    {
+        uint32_t count = 0;
+        for (auto p = s; p; p = p->next) count++;
+        value(count);
+        for (auto p = s; p; p = p->next)
+        {
+            structure(p);
+        }
+    }
+};
+
+//! Records API calls into a memory buffer which is periodically appended to the trace file
+//!
+//! Thread safe, calls are stored in the order in which they acquire the lock.
+//! Full buffers are handed to a background writer so the calling thread never waits on the disk.
+class Recorder
+{
+    std::mutex m_mtx;
+    std::vector<uint8_t> m_buffer;
+    std::wstring m_path;
+    std::chrono::steady_clock::time_point m_start;
+    size_t m_recordCount = 0;
+    std::atomic<bool> m_failed = false;
+    bool m_created = false;
+    //! Declared last so it completes all writes before anything above is destroyed
+    file::AsyncIO m_writer{ L"sl.api.trace.io" };
+
+    static constexpr size_t kFlushThreshold = 1 << 20;
+
+    void flushLocked()
+    {
+        if (m_buffer.empty() || m_failed) return;
+        std::vector<uint8_t> data;
+        data.swap(m_buffer);
+        m_buffer.reserve(kFlushThreshold + 4096);
+        auto onComplete = [this](file::IOCompletion& completion)->void
+        {
+            if (!completion.success && !m_failed.exchange(true))
+            {
+                SL_LOG_ERROR("Failed to write API trace to '%S', recording stopped", m_path.c_str());
+            }
+        };
+        // First flush replaces any trace left over from a previous run, same path keeps writes in order
+        if (m_created)
+        {
+            m_writer.append(m_path.c_str(), std::move(data), onComplete);
+        }
+        else
+        {
+            m_writer.write(m_path.c_str(), std::move(data), onComplete);
+            m_created = true;
+        }
+    }
+
+public:
+    Recorder(const Recorder&) = delete;
+
+    Recorder(const wchar_t* path, uint64_t sdkVersion) : m_path(path), m_start(std::chrono::steady_clock::now())
+    {
+        FileHeader header{};
+        header.sdkVersion = sdkVersion;
+        header.constantsSize = sizeof(Constants);
+        m_buffer.reserve(kFlushThreshold + 4096);
+        Writer(m_buffer).value(header);
+        SL_LOG_INFO("Recording API trace to '%S'", path);
+    }
+
+    ~Recorder()
+    {
+        flush();
+        m_writer.flush();
+        SL_LOG_INFO("Recorded %llu API calls", (uint64_t)m_recordCount);
+    }
+
+    //! Hands whatever is buffered to the writer, does not wait for it to reach the disk
+    void flush()
+    {
+        std::scoped_lock lock(m_mtx);
+        flushLocked();
+    }
+
+    //! Appends a record, 'payload' writes the call specific data
+    template<typename F>
+    void record(CallId call, F&& payload)
+    {
+        std::scoped_lock lock(m_mtx);
+        if (m_failed) return;
+        auto offset = m_buffer.size();
+        RecordHeader header{};
+        header.call = call;
+        header.timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        Writer writer(m_buffer);
+        writer.value(header);
+        payload(writer);
+        auto size = (uint32_t)(m_buffer.size() - offset - sizeof(RecordHeader));
+        memcpy(m_buffer.data() + offset + offsetof(RecordHeader, size), &size, sizeof(size));
+        m_recordCount++;
+        if (m_buffer.size() >= kFlushThreshold)
+        {
+            flushLocked();
+        }
+    }
+
+    //! Call specific encoders, the layout must match Replayer::replayCall
+
+    void recordSetFeatureLoaded(Feature feature, bool enabled)
+    {
+        record(CallId::eSetFeatureLoaded, [&](Writer& writer)
+        {
+            writer.value(feature);
+            writer.value((uint8_t)enabled);
+        });
+    }
+
+    void recordSetTag(const ViewportHandle& viewport, const ResourceTag* tags, uint32_t numTags, CommandBuffer* cmdBuffer)
+    {
+        record(CallId::eSetTag, [&](Writer& writer)
+        {
+            writer.value((uint32_t)viewport);
+            writer.value(tags ? numTags : 0);
+            for (uint32_t i = 0; tags && i < numTags; i++)
+            {
+                writer.chain(&tags[i]);
+            }
+            writer.handle(cmdBuffer);
+        });
+    }
+
+    void recordSetConstants(const Constants& values, const FrameToken& frame, const ViewportHandle& viewport)
+    {
+        record(CallId::eSetConstants, [&](Writer& writer)
+        {
+            writer.value((uint32_t)frame);
+            writer.value((uint32_t)viewport);
+            writer.chain(&values);
+        });
+    }
+
+    void recordAllocateResources(CommandBuffer* cmdBuffer, Feature feature, const ViewportHandle& viewport)
+    {
+        record(CallId::eAllocateResources, [&](Writer& writer)
+        {
+            writer.handle(cmdBuffer);
+            writer.value(feature);
+            writer.value((uint32_t)viewport);
+        });
+    }
+
+    void recordFreeResources(Feature feature, const ViewportHandle& viewport)
+    {
+        record(CallId::eFreeResources, [&](Writer& writer)
+        {
+            writer.value(feature);
+            writer.value((uint32_t)viewport);
+        });
+    }
+
+    void recordEvaluateFeature(Feature feature, const FrameToken& frame, const BaseStructure** inputs, uint32_t numInputs, CommandBuffer* cmdBuffer)
+    {
+        record(CallId::eEvaluateFeature, [&](Writer& writer)
+        {
+            uint32_t count = 0;
+            for (uint32_t i = 0; inputs && i < numInputs; i++)
+            {
+                if (inputs[i]) count++;
+            }
+            writer.value(feature);
+            writer.value((uint32_t)frame);
+            writer.value(count);
+            for (uint32_t i = 0; inputs && i < numInputs; i++)
+            {
+                if (inputs[i]) writer.chain(inputs[i]);
+            }
+            writer.handle(cmdBuffer);
+        });
+    }
+
+    void recordGetNewFrameToken(const uint32_t* frameIndex)
+    {
+        record(CallId::eGetNewFrameToken, [&](Writer& writer)
+        {
+            writer.value((uint8_t)(frameIndex != nullptr));
+            writer.value(frameIndex ? *frameIndex : 0);
+        });
+    }
+
+    void recordGetFeatureFunction(Feature feature, const char* functionName)
+    {
+        record(CallId::eGetFeatureFunction, [&](Writer& writer)
+        {
+            writer.value(feature);
+            writer.string(functionName);
+        });
+    }
+};
+
+//! Bounds checked reader, any read past the end marks the reader as failed and returns zeroes
+class Reader
+{
+    const uint8_t* m_data{};
+    size_t m_size{};
+    size_t m_offset{};
+    bool m_failed = false;
+
+public:
+    Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+    inline bool failed() const { return m_failed; }
+    inline bool eof() const { return m_offset >= m_size; }
+    inline size_t offset() const { return m_offset; }
+
+    inline bool bytes(void* dst, size_t size)
+    {
+        if (m_failed || size > m_size - m_offset)
+        {
+            m_failed = true;
+            if (dst) memset(dst, 0, size);
+            return false;
+        }
+        if (dst) memcpy(dst, m_data + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    inline bool skip(size_t size) { return bytes(nullptr, size); }
+
+    template<typename T>
+    inline T value()
+    {
+        T v;
+        bytes(&v, sizeof(T));
+        return v;
+    }
+
+    inline void* handle() { return (void*)(uintptr_t)value<uint64_t>(); }
+
+    inline std::string string()
+    {
+        auto size = value<uint32_t>();
+        std::string s;
+        if (size <= m_size - m_offset)
+        {
+            s.assign((const char*)m_data + m_offset, size);
+        }
+        skip(size);
+        return s;
+    }
+
+    inline void resource(Resource& r)
+    {
+        r.type = value<ResourceType>();
+        r.native = handle();
+        r.memory = handle();
+        r.view = handle();
+        r.state = value<uint32_t>();
+        r.width = value<uint32_t>();
+        r.height = value<uint32_t>();
+        r.nativeFormat = value<uint32_t>();
+        r.mipLevels = value<uint32_t>();
+        r.arrayLayers = value<uint32_t>();
+        r.gpuVirtualAddress = value<uint64_t>();
+        r.flags = value<uint32_t>();
+        r.usage = value<uint32_t>();
+    }
+};
+
+//! Called on replay for every recorded resource, can patch native handles with live ones
+using PFunResolveResource = std::function<void(Resource& resource)>;
+//! Called on replay for every recorded command buffer
+using PFunResolveCommandBuffer = std::function<CommandBuffer*(void* recorded)>;
+
+//! Public API entry points used by the replayer, normally obtained from sl.interposer
+struct ReplayFunctions
+{
+    PFun_slSetFeatureLoaded* setFeatureLoaded{};
+    PFun_slSetTag* setTag{};
+    PFun_slSetConstants* setConstants{};
+    PFun_slAllocateResources* allocateResources{};
+    PFun_slFreeResources* freeResources{};
+    PFun_slEvaluateFeature* evaluateFeature{};
+    PFun_slGetNewFrameToken* getNewFrameToken{};
+    PFun_slGetFeatureFunction* getFeatureFunction{};
+};
+
+struct ReplayStats
+{
+    uint64_t calls[(size_t)CallId::eCount]{};
+    //! Time spent inside SL for each call type
+    uint64_t nanoseconds[(size_t)CallId::eCount]{};
+    uint64_t failed{};
+    uint64_t skipped{};
+};
+
+//! Decodes a trace and invokes the recorded calls in order
+//!
+//! Structures are rebuilt in storage owned by the replayer which is recycled
+//! after each call, recorded handles are passed through as is unless the host
+//! provides resolve callbacks.
+class Replayer
+{
+    std::vector<uint8_t> m_trace;
+    FileHeader m_header{};
+    std::vector<std::unique_ptr<uint8_t[]>> m_storage;
+    PFunResolveResource m_resolveResource;
+    PFunResolveCommandBuffer m_resolveCommandBuffer;
+
+    template<typename T>
+    T* allocate(size_t size = sizeof(T))
+    {
+        m_storage.push_back(std::make_unique<uint8_t[]>(size));
+        return (T*)m_storage.back().get();
+    }
+
+    CommandBuffer* commandBuffer(Reader& reader)
+    {
+        auto recorded = reader.handle();
+        return m_resolveCommandBuffer ? m_resolveCommandBuffer(recorded) : (CommandBuffer*)recorded;
+    }
+
+    //! Returns nullptr for structures which cannot be rebuilt
+    BaseStructure* structure(Reader& reader)
+    {
+        auto type = reader.value<StructType>();
+        auto version = reader.value<uint32_t>();
+        if (type == ResourceTag::s_structType)
+        {
+            auto tag = new (allocate<ResourceTag>()) ResourceTag();
+            tag->structVersion = version;
+            if (reader.value<uint8_t>())
+            {
+                tag->resource = new (allocate<Resource>()) Resource();
+                reader.resource(*tag->resource);
+                if (m_resolveResource)
+                {
+                    m_resolveResource(*tag->resource);
+                }
+            }
+            tag->type = reader.value<BufferType>();
+            tag->lifecycle = reader.value<ResourceLifecycle>();
+            tag->extent = reader.value<Extent>();
+            return tag;
+        }
+        auto payload = reader.value<uint32_t>();
+        // Storage is always the latest version, members the trace does not have stay zeroed
+        auto size = getPlainStructSize(type);
+        if (!size)
+        {
+            reader.skip(payload);
+            return nullptr;
+        }
+        // Newer structures only append members so copy what both sides know about
+        auto s = new (allocate<uint8_t>(size)) BaseStructure(type, version);
+        auto known = std::min((size_t)payload, size - sizeof(BaseStructure));
+        reader.bytes((uint8_t*)s + sizeof(BaseStructure), known);
+        reader.skip(payload - known);
+        return s;
+    }
+
+    BaseStructure* chain(Reader& reader)
+    {
+        auto count = reader.value<uint32_t>();
+        BaseStructure* head{};
+        BaseStructure* tail{};
+        for (uint32_t i = 0; i < count && !reader.failed(); i++)
+        {
+            auto s = structure(reader);
+            if (!s) continue;
+            if (tail) tail->next = s; else head = s;
+            tail = s;
+        }
+        return head;
+    }
+
+    FrameToken* frameToken(const ReplayFunctions& api, uint32_t index)
+    {
+        FrameToken* token{};
+        api.getNewFrameToken(token, &index);
+        return token;
+    }
+
+    Result replayCall(const ReplayFunctions& api, CallId call, Reader& reader)
+    {
+        switch (call)
+        {
+            case CallId::eSetFeatureLoaded:
+            {
+                auto feature = reader.value<Feature>();
+                auto enabled = reader.value<uint8_t>() != 0;
+                return reader.failed() ? Result::eErrorInvalidParameter : api.setFeatureLoaded(feature, enabled);
+            }
+            case CallId::eSetTag:
+            {
+                ViewportHandle viewport(reader.value<uint32_t>());
+                auto numTags = reader.value<uint32_t>();
+                auto tags = numTags ? allocate<ResourceTag>(sizeof(ResourceTag) * numTags) : nullptr;
+                for (uint32_t i = 0; i < numTags && !reader.failed(); i++)
+                {
+                    auto tag = chain(reader);
+                    if (tag && tag->structType == ResourceTag::s_structType)
+                    {
+                        memcpy((void*)&tags[i], (const void*)tag, sizeof(ResourceTag));
+                    }
+                    else
+                    {
+                        new (&tags[i]) ResourceTag();
+                    }
+                }
+                auto cmdBuffer = commandBuffer(reader);
+                return reader.failed() ? Result::eErrorInvalidParameter : api.setTag(viewport, tags, numTags, cmdBuffer);
+            }
+            case CallId::eSetConstants:
+            {
+                auto frame = reader.value<uint32_t>();
+                ViewportHandle viewport(reader.value<uint32_t>());
+                auto consts = chain(reader);
+                auto token = frameToken(api, frame);
+                if (reader.failed() || !token || !consts || consts->structType != Constants::s_structType) return Result::eErrorInvalidParameter;
+                return api.setConstants(*(Constants*)consts, *token, viewport);
+            }
+            case CallId::eAllocateResources:
+            {
+                auto cmdBuffer = commandBuffer(reader);
+                auto feature = reader.value<Feature>();
+                ViewportHandle viewport(reader.value<uint32_t>());
+                return reader.failed() ? Result::eErrorInvalidParameter : api.allocateResources(cmdBuffer, feature, viewport);
+            }
+            case CallId::eFreeResources:
+            {
+                auto feature = reader.value<Feature>();
+                ViewportHandle viewport(reader.value<uint32_t>());
+                return reader.failed() ? Result::eErrorInvalidParameter : api.freeResources(feature, viewport);
+            }
+            case CallId::eEvaluateFeature:
+            {
+                auto feature = reader.value<Feature>();
+                auto frame = reader.value<uint32_t>();
+                auto numInputs = reader.value<uint32_t>();
+                auto inputs = numInputs ? allocate<const BaseStructure*>(sizeof(BaseStructure*) * numInputs) : nullptr;
+                uint32_t count = 0;
+                for (uint32_t i = 0; i < numInputs && !reader.failed(); i++)
+                {
+                    if (auto input = chain(reader))
+                    {
+                        inputs[count++] = input;
+                    }
+                }
+                auto cmdBuffer = commandBuffer(reader);
+                auto token = frameToken(api, frame);
+                return reader.failed() || !token ? Result::eErrorInvalidParameter : api.evaluateFeature(feature, *token, inputs, count, cmdBuffer);
+            }
+            case CallId::eGetNewFrameToken:
+            {
+                auto hasIndex = reader.value<uint8_t>() != 0;
+                auto index = reader.value<uint32_t>();
+                FrameToken* token{};
+                return reader.failed() ? Result::eErrorInvalidParameter : api.getNewFrameToken(token, hasIndex ? &index : nullptr);
+            }
+            case CallId::eGetFeatureFunction:
+            {
+                auto feature = reader.value<Feature>();
+                auto name = reader.string();
+                void* function{};
+                return reader.failed() ? Result::eErrorInvalidParameter : api.getFeatureFunction(feature, name.c_str(), function);
+            }
+            default:
+                break;
+        }
+        return Result::eErrorMissingOrInvalidAPI;
+    }
+
+public:
+    //! Loads the trace and validates the header
+    bool load(const wchar_t* path)
+    {
+        m_trace = file::read(path);
+        if (m_trace.size() < sizeof(FileHeader))
+        {
+            SL_LOG_ERROR("API trace '%S' is missing or truncated", path);
+            return false;
+        }
+        memcpy(&m_header, m_trace.data(), sizeof(FileHeader));
+        if (m_header.magic != kTraceMagic || m_header.headerSize < sizeof(FileHeader) || m_header.headerSize > m_trace.size())
+        {
+            SL_LOG_ERROR("'%S' is not an API trace", path);
+            return false;
+        }
+        if (m_header.version > kTraceVersion)
+        {
+            SL_LOG_ERROR("API trace '%S' has version %u, only up to %u is supported", path, m_header.version, kTraceVersion);
+            return false;
+        }
+        return true;
+    }
+
+    const FileHeader& getHeader() const { return m_header; }
+
+    void setResolveCallbacks(const PFunResolveResource& resolveResource, const PFunResolveCommandBuffer& resolveCommandBuffer)
+    {
+        m_resolveResource = resolveResource;
+        m_resolveCommandBuffer = resolveCommandBuffer;
+    }
+
+    //! Replays all records, returns false if the trace is corrupted or an entry point is missing
+    bool replay(const ReplayFunctions& api, ReplayStats& stats)
+    {
+        if (!api.setFeatureLoaded || !api.setTag || !api.setConstants || !api.allocateResources || !api.freeResources ||
+            !api.evaluateFeature || !api.getNewFrameToken || !api.getFeatureFunction)
+        {
+            SL_LOG_ERROR("Missing SL API entry points, cannot replay");
+            return false;
+        }
+
+        Reader trace(m_trace.data(), m_trace.size());
+        trace.skip(m_header.headerSize);
+        while (!trace.eof())
+        {
+            auto header = trace.value<RecordHeader>();
+            auto payload = m_trace.data() + trace.offset();
+            if (!trace.skip(header.size))
+            {
+                SL_LOG_ERROR("API trace is truncated at offset %llu", (uint64_t)trace.offset());
+                return false;
+            }
+            if (header.call >= CallId::eCount)
+            {
+                stats.skipped++;
+                continue;
+            }
+
+            Reader reader(payload, header.size);
+            auto start = std::chrono::steady_clock::now();
+            auto result = replayCall(api, header.call, reader);
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            m_storage.clear();
+
+            auto i = (size_t)header.call;
+            stats.calls[i]++;
+            stats.nanoseconds[i] += (uint64_t)elapsed;
+            if (result != Result::eOk)
+            {
+                stats.failed++;
+            }
+        }
+        return true;
+    }
+};
+
+}
+}
+}
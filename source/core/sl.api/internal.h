@@ -112,6 +112,23 @@ using PFuncOnPluginShutdown = void(void);
 using PFuncGetPluginFunction = void* (const char* name);
 using PFuncOnPluginsInitialized = void(const char* loaderJSON);
 
+//! Binary copy of the loader JSON passed to 'slOnPluginLoad' and 'slOnPluginStartup'
+//!
+//! Published as 'sl.param.global.loaderConfigBinary' for the duration of the call so
+//! plugins can decode CBOR instead of tokenizing text. Plugins which do not know about
+//! it keep parsing the text, which is always provided.
+//!
+//! NOTE: Shared across DLL boundaries, only append new members
+struct LoaderConfigBinary
+{
+    uint32_t version = 1;
+    //! Text this blob matches, must be the same pointer as 'loaderJSON' passed to the call
+    const char* text{};
+    //! CBOR (RFC 8949) encoding of the same config
+    const uint8_t* data{};
+    size_t size{};
+};
+
 } // namespace api
 
 //! IMPORTANT: 
@@ -39,9 +39,11 @@
 #include "include/sl_dlss_g.h"
 #include "include/sl_hooks.h"
 #include "internal.h"
+#include "apiTrace.h"
 #include "source/core/sl.exception/exception.h"
 #include "source/core/sl.extra/extra.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/core/sl.interposer/hook.h"
@@ -180,18 +182,14 @@ inline sl::Result slValidateState()
 
 inline sl::Result slValidateFeatureContext(sl::Feature f, const sl::plugin_manager::FeatureContext*& ctx)
 {
+    // Called for every tag, constants and evaluate so no JSON here, plugin manager caches what is needed
     ctx = plugin_manager::getInterface()->getFeatureContext(f);
-    std::string jsonConfig{};
-    if (!ctx || !plugin_manager::getInterface()->getExternalFeatureConfig(f, jsonConfig))
+    if (!ctx)
     {
         SL_LOG_ERROR("'%s' is missing.", getFeatureAsStr(f));
         return Result::eErrorFeatureMissing;
     }
-    // Any JSON parser can be used here
-    std::istringstream stream(jsonConfig);
-    nlohmann::json extCfg;
-    stream >> extCfg;
-    if (extCfg.contains("/feature/supported"_json_pointer) && !extCfg["feature"]["supported"])
+    if (!ctx->supported)
     {
         SL_LOG_ERROR("'%s' is not supported.", getFeatureAsStr(f));
         return Result::eErrorFeatureNotSupported;
@@ -221,9 +219,67 @@ struct APIContext
     std::map<Feature, std::pair<size_t, char**>> vkFeatures12;
     std::map<Feature, std::pair<size_t, char**>> vkFeatures13;
     std::map<Feature, std::pair<size_t, char**>> vkFeaturesOpticalflowNV;
+
+    //! Valid only when "recordAPITrace" is set in 'sl.interposer.json'
+    api::trace::Recorder* recorder{};
 };
 
 APIContext s_ctx;
+
+namespace trace
+{
+
+//! Recording is kept out of the API functions since they cannot unwind objects inside exception handlers
+
+void recordSetFeatureLoaded(Feature feature, bool enabled)
+{
+    s_ctx.recorder->recordSetFeatureLoaded(feature, enabled);
+}
+
+void recordSetTag(const ViewportHandle& viewport, const ResourceTag* tags, uint32_t numTags, CommandBuffer* cmdBuffer)
+{
+    s_ctx.recorder->recordSetTag(viewport, tags, numTags, cmdBuffer);
+}
+
+void recordSetConstants(const Constants& values, const FrameToken& frame, const ViewportHandle& viewport)
+{
+    s_ctx.recorder->recordSetConstants(values, frame, viewport);
+}
+
+void recordAllocateResources(CommandBuffer* cmdBuffer, Feature feature, const ViewportHandle& viewport)
+{
+    s_ctx.recorder->recordAllocateResources(cmdBuffer, feature, viewport);
+}
+
+void recordFreeResources(Feature feature, const ViewportHandle& viewport)
+{
+    s_ctx.recorder->recordFreeResources(feature, viewport);
+}
+
+void recordEvaluateFeature(Feature feature, const FrameToken& frame, const BaseStructure** inputs, uint32_t numInputs, CommandBuffer* cmdBuffer)
+{
+    s_ctx.recorder->recordEvaluateFeature(feature, frame, inputs, numInputs, cmdBuffer);
+}
+
+void recordGetNewFrameToken(const uint32_t* frameIndex)
+{
+    s_ctx.recorder->recordGetNewFrameToken(frameIndex);
+}
+
+void recordGetFeatureFunction(Feature feature, const char* functionName)
+{
+    s_ctx.recorder->recordGetFeatureFunction(feature, functionName);
+}
+
+//! Files produced on request go next to the log
+std::wstring getOutputPath(const wchar_t* fileName)
+{
+    auto logPath = log::getInterface()->getLogPath();
+    return (logPath && logPath[0] ? std::wstring(logPath) : file::getCurrentDirectoryPath()) + L"/" + fileName;
+}
+
+} // namespace trace
+
 sl::Result slInit(const Preferences &pref, uint64_t sdkVersion)
 {
     //! IMPORTANT:
@@ -263,6 +319,11 @@ sl::Result slInit(const Preferences &pref, uint64_t sdkVersion)
             if (!sl::interposer::getInterface()->getConfigPath().empty())
             {
                 auto config = sl::interposer::getInterface()->getConfig();
+                profiler::getInterface()->setEnabled(config.enableProfiling);
+                if (config.recordAPITrace && !s_ctx.recorder)
+                {
+                    s_ctx.recorder = new api::trace::Recorder(trace::getOutputPath(L"sl.api.trace").c_str(), sdkVersion);
+                }
                 if (config.waitForDebugger)
                 {
                     SL_LOG_INFO("Waiting for debugger to attach ...");
@@ -309,6 +370,7 @@ sl::Result slInit(const Preferences &pref, uint64_t sdkVersion)
             param::getInterface()->set(param::global::kPFunAllocateResource, pref.allocateCallback);
             param::getInterface()->set(param::global::kPFunReleaseResource, pref.releaseCallback);
             param::getInterface()->set(param::global::kLogInterface, log::getInterface());
+            param::getInterface()->set(param::global::kProfilerInterface, profiler::getInterface());
 
             // Enumerate plugins and check if they are supported or not
             return manager->loadPlugins();
@@ -353,8 +415,18 @@ Result slShutdown()
     }
     manager->unloadPlugins();
 
+    if (profiler::getInterface()->isEnabled())
+    {
+        profiler::getInterface()->exportTrace(trace::getOutputPath(L"sl.trace.json").c_str());
+    }
+
+    // Flushes whatever is left in memory
+    delete s_ctx.recorder;
+    s_ctx.recorder = {};
+
     plugin_manager::destroyInterface();
     param::destroyInterface();
+    profiler::destroyInterface();
     log::destroyInterface();
     interposer::destroyInterface();
 
@@ -378,6 +450,7 @@ Result slSetFeatureLoaded(sl::Feature feature, bool enabled)
 {
     SL_EXCEPTION_HANDLE_START;
     SL_CHECK(slValidateState());
+    if (s_ctx.recorder) trace::recordSetFeatureLoaded(feature, enabled);
     return plugin_manager::getInterface()->setFeatureEnabled(feature, enabled);
     SL_EXCEPTION_HANDLE_END_RETURN(Result::eErrorExceptionHandler);
 }
@@ -395,6 +468,7 @@ Result slSetTag(const sl::ViewportHandle& viewport, const sl::ResourceTag* tags,
 
     SL_EXCEPTION_HANDLE_START;
     SL_CHECK(slValidateState());
+    if (s_ctx.recorder) trace::recordSetTag(viewport, tags, numTags, cmdBuffer);
     const sl::plugin_manager::FeatureContext* ctx;
     SL_CHECK(slValidateFeatureContext(kFeatureCommon, ctx));
     if (!tags || numTags == 0) return Result::eErrorInvalidParameter;
@@ -414,6 +488,7 @@ Result slSetConstants(const Constants& values, const FrameToken& frame, const Vi
 
     SL_EXCEPTION_HANDLE_START;
     SL_CHECK(slValidateState());
+    if (s_ctx.recorder) trace::recordSetConstants(values, frame, viewport);
     const sl::plugin_manager::FeatureContext* ctx;
     SL_CHECK(slValidateFeatureContext(kFeatureCommon, ctx));
     return ctx->setConstants(values, frame, viewport);
@@ -424,6 +499,7 @@ Result slAllocateResources(sl::CommandBuffer* cmdBuffer, sl::Feature feature, co
 {
     SL_EXCEPTION_HANDLE_START;
     SL_CHECK(slValidateState());
+    if (s_ctx.recorder) trace::recordAllocateResources(cmdBuffer, feature, viewport);
     const sl::plugin_manager::FeatureContext* ctx;
     SL_CHECK(slValidateFeatureContext(feature, ctx));
     if (!ctx->allocResources)
@@ -439,6 +515,7 @@ Result slFreeResources(sl::Feature feature, const sl::ViewportHandle& viewport)
 {
     SL_EXCEPTION_HANDLE_START;
     SL_CHECK(slValidateState());
+    if (s_ctx.recorder) trace::recordFreeResources(feature, viewport);
     const sl::plugin_manager::FeatureContext* ctx;
     SL_CHECK(slValidateFeatureContext(feature, ctx));
     if (!ctx->freeResources)
@@ -454,6 +531,7 @@ Result slEvaluateFeature(sl::Feature feature, const sl::FrameToken& frame, const
 {
     SL_EXCEPTION_HANDLE_START;
     SL_CHECK(slValidateState());
+    if (s_ctx.recorder) trace::recordEvaluateFeature(feature, frame, inputs, numInputs, cmdBuffer);
     //! First check if plugin provides an override 
     //!
     //! This allows flexibility and separation from sl.common if needed.
@@ -1092,6 +1170,7 @@ Result slGetFeatureFunction(sl::Feature feature, const char* functionName, void*
         }
     }
     if (!functionName) return Result::eErrorInvalidParameter;
+    if (s_ctx.recorder) trace::recordGetFeatureFunction(feature, functionName);
     function = ctx->getFunction(functionName);
     return function ? Result::eOk : Result::eErrorMissingOrInvalidAPI;
     SL_EXCEPTION_HANDLE_END_RETURN(Result::eErrorExceptionHandler)
@@ -1102,6 +1181,7 @@ Result slGetNewFrameToken(FrameToken*& handle, const uint32_t* frameIndex)
     auto getFrame = [](FrameToken*& handle, const uint32_t* frameIndex)->Result
     {
         SL_CHECK(slValidateState());
+        if (s_ctx.recorder) trace::recordGetNewFrameToken(frameIndex);
 
         std::scoped_lock lock(s_ctx.mtxFrameHandle);
 
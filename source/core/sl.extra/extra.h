@@ -24,20 +24,25 @@
 
 #if SL_WINDOWS
 #include <windows.h>
+#else
+#include <time.h>
 #endif
 #include <string>
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <thread>
 #include <algorithm>
 #include <cstring>
 #include <sstream>
 #include <atomic>
 #include <cmath>
-#include <codecvt>
-#include <locale>
 #include <iomanip>
 #include <array>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+#include <limits>
 
 #ifdef SL_WINDOWS
 #define SL_IGNOREWARNING_PUSH __pragma(warning(push))
@@ -54,6 +59,7 @@
 #define SL_IGNOREWARNING_WITH_PUSH(w) SL_IGNOREWARNING_PUSH SL_IGNOREWARNING(w)
 #endif
 
+#include "source/core/sl.extra/utf.h"
 
 namespace sl
 {
@@ -61,23 +67,6 @@ namespace sl
 namespace extra
 {
 
-// Ignore deprecated warning, c++17 does not provide proper alternative yet
-SL_IGNOREWARNING_WITH_PUSH(4996)
-
-inline std::wstring utf8ToUtf16(const char* source)
-{
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert;
-    return convert.from_bytes(source);
-}
-
-inline std::string utf16ToUtf8(const wchar_t* source)
-{
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert;
-    return convert.to_bytes(source);
-}
-
-SL_IGNOREWARNING_POP
-
 inline std::wstring toWStr(const std::string& s)
 {
     return utf8ToUtf16(s.c_str());
@@ -291,20 +280,235 @@ struct IKeyboard
 IKeyboard* getInterface();
 }
 
-constexpr size_t kAverageMeterWindowSize = 120;
+//! Streaming quantile estimator using the P-square algorithm
+//! 
+//! Jain & Chlamtac, "The P2 algorithm for dynamic calculation of quantiles
+//! and histograms without storing observations", CACM 1985.
+//! 
+//! Tracks a single quantile with five markers, constant memory and O(1) per sample.
+//! Exact while there are fewer than five samples.
+//! 
+//! NOT thread safe
+struct P2Quantile
+{
+    P2Quantile(double p = 0.5) : m_p(p) { reset(); }
 
-//! IMPORTANT: Mainly not thread safe for performance reasons
+    void reset()
+    {
+        m_count = 0;
+        m_q = {};
+        m_n = { 0, 1, 2, 3, 4 };
+        m_np = { 0, 2 * m_p, 4 * m_p, 2 + 2 * m_p, 4 };
+        m_dn = { 0, m_p / 2, m_p, (1 + m_p) / 2, 1 };
+    }
+
+    void add(double x)
+    {
+        if (m_count < 5)
+        {
+            m_q[m_count++] = x;
+            if (m_count == 5)
+            {
+                std::sort(m_q.begin(), m_q.end());
+            }
+            return;
+        }
+
+        // Find cell k such that q[k] <= x < q[k + 1], extend extremes if needed
+        int k;
+        if (x < m_q[0])
+        {
+            m_q[0] = x;
+            k = 0;
+        }
+        else if (x >= m_q[4])
+        {
+            m_q[4] = x;
+            k = 3;
+        }
+        else
+        {
+            k = 0;
+            while (x >= m_q[k + 1]) k++;
+        }
+        m_count++;
+
+        for (int i = k + 1; i < 5; i++) m_n[i]++;
+        for (int i = 0; i < 5; i++) m_np[i] += m_dn[i];
+
+        // Adjust heights of the middle markers if they drifted off their desired positions
+        for (int i = 1; i < 4; i++)
+        {
+            auto d = m_np[i] - m_n[i];
+            if ((d >= 1 && m_n[i + 1] - m_n[i] > 1) || (d <= -1 && m_n[i - 1] - m_n[i] < -1))
+            {
+                int ds = d >= 0 ? 1 : -1;
+                auto q = parabolic(i, ds);
+                if (m_q[i - 1] < q && q < m_q[i + 1])
+                {
+                    m_q[i] = q;
+                }
+                else
+                {
+                    m_q[i] = linear(i, ds);
+                }
+                m_n[i] += ds;
+            }
+        }
+    }
+
+    double get() const
+    {
+        if (m_count == 0) return 0.;
+        if (m_count < 5)
+        {
+            // Exact interpolated quantile over the few samples we have
+            std::array<double, 5> tmp = m_q;
+            std::sort(tmp.begin(), tmp.begin() + m_count);
+            auto pos = m_p * (m_count - 1);
+            auto i = (uint32_t)pos;
+            auto frac = pos - i;
+            return i + 1 < m_count ? tmp[i] + (tmp[i + 1] - tmp[i]) * frac : tmp[i];
+        }
+        return m_q[2];
+    }
+
+    inline uint64_t getNumSamples() const { return m_count; }
+
+private:
+    double parabolic(int i, int d) const
+    {
+        return m_q[i] + d / double(m_n[i + 1] - m_n[i - 1]) *
+            ((m_n[i] - m_n[i - 1] + d) * (m_q[i + 1] - m_q[i]) / double(m_n[i + 1] - m_n[i]) +
+             (m_n[i + 1] - m_n[i] - d) * (m_q[i] - m_q[i - 1]) / double(m_n[i] - m_n[i - 1]));
+    }
+
+    double linear(int i, int d) const
+    {
+        return m_q[i] + d * (m_q[i + d] - m_q[i]) / double(m_n[i + d] - m_n[i]);
+    }
+
+    double m_p;
+    uint64_t m_count = 0;
+    std::array<double, 5> m_q{};
+    std::array<int64_t, 5> m_n{};
+    std::array<double, 5> m_np{};
+    std::array<double, 5> m_dn{};
+};
+
+//! Tracks p50/p90/p99 over the most recent window of samples
 //! 
-//! Only selected "get" methods use atomics.
+//! Two generations of P2 estimators are kept, one collecting the current
+//! window and one holding the last complete window. Queries are answered
+//! from the last complete window once there is one so results do not jump
+//! when a new window starts.
+//! 
+//! NOT thread safe
 template <uint32_t WINDOW_SIZE>
-struct TAverageValueMeter
+struct TPercentileSketch
 {
-    TAverageValueMeter()
+    void reset()
     {
+        for (auto& g : m_generations)
+        {
+            for (auto& q : g) q.reset();
+        }
+        m_active = 0;
+        m_hasComplete = false;
+    }
+
+    void add(double value)
+    {
+        auto& active = m_generations[m_active];
+        for (auto& q : active) q.add(value);
+        if (active[0].getNumSamples() >= WINDOW_SIZE)
+        {
+            m_active ^= 1;
+            m_hasComplete = true;
+            for (auto& q : m_generations[m_active]) q.reset();
+        }
+    }
+
+    inline double getP50() const { return getCurrent()[0].get(); }
+    inline double getP90() const { return getCurrent()[1].get(); }
+    inline double getP99() const { return getCurrent()[2].get(); }
+
+private:
+    using Estimators = std::array<P2Quantile, 3>;
+
+    const Estimators& getCurrent() const { return m_hasComplete ? m_generations[m_active ^ 1] : m_generations[m_active]; }
+
+    std::array<Estimators, 2> m_generations{ Estimators{ P2Quantile(0.5), P2Quantile(0.9), P2Quantile(0.99) },
+                                             Estimators{ P2Quantile(0.5), P2Quantile(0.9), P2Quantile(0.99) } };
+    uint32_t m_active = 0;
+    bool m_hasComplete = false;
+};
+
+//! Portable high resolution monotonic clock used by the meters
+//! 
+//! QueryPerformanceCounter on Windows, CLOCK_MONOTONIC elsewhere which
+//! is serviced from the vDSO on Linux so neither requires a syscall.
+namespace timer
+{
 #ifdef SL_WINDOWS
+inline int64_t getFrequency()
+{
+    static const int64_t s_frequency = []()
+    {
+        LARGE_INTEGER frequency{};
         QueryPerformanceFrequency(&frequency);
+        return (int64_t)frequency.QuadPart;
+    }();
+    return s_frequency;
+}
+
+inline int64_t getTicks()
+{
+    LARGE_INTEGER ticks{};
+    QueryPerformanceCounter(&ticks);
+    return ticks.QuadPart;
+}
+#else
+inline int64_t getFrequency()
+{
+    return 1000000000;
+}
+
+inline int64_t getTicks()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
 #endif
-    };
+
+//! Split to avoid overflowing when multiplying large tick counts
+inline int64_t ticksToUs(int64_t ticks)
+{
+    auto frequency = getFrequency();
+    return (ticks / frequency) * 1000000 + (ticks % frequency) * 1000000 / frequency;
+}
+}
+
+constexpr size_t kAverageMeterWindowSize = 120;
+
+//! Placeholder used by meters which do not track percentiles
+struct NoPercentileSketch
+{
+    inline void reset() {}
+    inline void add(double) {}
+};
+
+//! IMPORTANT: Mainly not thread safe for performance reasons
+//! 
+//! Only selected "get" methods use atomics.
+//! 
+//! Set PERCENTILES to also feed samples into a TPercentileSketch and enable getP50/getP90/getP99,
+//! this adds three P2 estimator updates per sample so only meters which report percentiles should opt in.
+template <uint32_t WINDOW_SIZE, bool PERCENTILES = false>
+struct TAverageValueMeter
+{
+    TAverageValueMeter() {};
 
     TAverageValueMeter(const TAverageValueMeter& rhs) { operator=(rhs); }
 
@@ -314,11 +518,9 @@ struct TAverageValueMeter
         val = rhs.val.load();
         sum = rhs.sum;
         window = rhs.window;
-#ifdef SL_WINDOWS
-        frequency = rhs.frequency;
+        percentiles = rhs.percentiles;
         startTime = rhs.startTime;
         elapsedUs = rhs.elapsedUs;
-#endif
         return *this;
     }
 
@@ -330,35 +532,26 @@ struct TAverageValueMeter
         sum = 0;
         mean = 0;
         std::fill(window.begin(), window.end(), 0);
-#ifdef SL_WINDOWS
+        percentiles.reset();
         startTime = {};
         elapsedUs = {};
-#endif
     }
 
     //! NOT thread safe
     void begin()
     {
-#ifdef SL_WINDOWS
-        QueryPerformanceCounter(&startTime);
-#endif
+        startTime = timer::getTicks();
     }
 
     //! NOT thread safe
     void end()
     {
-#ifdef SL_WINDOWS
-        if (startTime.QuadPart > 0)
+        if (startTime > 0)
         {
-            LARGE_INTEGER endTime{};
-            QueryPerformanceCounter(&endTime);
-            elapsedUs.QuadPart = endTime.QuadPart - startTime.QuadPart;
-            elapsedUs.QuadPart *= 1000000;
-            elapsedUs.QuadPart /= frequency.QuadPart;
-            auto elapsedMs = elapsedUs.QuadPart / 1000.0;
+            elapsedUs = timer::ticksToUs(timer::getTicks() - startTime);
+            auto elapsedMs = elapsedUs / 1000.0;
             add(elapsedMs);
         }
-#endif
     }
 
     //! NOT thread safe
@@ -371,19 +564,11 @@ struct TAverageValueMeter
     //! NOT thread safe
     int64_t timeFromLastTimestampUs()
     {
-#ifdef SL_WINDOWS
-        if (startTime.QuadPart > 0)
+        if (startTime > 0)
         {
-            LARGE_INTEGER endTime{};
-            QueryPerformanceCounter(&endTime);
-            elapsedUs.QuadPart = endTime.QuadPart - startTime.QuadPart;
-            elapsedUs.QuadPart *= 1000000;
-            elapsedUs.QuadPart /= frequency.QuadPart;
+            elapsedUs = timer::ticksToUs(timer::getTicks() - startTime);
         }
-        return elapsedUs.QuadPart;
-#else
-        return 0;
-#endif
+        return elapsedUs;
     }
 
     //! Performance sensitive code, can be called
@@ -401,32 +586,42 @@ struct TAverageValueMeter
             sum = sum - window[i];
         }
         window[i] = value;
+        percentiles.add(value);
         n++;
         mean = sum / double(std::min(n.load(), (uint64_t)window.size()));
     }
 
+    //! Exact median over the sliding window of the last WINDOW_SIZE samples
+    //! 
+    //! Selects in place on a stack copy of the window so there is no allocation or full sort.
+    //! 
     //! NOT thread safe
-    double getMedian()
+    double getMedian() const
     {
         if (n == 0) return 0.;
-        std::vector<double> tmp(window.begin(), window.begin() + std::min(n.load(), (uint64_t)window.size()));
-        std::sort(tmp.begin(), tmp.end());
-        uint32_t i = ((uint32_t)tmp.size()) / 2;
-        if (i * 2 != tmp.size()) // tmp has an odd number of elements?
+        std::array<double, WINDOW_SIZE> tmp = window;
+        auto count = (uint32_t)std::min(n.load(), (uint64_t)window.size());
+        auto i = count / 2;
+        std::nth_element(tmp.begin(), tmp.begin() + i, tmp.begin() + count);
+        if (i * 2 != count) // odd number of elements?
         {
             return tmp[i];
         }
-        return (tmp[i] + tmp[i - 1]) / 2;
+        // Lower middle is the largest element of the lower partition
+        return (tmp[i] + *std::max_element(tmp.begin(), tmp.begin() + i)) / 2;
     }
 
+    //! Estimated percentiles over the last full window, see TPercentileSketch
+    //! 
+    //! NOT thread safe
+    inline double getP50() const { static_assert(PERCENTILES, "Meter was not created with percentiles enabled"); return percentiles.getP50(); }
+    inline double getP90() const { static_assert(PERCENTILES, "Meter was not created with percentiles enabled"); return percentiles.getP90(); }
+    inline double getP99() const { static_assert(PERCENTILES, "Meter was not created with percentiles enabled"); return percentiles.getP99(); }
+
     //! NOT thread safe
     inline int64_t getElapsedTimeUs() const
     {
-#ifdef SL_WINDOWS
-        return elapsedUs.QuadPart;
-#else
-        return 0;
-#endif
+        return elapsedUs;
     }
 
     //! Thread safe
@@ -442,12 +637,10 @@ private:
 
     double sum{};
     std::array<double, WINDOW_SIZE> window;
+    std::conditional_t<PERCENTILES, TPercentileSketch<WINDOW_SIZE>, NoPercentileSketch> percentiles{};
 
-#ifdef SL_WINDOWS
-    LARGE_INTEGER frequency{};
-    LARGE_INTEGER startTime{};
-    LARGE_INTEGER elapsedUs{};
-#endif
+    int64_t startTime{};
+    int64_t elapsedUs{};
 };
 typedef TAverageValueMeter<kAverageMeterWindowSize> AverageValueMeter;
 
@@ -466,56 +659,198 @@ struct ScopedCPUTimer
     AverageValueMeter* m_meter{};
 };
 
-inline void format(std::ostringstream& stream, const char* str)
+namespace formatting
 {
-    stream << str;
-}
+#if defined(__cpp_consteval)
+#define SL_FORMAT_CONSTEVAL consteval
+#else
+#define SL_FORMAT_CONSTEVAL constexpr
+#endif
+
+template <class T>
+struct TypeIdentity { using type = T; };
 
-template <class Arg, class... Args>
-inline void format(std::ostringstream& stream, const char* str, Arg&& arg, Args&&... args)
+//! Intentionally not constexpr, calling it while parsing a format string at
+//! compile time turns a placeholder/argument count mismatch into a build error.
+inline void formatPlaceholderCountDoesNotMatchArguments() {}
+
+//! One '{}' or '{}%x' placeholder in a format string
+struct Placeholder
 {
-    auto p = strstr(str, "{}");
-    if (p)
+    size_t offset = 0;
+    bool hex = false;
+};
+
+//! Format string parsed at compile time
+//! 
+//! Offsets of all placeholders are computed when the literal is converted
+//! so formatting at runtime only copies segments and converts arguments.
+template <class... Args>
+struct FormatString
+{
+    static constexpr size_t kArgCount = sizeof...(Args);
+
+    template <size_t N>
+    SL_FORMAT_CONSTEVAL FormatString(const char(&s)[N]) : str(s), size(N - 1)
     {
-        stream.write(str, p - str);
-        auto p1 = strstr(p + 2, "%x");
-        if (p1 == p + 2)
+        size_t i = 0;
+        while (i + 1 < size)
         {
-            stream << std::hex;
+            if (s[i] == '{' && s[i + 1] == '}')
+            {
+                bool hex = i + 3 < size && s[i + 2] == '%' && s[i + 3] == 'x';
+                if (count < kArgCount)
+                {
+                    placeholders[count] = { i, hex };
+                }
+                count++;
+                i += hex ? 4 : 2;
+            }
+            else
+            {
+                i++;
+            }
         }
-        stream << arg;
-        if (p1 == p + 2)
+        if (count != kArgCount)
         {
-            stream << std::dec;
-            p += 2;
+            formatPlaceholderCountDoesNotMatchArguments();
         }
-        format(stream, p + 2, std::forward<Args>(args)...);
+    }
+
+    const char* str{};
+    size_t size{};
+    size_t count{};
+    std::array<Placeholder, kArgCount> placeholders{};
+};
+
+//! Small stack buffer which only touches the heap for long strings
+struct FormatBuffer
+{
+    void append(const char* s, size_t n)
+    {
+        if (m_heap.empty() && m_size + n <= sizeof(m_stack))
+        {
+            memcpy(m_stack + m_size, s, n);
+        }
+        else
+        {
+            if (m_heap.empty())
+            {
+                m_heap.reserve(2 * (m_size + n));
+                m_heap.assign(m_stack, m_size);
+            }
+            m_heap.append(s, n);
+        }
+        m_size += n;
+    }
+
+    std::string str()
+    {
+        return m_heap.empty() ? std::string(m_stack, m_size) : std::move(m_heap);
+    }
+
+private:
+    char m_stack[256];
+    size_t m_size = 0;
+    std::string m_heap;
+};
+
+//! Matches what the previous std::ostringstream based implementation produced,
+//! i.e. fixed notation with two decimals and std::hex for '{}%x'
+template <class T>
+inline void formatValue(FormatBuffer& buffer, const T& value, bool hex)
+{
+    using V = std::decay_t<T>;
+    if constexpr (std::is_same_v<V, bool>)
+    {
+        buffer.append(value ? "1" : "0", 1);
+    }
+    else if constexpr (std::is_same_v<V, char> || std::is_same_v<V, signed char> || std::is_same_v<V, unsigned char>)
+    {
+        buffer.append((const char*)&value, 1);
+    }
+    else if constexpr (std::is_integral_v<V>)
+    {
+        char tmp[32];
+        auto res = hex ? std::to_chars(tmp, tmp + sizeof(tmp), (std::make_unsigned_t<V>)value, 16) : std::to_chars(tmp, tmp + sizeof(tmp), value);
+        buffer.append(tmp, res.ptr - tmp);
+    }
+    else if constexpr (std::is_floating_point_v<V>)
+    {
+        // Enough for the largest value in fixed notation
+        char tmp[std::numeric_limits<V>::max_exponent10 + 32];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), value, std::chars_format::fixed, 2);
+        buffer.append(tmp, res.ptr - tmp);
+    }
+    else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>)
+    {
+        // String literals and char buffers, never null
+        buffer.append(value, strlen(value));
+    }
+    else if constexpr (std::is_same_v<V, const char*> || std::is_same_v<V, char*>)
+    {
+        if (value)
+        {
+            buffer.append(value, strlen(value));
+        }
+    }
+    else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+    {
+        std::string_view view = value;
+        buffer.append(view.data(), view.size());
     }
     else
     {
-        stream << str;
+        // Anything else must be streamable
+        std::ostringstream stream;
+        stream.precision(2);
+        stream << std::fixed;
+        if (hex)
+        {
+            stream << std::hex;
+        }
+        stream << value;
+        auto str = stream.str();
+        buffer.append(str.data(), str.size());
     }
- }
+}
+}
+
+template <class... Args>
+using FormatString = formatting::FormatString<typename formatting::TypeIdentity<Args>::type...>;
 
 /**
  * Formats a string similar to the {fmt} library (https://fmt.dev), but header-only and without requiring an external
  * library be included
  *
  * NOTE: This is not intended to be a full replacement for {fmt}. Only '{}' is supported (i.e. no non-positional
- * support). And any type can be formatted, but must be streamable (i.e. have an appropriate operator<<)
+ * support), optionally followed by '%x' for hexadecimal integers. Strings, integers and floating point values are
+ * converted directly into a stack buffer, any other type must be streamable (i.e. have an appropriate operator<<).
+ * Format string must be a literal, number of '{}' is checked against number of arguments at compile time.
  *
  * Example: format("{}, {} and {}: {}", "Peter", "Paul", "Mary", 42) would produce the string "Peter, Paul and Mary: 42"
  * @param str The format string. Use '{}' to indicate where the next parameter would be inserted.
  * @returns The formatted string
  */
 template <class... Args>
-inline std::string format(const char* str, Args&&... args)
+inline std::string format(FormatString<Args...> str, Args&&... args)
 {
-    std::ostringstream stream;
-    stream.precision(2);
-    stream << std::fixed;
-    extra::format(stream, str, std::forward<Args>(args)...);
-    return stream.str();
+    formatting::FormatBuffer buffer;
+    size_t pos = 0;
+    size_t index = 0;
+    // Unused when there are no arguments
+    [[maybe_unused]] auto formatArg = [&](const auto& arg)
+    {
+        // Extra arguments without a placeholder are ignored
+        if (index >= str.count) return;
+        auto& placeholder = str.placeholders[index++];
+        buffer.append(str.str + pos, placeholder.offset - pos);
+        formatting::formatValue(buffer, arg, placeholder.hex);
+        pos = placeholder.offset + (placeholder.hex ? 4 : 2);
+    };
+    (formatArg(args), ...);
+    buffer.append(str.str + pos, str.size - pos);
+    return buffer.str();
 }
 
 }
@@ -0,0 +1,355 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cwchar>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SL_UTF_SSE2 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define SL_UTF_NEON 1
+#endif
+
+namespace sl
+{
+
+namespace extra
+{
+
+//! Validating UTF-8 <-> UTF-16 transcoding
+//!
+//! Wide strings always hold UTF-16 code units, including on platforms where
+//! wchar_t is 32-bit, which matches what std::codecvt_utf8_utf16 produced.
+//! For convenience full code points in a 32-bit wchar_t are accepted on input.
+//!
+//! Invalid input (overlong or truncated sequences, unpaired surrogates, code points
+//! above U+10FFFF) is replaced with U+FFFD and reported via the optional 'valid' flag.
+//!
+//! Runs of ASCII, which is what paths and module names mostly are, are converted
+//! 16 bytes at a time with SSE2/NEON.
+namespace utf
+{
+
+constexpr uint32_t kReplacementChar = 0xFFFD;
+
+#if SL_UTF_SSE2
+inline bool isAscii16(const char* src)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)src)) == 0;
+}
+
+inline void widenAscii16(const char* src, wchar_t* dst)
+{
+    auto v = _mm_loadu_si128((const __m128i*)src);
+    auto zero = _mm_setzero_si128();
+    auto lo = _mm_unpacklo_epi8(v, zero);
+    auto hi = _mm_unpackhi_epi8(v, zero);
+    if constexpr (sizeof(wchar_t) == 2)
+    {
+        _mm_storeu_si128((__m128i*)dst, lo);
+        _mm_storeu_si128((__m128i*)(dst + 8), hi);
+    }
+    else
+    {
+        _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(dst + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(dst + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i*)(dst + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+}
+
+//! Returns false without writing anything if any of the 16 units is not ASCII
+inline bool narrowAscii16(const wchar_t* src, char* dst)
+{
+    __m128i v;
+    if constexpr (sizeof(wchar_t) == 2)
+    {
+        auto a = _mm_loadu_si128((const __m128i*)src);
+        auto b = _mm_loadu_si128((const __m128i*)(src + 8));
+        auto mask = _mm_set1_epi16((short)0xff80);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), mask), _mm_setzero_si128())) != 0xffff) return false;
+        v = _mm_packus_epi16(a, b);
+    }
+    else
+    {
+        auto a = _mm_loadu_si128((const __m128i*)src);
+        auto b = _mm_loadu_si128((const __m128i*)(src + 4));
+        auto c = _mm_loadu_si128((const __m128i*)(src + 8));
+        auto d = _mm_loadu_si128((const __m128i*)(src + 12));
+        auto any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        auto mask = _mm_set1_epi32((int)0xffffff80);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, mask), _mm_setzero_si128())) != 0xffff) return false;
+        // Values are below 0x80 so signed saturation is lossless
+        v = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+    }
+    _mm_storeu_si128((__m128i*)dst, v);
+    return true;
+}
+#elif SL_UTF_NEON
+inline bool isAscii16(const char* src)
+{
+    return vmaxvq_u8(vld1q_u8((const uint8_t*)src)) < 0x80;
+}
+
+inline void widenAscii16(const char* src, wchar_t* dst)
+{
+    auto v = vld1q_u8((const uint8_t*)src);
+    auto lo = vmovl_u8(vget_low_u8(v));
+    auto hi = vmovl_u8(vget_high_u8(v));
+    if constexpr (sizeof(wchar_t) == 2)
+    {
+        vst1q_u16((uint16_t*)dst, lo);
+        vst1q_u16((uint16_t*)(dst + 8), hi);
+    }
+    else
+    {
+        vst1q_u32((uint32_t*)dst, vmovl_u16(vget_low_u16(lo)));
+        vst1q_u32((uint32_t*)(dst + 4), vmovl_u16(vget_high_u16(lo)));
+        vst1q_u32((uint32_t*)(dst + 8), vmovl_u16(vget_low_u16(hi)));
+        vst1q_u32((uint32_t*)(dst + 12), vmovl_u16(vget_high_u16(hi)));
+    }
+}
+
+//! Returns false without writing anything if any of the 16 units is not ASCII
+inline bool narrowAscii16(const wchar_t* src, char* dst)
+{
+    uint16x8_t a, b;
+    if constexpr (sizeof(wchar_t) == 2)
+    {
+        a = vld1q_u16((const uint16_t*)src);
+        b = vld1q_u16((const uint16_t*)(src + 8));
+    }
+    else
+    {
+        auto a0 = vld1q_u32((const uint32_t*)src);
+        auto a1 = vld1q_u32((const uint32_t*)(src + 4));
+        auto b0 = vld1q_u32((const uint32_t*)(src + 8));
+        auto b1 = vld1q_u32((const uint32_t*)(src + 12));
+        if (vmaxvq_u32(vmaxq_u32(vmaxq_u32(a0, a1), vmaxq_u32(b0, b1))) >= 0x80) return false;
+        a = vcombine_u16(vmovn_u32(a0), vmovn_u32(a1));
+        b = vcombine_u16(vmovn_u32(b0), vmovn_u32(b1));
+    }
+    if (vmaxvq_u16(vmaxq_u16(a, b)) >= 0x80) return false;
+    vst1q_u8((uint8_t*)dst, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    return true;
+}
+#endif
+
+//! Decodes one code point, returns number of bytes consumed (always at least one)
+inline size_t decodeUtf8(const uint8_t* src, size_t size, uint32_t& cp, bool& valid)
+{
+    uint8_t c = src[0];
+    if (c < 0x80)
+    {
+        cp = c;
+        return 1;
+    }
+    size_t len;
+    uint32_t min;
+    if ((c & 0xe0) == 0xc0) { len = 2; cp = c & 0x1f; min = 0x80; }
+    else if ((c & 0xf0) == 0xe0) { len = 3; cp = c & 0x0f; min = 0x800; }
+    else if ((c & 0xf8) == 0xf0) { len = 4; cp = c & 0x07; min = 0x10000; }
+    else
+    {
+        // Stray continuation byte or invalid lead byte
+        valid = false;
+        cp = kReplacementChar;
+        return 1;
+    }
+    for (size_t i = 1; i < len; i++)
+    {
+        if (i >= size || (src[i] & 0xc0) != 0x80)
+        {
+            // Truncated sequence, resume at the offending byte
+            valid = false;
+            cp = kReplacementChar;
+            return i;
+        }
+        cp = (cp << 6) | (src[i] & 0x3f);
+    }
+    if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff))
+    {
+        valid = false;
+        cp = kReplacementChar;
+    }
+    return len;
+}
+
+//! Decodes one code point, returns number of units consumed (always at least one)
+inline size_t decodeUtf16(const wchar_t* src, size_t size, uint32_t& cp, bool& valid)
+{
+    uint32_t c = (uint32_t)src[0];
+    // With 32-bit wchar_t accept full code points as well
+    if (c < 0xd800 || (c > 0xdfff && c <= 0x10ffff))
+    {
+        cp = c;
+        return 1;
+    }
+    if (c <= 0xdbff && size > 1)
+    {
+        uint32_t c1 = (uint32_t)src[1];
+        if (c1 >= 0xdc00 && c1 <= 0xdfff)
+        {
+            cp = 0x10000 + ((c - 0xd800) << 10) + (c1 - 0xdc00);
+            return 2;
+        }
+    }
+    // Unpaired surrogate or out of range unit
+    valid = false;
+    cp = kReplacementChar;
+    return 1;
+}
+
+//! Converts 'size' bytes of UTF-8 into 'dst' writing at most 'capacity' units
+//!
+//! Returns number of UTF-16 units required for the whole input, output is not null terminated.
+//! Call with a null 'dst' to query the size.
+inline size_t utf8ToUtf16(const char* src, size_t size, wchar_t* dst, size_t capacity, bool* valid = nullptr)
+{
+    bool ok = true;
+    size_t i = 0, n = 0;
+    if (!dst) capacity = 0;
+    while (i < size)
+    {
+#if SL_UTF_SSE2 || SL_UTF_NEON
+        if (i + 16 <= size && isAscii16(src + i))
+        {
+            if (n + 16 <= capacity)
+            {
+                widenAscii16(src + i, dst + n);
+            }
+            else
+            {
+                for (size_t k = 0; k < 16 && n + k < capacity; k++) dst[n + k] = (wchar_t)src[i + k];
+            }
+            i += 16;
+            n += 16;
+            continue;
+        }
+#endif
+        uint32_t cp;
+        i += decodeUtf8((const uint8_t*)src + i, size - i, cp, ok);
+        if (cp < 0x10000)
+        {
+            if (n < capacity) dst[n] = (wchar_t)cp;
+            n++;
+        }
+        else
+        {
+            cp -= 0x10000;
+            if (n < capacity) dst[n] = (wchar_t)(0xd800 + (cp >> 10));
+            if (n + 1 < capacity) dst[n + 1] = (wchar_t)(0xdc00 + (cp & 0x3ff));
+            n += 2;
+        }
+    }
+    if (valid) *valid = ok;
+    return n;
+}
+
+//! Converts 'size' UTF-16 units into 'dst' writing at most 'capacity' bytes
+//!
+//! Returns number of bytes required for the whole input, output is not null terminated.
+//! Call with a null 'dst' to query the size.
+inline size_t utf16ToUtf8(const wchar_t* src, size_t size, char* dst, size_t capacity, bool* valid = nullptr)
+{
+    bool ok = true;
+    size_t i = 0, n = 0;
+    if (!dst) capacity = 0;
+    while (i < size)
+    {
+#if SL_UTF_SSE2 || SL_UTF_NEON
+        if (i + 16 <= size && n + 16 <= capacity && narrowAscii16(src + i, dst + n))
+        {
+            i += 16;
+            n += 16;
+            continue;
+        }
+#endif
+        uint32_t cp;
+        i += decodeUtf16(src + i, size - i, cp, ok);
+        char tmp[4];
+        size_t len;
+        if (cp < 0x80)
+        {
+            tmp[0] = (char)cp;
+            len = 1;
+        }
+        else if (cp < 0x800)
+        {
+            tmp[0] = (char)(0xc0 | (cp >> 6));
+            tmp[1] = (char)(0x80 | (cp & 0x3f));
+            len = 2;
+        }
+        else if (cp < 0x10000)
+        {
+            tmp[0] = (char)(0xe0 | (cp >> 12));
+            tmp[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+            tmp[2] = (char)(0x80 | (cp & 0x3f));
+            len = 3;
+        }
+        else
+        {
+            tmp[0] = (char)(0xf0 | (cp >> 18));
+            tmp[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+            tmp[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+            tmp[3] = (char)(0x80 | (cp & 0x3f));
+            len = 4;
+        }
+        for (size_t k = 0; k < len; k++, n++)
+        {
+            if (n < capacity) dst[n] = tmp[k];
+        }
+    }
+    if (valid) *valid = ok;
+    return n;
+}
+
+}
+
+inline std::wstring utf8ToUtf16(const char* source)
+{
+    if (!source) return {};
+    auto size = strlen(source);
+    // Never more UTF-16 units than UTF-8 bytes
+    std::wstring result(size, L'\0');
+    result.resize(utf::utf8ToUtf16(source, size, result.data(), result.size()));
+    return result;
+}
+
+inline std::string utf16ToUtf8(const wchar_t* source)
+{
+    if (!source) return {};
+    auto size = wcslen(source);
+    // Never more than three UTF-8 bytes per UTF-16 unit, a full code point in a 32-bit wchar_t can take four
+    std::string result(size * (sizeof(wchar_t) == 4 ? 4 : 3), '\0');
+    result.resize(utf::utf16ToUtf8(source, size, result.data(), result.size()));
+    return result;
+}
+
+}
+}
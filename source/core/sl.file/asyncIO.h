@@ -0,0 +1,320 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+
+#include "source/core/sl.file/file.h"
+
+namespace sl
+{
+namespace file
+{
+
+using IORequestId = uint64_t;
+
+enum class IOOperation : uint32_t
+{
+    eRead,
+    eWrite,
+    eAppend
+};
+
+struct IOCompletion
+{
+    IORequestId id{};
+    IOOperation op{};
+    bool success = false;
+    //! Bytes read or written
+    size_t bytes{};
+    //! Valid for reads only, callback is free to move it out
+    std::vector<uint8_t>* data{};
+};
+
+using PFunIOCompletion = std::function<void(IOCompletion& completion)>;
+
+//! Asynchronous batched file I/O
+//!
+//! Requests are routed to one of the worker threads based on the file path
+//! so requests for the same file always complete in submission order.
+//! Each worker drains its whole queue as a batch and opens every file
+//! only once per batch, consecutive appends to a log or capture stream
+//! therefore turn into a single open/write/close.
+//!
+//! Completion callbacks run on the worker thread, they may submit new requests
+//! but flush() called from a callback never blocks, see below.
+//!
+//! NOTE: This is a portable thread based backend, there is no io_uring or
+//! overlapped I/O dependency in the tree. Interface does not expose threads
+//! so a native backend can be slotted in later.
+class AsyncIO
+{
+    struct Request
+    {
+        IORequestId id{};
+        IOOperation op{};
+        std::wstring path;
+        std::vector<uint8_t> data;
+        PFunIOCompletion callback;
+        bool success = false;
+        size_t bytes{};
+    };
+
+    struct Worker
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::deque<Request> queue;
+        std::thread thread;
+        //! Requests are queued and completed in id order per worker, 'lastSubmitted' is guarded by 'mtx'
+        //! and 'lastCompleted' by 'm_pendingMtx'
+        IORequestId lastSubmitted{};
+        IORequestId lastCompleted{};
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_quit = false;
+    std::atomic<IORequestId> m_nextId = 1;
+
+    std::mutex m_pendingMtx;
+    std::condition_variable m_pendingCv;
+    size_t m_pending = 0;
+
+    void complete(Worker* worker, Request& req, bool success, size_t bytes)
+    {
+        if (req.callback)
+        {
+            IOCompletion completion{ req.id, req.op, success, bytes, req.op == IOOperation::eRead ? &req.data : nullptr };
+            req.callback(completion);
+        }
+        std::unique_lock<std::mutex> lock(m_pendingMtx);
+        m_pending--;
+        worker->lastCompleted = req.id;
+        m_pendingCv.notify_all();
+    }
+
+    void processRead(Worker* worker, Request& req)
+    {
+        bool success = false;
+        size_t bytes = 0;
+        auto file = file::open(req.path.c_str(), L"rb");
+        if (file)
+        {
+            std::error_code ec;
+            auto size = fs::file_size(req.path, ec);
+            if (!ec)
+            {
+                req.data.resize((size_t)size);
+                bytes = readChunk(file, req.data.data(), req.data.size());
+                req.data.resize(bytes);
+                success = bytes == size;
+            }
+            file::close(file);
+        }
+        complete(worker, req, success, bytes);
+    }
+
+    //! Writes a run of requests targeting the same file using a single open
+    //!
+    //! Requests are completed once the file is closed so whoever is notified can read the data back.
+    void processWrites(Worker* worker, std::deque<Request>& batch, size_t first, size_t last)
+    {
+        auto& head = batch[first];
+        auto file = file::open(head.path.c_str(), head.op == IOOperation::eAppend ? L"ab" : L"wb");
+        for (size_t i = first; i < last; i++)
+        {
+            auto& req = batch[i];
+            if (file && req.op == IOOperation::eWrite && i != first)
+            {
+                // Full overwrite in the middle of the run, start over
+                file::close(file);
+                file = file::open(req.path.c_str(), L"wb");
+            }
+            if (file)
+            {
+                req.bytes = writeChunk(file, req.data.data(), req.data.size());
+                req.success = req.bytes == req.data.size();
+            }
+        }
+        if (file)
+        {
+            file::close(file);
+        }
+        for (size_t i = first; i < last; i++)
+        {
+            complete(worker, batch[i], batch[i].success, batch[i].bytes);
+        }
+    }
+
+    void workerFunction(Worker* worker)
+    {
+        std::deque<Request> batch;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(worker->mtx);
+                worker->cv.wait(lock, [this, worker] { return m_quit || !worker->queue.empty(); });
+                if (worker->queue.empty() && m_quit)
+                {
+                    break;
+                }
+                batch.swap(worker->queue);
+            }
+            size_t i = 0;
+            while (i < batch.size())
+            {
+                if (batch[i].op == IOOperation::eRead)
+                {
+                    processRead(worker, batch[i++]);
+                    continue;
+                }
+                auto last = i + 1;
+                while (last < batch.size() && batch[last].op != IOOperation::eRead && batch[last].path == batch[i].path)
+                {
+                    last++;
+                }
+                processWrites(worker, batch, i, last);
+                i = last;
+            }
+            batch.clear();
+        }
+    }
+
+    IORequestId submit(IOOperation op, const wchar_t* path, std::vector<uint8_t>&& data, const PFunIOCompletion& callback)
+    {
+        Request req{ 0, op, path, std::move(data), callback };
+        {
+            std::unique_lock<std::mutex> lock(m_pendingMtx);
+            m_pending++;
+        }
+        auto& worker = m_workers[std::hash<std::wstring>{}(req.path) % m_workers.size()];
+        IORequestId id;
+        {
+            // Id is taken under the worker lock so each queue is in id order
+            std::unique_lock<std::mutex> lock(worker->mtx);
+            id = req.id = m_nextId++;
+            worker->lastSubmitted = id;
+            worker->queue.push_back(std::move(req));
+        }
+        worker->cv.notify_one();
+        return id;
+    }
+
+public:
+    AsyncIO(const AsyncIO&) = delete;
+
+    //! 'name' is shown in the debugger on Windows
+    AsyncIO([[maybe_unused]] const wchar_t* name, uint32_t threadCount = 1)
+    {
+        threadCount = std::max(1u, threadCount);
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            auto worker = std::make_unique<Worker>();
+            worker->thread = std::thread(&AsyncIO::workerFunction, this, worker.get());
+#ifdef SL_WINDOWS
+            SetThreadDescription(worker->thread.native_handle(), name);
+#endif
+            m_workers.push_back(std::move(worker));
+        }
+    }
+
+    //! Completes all outstanding requests before returning
+    ~AsyncIO()
+    {
+        m_quit = true;
+        for (auto& worker : m_workers)
+        {
+            {
+                std::unique_lock<std::mutex> lock(worker->mtx);
+            }
+            worker->cv.notify_all();
+            worker->thread.join();
+        }
+    }
+
+    //! Replaces file contents with 'data'
+    IORequestId write(const wchar_t* path, std::vector<uint8_t>&& data, const PFunIOCompletion& callback = {})
+    {
+        return submit(IOOperation::eWrite, path, std::move(data), callback);
+    }
+
+    //! Appends 'data' to the file, creating it if needed
+    IORequestId append(const wchar_t* path, std::vector<uint8_t>&& data, const PFunIOCompletion& callback = {})
+    {
+        return submit(IOOperation::eAppend, path, std::move(data), callback);
+    }
+
+    //! Reads the whole file, contents are provided via IOCompletion::data
+    IORequestId read(const wchar_t* path, const PFunIOCompletion& callback)
+    {
+        return submit(IOOperation::eRead, path, {}, callback);
+    }
+
+    //! Waits for all requests submitted before the call, returns false on timeout
+    //!
+    //! Requests submitted while waiting, from any thread, are not waited for.
+    //! When called from a completion callback it only reports whether everything
+    //! is already done, blocking there would wait on the calling worker itself.
+    bool flush(uint32_t timeoutMs = UINT_MAX)
+    {
+        std::vector<IORequestId> targets(m_workers.size());
+        bool onWorker = false;
+        for (size_t i = 0; i < m_workers.size(); i++)
+        {
+            std::unique_lock<std::mutex> lock(m_workers[i]->mtx);
+            targets[i] = m_workers[i]->lastSubmitted;
+            onWorker |= m_workers[i]->thread.get_id() == std::this_thread::get_id();
+        }
+        auto done = [this, &targets]()->bool
+        {
+            for (size_t i = 0; i < m_workers.size(); i++)
+            {
+                if (m_workers[i]->lastCompleted < targets[i]) return false;
+            }
+            return true;
+        };
+        std::unique_lock<std::mutex> lock(m_pendingMtx);
+        if (onWorker)
+        {
+            return done();
+        }
+        if (timeoutMs == UINT_MAX)
+        {
+            m_pendingCv.wait(lock, done);
+            return true;
+        }
+        return m_pendingCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), done);
+    }
+
+    size_t getPendingCount()
+    {
+        std::unique_lock<std::mutex> lock(m_pendingMtx);
+        return m_pending;
+    }
+};
+
+}
+}
@@ -48,6 +48,9 @@
 EXTERN_C IMAGE_DOS_HEADER __ImageBase; // MS linker feature
 #else
 #include <linux/limits.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 namespace fs = std::filesystem;
@@ -173,6 +176,135 @@ inline std::vector<uint8_t> read(const wchar_t* fname)
     return ret_buffer;
 }
 
+//! Read-only memory mapped view of a whole file
+//! 
+//! Contents are paged in on demand straight from the OS file cache so
+//! large files are not copied into a heap buffer like 'read' does.
+//! Views are independent, the same file can be mapped multiple times
+//! and from multiple threads.
+//! 
+//! NOTE: Empty files map successfully with a null data pointer and zero size.
+class MappedView
+{
+public:
+    MappedView() = default;
+    MappedView(const wchar_t* fname) { map(fname); }
+    ~MappedView() { unmap(); }
+
+    MappedView(const MappedView&) = delete;
+    MappedView& operator=(const MappedView&) = delete;
+
+    MappedView(MappedView&& rhs) noexcept { *this = std::move(rhs); }
+    MappedView& operator=(MappedView&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            unmap();
+            std::swap(m_data, rhs.m_data);
+            std::swap(m_size, rhs.m_size);
+            std::swap(m_valid, rhs.m_valid);
+        }
+        return *this;
+    }
+
+    bool map(const wchar_t* fname)
+    {
+        unmap();
+#ifdef SL_WINDOWS
+        HANDLE file = CreateFileW(fname, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            SL_LOG_ERROR("Unable to open file '%S' for mapping (error code %" PRIu32 ")", fname, GetLastError());
+            return false;
+        }
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size))
+        {
+            SL_LOG_ERROR("Unable to get size of file '%S' (error code %" PRIu32 ")", fname, GetLastError());
+            CloseHandle(file);
+            return false;
+        }
+        if (size.QuadPart > 0)
+        {
+            // View keeps the section alive, no need to hold on to any of the handles
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+            {
+                m_data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+            }
+            if (!m_data)
+            {
+                SL_LOG_ERROR("Unable to map file '%S' (error code %" PRIu32 ")", fname, GetLastError());
+                CloseHandle(file);
+                return false;
+            }
+        }
+        CloseHandle(file);
+        m_size = (size_t)size.QuadPart;
+#else
+        int fd = ::open(extra::toStr(fname).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            SL_LOG_ERROR("Unable to open file '%S' for mapping (%s)", fname, strerror(errno));
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0)
+        {
+            SL_LOG_ERROR("Unable to get size of file '%S' (%s)", fname, strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        if (st.st_size > 0)
+        {
+            // Mapping keeps the file referenced after the descriptor is closed
+            auto data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                SL_LOG_ERROR("Unable to map file '%S' (%s)", fname, strerror(errno));
+                ::close(fd);
+                return false;
+            }
+            m_data = (const uint8_t*)data;
+        }
+        ::close(fd);
+        m_size = (size_t)st.st_size;
+#endif
+        m_valid = true;
+        return true;
+    }
+
+    void unmap()
+    {
+        if (m_data)
+        {
+#ifdef SL_WINDOWS
+            UnmapViewOfFile(m_data);
+#else
+            munmap((void*)m_data, m_size);
+#endif
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_valid = false;
+    }
+
+    //! True if mapping succeeded, including for empty files
+    inline bool isValid() const { return m_valid; }
+    inline bool empty() const { return m_size == 0; }
+    inline const uint8_t* data() const { return m_data; }
+    inline size_t size() const { return m_size; }
+    inline const uint8_t* begin() const { return m_data; }
+    inline const uint8_t* end() const { return m_data + m_size; }
+    inline std::string_view asString() const { return std::string_view((const char*)m_data, m_size); }
+
+private:
+    const uint8_t* m_data{};
+    size_t m_size{};
+    bool m_valid = false;
+};
+
 inline const wchar_t* getTmpPath()
 {
     static std::wstring g_result;
@@ -356,8 +488,7 @@ inline std::wstring getFullPathOfExecutable()
 #else
     char exePath[PATH_MAX] = {};
     readlink("/proc/self/exe", exePath, sizeof(exePath));
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert;
-    return convert.from_bytes(exePath);
+    return extra::utf8ToUtf16(exePath);
 #endif
 }
 
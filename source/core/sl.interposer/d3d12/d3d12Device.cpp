@@ -436,7 +436,7 @@ HRESULT STDMETHODCALLTYPE D3D12Device::CreateCommandQueue(const D3D12_COMMAND_QU
 
     if(ppCommandQueue && *ppCommandQueue)
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eID3D12Device_CreateCommandQueue);
+        const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eID3D12Device_CreateCommandQueue);
         for (auto [hook, feature] : hooks) ((PFunCreateCommandQueueAfter*)hook)(pDesc, riid, ppCommandQueue);
     }
 
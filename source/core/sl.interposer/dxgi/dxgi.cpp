@@ -88,7 +88,7 @@ HRESULT STDMETHODCALLTYPE IDXGIFactory_CreateSwapChain(IDXGIFactory* pFactory, I
     HRESULT hr = S_OK;
     bool skip = false;
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
         for (auto [hook, feature] : hooks)
         {
             hr = ((PFunCreateSwapChainBefore*)hook)(pFactory, pDevice, &desc, ppSwapChain, skip);
@@ -111,7 +111,7 @@ HRESULT STDMETHODCALLTYPE IDXGIFactory_CreateSwapChain(IDXGIFactory* pFactory, I
     }
 
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
+        const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
         for (auto [hook, feature] : hooks) ((PFunCreateSwapChainAfter*)hook)(pFactory, pDevice, &desc, ppSwapChain);
     }
 
@@ -157,7 +157,7 @@ HRESULT STDMETHODCALLTYPE IDXGIFactory2_CreateSwapChainForHwnd(IDXGIFactory2* pF
     HRESULT hr = S_OK;
     bool skip = false;
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
         for (auto [hook, feature] : hooks)
         {
             hr = ((PFunCreateSwapChainForHwndBefore*)hook)(pFactory, pDevice, hWnd, &desc, pFullscreenDesc, pRestrictToOutput, ppSwapChain, skip);
@@ -180,7 +180,7 @@ HRESULT STDMETHODCALLTYPE IDXGIFactory2_CreateSwapChainForHwnd(IDXGIFactory2* pF
     }
 
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
+        const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
         for (auto [hook, feature] : hooks) ((PFunCreateSwapChainForHwndAfter*)hook)(pFactory, pDevice, hWnd, &desc, pFullscreenDesc, pRestrictToOutput, ppSwapChain);
     }
     setupSwapchainProxy(*ppSwapChain, d3dVersion, deviceProxy, desc.BufferUsage);
@@ -215,7 +215,7 @@ HRESULT STDMETHODCALLTYPE IDXGIFactory2_CreateSwapChainForCoreWindow(IDXGIFactor
     HRESULT hr = S_OK;
     bool skip = false;
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
         for (auto [hook, feature] : hooks)
         {
             hr = ((PFunCreateSwapChainForCoreWindowBefore*)hook)(pFactory, pDevice, pWindow, &desc, pRestrictToOutput, ppSwapChain, skip);
@@ -239,7 +239,7 @@ HRESULT STDMETHODCALLTYPE IDXGIFactory2_CreateSwapChainForCoreWindow(IDXGIFactor
     }
     
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
+        const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
         for (auto [hook, feature] : hooks) ((PFunCreateSwapChainForCoreWindowAfter*)hook)(pFactory, pDevice, pWindow, &desc, pRestrictToOutput, ppSwapChain);
     }
 
@@ -275,7 +275,7 @@ HRESULT STDMETHODCALLTYPE DXGIFactory::CreateSwapChain(IUnknown* pDevice, DXGI_S
     HRESULT hr = S_OK;
     bool skip = false;
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
         for (auto [hook, feature] : hooks)
         {
             hr = ((PFunCreateSwapChainBefore*)hook)(m_base, pDevice, &desc, ppSwapChain, skip);
@@ -298,7 +298,7 @@ HRESULT STDMETHODCALLTYPE DXGIFactory::CreateSwapChain(IUnknown* pDevice, DXGI_S
     }
 
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
+        const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChain);
         for (auto [hook, feature] : hooks) ((PFunCreateSwapChainAfter*)hook)(m_base, pDevice, &desc, ppSwapChain);
     }
 
@@ -366,7 +366,7 @@ HRESULT STDMETHODCALLTYPE DXGIFactory::CreateSwapChainForHwnd(IUnknown* pDevice,
     HRESULT hr = S_OK;
     bool skip = false;
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
         for (auto [hook, feature] : hooks)
         {
             hr = ((PFunCreateSwapChainForHwndBefore*)hook)((IDXGIFactory2*)m_base, pDevice, hWnd, &desc, pFullscreenDesc, pRestrictToOutput, ppSwapChain, skip);
@@ -389,7 +389,7 @@ HRESULT STDMETHODCALLTYPE DXGIFactory::CreateSwapChainForHwnd(IUnknown* pDevice,
     }
 
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
+        const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForHwnd);
         for (auto [hook, feature] : hooks) ((PFunCreateSwapChainForHwndAfter*)hook)((IDXGIFactory2*)m_base, pDevice, hWnd, &desc, pFullscreenDesc, pRestrictToOutput, ppSwapChain);
     }
     setupSwapchainProxy(*ppSwapChain, d3dVersion, deviceProxy, desc.BufferUsage);
@@ -427,7 +427,7 @@ HRESULT STDMETHODCALLTYPE DXGIFactory::CreateSwapChainForCoreWindow(
     HRESULT hr = S_OK;
     bool skip = false;
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
         for (auto [hook, feature] : hooks)
         {
             hr = ((PFunCreateSwapChainForCoreWindowBefore*)hook)((IDXGIFactory2*)m_base, pDevice, pWindow, &desc, pRestrictToOutput, ppSwapChain, skip);
@@ -450,7 +450,7 @@ HRESULT STDMETHODCALLTYPE DXGIFactory::CreateSwapChainForCoreWindow(
     }
 
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
+        const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGIFactory_CreateSwapChainForCoreWindow);
         for (auto [hook, feature] : hooks) ((PFunCreateSwapChainForCoreWindowAfter*)hook)((IDXGIFactory2*)m_base, pDevice, pWindow, &desc, pRestrictToOutput, ppSwapChain);
     }
 
@@ -178,7 +178,7 @@ ULONG   STDMETHODCALLTYPE DXGISwapChain::Release()
     {
         // Inform our plugins that swap-chain is just about to be destroyed
         SL_EXCEPTION_HANDLE_START
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGISwapChain_Destroyed);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGISwapChain_Destroyed);
         for (auto [hook, feature] : hooks)
         {
             ((PFunSwapchainDestroyedBefore*)hook)(m_base);
@@ -244,7 +244,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present(UINT SyncInterval, UINT Flags)
     auto present = [this](UINT SyncInterval, UINT Flags)->HRESULT
     {
         auto hooksId = FunctionHookID::eIDXGISwapChain_Present;
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(hooksId);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(hooksId);
         bool skip = false;
         HRESULT hr = S_OK;
         for (auto [hook, feature] : hooks)
@@ -258,10 +258,11 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present(UINT SyncInterval, UINT Flags)
         }
 
         if (!skip) hr = m_base->Present(SyncInterval, Flags);
+        sl::plugin_manager::getInterface()->onPresent();
 
         if (g_swapChainTracker.notifyAfterPresent(this, skip))
         {
-            const auto& hooksAfter = sl::plugin_manager::getInterface()->getAfterHooks(hooksId);
+            const auto& hooksAfter = sl::plugin_manager::getAfterHooks(hooksId);
             for (auto [hook, feature] : hooksAfter)
             {
                 hr = ((PFunPresentAfter*)hook)(Flags);
@@ -282,7 +283,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present(UINT SyncInterval, UINT Flags)
 HRESULT STDMETHODCALLTYPE DXGISwapChain::GetBuffer(UINT Buffer, REFIID riid, void** ppSurface)
 {
     SL_EXCEPTION_HANDLE_START
-    const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGISwapChain_GetBuffer);
+    const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGISwapChain_GetBuffer);
     bool skip = false;
     for (auto [hook, feature] : hooks) ((PFunGetBufferBefore*)hook)(m_base, Buffer, riid, ppSurface, skip);
 
@@ -302,7 +303,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::SetFullscreenState(BOOL Fullscreen, IDX
         HRESULT hr = S_OK;
 
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGISwapChain_SetFullscreenState);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGISwapChain_SetFullscreenState);
             for (auto [hook, feature] : hooks)
             {
                 hr = ((PFunSetFullscreenStateBefore*)hook)(m_base, Fullscreen, pTarget, skip);
@@ -325,7 +326,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::SetFullscreenState(BOOL Fullscreen, IDX
         }
 
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGISwapChain_SetFullscreenState);
+            const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGISwapChain_SetFullscreenState);
             for (auto [hook, feature] : hooks)
             {
                 hr = ((PFunSetFullscreenStateAfter*)hook)(m_base, Fullscreen, pTarget);
@@ -362,7 +363,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::GetDesc(DXGI_SWAP_CHAIN_DESC* pDesc)
         }
         // plugins may want to adjust pDesc - give them the chance
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGISwapChain_GetDesc);
+            const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGISwapChain_GetDesc);
             for (auto [hook, feature] : hooks)
             {
                 hr = ((PFunGetDescAfter*)hook)(m_base, pDesc);
@@ -386,7 +387,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::ResizeBuffers(UINT BufferCount, UINT Wi
         bool Skip = false;
         HRESULT hr = S_OK;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers);
             for (auto [hook, feature] : hooks)
             {
                 hr = ((PFunResizeBuffersBefore*)hook)(m_base, BufferCount, Width, Height, NewFormat, SwapChainFlags, Skip);
@@ -410,7 +411,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::ResizeBuffers(UINT BufferCount, UINT Wi
         }
 
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers);
+            const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers);
             for (auto [hook, feature] : hooks)
             {
                 hr = ((PFunResizeBuffersAfter*)hook)(m_base, BufferCount, Width, Height, NewFormat, SwapChainFlags);
@@ -481,7 +482,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present1(UINT SyncInterval, UINT Presen
     auto present = [this](UINT SyncInterval, UINT PresentFlags, const DXGI_PRESENT_PARAMETERS* pPresentParameters)->HRESULT
     {
         auto hooksId = FunctionHookID::eIDXGISwapChain_Present1;
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(hooksId);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(hooksId);
         bool skip = false;
         HRESULT hr = S_OK;
         for (auto [hook, feature] : hooks)
@@ -498,10 +499,11 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::Present1(UINT SyncInterval, UINT Presen
         {
             hr = static_cast<IDXGISwapChain1*>(m_base)->Present1(SyncInterval, PresentFlags, pPresentParameters);
         }
+        sl::plugin_manager::getInterface()->onPresent();
 
         if (g_swapChainTracker.notifyAfterPresent(this, skip))
         {
-            const auto& hooksAfter = sl::plugin_manager::getInterface()->getAfterHooks(hooksId);
+            const auto& hooksAfter = sl::plugin_manager::getAfterHooks(hooksId);
             for (auto [hook, feature] : hooksAfter)
             {
                 hr = ((PFunPresentAfter*)hook)(PresentFlags);
@@ -576,7 +578,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::GetMatrixTransform(DXGI_MATRIX_3X2_F* p
 UINT STDMETHODCALLTYPE DXGISwapChain::GetCurrentBackBufferIndex()
 {
     SL_EXCEPTION_HANDLE_START
-    const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGISwapChain_GetCurrentBackBufferIndex);
+    const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGISwapChain_GetCurrentBackBufferIndex);
     bool skip = false;
     UINT res = 0;
     for (auto [hook, feature] : hooks) res = ((PFunGetCurrentBackBufferIndexBefore*)hook)(m_base, skip);
@@ -609,7 +611,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::ResizeBuffers1(UINT BufferCount, UINT W
         HRESULT hr = S_OK;
         bool Skip = false;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers1);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers1);
             for (auto [hook, feature] : hooks)
             {
                 hr = ((PFunResizeBuffers1Before*)hook)(m_base, BufferCount, Width, Height, Format, SwapChainFlags, pCreationNodeMask, present_queues.data(), Skip);
@@ -627,7 +629,7 @@ HRESULT STDMETHODCALLTYPE DXGISwapChain::ResizeBuffers1(UINT BufferCount, UINT W
         }
 
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers1);
+            const auto& hooks = sl::plugin_manager::getAfterHooks(FunctionHookID::eIDXGISwapChain_ResizeBuffers1);
             for (auto [hook, feature] : hooks)
             {
                 hr = ((PFunResizeBuffers1After*)hook)(m_base, BufferCount, Width, Height, Format, SwapChainFlags, pCreationNodeMask, present_queues.data());
@@ -60,7 +60,7 @@ if (config.contains(#a))
             {
                 // NOTE: Logging does not work here, not initialized yet since values from this JSON can change the way logging works
                 m_configPath = path;
-                auto jsonText = file::read(interposerJSONFile.c_str());
+                file::MappedView jsonText(interposerJSONFile.c_str());
                 if (!jsonText.empty())
                 {
                     json config = json::parse(jsonText.begin(), jsonText.end(), nullptr, /* allow exceptions: */ true, /* ignore comments: */ true);
@@ -79,6 +79,8 @@ if (config.contains(#a))
                     SL_EXTRACT_CONFIG_FLAG(forceNonNVDA);
                     SL_EXTRACT_CONFIG_FLAG(trackEngineAllocations);
                     SL_EXTRACT_CONFIG_FLAG(enableD3D12DebugLayer);
+                    SL_EXTRACT_CONFIG_FLAG(enableProfiling);
+                    SL_EXTRACT_CONFIG_FLAG(recordAPITrace);
 
                     if (m_config.trackEngineAllocations)
                     {
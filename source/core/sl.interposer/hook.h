@@ -80,6 +80,8 @@ struct InterposerConfig
     bool forceNonNVDA = false;
     bool trackEngineAllocations = false;
     bool enableD3D12DebugLayer = false;
+    bool enableProfiling = false;
+    bool recordAPITrace = false;
     float logMessageDelayMs = 5000.0f;
     uint32_t logLevel = 2;
     std::string logPath{};
@@ -1055,7 +1055,7 @@ extern "C"
 
     VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice Device)
     {
-        const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(sl::FunctionHookID::eVulkan_DeviceWaitIdle);
+        const auto& hooks = sl::plugin_manager::getBeforeHooks(sl::FunctionHookID::eVulkan_DeviceWaitIdle);
         bool skip = false;
         VkResult result = VK_SUCCESS;
         for (auto [hook, feature] : hooks)
@@ -2090,7 +2090,7 @@ extern "C"
         bool skip = false;
         VkResult result = VK_SUCCESS;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(sl::FunctionHookID::eVulkan_CreateSwapchainKHR);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(sl::FunctionHookID::eVulkan_CreateSwapchainKHR);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkCreateSwapchainKHRBefore*)hook)(Device, CreateInfo, Allocator, Swapchain, skip);
@@ -2107,7 +2107,7 @@ extern "C"
         }
 
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(sl::FunctionHookID::eVulkan_CreateSwapchainKHR);
+            const auto& hooks = sl::plugin_manager::getAfterHooks(sl::FunctionHookID::eVulkan_CreateSwapchainKHR);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkCreateSwapchainKHRAfter*)hook)(Device, CreateInfo, Allocator, Swapchain);
@@ -2124,7 +2124,7 @@ extern "C"
     {
         bool skip = false;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(sl::FunctionHookID::eVulkan_DestroySwapchainKHR);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(sl::FunctionHookID::eVulkan_DestroySwapchainKHR);
             for (auto [hook, feature] : hooks)
             {
                 ((sl::PFunVkDestroySwapchainKHRBefore*)hook)(Device, Swapchain, Allocator, skip);
@@ -2142,7 +2142,7 @@ extern "C"
         bool skip = false;
         VkResult result = VK_SUCCESS;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(sl::FunctionHookID::eVulkan_GetSwapchainImagesKHR);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(sl::FunctionHookID::eVulkan_GetSwapchainImagesKHR);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkGetSwapchainImagesKHRBefore*)hook)(Device, Swapchain, SwapchainImageCount, SwapchainImages, skip);
@@ -2165,7 +2165,7 @@ extern "C"
         bool skip = false;
         VkResult result = VK_SUCCESS;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(sl::FunctionHookID::eVulkan_AcquireNextImageKHR);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(sl::FunctionHookID::eVulkan_AcquireNextImageKHR);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkAcquireNextImageKHRBefore*)hook)(Device, Swapchain, Timeout, Semaphore, Fence, ImageIndex, skip);
@@ -2190,7 +2190,7 @@ extern "C"
         VkResult result = VK_SUCCESS;
         auto hooksId = sl::FunctionHookID::eVulkan_Present;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(hooksId);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(hooksId);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkQueuePresentKHRBefore*)hook)(Queue, PresentInfo, skip);
@@ -2206,9 +2206,10 @@ extern "C"
         {
             result = s_ddt.QueuePresentKHR(Queue, PresentInfo);
         }
+        sl::plugin_manager::getInterface()->onPresent();
 
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(hooksId);
+            const auto& hooks = sl::plugin_manager::getAfterHooks(hooksId);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkQueuePresentKHRAfter*)hook)();
@@ -2250,7 +2251,7 @@ extern "C"
         bool skip = false;
         VkResult result = VK_SUCCESS;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(sl::FunctionHookID::eVulkan_CreateWin32SurfaceKHR);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(sl::FunctionHookID::eVulkan_CreateWin32SurfaceKHR);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkCreateWin32SurfaceKHRBefore*)hook)(Instance, CreateInfo, Allocator, Surface, skip);
@@ -2267,7 +2268,7 @@ extern "C"
         }
 
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getAfterHooks(sl::FunctionHookID::eVulkan_CreateWin32SurfaceKHR);
+            const auto& hooks = sl::plugin_manager::getAfterHooks(sl::FunctionHookID::eVulkan_CreateWin32SurfaceKHR);
             for (auto [hook, feature] : hooks)
             {
                 result = ((sl::PFunVkCreateWin32SurfaceKHRAfter*)hook)(Instance, CreateInfo, Allocator, Surface);
@@ -2284,7 +2285,7 @@ extern "C"
     {
         bool skip = false;
         {
-            const auto& hooks = sl::plugin_manager::getInterface()->getBeforeHooks(sl::FunctionHookID::eVulkan_DestroySurfaceKHR);
+            const auto& hooks = sl::plugin_manager::getBeforeHooks(sl::FunctionHookID::eVulkan_DestroySurfaceKHR);
             for (auto [hook, feature] : hooks)
             {
                 ((sl::PFunVkDestroySurfaceKHRBefore*)hook)(Instance, Surface, pAllocator, skip);
@@ -0,0 +1,293 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <cstring>
+
+#ifdef SL_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
+#include "source/core/sl.file/file.h"
+
+namespace sl
+{
+namespace profiler
+{
+
+constexpr size_t kMaxEventNameLength = 48;
+constexpr uint32_t kEventsPerChunk = 4096;
+//! Up to 256K events per thread, anything above that is dropped and reported on export
+constexpr uint32_t kMaxChunksPerThread = 64;
+
+struct Event
+{
+    char name[kMaxEventNameLength];
+    int64_t begin;
+    int64_t end;
+};
+
+struct EventChunk
+{
+    Event events[kEventsPerChunk];
+};
+
+//! Single producer buffer, only the owning thread writes while export reads up to 'count'
+struct ThreadBuffer
+{
+    uint32_t threadId{};
+    std::atomic<uint32_t> count{};
+    std::atomic<uint32_t> dropped{};
+    std::atomic<EventChunk*> chunks[kMaxChunksPerThread]{};
+
+    ~ThreadBuffer()
+    {
+        for (auto& chunk : chunks)
+        {
+            delete chunk.load();
+        }
+    }
+};
+
+static uint32_t getCurrentThreadId()
+{
+#ifdef SL_WINDOWS
+    return (uint32_t)GetCurrentThreadId();
+#else
+    return (uint32_t)syscall(SYS_gettid);
+#endif
+}
+
+static uint32_t getCurrentProcessId()
+{
+#ifdef SL_WINDOWS
+    return (uint32_t)GetCurrentProcessId();
+#else
+    return (uint32_t)getpid();
+#endif
+}
+
+struct Profiler : IProfiler
+{
+    Profiler() : m_generation(++s_generation)
+    {
+    }
+
+    bool isEnabled() const override final
+    {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool value) override final
+    {
+        if (value)
+        {
+            // Recording again after 'shutdown', e.g. slInit following slShutdown
+            m_shutdown = false;
+        }
+        m_enabled = value;
+    }
+
+    void recordEvent(const char* name, int64_t beginTicks, int64_t endTicks) override final
+    {
+        // Registered before checking the flag so 'shutdown' either sees this writer or the writer sees the flag
+        m_writers.fetch_add(1);
+        if (m_shutdown.load())
+        {
+            m_writers.fetch_sub(1);
+            return;
+        }
+        write(name, beginTicks, endTicks);
+        m_writers.fetch_sub(1, std::memory_order_release);
+    }
+
+    void write(const char* name, int64_t beginTicks, int64_t endTicks)
+    {
+        auto buffer = getThreadBuffer();
+        auto index = buffer->count.load(std::memory_order_relaxed);
+        auto chunkIndex = index / kEventsPerChunk;
+        if (chunkIndex >= kMaxChunksPerThread)
+        {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto chunk = buffer->chunks[chunkIndex].load(std::memory_order_relaxed);
+        if (!chunk)
+        {
+            chunk = new EventChunk;
+            buffer->chunks[chunkIndex].store(chunk, std::memory_order_release);
+        }
+        auto& event = chunk->events[index % kEventsPerChunk];
+        strncpy(event.name, name ? name : "unknown", kMaxEventNameLength - 1);
+        event.name[kMaxEventNameLength - 1] = 0;
+        event.begin = beginTicks;
+        event.end = endTicks;
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    bool exportTrace(const wchar_t* path) override final
+    {
+        auto file = file::open(path, L"wt");
+        if (!file)
+        {
+            SL_LOG_ERROR("Failed to open '%S' for writing the trace", path);
+            return false;
+        }
+
+        // Chrome trace format, complete events ("ph":"X") with timestamps in microseconds
+        auto pid = getCurrentProcessId();
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        uint32_t total = 0, dropped = 0;
+        {
+            std::scoped_lock lock(m_mtx);
+            for (auto& buffer : m_buffers)
+            {
+                auto count = buffer->count.load(std::memory_order_acquire);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    auto chunk = buffer->chunks[i / kEventsPerChunk].load(std::memory_order_acquire);
+                    auto& event = chunk->events[i % kEventsPerChunk];
+                    auto begin = extra::timer::ticksToUs(event.begin);
+                    auto duration = extra::timer::ticksToUs(event.end) - begin;
+                    fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"sl\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}", first ? "" : ",\n",
+                        escape(event.name).c_str(), pid, buffer->threadId, (long long)begin, (long long)duration);
+                    first = false;
+                }
+                total += count;
+                dropped += buffer->dropped.load(std::memory_order_relaxed);
+            }
+        }
+        fprintf(file, "\n]}\n");
+        file::close(file);
+
+        SL_LOG_INFO("Wrote %u profiling events to '%S'", total, path);
+        if (dropped)
+        {
+            SL_LOG_WARN("Dropped %u profiling events, per thread buffers are full", dropped);
+        }
+        return true;
+    }
+
+    void clear() override final
+    {
+        std::scoped_lock lock(m_mtx);
+        // Other threads could be writing right now so buffers are retired rather than released,
+        // threads register new buffers on their next event
+        for (auto& buffer : m_buffers)
+        {
+            m_retiredBuffers.push_back(std::move(buffer));
+        }
+        m_buffers.clear();
+        m_generation = ++s_generation;
+    }
+
+    //! Stops recording, waits for threads which are inside 'recordEvent' and releases all buffers
+    void shutdown()
+    {
+        m_enabled = false;
+        m_shutdown.store(true);
+        while (m_writers.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        std::scoped_lock lock(m_mtx);
+        m_buffers.clear();
+        m_retiredBuffers.clear();
+        m_generation = ++s_generation;
+    }
+
+private:
+
+    ThreadBuffer* getThreadBuffer()
+    {
+        struct ThreadState
+        {
+            uint32_t generation{};
+            ThreadBuffer* buffer{};
+        };
+        thread_local ThreadState t_state{};
+
+        auto generation = m_generation.load(std::memory_order_acquire);
+        if (t_state.generation != generation)
+        {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->threadId = getCurrentThreadId();
+            t_state.buffer = buffer.get();
+            t_state.generation = generation;
+            std::scoped_lock lock(m_mtx);
+            m_buffers.push_back(std::move(buffer));
+        }
+        return t_state.buffer;
+    }
+
+    static std::string escape(const char* name)
+    {
+        std::string result;
+        for (auto c = name; *c; c++)
+        {
+            if (*c == '"' || *c == '\\') result += '\\';
+            result += (unsigned char)*c < 0x20 ? ' ' : *c;
+        }
+        return result;
+    }
+
+    //! Generations are unique across profiler instances so stale thread local state is never reused
+    inline static std::atomic<uint32_t> s_generation = 0;
+
+    std::atomic<bool> m_enabled = false;
+    std::atomic<bool> m_shutdown = false;
+    std::atomic<uint32_t> m_writers = 0;
+    std::atomic<uint32_t> m_generation;
+    std::mutex m_mtx;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_retiredBuffers;
+};
+
+static Profiler* getProfiler()
+{
+    // Thread safe initialization, never deleted so threads still recording at process exit
+    // and modules holding on to the interface can not end up with a dangling pointer
+    static Profiler* s_profiler = new Profiler();
+    return s_profiler;
+}
+
+IProfiler* getInterface()
+{
+    return getProfiler();
+}
+
+void destroyInterface()
+{
+    getProfiler()->shutdown();
+}
+
+}
+}
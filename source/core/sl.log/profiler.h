@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#include "source/core/sl.extra/extra.h"
+
+//! Scoped CPU instrumentation
+//!
+//! Compiled in for all non-production builds, recording is off until enabled
+//! with "enableProfiling" in 'sl.interposer.json'. Events from the interposer and
+//! all plugins end up in the same recorder owned by sl.interposer.
+//!
+//! NOTE: Independent of SL_ENABLE_PROFILING which is owned by premake and controls GPU markers
+#ifndef SL_ENABLE_CPU_PROFILER
+#ifdef SL_PRODUCTION
+#define SL_ENABLE_CPU_PROFILER 0
+#else
+#define SL_ENABLE_CPU_PROFILER 1
+#endif
+#endif
+
+namespace sl
+{
+namespace profiler
+{
+
+//! Shared across DLL boundaries, only append new methods
+struct IProfiler
+{
+    virtual bool isEnabled() const = 0;
+    virtual void setEnabled(bool value) = 0;
+    //! Records a complete event on the calling thread, timestamps come from 'extra::timer::getTicks'
+    //!
+    //! Name is copied so it does not have to outlive the module which recorded it
+    virtual void recordEvent(const char* name, int64_t beginTicks, int64_t endTicks) = 0;
+    //! Writes all events recorded so far in Chrome trace format (chrome://tracing or ui.perfetto.dev)
+    virtual bool exportTrace(const wchar_t* path) = 0;
+    virtual void clear() = 0;
+};
+
+//! Can return null in plugins loaded by an older sl.interposer
+IProfiler* getInterface();
+//! Stops recording and waits for threads still recording an event before releasing the buffers
+//!
+//! Interface itself stays valid, events recorded after this call are dropped until
+//! recording is enabled again.
+void destroyInterface();
+
+class ScopedEvent
+{
+public:
+    ScopedEvent(const ScopedEvent&) = delete;
+    ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+    ScopedEvent(const char* name) : m_name(name)
+    {
+        auto profiler = getInterface();
+        if (profiler && profiler->isEnabled())
+        {
+            m_profiler = profiler;
+            m_begin = extra::timer::getTicks();
+        }
+    }
+
+    ~ScopedEvent()
+    {
+        if (m_profiler)
+        {
+            m_profiler->recordEvent(m_name, m_begin, extra::timer::getTicks());
+        }
+    }
+
+private:
+    IProfiler* m_profiler{};
+    const char* m_name{};
+    int64_t m_begin{};
+};
+
+}
+}
+
+#define SL_PROFILE_CONCAT_(a, b) a##b
+#define SL_PROFILE_CONCAT(a, b) SL_PROFILE_CONCAT_(a, b)
+
+#if SL_ENABLE_CPU_PROFILER
+#define SL_PROFILE_SCOPE(name) sl::profiler::ScopedEvent SL_PROFILE_CONCAT(_slProfileScope, __LINE__)(name)
+#else
+#define SL_PROFILE_SCOPE(name)
+#endif
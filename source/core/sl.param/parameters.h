@@ -49,6 +49,9 @@ constexpr const char* kDebugMode = "sl.param.global.dbgMode";
 constexpr const char* kPFunGetTag = "sl.param.global.getTag";
 constexpr const char* kVulkanTable = "sl.param.global.vulkanTable";
 constexpr const char* kPreferenceFlags = "sl.param.global.prefFlags";
+constexpr const char* kLoaderConfigBinary = "sl.param.global.loaderConfigBinary";
+constexpr const char* kProfilerInterface = "sl.param.global.profilerInterface";
+constexpr const char* kKernelCache = "sl.param.global.kernelCache";
 }
 
 namespace interposer
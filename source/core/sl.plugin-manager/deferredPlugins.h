@@ -0,0 +1,187 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "include/sl_core_types.h"
+#include "source/core/sl.log/log.h"
+#include "source/core/sl.plugin-manager/pluginCache.h"
+
+namespace sl
+{
+namespace plugin_manager
+{
+
+enum class PluginState : uint32_t
+{
+    // DLL is loaded, plugin is started in 'initializePlugins' or right away when loaded on first use after that
+    eLoaded,
+    // Only known from the cached manifest, DLL is loaded on first use
+    eDeferred,
+    // Deferred plugin is being loaded, used to detect circular dependencies
+    eLoading,
+    // Deferred plugin failed to load or start, kept around since the feature context can be referenced
+    eFailed
+};
+
+//! Picks plugins which can be loaded on first use, returns one flag per manifest
+//!
+//! 'manifests' holds the cached manifest of every discovered plugin. Hooks must be in place
+//! before the device and swap-chain are created so such plugins cannot wait, anything which
+//! could end up rejected by the regular checks when plugins are mapped is loaded as well.
+//! Plugins required by others are loaded right away, dependent plugins can rely on them in 'onStartup'.
+template<typename IsRequested>
+std::vector<bool> selectDeferredPlugins(const std::vector<PluginManifest>& manifests, const Version& api, IsRequested&& isRequested)
+{
+    std::map<Feature, uint32_t> idCount;
+    std::set<std::string> requiredPlugins;
+    for (auto& manifest : manifests)
+    {
+        idCount[manifest.id]++;
+        if (isRequested(manifest.id))
+        {
+            requiredPlugins.insert(manifest.requiredPlugins.begin(), manifest.requiredPlugins.end());
+        }
+    }
+
+    std::vector<bool> deferred(manifests.size());
+    for (size_t i = 0; i < manifests.size(); i++)
+    {
+        auto& manifest = manifests[i];
+        deferred[i] = isRequested(manifest.id) && manifest.id != kFeatureCommon && idCount[manifest.id] == 1 &&
+            !manifest.hasHooks && manifest.exclusiveHooks.empty() && manifest.incompatiblePlugins.empty() &&
+            requiredPlugins.find(manifest.name) == requiredPlugins.end() &&
+            manifest.api.major == api.major && !(manifest.api > api) && manifest.priority > 0;
+    }
+    return deferred;
+}
+
+//! Loads deferred plugins on first use, dependencies first
+//!
+//! 'Plugin' provides 'std::atomic<PluginState> state', 'std::string name' and
+//! 'std::vector<std::string> requiredPlugins'. Actual loading is up to the owner:
+//!
+//! - 'find(name)' returns the plugin with the given name or null
+//! - 'load(plugin)' loads and starts a plugin whose dependencies are loaded, returns eLoaded,
+//!   eFailed or eDeferred if nothing can be loaded yet
+//! - 'fail(plugin, error)' records why a plugin cannot be loaded because of its dependencies
+//! - 'loaded(plugin)' runs once the plugin is published as loaded
+//!
+//! Resolving a loaded or failed plugin is a single atomic load, this is on the path of every
+//! evaluate call. Loads are serialized on the owner's mutex, held while calling back, so each
+//! plugin is loaded at most once no matter how many threads use it first.
+template<typename Plugin>
+class DeferredPluginLoader
+{
+public:
+    using PFunFind = std::function<Plugin*(const std::string& name)>;
+    using PFunLoad = std::function<PluginState(Plugin* plugin)>;
+    using PFunFail = std::function<void(Plugin* plugin, const std::string& error)>;
+    using PFunLoaded = std::function<void(Plugin* plugin)>;
+
+    DeferredPluginLoader(std::mutex& mtx, const PFunFind& find, const PFunLoad& load, const PFunFail& fail, const PFunLoaded& loaded) :
+        m_mtx(mtx), m_find(find), m_load(load), m_fail(fail), m_loaded(loaded) {}
+
+    DeferredPluginLoader(const DeferredPluginLoader&) = delete;
+
+    //! Returns true if the plugin is loaded, loads it if needed
+    bool resolve(Plugin* plugin)
+    {
+        auto state = plugin->state.load(std::memory_order_acquire);
+        if (state == PluginState::eLoaded)
+        {
+            return true;
+        }
+        if (state == PluginState::eFailed)
+        {
+            return false;
+        }
+        std::scoped_lock lock(m_mtx);
+        return resolveLocked(plugin) == PluginState::eLoaded;
+    }
+
+    //! Same as 'resolve' for callers holding the owner's mutex
+    PluginState resolveLocked(Plugin* plugin)
+    {
+        auto state = plugin->state.load(std::memory_order_acquire);
+        if (state == PluginState::eLoading)
+        {
+            SL_LOG_ERROR("Detected circular dependency while loading plugin '%s'", plugin->name.c_str());
+            return PluginState::eFailed;
+        }
+        if (state != PluginState::eDeferred)
+        {
+            // Another thread got here first
+            return state;
+        }
+
+        plugin->state.store(PluginState::eLoading, std::memory_order_relaxed);
+
+        // Dependencies first, same order as if everything was loaded on startup
+        for (auto& required : plugin->requiredPlugins)
+        {
+            auto requiredPlugin = m_find(required);
+            auto requiredState = requiredPlugin ? resolveLocked(requiredPlugin) : PluginState::eFailed;
+            if (requiredState == PluginState::eDeferred)
+            {
+                // Too early, next use tries again
+                plugin->state.store(PluginState::eDeferred, std::memory_order_relaxed);
+                return PluginState::eDeferred;
+            }
+            if (requiredState != PluginState::eLoaded)
+            {
+                SL_LOG_ERROR("Plugin '%s' will be unloaded since it requires plugin '%s' which is NOT loaded.", plugin->name.c_str(), required.c_str());
+                m_fail(plugin, "Error: feature depends on " + required + " which is missing");
+                plugin->state.store(PluginState::eFailed, std::memory_order_release);
+                return PluginState::eFailed;
+            }
+        }
+
+        state = m_load(plugin);
+        plugin->state.store(state, std::memory_order_release);
+        if (state == PluginState::eLoaded && m_loaded)
+        {
+            m_loaded(plugin);
+        }
+        return state;
+    }
+
+private:
+    std::mutex& m_mtx;
+    PFunFind m_find;
+    PFunLoad m_load;
+    PFunFail m_fail;
+    PFunLoaded m_loaded;
+};
+
+}
+}
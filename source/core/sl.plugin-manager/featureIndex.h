@@ -0,0 +1,104 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <utility>
+
+namespace sl
+{
+
+using Feature = uint32_t;
+
+namespace plugin_manager
+{
+
+//! Maps sparse feature ids to dense ordinals assigned when plugins are loaded
+//!
+//! Ids are sparse (DLSS-G and newer start at 1000) but mostly small enough to be
+//! mapped directly, the few large ones (sl.imgui, sl.common is UINT_MAX) go through a short list.
+struct FeatureIndex
+{
+    static constexpr uint32_t kDirectCount = 2048;
+    static constexpr uint32_t kInvalidOrdinal = ~0u;
+
+    // Ordinal + 1, zero means feature is not mapped
+    uint8_t direct[kDirectCount]{};
+    std::vector<std::pair<Feature, uint32_t>> sparse;
+
+    inline uint32_t find(Feature feature) const
+    {
+        if (feature < kDirectCount && direct[feature])
+        {
+            return direct[feature] - 1u;
+        }
+        for (auto& [id, ordinal] : sparse)
+        {
+            if (id == feature) return ordinal;
+        }
+        return kInvalidOrdinal;
+    }
+
+    //! Mapping an id again replaces its ordinal
+    inline void add(Feature feature, uint32_t ordinal)
+    {
+        remove(feature);
+        // Ordinals which do not fit the byte table are rare enough for the list
+        if (feature < kDirectCount && ordinal < UINT8_MAX)
+        {
+            direct[feature] = (uint8_t)(ordinal + 1);
+        }
+        else
+        {
+            sparse.push_back({ feature, ordinal });
+        }
+    }
+
+    inline void remove(Feature feature)
+    {
+        if (feature < kDirectCount)
+        {
+            direct[feature] = 0;
+        }
+        for (auto it = sparse.begin(); it != sparse.end(); it++)
+        {
+            if ((*it).first == feature)
+            {
+                sparse.erase(it);
+                break;
+            }
+        }
+    }
+
+    inline void clear()
+    {
+        memset(direct, 0, sizeof(direct));
+        sparse.clear();
+    }
+};
+
+}
+}
@@ -0,0 +1,185 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "include/sl_hooks.h"
+
+namespace sl
+{
+
+namespace interposer
+{
+using VirtualAddress = void*;
+}
+
+using Feature = uint32_t;
+
+namespace plugin_manager
+{
+
+using HookPair = std::pair<interposer::VirtualAddress, sl::Feature>;
+
+//! Read-only view of the hooks registered for a single function, sorted by plugin priority
+//!
+//! Points into a flat dispatch table which is never modified once published, rebuilding
+//! hooks (for example when a feature gets disabled) publishes a new table instead.
+struct HookList
+{
+    const HookPair* first{};
+    const HookPair* last{};
+
+    inline const HookPair* begin() const { return first; }
+    inline const HookPair* end() const { return last; }
+    inline const HookPair* data() const { return first; }
+    inline size_t size() const { return last - first; }
+    inline bool empty() const { return first == last; }
+};
+
+//! Bit N is set if function N has at least one hook, mirrors the current hook table
+//!
+//! All bits stay set until plugins are initialized so the first hooked call still
+//! goes through the lazy initialization in 'getBeforeHooks'/'getAfterHooks'.
+struct HookMasks
+{
+    std::atomic<uint64_t> before{ ~0ull };
+    std::atomic<uint64_t> after{ ~0ull };
+};
+
+//! Flattened before/after hooks for all functions, immutable once published
+struct HookTable
+{
+    static_assert((size_t)FunctionHookID::eMaxNum <= 64, "Hook masks hold one bit per function");
+
+    //! Bit N is set if function N has at least one hook, most calls have none so they exit early
+    uint64_t beforeMask{};
+    uint64_t afterMask{};
+    //! Hooks for function N are in [offsets[N], offsets[N + 1])
+    uint32_t beforeOffsets[(uint32_t)FunctionHookID::eMaxNum + 1]{};
+    uint32_t afterOffsets[(uint32_t)FunctionHookID::eMaxNum + 1]{};
+    std::vector<HookPair> before;
+    std::vector<HookPair> after;
+
+    //! Flattens per function hook lists, each array holds 'FunctionHookID::eMaxNum' lists
+    static std::unique_ptr<HookTable> build(const std::vector<HookPair>* beforeLists, const std::vector<HookPair>* afterLists)
+    {
+        auto table = std::make_unique<HookTable>();
+        auto flatten = [](const std::vector<HookPair>* lists, uint64_t& mask, uint32_t* offsets, std::vector<HookPair>& hooks)->void
+        {
+            for (uint32_t i = 0; i < (uint32_t)FunctionHookID::eMaxNum; i++)
+            {
+                offsets[i] = (uint32_t)hooks.size();
+                if (!lists[i].empty())
+                {
+                    mask |= 1ull << i;
+                    hooks.insert(hooks.end(), lists[i].begin(), lists[i].end());
+                }
+            }
+            offsets[(uint32_t)FunctionHookID::eMaxNum] = (uint32_t)hooks.size();
+        };
+        flatten(beforeLists, table->beforeMask, table->beforeOffsets, table->before);
+        flatten(afterLists, table->afterMask, table->afterOffsets, table->after);
+        return table;
+    }
+
+    inline HookList getBefore(FunctionHookID functionHookID) const
+    {
+        auto i = (uint32_t)functionHookID;
+        if (!(beforeMask & (1ull << i))) return {};
+        return { before.data() + beforeOffsets[i], before.data() + beforeOffsets[i + 1] };
+    }
+    inline HookList getAfter(FunctionHookID functionHookID) const
+    {
+        auto i = (uint32_t)functionHookID;
+        if (!(afterMask & (1ull << i))) return {};
+        return { after.data() + afterOffsets[i], after.data() + afterOffsets[i + 1] };
+    }
+};
+
+//! Owns the current hook table and the ones it replaced
+//!
+//! Other threads could still be iterating over a replaced table, it is freed
+//! after two more presents. Publishing is serialized by the caller, 'get' and
+//! 'onPresent' can be called from any thread.
+class HookTablePublisher
+{
+    struct RetiredHookTable
+    {
+        uint64_t presentCount{};
+        std::unique_ptr<HookTable> table;
+    };
+
+    std::atomic<const HookTable*> m_table{};
+    std::unique_ptr<HookTable> m_current;
+    std::mutex m_retiredMutex;
+    std::vector<RetiredHookTable> m_retired;
+    std::atomic<bool> m_hasRetired{};
+    std::atomic<uint64_t> m_presentCount{};
+
+public:
+    inline const HookTable* get() const { return m_table.load(std::memory_order_acquire); }
+
+    void publish(std::unique_ptr<HookTable> table)
+    {
+        m_table.store(table.get(), std::memory_order_release);
+        if (m_current)
+        {
+            std::scoped_lock lock(m_retiredMutex);
+            m_retired.push_back({ m_presentCount.load(), std::move(m_current) });
+            m_hasRetired.store(true, std::memory_order_release);
+        }
+        m_current = std::move(table);
+    }
+
+    void onPresent()
+    {
+        auto presentCount = ++m_presentCount;
+        if (!m_hasRetired.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        // A present which was in flight when the table got retired could still hold it, wait for the next one too
+        std::scoped_lock lock(m_retiredMutex);
+        m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(), [presentCount](const RetiredHookTable& entry)->bool
+        {
+            return presentCount >= entry.presentCount + 2;
+        }), m_retired.end());
+        m_hasRetired.store(!m_retired.empty(), std::memory_order_release);
+    }
+
+    size_t getRetiredCount()
+    {
+        std::scoped_lock lock(m_retiredMutex);
+        return m_retired.size();
+    }
+};
+
+}
+}
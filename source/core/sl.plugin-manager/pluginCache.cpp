@@ -0,0 +1,312 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "source/core/sl.log/log.h"
+#include "source/core/sl.file/file.h"
+#include "source/core/sl.file/asyncIO.h"
+#include "source/core/sl.extra/extra.h"
+#include "source/core/sl.plugin-manager/pluginCache.h"
+
+using json = nlohmann::json;
+
+namespace sl
+{
+namespace plugin_manager
+{
+
+//! Bump when the layout of the cache file changes
+constexpr uint32_t kManifestCacheFormat = 2;
+
+//! Amount of data hashed at each end of the binary
+//!
+//! The head covers the PE/ELF headers, build id and timestamp,
+//! the tail covers the Authenticode signature appended to signed binaries.
+constexpr size_t kManifestDigestBlockSize = 64 * 1024;
+
+PluginManifestCache::PluginManifestCache() = default;
+PluginManifestCache::~PluginManifestCache() = default;
+
+static uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static void toJSON(json& j, const Version& v)
+{
+    j["major"] = v.major;
+    j["minor"] = v.minor;
+    j["build"] = v.build;
+}
+
+static void fromJSON(const json& j, Version& v)
+{
+    j.at("major").get_to(v.major);
+    j.at("minor").get_to(v.minor);
+    j.at("build").get_to(v.build);
+}
+
+static void extractItems(const json& config, const char* key, std::vector<std::string>& stringList)
+{
+    stringList.clear();
+    if (config.contains(key))
+    {
+        for (auto& item : config.at(key))
+        {
+            stringList.push_back(item.get<std::string>());
+        }
+    }
+}
+
+bool PluginManifestCache::getFileIdentity(const fs::path& pluginPath, FileIdentity& identity)
+{
+    auto it = m_identities.find(pluginPath.wstring());
+    if (it != m_identities.end())
+    {
+        identity = (*it).second;
+        return true;
+    }
+
+    std::error_code ec;
+    auto modTime = fs::last_write_time(pluginPath, ec);
+    if (ec)
+    {
+        return false;
+    }
+
+    file::MappedView view(pluginPath.wstring().c_str());
+    if (!view.isValid() || view.empty())
+    {
+        return false;
+    }
+
+    uint64_t digest = 0xcbf29ce484222325ull;
+    auto headSize = std::min(view.size(), kManifestDigestBlockSize);
+    digest = fnv1a(digest, view.data(), headSize);
+    if (view.size() > headSize)
+    {
+        auto tailSize = std::min(view.size() - headSize, kManifestDigestBlockSize);
+        digest = fnv1a(digest, view.end() - tailSize, tailSize);
+    }
+
+    identity.size = view.size();
+    identity.modTime = (int64_t)modTime.time_since_epoch().count();
+    identity.digest = digest;
+    m_identities[pluginPath.wstring()] = identity;
+    return true;
+}
+
+bool PluginManifestCache::load(const fs::path& cacheFile, const std::string& interposerVersion)
+{
+    m_cacheFile = cacheFile;
+    m_interposerVersion = interposerVersion;
+    m_entries.clear();
+    m_identities.clear();
+    m_dirty = false;
+
+    if (!file::exists(cacheFile.wstring().c_str()))
+    {
+        return false;
+    }
+
+    file::MappedView text(cacheFile.wstring().c_str());
+    if (text.empty())
+    {
+        return false;
+    }
+
+    try
+    {
+        auto cache = json::parse(text.begin(), text.end());
+        if (cache.at("format").get<uint32_t>() != kManifestCacheFormat || cache.at("interposer").get<std::string>() != interposerVersion)
+        {
+            SL_LOG_INFO("Plugin manifest cache '%S' is out of date, ignoring", cacheFile.wstring().c_str());
+            m_dirty = true;
+            return false;
+        }
+
+        for (auto& item : cache.at("plugins"))
+        {
+            Entry entry{};
+            item.at("size").get_to(entry.identity.size);
+            item.at("modTime").get_to(entry.identity.modTime);
+            item.at("digest").get_to(entry.identity.digest);
+
+            auto& manifest = entry.manifest;
+            item.at("id").get_to(manifest.id);
+            item.at("name").get_to(manifest.name);
+            item.at("priority").get_to(manifest.priority);
+            item.at("hasHooks").get_to(manifest.hasHooks);
+            fromJSON(item.at("version"), manifest.version);
+            fromJSON(item.at("api"), manifest.api);
+            extractItems(item, "required_plugins", manifest.requiredPlugins);
+            extractItems(item, "exclusive_hooks", manifest.exclusiveHooks);
+            extractItems(item, "incompatible_plugins", manifest.incompatiblePlugins);
+
+            m_entries[extra::utf8ToUtf16(item.at("path").get<std::string>().c_str())] = entry;
+        }
+    }
+    catch (std::exception& e)
+    {
+        SL_LOG_WARN("Discarding plugin manifest cache '%S' - %s", cacheFile.wstring().c_str(), e.what());
+        m_entries.clear();
+        m_dirty = true;
+        return false;
+    }
+    return true;
+}
+
+bool PluginManifestCache::save()
+{
+    // Entries which were not touched belong to plugins which are no longer discovered
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (!(*it).second.used)
+        {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    if (!m_dirty || m_cacheFile.empty())
+    {
+        return true;
+    }
+
+    json cache;
+    cache["format"] = kManifestCacheFormat;
+    cache["interposer"] = m_interposerVersion;
+    cache["plugins"] = json::array();
+    for (auto& [path, entry] : m_entries)
+    {
+        auto& manifest = entry.manifest;
+        json item;
+        item["path"] = extra::utf16ToUtf8(path.c_str());
+        item["size"] = entry.identity.size;
+        item["modTime"] = entry.identity.modTime;
+        item["digest"] = entry.identity.digest;
+        item["id"] = manifest.id;
+        item["name"] = manifest.name;
+        item["priority"] = manifest.priority;
+        item["hasHooks"] = manifest.hasHooks;
+        toJSON(item["version"], manifest.version);
+        toJSON(item["api"], manifest.api);
+        item["required_plugins"] = manifest.requiredPlugins;
+        item["exclusive_hooks"] = manifest.exclusiveHooks;
+        item["incompatible_plugins"] = manifest.incompatiblePlugins;
+        cache["plugins"].push_back(item);
+    }
+
+    if (!file::createDirectoryRecursively(m_cacheFile.parent_path().wstring().c_str()))
+    {
+        return false;
+    }
+    auto text = cache.dump();
+    if (!m_writer)
+    {
+        m_writer = std::make_unique<file::AsyncIO>(L"sl.pluginCache.io");
+    }
+    m_writer->write(m_cacheFile.wstring().c_str(), std::vector<uint8_t>(text.begin(), text.end()), [](file::IOCompletion& completion)->void
+    {
+        if (!completion.success)
+        {
+            SL_LOG_WARN("Failed to write plugin manifest cache");
+        }
+    });
+    m_dirty = false;
+    return true;
+}
+
+bool PluginManifestCache::find(const fs::path& pluginPath, PluginManifest& manifest)
+{
+    auto it = m_entries.find(pluginPath.wstring());
+    if (it == m_entries.end())
+    {
+        return false;
+    }
+
+    auto& entry = (*it).second;
+    FileIdentity identity{};
+    if (!getFileIdentity(pluginPath, identity) || !(identity == entry.identity))
+    {
+        SL_LOG_INFO("Plugin '%S' changed since it was last cached", pluginPath.wstring().c_str());
+        m_entries.erase(it);
+        m_dirty = true;
+        return false;
+    }
+
+    entry.used = true;
+    manifest = entry.manifest;
+    return true;
+}
+
+bool PluginManifestCache::update(const fs::path& pluginPath, const json& config)
+{
+    Entry entry{};
+    if (!getFileIdentity(pluginPath, entry.identity))
+    {
+        return false;
+    }
+
+    auto it = m_entries.find(pluginPath.wstring());
+    if (it != m_entries.end() && (*it).second.identity == entry.identity)
+    {
+        // Same binary, manifest cannot change
+        (*it).second.used = true;
+        return true;
+    }
+
+    try
+    {
+        auto& manifest = entry.manifest;
+        config.at("id").get_to(manifest.id);
+        config.at("name").get_to(manifest.name);
+        config.at("priority").get_to(manifest.priority);
+        manifest.hasHooks = config.contains("hooks") && !config.at("hooks").empty();
+        fromJSON(config.at("version"), manifest.version);
+        fromJSON(config.at("api"), manifest.api);
+        extractItems(config, "required_plugins", manifest.requiredPlugins);
+        extractItems(config, "exclusive_hooks", manifest.exclusiveHooks);
+        extractItems(config, "incompatible_plugins", manifest.incompatiblePlugins);
+    }
+    catch (std::exception& e)
+    {
+        SL_LOG_WARN("Unable to cache manifest for plugin '%S' - %s", pluginPath.wstring().c_str(), e.what());
+        return false;
+    }
+
+    entry.used = true;
+    m_entries[pluginPath.wstring()] = entry;
+    m_dirty = true;
+    return true;
+}
+
+}
+}
@@ -0,0 +1,122 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <memory>
+
+#include "include/sl_version.h"
+#include "external/json/include/nlohmann/json.hpp"
+
+namespace sl
+{
+
+using Feature = uint32_t;
+
+namespace file
+{
+class AsyncIO;
+}
+
+namespace plugin_manager
+{
+
+//! Static plugin identity as reported by 'slOnPluginLoad'
+//!
+//! Only information which is baked into the plugin binary is stored here,
+//! anything depending on the adapter, driver or OS is always queried live.
+struct PluginManifest
+{
+    Feature id{};
+    std::string name{};
+    Version version{};
+    Version api{};
+    int priority{};
+    //! True if the plugin registers any interposer hooks
+    bool hasHooks = false;
+    std::vector<std::string> requiredPlugins;
+    std::vector<std::string> exclusiveHooks;
+    std::vector<std::string> incompatiblePlugins;
+};
+
+//! Persistent cache of plugin manifests
+//!
+//! Entries are keyed by the full path of the plugin and validated against
+//! its size, last write time and a digest of the PE/ELF header and trailing
+//! signature block. Any mismatch invalidates the entry so a replaced or
+//! OTA updated plugin is always loaded and parsed again.
+class PluginManifestCache
+{
+public:
+    PluginManifestCache();
+    //! Waits for a pending save to reach the disk
+    ~PluginManifestCache();
+
+    //! Reads cache from disk, entries produced by a different interposer build are discarded
+    bool load(const std::filesystem::path& cacheFile, const std::string& interposerVersion);
+    //! Writes cache to disk if anything changed, entries not used since 'load' are dropped
+    //!
+    //! File is written in the background so plugin loading does not wait on the disk.
+    bool save();
+
+    //! Returns true and fills in 'manifest' if a valid entry exists for the plugin
+    bool find(const std::filesystem::path& pluginPath, PluginManifest& manifest);
+    //! Stores manifest parsed from the plugin's JSON config
+    bool update(const std::filesystem::path& pluginPath, const nlohmann::json& config);
+
+private:
+    struct FileIdentity
+    {
+        uint64_t size{};
+        int64_t modTime{};
+        uint64_t digest{};
+
+        inline bool operator==(const FileIdentity& rhs) const
+        {
+            return size == rhs.size && modTime == rhs.modTime && digest == rhs.digest;
+        }
+    };
+
+    struct Entry
+    {
+        FileIdentity identity{};
+        PluginManifest manifest{};
+        bool used = false;
+    };
+
+    bool getFileIdentity(const std::filesystem::path& pluginPath, FileIdentity& identity);
+
+    std::filesystem::path m_cacheFile{};
+    std::string m_interposerVersion{};
+    std::map<std::wstring, Entry> m_entries;
+    //! Identities computed during this run, avoids hashing the same binary twice
+    std::map<std::wstring, FileIdentity> m_identities;
+    bool m_dirty = false;
+    std::unique_ptr<file::AsyncIO> m_writer;
+};
+
+}
+}
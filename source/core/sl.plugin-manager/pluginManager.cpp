@@ -31,19 +31,28 @@
 
 #include <sstream>
 #include <random>
+#include <atomic>
+#include <memory>
+#include <set>
 
 #include "include/sl_hooks.h"
 #include "include/sl_version.h"
 #include "source/core/sl.api/internal.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/core/sl.plugin-manager/ota.h"
 #include "source/core/sl.plugin-manager/pluginManager.h"
+#include "source/core/sl.plugin-manager/pluginCache.h"
+#include "source/core/sl.plugin-manager/deferredPlugins.h"
+#include "source/core/sl.plugin-manager/featureIndex.h"
+#include "source/core/sl.plugin/loaderConfig.h"
 #include "source/core/sl.security/secureLoadLibrary.h"
 #include "source/core/sl.interposer/versions.h"
 #include "source/core/sl.interposer/hook.h"
 #include "source/plugins/sl.imgui/imgui.h"
+#include "source/platforms/sl.chi/kernelCache.h"
 #include "_artifacts/gitVersion.h"
 #include "include/sl_helpers.h"
 
@@ -77,10 +86,10 @@ public:
 
     virtual Result initializePlugins() override final;
 
-    virtual const HookList& getBeforeHooks(FunctionHookID functionHookID) override final;
-    virtual const HookList& getAfterHooks(FunctionHookID functionHookID) override final;
-    virtual const HookList& getBeforeHooksWithoutLazyInit(FunctionHookID functionHookID) override final;
-    virtual const HookList& getAfterHooksWithoutLazyInit(FunctionHookID functionHookID) override final;
+    virtual HookList getBeforeHooks(FunctionHookID functionHookID) override final;
+    virtual HookList getAfterHooks(FunctionHookID functionHookID) override final;
+    virtual HookList getBeforeHooksWithoutLazyInit(FunctionHookID functionHookID) override final;
+    virtual HookList getAfterHooksWithoutLazyInit(FunctionHookID functionHookID) override final;
 
     virtual Result setHostSDKVersion(uint64_t sdkVersion) override final;
 
@@ -185,27 +194,33 @@ public:
 
     virtual bool isFeatureEnabled(Feature feature) const override final
     {
-        auto it = m_featurePluginsMap.find(feature);
-        if (it == m_featurePluginsMap.end())
+        auto plugin = getFeaturePlugin(feature);
+        if (!plugin || plugin->state == PluginState::eFailed)
         {
             return false;
         }
         
-        return (*it).second->context.enabled;
+        return plugin->context.enabled;
     }
 
     virtual const FeatureContext* getFeatureContext(Feature feature) override final
     {
-        auto it = m_featurePluginsMap.find(feature);
-        if (it != m_featurePluginsMap.end())
+        auto plugin = getFeaturePlugin(feature);
+        if (plugin && m_deferredLoader.resolve(plugin))
         {
-            return &(*it).second->context;
+            return &plugin->context;
         }
         return nullptr;
     }
 
     virtual bool getExternalFeatureConfig(Feature feature, std::string& configAsText) override final
     {
+        // Deferred plugins provide their config only once loaded
+        if (auto plugin = getFeaturePlugin(feature))
+        {
+            m_deferredLoader.resolve(plugin);
+        }
+
         std::scoped_lock lock(m_mtxPluginConfig);
 
         configAsText = "";
@@ -226,11 +241,25 @@ public:
         return false;
     }
 
-    virtual bool getLoadedFeatureConfigs(std::vector<json>& configList) const override final
+    virtual bool getLoadedFeatureConfigs(std::vector<json>& configList) override final
     {
+        // Caller needs complete configs so deferred plugins are loaded here. Vulkan extensions and features
+        // requested by plugins depend on the driver and adapter so they cannot come from the manifest cache.
+        uint32_t deferred = 0;
         for (auto plugin : m_plugins)
         {
-            configList.push_back(plugin->config);
+            deferred += plugin->state.load(std::memory_order_relaxed) == PluginState::eDeferred ? 1 : 0;
+        }
+        if (deferred)
+        {
+            SL_LOG_WARN("Loading %u deferred plugin(s) since all feature configs were requested, 'eLoadPluginsOnFirstUse' has no effect here", deferred);
+        }
+        for (auto plugin : m_plugins)
+        {
+            if (m_deferredLoader.resolve(plugin))
+            {
+                configList.push_back(plugin->config);
+            }
         }
         return !configList.empty();
     }
@@ -239,12 +268,16 @@ public:
     {
         for (auto plugin : m_plugins)
         {
+            if (plugin->state == PluginState::eFailed) continue;
             featureList.push_back(plugin->id);
         }
         return !featureList.empty();
     }
 
+    virtual void onPresent() override final;
+
     void populateLoaderJSON(uint32_t deviceType, json& config);
+    void serializeLoaderJSON(const json& config, std::string& text, int indent);
 
     std::mutex m_mtxPluginConfig;
 
@@ -254,7 +287,8 @@ private:
 
     Result mapPlugins(std::vector<fs::path>& files);
     Result findPlugins(const fs::path& path, std::vector<fs::path>& files);
-    
+    void pruneSupersededPlugins(std::vector<fs::path>& files, std::map<std::wstring, std::vector<fs::path>>& fallbacks);
+    void selectDeferredPlugins(const std::vector<fs::path>& files, std::map<std::wstring, PluginManifest>& deferred);
 
     struct Plugin
     {
@@ -285,11 +319,19 @@ private:
         std::vector<std::string> exclusiveHooks;
         std::vector<std::string> incompatiblePlugins;
         FeatureContext context{};
+        std::atomic<PluginState> state = PluginState::eLoaded;
     };
 
     bool loadPlugin(const fs::path path, Plugin **ppPlugin);
+    bool startPlugin(Plugin* plugin, const char* configStr, void* device);
+    PluginState loadDeferredPlugin(Plugin* plugin);
+    void failDeferredPlugin(Plugin* plugin, const std::string& error);
+    void* getDevice(uint32_t& deviceType, VkDevices& vk) const;
 
     void processPluginHooks(const Plugin* plugin);
+    void rebuildHooks();
+    void publishHooks();
+    void publishHookMasks();
     void mapPluginCallbacks(Plugin* plugin);
     uint32_t getFunctionHookID(const std::string& name);
 
@@ -301,8 +343,11 @@ private:
     Version m_version = { 0,0,1 };
     Version m_api = { 0,0,1 };
 
-    HookList m_beforeHooks[(uint32_t)FunctionHookID::eMaxNum];
-    HookList m_afterHooks[(uint32_t)FunctionHookID::eMaxNum];
+    // Hooks are collected here first and then flattened into a new table by 'publishHooks'
+    std::vector<HookPair> m_beforeHooks[(uint32_t)FunctionHookID::eMaxNum];
+    std::vector<HookPair> m_afterHooks[(uint32_t)FunctionHookID::eMaxNum];
+
+    HookTablePublisher m_hookTables;
 
     ID3D12Device* m_d3d12Device = {};
     ID3D11Device* m_d3d11Device = {};
@@ -315,10 +360,17 @@ private:
     using PluginList = std::vector<Plugin*>;
     PluginList m_plugins;
 
-    using PluginMap = std::map<Feature,Plugin*>;
+    inline Plugin* getFeaturePlugin(Feature feature) const
+    {
+        auto ordinal = m_featureIndex.find(feature);
+        return ordinal < m_featurePlugins.size() ? m_featurePlugins[ordinal] : nullptr;
+    }
+
     using ConfigMap = std::map<Feature, json>;
 
-    PluginMap m_featurePluginsMap;
+    FeatureIndex m_featureIndex;
+    // Indexed by feature ordinal, slots are cleared rather than erased so ordinals remain valid
+    std::vector<Plugin*> m_featurePlugins;
     ConfigMap m_featureExternalConfigMap;
 
     int m_appId = 0;
@@ -335,11 +387,40 @@ private:
 
     // Can only be set to true in non production builds (modified by sl.interposer JSON)
     bool m_loadAllFeatures = false;
+    // Set by 'PreferenceFlags::eLoadPluginsOnFirstUse'
+    bool m_loadOnFirstUse = false;
+    // Loader config with all features started so far, provided to plugins started on first use
+    json m_initializedConfig{};
     Preferences m_pref{};
 
     sl::ota::IOTA* m_ota{};
+
+    PluginManifestCache m_manifestCache{};
+
+    // Binary copy of the loader JSON shared with plugins while they are loading or starting up
+    std::vector<uint8_t> m_loaderConfigCBOR{};
+    api::LoaderConfigBinary m_loaderConfigBinary{};
+
+    // Kernel blobs shared by all plugins, must outlive them
+    chi::KernelCache m_kernelCache{};
+
+    DeferredPluginLoader<Plugin> m_deferredLoader{ m_mtxPluginConfig,
+        [this](const std::string& name) { return isPluginLoaded(name); },
+        [this](Plugin* plugin) { return loadDeferredPlugin(plugin); },
+        [this](Plugin* plugin, const std::string& error) { failDeferredPlugin(plugin, error); },
+        [this](Plugin* plugin)
+        {
+            if (s_status == PluginManagerStatus::ePluginsInitialized && !plugin->config.at("hooks").empty())
+            {
+                // Not expected since the manifest said otherwise, plugin must have changed its hooks based on the environment
+                SL_LOG_WARN("Plugin '%s' registered hooks after initialization, objects created earlier are not hooked", plugin->name.c_str());
+                rebuildHooks();
+            }
+        } };
 };
 
+HookMasks g_hookMasks{};
+
 IPluginManager* getInterface()
 {
     if (!PluginManager::s_manager)
@@ -393,7 +474,7 @@ PluginManager::Plugin* PluginManager::isExclusiveHookUsed(const Plugin* exclusiv
 {
     for (auto& plugin : m_plugins)
     {
-        if (plugin == exclusivePlugin) continue;
+        if (plugin == exclusivePlugin || plugin->state != PluginState::eLoaded) continue;
 
         auto hooks = plugin->config.at("hooks");
         for (auto hook : hooks)
@@ -412,6 +493,9 @@ bool PluginManager::isProxyNeeded(const char* className)
 {
     for (auto plugin : m_plugins)
     {
+        // Deferred plugins never register hooks
+        if (plugin->state != PluginState::eLoaded) continue;
+
         auto hooks = plugin->config.at("hooks");
         for (auto hook : hooks)
         {
@@ -429,13 +513,18 @@ Result PluginManager::setFeatureEnabled(Feature feature, bool value)
     // host will not invoke any hooks while we are running as it is
     // documented in the programming guide.
 
-    auto it = m_featurePluginsMap.find(feature);
-    if (it == m_featurePluginsMap.end())
+    auto plugin = getFeaturePlugin(feature);
+    if (!plugin)
     {
         SL_LOG_WARN("Feature '%s' not loaded", getFeatureAsStr(feature));
         return Result::eErrorFeatureFailedToLoad;
     }
-    auto& ctx = (*it).second->context;
+    if (!m_deferredLoader.resolve(plugin))
+    {
+        SL_LOG_WARN("Feature '%s' failed to load", getFeatureAsStr(feature));
+        return Result::eErrorFeatureFailedToLoad;
+    }
+    auto& ctx = plugin->context;
     if (!ctx.supportedAdapters)
     {
         SL_LOG_WARN("Feature '%s' not supported on any available adapter", getFeatureAsStr(feature));
@@ -456,7 +545,7 @@ Result PluginManager::setFeatureEnabled(Feature feature, bool value)
     }
     ctx.enabled = value;
     SL_LOG_INFO("Feature '%s' %s", getFeatureAsStr(feature), value ? "loaded" : "unloaded");
-    auto hooks = (*it).second->config.at("hooks");
+    auto hooks = plugin->config.at("hooks");
     if (!hooks.empty())
     {
         // Plugin has registered hooks, need to redo our prioritized hook lists
@@ -465,27 +554,14 @@ Result PluginManager::setFeatureEnabled(Feature feature, bool value)
         // we could leave the lists intact and check for each hook if plugin 
         // is enabled or not but that is very expensive when hooks are accessed 
         // hundreds of times per frame.
-
-        for (auto& hooks : m_afterHooks)
-        {
-            hooks.clear();
-        }
-        for (auto& hooks : m_beforeHooks)
-        {
-            hooks.clear();
-        }
-
-        // Sorted by priority so processing hooks by priority
-        for (auto plugin : m_plugins)
-        {
-            processPluginHooks(plugin);
-        }
+        rebuildHooks();
     }
     return Result::eOk;
 }
 
 Result PluginManager::findPlugins(const fs::path& directory, std::vector<fs::path>& files)
 {
+    SL_PROFILE_SCOPE("pluginManager::findPlugins");
 #ifdef SL_WINDOWS
     std::wstring dynamicLibraryExt = L".dll";
 #else
@@ -525,6 +601,7 @@ Result PluginManager::findPlugins(const fs::path& directory, std::vector<fs::pat
 
 bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
 {
+    SL_PROFILE_SCOPE("pluginManager::loadPlugin");
     auto freePlugin = [](Plugin** plugin)->void
     {
         FreeLibrary((*plugin)->lib);
@@ -532,7 +609,12 @@ bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
         *plugin = nullptr;
     };
 
-    HMODULE mod = security::loadLibrary(pluginFullPath.c_str());
+    HMODULE mod{};
+    {
+        // Includes signature verification
+        SL_PROFILE_SCOPE("pluginManager::secureLoadLibrary");
+        mod = security::loadLibrary(pluginFullPath.c_str());
+    }
     if (!mod)
     {
         return false;
@@ -565,9 +647,12 @@ bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
         json loaderJSON;
         // Here we do not know device type yet so just pass invalid id
         populateLoaderJSON((uint32_t)m_pref.renderAPI, loaderJSON);
-        auto loaderJSONStr = loaderJSON.dump();
+        std::string loaderJSONStr;
+        serializeLoaderJSON(loaderJSON, loaderJSONStr, -1);
         const char* pluginJSONText{};
-        if (!plugin->onLoad(parameters, loaderJSONStr.c_str(), &pluginJSONText))
+        bool loaded = plugin->onLoad(parameters, loaderJSONStr.c_str(), &pluginJSONText);
+        parameters->set(param::global::kLoaderConfigBinary, (void*)nullptr);
+        if (!loaded)
         {
             SL_LOG_ERROR( "Ignoring '%ls' since core API 'onPluginLoad' failed", plugin->filename.wstring().c_str());
             freePlugin(&plugin);
@@ -617,13 +702,99 @@ bool PluginManager::loadPlugin(const fs::path pluginFullPath, Plugin **ppPlugin)
         return false;
     };
 
+    m_manifestCache.update(pluginFullPath, plugin->config);
+
     // Finally on success make ppPlugin point to our new plugin
     *ppPlugin = plugin;
     return true;
 }
 
+void PluginManager::pruneSupersededPlugins(std::vector<fs::path>& files, std::map<std::wstring, std::vector<fs::path>>& fallbacks)
+{
+    // Mirrors the duplicate handling in 'mapPlugins', a plugin with a higher version and
+    // compatible API wins, on equal versions the first one found wins. Plugins without
+    // a valid cache entry are always loaded and go through the regular checks.
+    std::map<Feature, std::vector<std::pair<size_t, PluginManifest>>> candidates;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        PluginManifest manifest{};
+        if (!m_manifestCache.find(files[i], manifest))
+        {
+            continue;
+        }
+        if (manifest.api.major != m_api.major || manifest.api > m_api || (manifest.priority <= 0 && manifest.name != "sl.common"))
+        {
+            continue;
+        }
+        candidates[manifest.id].push_back({ i, manifest });
+    }
+
+    std::vector<bool> superseded(files.size(), false);
+    for (auto& [id, duplicates] : candidates)
+    {
+        if (duplicates.size() < 2) continue;
+
+        auto best = duplicates.begin();
+        for (auto it = duplicates.begin(); it != duplicates.end(); it++)
+        {
+            if ((*it).second.version > (*best).second.version)
+            {
+                best = it;
+            }
+        }
+        for (auto it = duplicates.begin(); it != duplicates.end(); it++)
+        {
+            if (it == best) continue;
+            auto& [index, manifest] = *it;
+            SL_LOG_INFO("Skipping plugin '%S' (%s) since it is superseded by '%S' (%s)", files[index].wstring().c_str(), manifest.version.toStr().c_str(),
+                files[(*best).first].wstring().c_str(), (*best).second.version.toStr().c_str());
+            superseded[index] = true;
+            fallbacks[files[(*best).first].wstring()].push_back(files[index]);
+        }
+    }
+
+    std::vector<fs::path> remaining;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (!superseded[i])
+        {
+            remaining.push_back(files[i]);
+        }
+    }
+    files.swap(remaining);
+}
+
+void PluginManager::selectDeferredPlugins(const std::vector<fs::path>& files, std::map<std::wstring, PluginManifest>& deferred)
+{
+    // Duplicates and dependencies can only be resolved up front if every plugin has a valid manifest,
+    // otherwise everything is loaded as usual which also makes the cache warm for the next run.
+    std::vector<PluginManifest> manifests(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (!m_manifestCache.find(files[i], manifests[i]))
+        {
+            SL_LOG_INFO("Plugin '%ls' has no cached manifest, loading all plugins on startup", files[i].wstring().c_str());
+            return;
+        }
+    }
+
+    auto isRequested = [this](Feature id)->bool
+    {
+        return m_loadAllFeatures || std::find(m_featuresToLoad.begin(), m_featuresToLoad.end(), id) != m_featuresToLoad.end();
+    };
+    auto deferrable = plugin_manager::selectDeferredPlugins(manifests, m_api, isRequested);
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        if (deferrable[i])
+        {
+            deferred[files[i].wstring()] = manifests[i];
+        }
+    }
+}
+
 Result PluginManager::mapPlugins(std::vector<fs::path>& files)
 {
+    SL_PROFILE_SCOPE("pluginManager::mapPlugins");
     using namespace sl::api;
 
     auto freePlugin = [](Plugin** plugin)->void
@@ -633,8 +804,41 @@ Result PluginManager::mapPlugins(std::vector<fs::path>& files)
         *plugin = nullptr;
     };
 
-    for (auto pluginFullPath : files)
+    // Plugins known to be superseded are not loaded at all, unless the plugin replacing them fails to load
+    std::map<std::wstring, std::vector<fs::path>> fallbacks;
+    pruneSupersededPlugins(files, fallbacks);
+
+    // Plugins loaded on first use are represented by their cached manifest until then
+    std::map<std::wstring, PluginManifest> deferred;
+    if (m_loadOnFirstUse)
+    {
+        selectDeferredPlugins(files, deferred);
+    }
+
+    for (size_t i = 0; i < files.size(); i++)
     {
+        auto pluginFullPath = files[i];
+
+        auto manifest = deferred.find(pluginFullPath.wstring());
+        if (manifest != deferred.end())
+        {
+            auto& info = (*manifest).second;
+            Plugin* plugin = new Plugin();
+            plugin->fullpath = pluginFullPath;
+            plugin->filename = pluginFullPath.stem();
+            plugin->id = info.id;
+            plugin->name = info.name;
+            plugin->version = info.version;
+            plugin->api = info.api;
+            plugin->priority = info.priority;
+            plugin->requiredPlugins = info.requiredPlugins;
+            plugin->state = PluginState::eDeferred;
+            SL_LOG_INFO("Deferred plugin '%s' - version %u.%u.%u - id %u - priority %u until first use", plugin->name.c_str(), plugin->version.major, plugin->version.minor, plugin->version.build,
+                plugin->id, plugin->priority);
+            m_plugins.push_back(plugin);
+            continue;
+        }
+
         // From this point any error is fatal since user requested specific set of features
         Plugin *plugin = nullptr;
         if (loadPlugin(pluginFullPath, &plugin))
@@ -691,6 +895,9 @@ Result PluginManager::mapPlugins(std::vector<fs::path>& files)
 
             if (!requested)
             {
+                // 'onLoad' still has to run for plugins which are not requested, the adapter, driver and OS
+                // requirements it reports are returned by 'slGetFeatureRequirements' for every feature
+                // and cannot be cached. Only deferred and superseded plugins skip it.
                 SL_LOG_WARN("Ignoring plugin '%s' since it is was not requested by the host", plugin->name.c_str());
                 freePlugin(&plugin);
             }
@@ -805,6 +1012,17 @@ Result PluginManager::mapPlugins(std::vector<fs::path>& files)
         else
         {
             SL_LOG_WARN("Failed to load plugin '%ls' - last error %s", pluginFullPath.wstring().c_str(), std::system_category().message(GetLastError()).c_str());
+
+            auto it = fallbacks.find(pluginFullPath.wstring());
+            if (it != fallbacks.end())
+            {
+                for (auto& fallback : (*it).second)
+                {
+                    SL_LOG_INFO("Falling back to previously superseded plugin '%S'", fallback.wstring().c_str());
+                    files.push_back(fallback);
+                }
+                fallbacks.erase(it);
+            }
         }
     };
 
@@ -813,6 +1031,7 @@ Result PluginManager::mapPlugins(std::vector<fs::path>& files)
 
 Result PluginManager::loadPlugins()
 {
+    SL_PROFILE_SCOPE("pluginManager::loadPlugins");
     using namespace sl::api;
 
     std::scoped_lock lock(m_mtxPluginConfig);
@@ -845,6 +1064,10 @@ Result PluginManager::loadPlugins()
 #endif
 
     s_status = PluginManagerStatus::ePluginsLoaded;
+    // Everything goes through the lazy initialization until hooks are known
+    g_hookMasks.before.store(~0ull, std::memory_order_relaxed);
+    g_hookMasks.after.store(~0ull, std::memory_order_relaxed);
+    m_loadOnFirstUse = m_pref.flags & PreferenceFlags::eLoadPluginsOnFirstUse;
 
     // Kickoff OTA update, this function internally will check OTA preferences
     m_ota->readServerManifest();
@@ -909,8 +1132,15 @@ Result PluginManager::loadPlugins()
     }
 
     param::getInterface()->set(param::global::kPluginPath, (void*)m_pluginPath.c_str());
+    param::getInterface()->set(param::global::kKernelCache, (void*)static_cast<chi::IKernelCache*>(&m_kernelCache));
 
-    SL_CHECK(mapPlugins(pluginList));
+    // Cache is per user and per executable, it only holds static plugin identity so worst case a stale entry costs an extra load
+    auto cacheFile = fs::path(file::getTmpPath()) / L"NVIDIA" / L"Streamline" / (file::getExecutableName() + L".plugins.json");
+    m_manifestCache.load(cacheFile, m_version.toStr() + "." + GIT_LAST_COMMIT_SHORT);
+
+    auto mapResult = mapPlugins(pluginList);
+    m_manifestCache.save();
+    SL_CHECK(mapResult);
     
     // Sort by priority so we can execute hooks in the specific order and check dependencies and other requirements in the correct order
     std::sort(m_plugins.begin(), m_plugins.end(),
@@ -927,9 +1157,9 @@ Result PluginManager::loadPlugins()
             // This is our current plugin
             auto plugin = *it;
             
-            // If we are not supported then we just unload ourselves
+            // If we are not supported then we just unload ourselves, deferred plugins are checked once loaded
             auto& extCfg = m_featureExternalConfigMap[plugin->id];
-            if (!extCfg["feature"]["supported"])
+            if (plugin->state == PluginState::eLoaded && !extCfg["feature"]["supported"])
             {
                 SL_LOG_WARN("Ignoring plugin '%s' since it is not supported on this platform", plugin->name.c_str());
                 pluginsToUnload.push_back(plugin);
@@ -1014,7 +1244,10 @@ Result PluginManager::loadPlugins()
                 if (*it == plugin)
                 {
                     it = m_plugins.erase(it);
-                    FreeLibrary(plugin->lib);
+                    if (plugin->lib)
+                    {
+                        FreeLibrary(plugin->lib);
+                    }
                     delete plugin;
                 }
                 else
@@ -1032,10 +1265,18 @@ Result PluginManager::loadPlugins()
     else
     {
         SL_LOG_INFO("Plugin execution order based on priority:");
+        m_featureIndex.clear();
+        m_featurePlugins.clear();
         for (auto plugin : m_plugins)
         {
-            SL_LOG_INFO("P%u - %s", plugin->priority, plugin->name.c_str());
-            m_featurePluginsMap[plugin->id] = plugin;
+            SL_LOG_INFO("P%u - %s%s", plugin->priority, plugin->name.c_str(), plugin->state == PluginState::eDeferred ? " (loaded on first use)" : "");
+            if (plugin->state == PluginState::eLoaded)
+            {
+                auto& extCfg = m_featureExternalConfigMap[plugin->id];
+                plugin->context.supported = !extCfg.contains("/feature/supported"_json_pointer) || extCfg["feature"]["supported"].get<bool>();
+            }
+            m_featureIndex.add(plugin->id, (uint32_t)m_featurePlugins.size());
+            m_featurePlugins.push_back(plugin);
         }
     }
     return m_plugins.empty() ? Result::eErrorNoPlugins : Result::eOk;
@@ -1045,31 +1286,47 @@ Result PluginManager::unloadPlugins()
 {
     SL_LOG_INFO("Unloading all plugins ...");
 
+    // Plugins can be loaded on first use from any thread, detach them under the lock
+    // but shut them down outside of it since 'onShutdown' can call back into the manager
+    std::vector<Plugin*> plugins;
+    {
+        std::scoped_lock lock(m_mtxPluginConfig);
+        plugins.swap(m_plugins);
+        m_featureIndex.clear();
+        m_featurePlugins.clear();
+        m_featureExternalConfigMap.clear();
+        for (auto& hooks : m_afterHooks)
+        {
+            hooks.clear();
+        }
+        for (auto& hooks : m_beforeHooks)
+        {
+            hooks.clear();
+        }
+        publishHooks();
+        m_externalJSONConfigs.clear();
+        // After shutdown any hook triggers will be ignored and no more plugins are loaded on first use
+        s_status = PluginManagerStatus::ePluginsUnloaded;
+    }
+
     // IMPORTANT: Shut down in the opposite order lower priority to higher
-    for (auto plugin = m_plugins.rbegin(); plugin != m_plugins.rend(); plugin++)
+    for (auto plugin = plugins.rbegin(); plugin != plugins.rend(); plugin++)
     {
         if ((*plugin)->onShutdown)
         {
             (*plugin)->onShutdown();
         }
-        FreeLibrary((*plugin)->lib);
+        if ((*plugin)->lib)
+        {
+            FreeLibrary((*plugin)->lib);
+        }
         delete (*plugin);
     }
-    m_plugins.clear();
-    m_featurePluginsMap.clear();
-    m_featureExternalConfigMap.clear();
-    for (auto& hooks : m_afterHooks)
-    {
-        hooks.clear();
-    }
-    for (auto& hooks : m_beforeHooks)
-    {
-        hooks.clear();
-    }
-    m_externalJSONConfigs.clear();
 
-    // After shutdown any hook triggers will be ignored
-    s_status = PluginManagerStatus::ePluginsUnloaded;
+    // Plugins released their kernels on shutdown, anything left belongs to modules which are gone
+    param::getInterface()->set(param::global::kKernelCache, (void*)nullptr);
+    SL_LOG_VERBOSE("Releasing %llu cached kernel blob(s)", (uint64_t)m_kernelCache.getBlobCount());
+    m_kernelCache.clear();
 
     return sl::Result::eOk;
 }
@@ -1139,6 +1396,49 @@ void PluginManager::processPluginHooks(const Plugin* plugin)
     }
 }
 
+void PluginManager::rebuildHooks()
+{
+    for (auto& hooks : m_afterHooks)
+    {
+        hooks.clear();
+    }
+    for (auto& hooks : m_beforeHooks)
+    {
+        hooks.clear();
+    }
+
+    // Sorted by priority so processing hooks by priority
+    for (auto plugin : m_plugins)
+    {
+        if (plugin->state == PluginState::eLoaded)
+        {
+            processPluginHooks(plugin);
+        }
+    }
+    publishHooks();
+}
+
+void PluginManager::publishHooks()
+{
+    m_hookTables.publish(HookTable::build(m_beforeHooks, m_afterHooks));
+    if (s_status == PluginManagerStatus::ePluginsInitialized)
+    {
+        publishHookMasks();
+    }
+}
+
+void PluginManager::publishHookMasks()
+{
+    auto table = m_hookTables.get();
+    g_hookMasks.before.store(table->beforeMask, std::memory_order_relaxed);
+    g_hookMasks.after.store(table->afterMask, std::memory_order_relaxed);
+}
+
+void PluginManager::onPresent()
+{
+    m_hookTables.onPresent();
+}
+
 void PluginManager::populateLoaderJSON(uint32_t deviceType, json& config)
 {
     try
@@ -1179,8 +1479,21 @@ void PluginManager::populateLoaderJSON(uint32_t deviceType, json& config)
     };
 }
 
+void PluginManager::serializeLoaderJSON(const json& config, std::string& text, int indent)
+{
+    m_loaderConfigBinary = {};
+    if (plugin::serializeLoaderConfig(config, indent, text, m_loaderConfigCBOR))
+    {
+        m_loaderConfigBinary.text = text.c_str();
+        m_loaderConfigBinary.data = m_loaderConfigCBOR.data();
+        m_loaderConfigBinary.size = m_loaderConfigCBOR.size();
+    }
+    param::getInterface()->set(param::global::kLoaderConfigBinary, m_loaderConfigBinary.text ? (void*)&m_loaderConfigBinary : nullptr);
+}
+
 Result PluginManager::initializePlugins()
 {
+    SL_PROFILE_SCOPE("pluginManager::initializePlugins");
     if (s_status == PluginManagerStatus::ePluginsLoaded)
     {
         std::scoped_lock lock(m_mtxPluginConfig);
@@ -1197,26 +1510,15 @@ Result PluginManager::initializePlugins()
             return Result::eErrorNoPlugins;
         }
 
-        // Default to VK
-        uint32_t deviceType = (uint32_t)RenderAPI::eVulkan;
-        VkDevices vk = { m_vkInstance, m_vkDevice, m_vkPhysicalDevice };
-        void* device = &vk;
-
-        if (m_d3d12Device)
-        {
-            device = m_d3d12Device;
-            deviceType = (uint32_t)RenderAPI::eD3D12;
-        }
-        else if (m_d3d11Device)
-        {
-            device = m_d3d11Device;
-            deviceType = (uint32_t)RenderAPI::eD3D11;
-        }
+        uint32_t deviceType{};
+        VkDevices vk{};
+        void* device = getDevice(deviceType, vk);
 
         // We have correct device type so generate new config
         json config;
         populateLoaderJSON(deviceType, config);
-        auto configStr = config.dump(1, ' ', false, json::error_handler_t::replace); // use indent 1 so it is easier to read in debugger
+        std::string configStr;
+        serializeLoaderJSON(config, configStr, 1); // use indent 1 so it is easier to read in debugger
 
         SL_LOG_INFO("Initializing plugins - api %u.%u.%u - application ID %u", m_api.major, m_api.minor, m_api.build, m_appId);
 
@@ -1225,54 +1527,32 @@ Result PluginManager::initializePlugins()
         auto plugins = m_plugins;
         for (auto plugin : plugins)
         {
-            auto& extCfg = m_featureExternalConfigMap[plugin->id];
+            // Deferred plugins are started once they are loaded
+            if (plugin->state != PluginState::eLoaded) continue;
 
-            plugin->onStartup = reinterpret_cast<api::PFuncOnPluginStartup*>(plugin->getFunction("slOnPluginStartup"));
-            plugin->onShutdown = reinterpret_cast<api::PFuncOnPluginShutdown*>(plugin->getFunction("slOnPluginShutdown"));
-            plugin->onPluginsInitialized = reinterpret_cast<api::PFuncOnPluginsInitialized*>(plugin->getFunction("slOnPluginsInitialized"));
-            bool unload = false;
-            if (!plugin->onStartup || !plugin->onShutdown)
+            if (!startPlugin(plugin, configStr.c_str(), device))
             {
-                unload = true;
-                SL_LOG_ERROR( "onStartup/onShutdown missing for plugin %s", plugin->name.c_str());
-                extCfg["feature"]["lastError"] = "Error: core API not found in the plugin";
-            }
-            else if (!plugin->onStartup(configStr.c_str(), device))
-            {
-                unload = true;
-                extCfg["feature"]["lastError"] = "Error: onStartup failed";
-            }
-            if (unload)
-            {
-                extCfg["feature"]["unloaded"] = true;
-                extCfg["feature"]["supported"] = false;
-                m_featurePluginsMap.erase(plugin->id);
-                FreeLibrary(plugin->lib);
+                m_featurePlugins[m_featureIndex.find(plugin->id)] = nullptr;
                 m_plugins.erase(std::remove(m_plugins.begin(), m_plugins.end(), plugin), m_plugins.end());
                 delete plugin;
                 
                 continue;
             }
-            else
-            {
-                // Plugin initialized correctly, let's map callbacks for the core API
-                mapPluginCallbacks(plugin);
-                // Let other plugins know that this plugin is loaded and supported and on which adapters
-                auto supportedAdaptersParam = "sl.param." + plugin->paramNamespace + ".supportedAdapters";
-                parameters->set(supportedAdaptersParam.c_str(), plugin->context.supportedAdapters);
-                config["active_features"][sl::getFeatureAsStr(plugin->id)]["supportedAdapters"] = plugin->context.supportedAdapters;
-            }
+            config["active_features"][sl::getFeatureAsStr(plugin->id)]["supportedAdapters"] = plugin->context.supportedAdapters;
             processPluginHooks(plugin);
         }
+        parameters->set(param::global::kLoaderConfigBinary, (void*)nullptr);
+        publishHooks();
 
         // Post init phase
         {
             // Config now contains list of active and initialized features with their supported adapters
+            m_initializedConfig = config;
             configStr = config.dump(1, ' ', false, json::error_handler_t::replace);
             for (auto plugin : m_plugins)
             {
                 // Optional so check first
-                if (!plugin->onPluginsInitialized)
+                if (plugin->state != PluginState::eLoaded || !plugin->onPluginsInitialized)
                 {
                     continue;
                 }
@@ -1297,6 +1577,7 @@ Result PluginManager::initializePlugins()
         }
 
         s_status = PluginManagerStatus::ePluginsInitialized;
+        publishHookMasks();
     }
     else if (s_status == PluginManagerStatus::ePluginsInitialized)
     {
@@ -1312,6 +1593,158 @@ Result PluginManager::initializePlugins()
     return Result::eOk;
 }
 
+void* PluginManager::getDevice(uint32_t& deviceType, VkDevices& vk) const
+{
+    // Default to VK
+    deviceType = (uint32_t)RenderAPI::eVulkan;
+    vk = { m_vkInstance, m_vkDevice, m_vkPhysicalDevice };
+    void* device = &vk;
+
+    if (m_d3d12Device)
+    {
+        device = m_d3d12Device;
+        deviceType = (uint32_t)RenderAPI::eD3D12;
+    }
+    else if (m_d3d11Device)
+    {
+        device = m_d3d11Device;
+        deviceType = (uint32_t)RenderAPI::eD3D11;
+    }
+    return device;
+}
+
+bool PluginManager::startPlugin(Plugin* plugin, const char* configStr, void* device)
+{
+    auto& extCfg = m_featureExternalConfigMap[plugin->id];
+
+    plugin->onStartup = reinterpret_cast<api::PFuncOnPluginStartup*>(plugin->getFunction("slOnPluginStartup"));
+    plugin->onShutdown = reinterpret_cast<api::PFuncOnPluginShutdown*>(plugin->getFunction("slOnPluginShutdown"));
+    plugin->onPluginsInitialized = reinterpret_cast<api::PFuncOnPluginsInitialized*>(plugin->getFunction("slOnPluginsInitialized"));
+    bool unload = false;
+    if (!plugin->onStartup || !plugin->onShutdown)
+    {
+        unload = true;
+        SL_LOG_ERROR( "onStartup/onShutdown missing for plugin %s", plugin->name.c_str());
+        extCfg["feature"]["lastError"] = "Error: core API not found in the plugin";
+    }
+    else if (!plugin->onStartup(configStr, device))
+    {
+        unload = true;
+        extCfg["feature"]["lastError"] = "Error: onStartup failed";
+    }
+    if (unload)
+    {
+        extCfg["feature"]["unloaded"] = true;
+        extCfg["feature"]["supported"] = false;
+        plugin->context.supported = false;
+        FreeLibrary(plugin->lib);
+        plugin->lib = {};
+        plugin->onShutdown = {};
+        return false;
+    }
+
+    // Plugin initialized correctly, let's map callbacks for the core API
+    mapPluginCallbacks(plugin);
+    // Let other plugins know that this plugin is loaded and supported and on which adapters
+    auto supportedAdaptersParam = "sl.param." + plugin->paramNamespace + ".supportedAdapters";
+    param::getInterface()->set(supportedAdaptersParam.c_str(), plugin->context.supportedAdapters);
+    return true;
+}
+
+void PluginManager::failDeferredPlugin(Plugin* plugin, const std::string& error)
+{
+    auto& extCfg = m_featureExternalConfigMap[plugin->id];
+    extCfg["feature"]["unloaded"] = true;
+    extCfg["feature"]["supported"] = false;
+    extCfg["feature"]["lastError"] = error;
+    plugin->context.supported = false;
+}
+
+PluginState PluginManager::loadDeferredPlugin(Plugin* plugin)
+{
+    // Called by 'm_deferredLoader' with the config lock held once all required plugins are loaded
+    if (s_status != PluginManagerStatus::ePluginsLoaded && s_status != PluginManagerStatus::ePluginsInitialized)
+    {
+        return PluginState::eDeferred;
+    }
+
+    SL_PROFILE_SCOPE("pluginManager::loadDeferredPlugin");
+    SL_LOG_INFO("Loading plugin '%s' on first use", plugin->name.c_str());
+
+    Plugin* loaded{};
+    if (!loadPlugin(plugin->fullpath, &loaded))
+    {
+        SL_LOG_ERROR( "Failed to load plugin '%ls' on first use", plugin->fullpath.wstring().c_str());
+        failDeferredPlugin(plugin, "Error: feature failed to load");
+        return PluginState::eFailed;
+    }
+
+    // Manifest cache validates file identity but be paranoid, this is what the host was told at init time
+    if (loaded->id != plugin->id || !(loaded->version == plugin->version) || !(loaded->api == plugin->api))
+    {
+        SL_LOG_ERROR( "Plugin '%s' does not match its cached manifest", plugin->name.c_str());
+        FreeLibrary(loaded->lib);
+        delete loaded;
+        failDeferredPlugin(plugin, "Error: feature does not match its cached manifest");
+        return PluginState::eFailed;
+    }
+
+    auto& extCfg = m_featureExternalConfigMap[plugin->id];
+    extCfg["feature"]["requested"] = true;
+    extCfg["feature"]["dependency"] = "none";
+    extCfg["feature"]["incompatible"] = "none";
+    if (!extCfg["feature"]["supported"])
+    {
+        SL_LOG_WARN("Ignoring plugin '%s' since it is not supported on this platform", plugin->name.c_str());
+        FreeLibrary(loaded->lib);
+        delete loaded;
+        plugin->context.supported = false;
+        return PluginState::eFailed;
+    }
+
+    // Placeholder stays in place since its feature context is handed out to the host
+    plugin->lib = loaded->lib;
+    plugin->sha = loaded->sha;
+    plugin->config = std::move(loaded->config);
+    plugin->paramNamespace = loaded->paramNamespace;
+    plugin->getFunction = loaded->getFunction;
+    plugin->onLoad = loaded->onLoad;
+    plugin->context.getFunction = loaded->context.getFunction;
+    plugin->context.isSupported = loaded->context.isSupported;
+    plugin->context.supportedAdapters = loaded->context.supportedAdapters;
+    delete loaded;
+
+    // Before initialization plugin is started together with all others in 'initializePlugins'
+    if (s_status == PluginManagerStatus::ePluginsInitialized)
+    {
+        uint32_t deviceType{};
+        VkDevices vk{};
+        void* device = getDevice(deviceType, vk);
+
+        json config;
+        populateLoaderJSON(deviceType, config);
+        std::string configStr;
+        serializeLoaderJSON(config, configStr, 1);
+        bool started = startPlugin(plugin, configStr.c_str(), device);
+        param::getInterface()->set(param::global::kLoaderConfigBinary, (void*)nullptr);
+        if (!started)
+        {
+            return PluginState::eFailed;
+        }
+
+        // Other plugins were notified already, only the new one gets the list of active features
+        m_initializedConfig["active_features"][sl::getFeatureAsStr(plugin->id)]["supportedAdapters"] = plugin->context.supportedAdapters;
+        if (plugin->onPluginsInitialized)
+        {
+            plugin->onPluginsInitialized(m_initializedConfig.dump(1, ' ', false, json::error_handler_t::replace).c_str());
+        }
+    }
+
+    SL_LOG_INFO("Loaded plugin '%s' - version %u.%u.%u.%s - id %u - priority %u - adapter mask 0x%x on first use", plugin->name.c_str(), plugin->version.major, plugin->version.minor, plugin->version.build,
+        plugin->sha.c_str(), plugin->id, plugin->priority, plugin->context.supportedAdapters);
+    return PluginState::eLoaded;
+}
+
 void PluginManager::mapPluginCallbacks(Plugin* plugin)
 {
     plugin->context.initialized = true;
@@ -1332,7 +1765,7 @@ void PluginManager::mapPluginCallbacks(Plugin* plugin)
     SL_LOG_INFO("Callback %s:slSetConsts:0x%llx", plugin->name.c_str(), plugin->context.setConstants);
 }
 
-const HookList& PluginManager::getBeforeHooks(FunctionHookID functionHookID)
+HookList PluginManager::getBeforeHooks(FunctionHookID functionHookID)
 {
     // Lazy plugin initialization because of the late device initialization
     if (s_status == PluginManagerStatus::ePluginsLoaded)
@@ -1343,10 +1776,10 @@ const HookList& PluginManager::getBeforeHooks(FunctionHookID functionHookID)
     {
         SL_LOG_ERROR( "Please make sure to call slInit before calling DXGI/D3D/Vulkan API");
     }
-    return m_beforeHooks[(uint32_t)functionHookID];
+    return m_hookTables.get()->getBefore(functionHookID);
 }
 
-const HookList& PluginManager::getAfterHooks(FunctionHookID functionHookID)
+HookList PluginManager::getAfterHooks(FunctionHookID functionHookID)
 {
     // Lazy plugin initialization because of the late device initialization
     if (s_status == PluginManagerStatus::ePluginsLoaded)
@@ -1357,17 +1790,17 @@ const HookList& PluginManager::getAfterHooks(FunctionHookID functionHookID)
     {
         SL_LOG_ERROR( "Please make sure to call slInit before calling DXGI/D3D/Vulkan API");
     }
-    return m_afterHooks[(uint32_t)functionHookID];
+    return m_hookTables.get()->getAfter(functionHookID);
 }
 
-const HookList& PluginManager::getBeforeHooksWithoutLazyInit(FunctionHookID functionHookID)
+HookList PluginManager::getBeforeHooksWithoutLazyInit(FunctionHookID functionHookID)
 {
-    return m_beforeHooks[(uint32_t)functionHookID];
+    return m_hookTables.get()->getBefore(functionHookID);
 }
 
-const HookList& PluginManager::getAfterHooksWithoutLazyInit(FunctionHookID functionHookID)
+HookList PluginManager::getAfterHooksWithoutLazyInit(FunctionHookID functionHookID)
 {
-    return m_afterHooks[(uint32_t)functionHookID];
+    return m_hookTables.get()->getAfter(functionHookID);
 }
 
 PluginManager::PluginManager()
@@ -1401,6 +1834,9 @@ PluginManager::PluginManager()
 
     assert((size_t)FunctionHookID::eMaxNum == m_functionHookIDMap.size());
 
+    // Empty table so hooks can be queried before any plugin is initialized
+    publishHooks();
+
     m_ota = ota::getInterface();
 }
 
@@ -24,9 +24,11 @@
 
 #include <vector>
 #include <map>
+#include <atomic>
 
 #include "include/sl_hooks.h"
 #include "source/core/sl.api/internal.h"
+#include "source/core/sl.plugin-manager/hookTable.h"
 
 #include "external/json/include/nlohmann/json.hpp"
 using json = nlohmann::json;
@@ -46,19 +48,9 @@ namespace param
 {
     struct Parameters;
 }
-namespace interposer
-{
-using VirtualAddress = void*;
-}
-
-using Feature = uint32_t;
-
 namespace plugin_manager
 {
 
-using HookPair = std::pair<interposer::VirtualAddress, sl::Feature>;
-using HookList = std::vector<HookPair>;
-
 using PFun_slSetDataInternal = Result(const sl::BaseStructure* inputs, sl::CommandBuffer* cmdBuffer);
 using PFun_slGetDataInternal = Result(const sl::BaseStructure* inputs, sl::BaseStructure* outputs, sl::CommandBuffer* cmdBuffer);
 using PFun_slIsSupported = Result(const sl::AdapterInfo& adapterInfo);
@@ -67,6 +59,8 @@ struct FeatureContext
 {
     bool initialized = false;
     bool enabled = true;
+    //! Mirrors "feature/supported" from the external config so it does not have to be parsed on each call
+    bool supported = true;
     uint32_t supportedAdapters = 0;
     api::PFuncGetPluginFunction* getFunction{};
     PFun_slSetDataInternal* setData{};
@@ -97,10 +91,10 @@ struct IPluginManager
 
     virtual Result initializePlugins() = 0;
 
-    virtual const HookList& getBeforeHooks(FunctionHookID functionHookID) = 0;
-    virtual const HookList& getAfterHooks(FunctionHookID functionHookID) = 0;
-    virtual const HookList& getBeforeHooksWithoutLazyInit(FunctionHookID functionHookID) = 0;
-    virtual const HookList& getAfterHooksWithoutLazyInit(FunctionHookID functionHookID) = 0;
+    virtual HookList getBeforeHooks(FunctionHookID functionHookID) = 0;
+    virtual HookList getAfterHooks(FunctionHookID functionHookID) = 0;
+    virtual HookList getBeforeHooksWithoutLazyInit(FunctionHookID functionHookID) = 0;
+    virtual HookList getAfterHooksWithoutLazyInit(FunctionHookID functionHookID) = 0;
     virtual Result setFeatureEnabled(Feature feature, bool value) = 0;
     virtual void setPreferences(const Preferences& pref) = 0;
     virtual const Preferences& getPreferences() const = 0;
@@ -116,12 +110,34 @@ struct IPluginManager
     virtual const FeatureContext* getFeatureContext(Feature feature) = 0;
 
     virtual bool getExternalFeatureConfig(Feature feature, std::string& configAsText) = 0;
-    virtual bool getLoadedFeatureConfigs(std::vector<json>& configList) const = 0;
+    virtual bool getLoadedFeatureConfigs(std::vector<json>& configList) = 0;
     virtual bool getLoadedFeatures(std::vector<Feature>& featureList) const = 0;
+
+    //! Called by the interposer once per present, after all present hooks returned
+    //!
+    //! Hook tables replaced before the previous present are freed here, a HookList must
+    //! therefore not be held for longer than a frame.
+    virtual void onPresent() = 0;
 };
 
 IPluginManager* getInterface();
 void destroyInterface();
 
+extern HookMasks g_hookMasks;
+
+//! Most API calls have no hooks at all, these skip the interface lookup, virtual call
+//! and status checks for them with a single load
+inline HookList getBeforeHooks(FunctionHookID functionHookID)
+{
+    if (!(g_hookMasks.before.load(std::memory_order_relaxed) & (1ull << (uint32_t)functionHookID))) return {};
+    return getInterface()->getBeforeHooks(functionHookID);
+}
+
+inline HookList getAfterHooks(FunctionHookID functionHookID)
+{
+    if (!(g_hookMasks.after.load(std::memory_order_relaxed) & (1ull << (uint32_t)functionHookID))) return {};
+    return getInterface()->getAfterHooks(functionHookID);
+}
+
 }
 }
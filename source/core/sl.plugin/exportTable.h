@@ -0,0 +1,165 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <utility>
+#include <initializer_list>
+
+namespace sl
+{
+namespace plugin
+{
+
+struct ExportedFunction
+{
+    const char* name;
+    void* function;
+};
+
+#define SL_EXPORT_FUNCTION(fun) sl::plugin::ExportedFunction{ #fun, (void*)fun }
+
+//! Perfect hash table with all functions exported via 'slGetPluginFunction'
+//!
+//! Seed is chosen when the table is built so that every name lands in its own slot,
+//! lookup costs one hash and at most one string comparison regardless of the number
+//! of exports and unknown names are rejected on the first mismatching character.
+//!
+//! Usage:
+//!
+//! static const plugin::ExportTable s_exports = { SL_EXPORT_FUNCTION(slOnPluginLoad), ... };
+//! return s_exports.find(functionName);
+class ExportTable
+{
+public:
+    ExportTable(const ExportTable&) = delete;
+    ExportTable& operator=(const ExportTable&) = delete;
+
+    ExportTable(std::initializer_list<ExportedFunction> exports) : ExportTable(std::vector<ExportedFunction>(exports)) {}
+
+    //! For export lists which are not known at compile time
+    ExportTable(std::vector<ExportedFunction> exports) : m_exports(std::move(exports))
+    {
+        // Exports share long prefixes ("slHook", "slOnPlugin") so by default only the length
+        // and the trailing characters are hashed, if that is not unique the whole name is used.
+        for (size_t i = 0; i < m_exports.size() && !m_hashWholeName; i++)
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                if (strcmp(m_exports[i].name, m_exports[j].name) && getKey(m_exports[i].name, false) == getKey(m_exports[j].name, false))
+                {
+                    m_hashWholeName = true;
+                    break;
+                }
+            }
+        }
+
+        // Load factor of at most 0.5 keeps the expected number of seeds to try low
+        uint32_t bits = 2;
+        while ((1ull << bits) < m_exports.size() * 2)
+        {
+            bits++;
+        }
+        for (uint64_t seed = 1; !build(seed, bits); seed++)
+        {
+            // Give up on this size after a while, a bigger table has fewer collisions
+            if ((seed % 256) == 0)
+            {
+                bits++;
+            }
+        }
+    }
+
+    inline void* find(const char* name) const
+    {
+        if (!name)
+        {
+            return nullptr;
+        }
+        auto index = m_slots[getSlot(getKey(name, m_hashWholeName), m_seed, m_bits)];
+        if (index == kEmptySlot || strcmp(m_exports[index].name, name) != 0)
+        {
+            return nullptr;
+        }
+        return m_exports[index].function;
+    }
+
+    inline size_t size() const { return m_exports.size(); }
+
+private:
+    static constexpr uint32_t kEmptySlot = ~0u;
+
+    static inline uint64_t getKey(const char* name, bool wholeName)
+    {
+        auto length = strlen(name);
+        uint64_t key = 0xcbf29ce484222325ull ^ length;
+        if (wholeName)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                key = (key ^ (uint8_t)name[i]) * 0x100000001b3ull;
+            }
+            return key;
+        }
+        uint64_t tail = 0;
+        auto count = length < sizeof(tail) ? length : sizeof(tail);
+        memcpy(&tail, name + length - count, count);
+        return (key ^ tail) * 0x100000001b3ull;
+    }
+
+    static inline uint32_t getSlot(uint64_t key, uint64_t seed, uint32_t bits)
+    {
+        key = (key ^ seed) * 0x9e3779b97f4a7c15ull;
+        return (uint32_t)((key ^ (key >> 29)) >> (64 - bits));
+    }
+
+    bool build(uint64_t seed, uint32_t bits)
+    {
+        m_slots.assign(1ull << bits, kEmptySlot);
+        for (uint32_t i = 0; i < (uint32_t)m_exports.size(); i++)
+        {
+            auto& slot = m_slots[getSlot(getKey(m_exports[i].name, m_hashWholeName), seed, bits)];
+            if (slot != kEmptySlot)
+            {
+                // Same name exported twice, first one wins just like it used to with the 'strcmp' chain
+                if (!strcmp(m_exports[slot].name, m_exports[i].name)) continue;
+                return false;
+            }
+            slot = i;
+        }
+        m_seed = seed;
+        m_bits = bits;
+        return true;
+    }
+
+    std::vector<ExportedFunction> m_exports;
+    std::vector<uint32_t> m_slots;
+    uint64_t m_seed = 0;
+    uint32_t m_bits = 0;
+    bool m_hashWholeName = false;
+};
+
+}
+}
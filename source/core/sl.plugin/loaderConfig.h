@@ -0,0 +1,77 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include "source/core/sl.log/log.h"
+#include "external/json/include/nlohmann/json.hpp"
+
+namespace sl
+{
+namespace plugin
+{
+
+//! Serializes loader config as JSON text and as CBOR (RFC 8949) describing the same tree
+//!
+//! Returns false if the config contains invalid UTF-8, 'text' then has replacement
+//! characters and 'cbor' is left empty so plugins fall back to parsing the text.
+inline bool serializeLoaderConfig(const nlohmann::json& config, int indent, std::string& text, std::vector<uint8_t>& cbor)
+{
+    cbor.clear();
+    try
+    {
+        // Strict on purpose, replacing invalid UTF-8 in the text only would make the two copies differ
+        text = config.dump(indent, ' ', false, nlohmann::json::error_handler_t::strict);
+        cbor = nlohmann::json::to_cbor(config);
+        return true;
+    }
+    catch (std::exception& e)
+    {
+        SL_LOG_WARN("Loader JSON contains invalid characters, plugins will parse the text - %s", e.what());
+        text = config.dump(indent, ' ', false, nlohmann::json::error_handler_t::replace);
+        cbor.clear();
+    }
+    return false;
+}
+
+//! Decodes loader config, CBOR is only used if it was serialized together with 'text'
+//!
+//! 'binaryText' is the text pointer published next to the CBOR, an older interposer
+//! does not publish anything and a stale blob belongs to a different string.
+inline void parseLoaderConfig(const char* text, const char* binaryText, const uint8_t* data, size_t size, nlohmann::json& loader)
+{
+    if (binaryText && binaryText == text && data)
+    {
+        loader = nlohmann::json::from_cbor(data, data + size);
+        return;
+    }
+    std::istringstream stream(text);
+    stream >> loader;
+}
+
+}
+}
@@ -20,15 +20,15 @@
 * SOFTWARE.
 */
 
-#include <sstream>
-
 #include "source/core/sl.plugin/plugin.h"
 #include "source/core/sl.api/internal.h"
 #include "include/sl.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.extra/extra.h"
 #include "source/core/sl.param/parameters.h"
+#include "source/core/sl.plugin/loaderConfig.h"
 #include "external/json/include/nlohmann/json.hpp"
 #include <unordered_set>
 
@@ -63,6 +63,15 @@ ILog* getInterface()
 }
 }
 
+namespace profiler
+{
+IProfiler* s_profiler = {};
+IProfiler* getInterface()
+{
+    return s_profiler;
+}
+}
+
 #define ENABLE_DISALLOW_NEWER_PLUGINS_WAR 1
 
 namespace plugin
@@ -116,10 +125,27 @@ static bool isLoadingAllowed(const json& loader)
     return true;
 }
 
+//! Decodes loader JSON from the binary copy published by the plugin manager,
+//! falls back to parsing text when loaded by an older sl.interposer
+static void parseLoaderJSON(api::Context* ctx, const char* loaderJSON, json& loader)
+{
+    api::LoaderConfigBinary* binary{};
+    param::getPointerParam(ctx->parameters, param::global::kLoaderConfigBinary, &binary);
+    if (binary)
+    {
+        parseLoaderConfig(loaderJSON, binary->text, binary->data, binary->size, loader);
+    }
+    else
+    {
+        parseLoaderConfig(loaderJSON, nullptr, nullptr, 0, loader);
+    }
+}
+
 bool onLoad(api::Context* ctx, const char* loaderJSON, const char* embeddedJSON)
 {
     // Setup logging and callbacks so we can report any issues correctly
     param::getPointerParam(api::getContext()->parameters, param::global::kLogInterface, &log::s_log);
+    param::getPointerParam(api::getContext()->parameters, param::global::kProfilerInterface, &profiler::s_profiler);
 #ifndef SL_COMMON_PLUGIN
     param::getPointerParam(api::getContext()->parameters, param::common::kKeyboardAPI, &extra::keyboard::s_keyboard);
 #endif
@@ -129,10 +155,7 @@ bool onLoad(api::Context* ctx, const char* loaderJSON, const char* embeddedJSON)
     json& config = *(json*)ctx->pluginConfig;
     try
     {
-        {
-            std::istringstream stream(loaderJSON);
-            stream >> loader;
-        }
+        parseLoaderJSON(ctx, loaderJSON, loader);
 
         if (!isLoadingAllowed(loader))
         {
@@ -170,7 +193,7 @@ bool onLoad(api::Context* ctx, const char* loaderJSON, const char* embeddedJSON)
             if (file::exists(extraJSONFile.c_str()))
             {
                 SL_LOG_INFO("Found extra JSON config %S", extraJSONFile.c_str());
-                std::vector<uint8_t> jsonText = file::read(extraJSONFile.c_str());
+                file::MappedView jsonText(extraJSONFile.c_str());
                 if (!jsonText.empty())
                 {
                     json& extraConfig = *(json*)ctx->extConfig;
@@ -193,10 +216,7 @@ StartupResult onStartup(api::Context *ctx, const char* jsonConfig)
     {
         // Get information provided by host (plugin manager or installed plugin)
         json& config = *(json*)ctx->loaderConfig;
-
-        std::istringstream stream(jsonConfig);
-        stream >> config;
-
+        parseLoaderJSON(ctx, jsonConfig, config);
     }
     catch (std::exception &e)
     {
@@ -24,6 +24,7 @@
 
 #include "include/sl_version.h"
 #include "source/core/sl.api/internal.h"
+#include "source/core/sl.plugin/exportTable.h"
 
 #define SL_EXPORT extern "C" __declspec(dllexport)
 SL_EXPORT BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID);
@@ -216,12 +217,6 @@ struct IParameters;
 namespace plugin
 {
 
-#define SL_EXPORT_FUNCTION(fun)\
-if (!strcmp(functionName, #fun))\
-{\
-    return fun;\
-}
-
 enum StartupResult
 {
     eStartupResultOK,
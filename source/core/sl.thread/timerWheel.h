@@ -0,0 +1,483 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+#ifndef SL_WINDOWS
+#include <sys/resource.h>
+#endif
+
+#include "source/core/sl.log/log.h"
+
+namespace sl
+{
+namespace thread
+{
+
+//! Identifies a scheduled timer, zero is never a valid id
+using TimerId = uint64_t;
+constexpr TimerId kInvalidTimerId = 0;
+
+//! Time source used by the timer wheel
+//!
+//! Injectable so that timers can be driven deterministically
+//! by advancing a manual clock and calling TimerWheel::advance.
+struct ITimerClock
+{
+    virtual uint64_t getTimeMs() = 0;
+};
+
+struct SteadyTimerClock : ITimerClock
+{
+    virtual uint64_t getTimeMs() override final
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+struct ManualTimerClock : ITimerClock
+{
+    virtual uint64_t getTimeMs() override final { return m_timeMs.load(); }
+    void advance(uint64_t ms) { m_timeMs += ms; }
+    void set(uint64_t ms) { m_timeMs = ms; }
+
+    std::atomic<uint64_t> m_timeMs = {};
+};
+
+//! Hierarchical timer wheel for delayed and periodic jobs
+//!
+//! Four levels of 256 slots with 1ms resolution cover ~49 days.
+//! Timers live in a slab with intrusive slot lists so that
+//! schedule and cancel are O(1). Expired timers cascade down
+//! one level each time the level below wraps around.
+//!
+//! When constructed with a thread name all timers are serviced by
+//! a single thread which sleeps until the next expiry. Without a name
+//! the owner is responsible for calling 'advance'.
+//!
+//! Callbacks run on the servicing thread without any internal locks
+//! held so they are free to schedule or cancel other timers.
+class TimerWheel
+{
+    static constexpr uint32_t kLevelCount = 4;
+    static constexpr uint32_t kSlotBits = 8;
+    static constexpr uint32_t kSlotCount = 1 << kSlotBits;
+    static constexpr uint32_t kSlotMask = kSlotCount - 1;
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    struct Timer
+    {
+        std::function<void(void)> func;
+        uint64_t expiry = 0;
+        uint64_t periodMs = 0;
+        uint32_t prev = kInvalidIndex;
+        uint32_t next = kInvalidIndex;
+        uint32_t generation = 0;
+        uint32_t* head = nullptr;
+        bool active = false;
+    };
+
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::atomic<bool> m_quit = false;
+    bool m_wakeUp = false;
+
+    ITimerClock* m_clock{};
+    SteadyTimerClock m_steadyClock{};
+
+    //! Next tick to be processed
+    uint64_t m_tick = 0;
+    size_t m_timerCount = 0;
+
+    std::vector<Timer> m_timers{};
+    std::vector<uint32_t> m_free{};
+    std::array<std::array<uint32_t, kSlotCount>, kLevelCount> m_slots{};
+
+    std::thread m_thread;
+    std::wstring m_name;
+    int m_priority{};
+
+    static TimerId makeId(uint32_t index, uint32_t generation) { return ((uint64_t)generation << 32) | (uint64_t)(index + 1); }
+    static uint32_t getIndex(TimerId id) { return (uint32_t)(id & 0xffffffff) - 1; }
+    static uint32_t getGeneration(TimerId id) { return (uint32_t)(id >> 32); }
+
+    Timer* findTimer(TimerId id)
+    {
+        if (id == kInvalidTimerId) return nullptr;
+        auto index = getIndex(id);
+        if (index >= m_timers.size()) return nullptr;
+        auto& timer = m_timers[index];
+        if (!timer.active || timer.generation != getGeneration(id)) return nullptr;
+        return &timer;
+    }
+
+    void link(uint32_t index)
+    {
+        auto& timer = m_timers[index];
+        uint32_t* head{};
+        int64_t delta = (int64_t)(timer.expiry - m_tick);
+        if (delta < 0)
+        {
+            // Already expired, process on the next tick
+            head = &m_slots[0][m_tick & kSlotMask];
+        }
+        else
+        {
+            // Beyond the wheel range park the timer in the last slot it can reach,
+            // it keeps its real expiry and cascades again until it is due
+            auto target = std::min<uint64_t>(timer.expiry, m_tick + (1ull << (kSlotBits * kLevelCount)) - 1);
+            delta = (int64_t)(target - m_tick);
+            uint32_t level = 0;
+            while (level + 1 < kLevelCount && (uint64_t)delta >= (1ull << (kSlotBits * (level + 1))))
+            {
+                level++;
+            }
+            head = &m_slots[level][(target >> (kSlotBits * level)) & kSlotMask];
+        }
+        timer.head = head;
+        timer.prev = kInvalidIndex;
+        timer.next = *head;
+        if (*head != kInvalidIndex)
+        {
+            m_timers[*head].prev = index;
+        }
+        *head = index;
+    }
+
+    void unlink(uint32_t index)
+    {
+        auto& timer = m_timers[index];
+        if (timer.prev != kInvalidIndex)
+        {
+            m_timers[timer.prev].next = timer.next;
+        }
+        else
+        {
+            *timer.head = timer.next;
+        }
+        if (timer.next != kInvalidIndex)
+        {
+            m_timers[timer.next].prev = timer.prev;
+        }
+        timer.prev = timer.next = kInvalidIndex;
+        timer.head = nullptr;
+    }
+
+    void release(uint32_t index)
+    {
+        auto& timer = m_timers[index];
+        timer.active = false;
+        timer.func = {};
+        timer.generation++;
+        m_free.push_back(index);
+        m_timerCount--;
+    }
+
+    void cascade(uint32_t level, uint32_t slot)
+    {
+        auto index = m_slots[level][slot];
+        m_slots[level][slot] = kInvalidIndex;
+        while (index != kInvalidIndex)
+        {
+            auto next = m_timers[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+    //! Returns milliseconds until the earliest possible expiry, zero if there
+    //! is work due now and UINT64_MAX if there are no timers at all.
+    uint64_t getWaitTimeMs(uint64_t now)
+    {
+        if (!m_timerCount) return UINT64_MAX;
+        if (now >= m_tick) return 0;
+        for (uint32_t i = 0; i < kSlotCount; i++)
+        {
+            auto tick = m_tick + i;
+            if ((tick & kSlotMask) == 0)
+            {
+                // Higher levels cascade here, wake up to process them
+                return tick - now;
+            }
+            if (m_slots[0][tick & kSlotMask] != kInvalidIndex)
+            {
+                return tick > now ? tick - now : 0;
+            }
+        }
+        return m_tick + kSlotCount - now;
+    }
+
+    void timerFunction()
+    {
+#ifndef SL_WINDOWS
+        // THREAD_PRIORITY_* values map to nice levels, raising priority needs privileges
+        auto nice = std::clamp(-m_priority * 5, -20, 19);
+        if (nice && setpriority(PRIO_PROCESS, 0, nice) != 0)
+        {
+            SL_LOG_WARN("Failed to set thread priority to %d for thread '%S'", m_priority, m_name.c_str());
+        }
+#endif
+        while (!m_quit)
+        {
+            advance();
+            std::unique_lock<std::mutex> lock(m_mtx);
+            auto waitMs = getWaitTimeMs(m_clock->getTimeMs());
+            if (waitMs == 0) continue;
+            if (waitMs == UINT64_MAX)
+            {
+                m_cv.wait(lock, [this] { return m_wakeUp; });
+            }
+            else
+            {
+                m_cv.wait_for(lock, std::chrono::milliseconds(waitMs), [this] { return m_wakeUp; });
+            }
+            m_wakeUp = false;
+        }
+    }
+
+    void wakeUp()
+    {
+        if (m_thread.joinable())
+        {
+            m_wakeUp = true;
+            m_cv.notify_one();
+        }
+    }
+
+public:
+    TimerWheel(const TimerWheel&) = delete;
+
+    //! Timers are serviced by the caller via 'advance' if name is null
+    //!
+    //! Priority is a THREAD_PRIORITY_* value, on Linux it is applied as the nice level of the service thread.
+    TimerWheel(const wchar_t* name, int priority, ITimerClock* clock = nullptr) : m_priority(priority)
+    {
+        m_clock = clock ? clock : &m_steadyClock;
+        m_tick = m_clock->getTimeMs();
+        for (auto& level : m_slots)
+        {
+            level.fill(kInvalidIndex);
+        }
+        if (name)
+        {
+            m_name = name;
+            m_thread = std::thread(&TimerWheel::timerFunction, this);
+#ifdef SL_WINDOWS
+            if (!SetThreadPriority(m_thread.native_handle(), priority))
+            {
+                SL_LOG_WARN("Failed to set thread priority to %d for thread '%S'", priority, name);
+            }
+            SetThreadDescription(m_thread.native_handle(), name);
+#endif
+        }
+    }
+
+    ~TimerWheel()
+    {
+        if (m_thread.joinable())
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mtx);
+                m_quit = true;
+                m_wakeUp = true;
+            }
+            m_cv.notify_all();
+            m_thread.join();
+        }
+    }
+
+    //! Runs 'func' once after 'delayMs' milliseconds
+    TimerId scheduleOnce(uint64_t delayMs, const std::function<void(void)>& func)
+    {
+        return schedule(delayMs, 0, func);
+    }
+
+    //! Runs 'func' every 'periodMs' milliseconds, first time after 'delayMs'
+    //!
+    //! Period is measured from the scheduled expiry so jobs do not drift
+    //! but late timers are never fired more than once to catch up.
+    TimerId schedulePeriodic(uint64_t periodMs, const std::function<void(void)>& func, uint64_t delayMs = UINT64_MAX)
+    {
+        return schedule(delayMs == UINT64_MAX ? periodMs : delayMs, std::max<uint64_t>(periodMs, 1), func);
+    }
+
+    //! Returns false if timer already expired or was cancelled
+    //!
+    //! Once this returns the callback is not invoked again, including periodic
+    //! timers which already expired in the batch being serviced. A callback
+    //! which is running at the time of the call is not waited for.
+    bool cancel(TimerId id)
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        auto timer = findTimer(id);
+        if (!timer) return false;
+        auto index = getIndex(id);
+        // Timer could be currently executing in which case it is not linked
+        if (timer->head)
+        {
+            unlink(index);
+        }
+        release(index);
+        return true;
+    }
+
+    size_t getTimerCount()
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        return m_timerCount;
+    }
+
+    //! Fires all timers which expired up to the current clock time
+    //!
+    //! Returns number of executed callbacks.
+    uint32_t advance()
+    {
+        uint32_t executed = 0;
+        std::unique_lock<std::mutex> lock(m_mtx);
+        auto now = m_clock->getTimeMs();
+        if (!m_timerCount && now >= m_tick)
+        {
+            // Nothing to process, skip idle ticks
+            m_tick = now + 1;
+            return 0;
+        }
+        std::vector<Expired> expired;
+        while (m_tick <= now)
+        {
+            // Cascade higher levels when the level below wraps around
+            for (uint32_t level = 1; level < kLevelCount; level++)
+            {
+                if ((m_tick >> (kSlotBits * (level - 1))) & kSlotMask) break;
+                cascade(level, (m_tick >> (kSlotBits * level)) & kSlotMask);
+            }
+
+            auto& head = m_slots[0][m_tick & kSlotMask];
+            while (head != kInvalidIndex)
+            {
+                auto index = head;
+                auto& timer = m_timers[index];
+                unlink(index);
+                auto id = makeId(index, timer.generation);
+                if (timer.periodMs)
+                {
+                    expired.push_back({ id, timer.func, true });
+                    // Re-arm relative to the previous expiry, periods missed while late are skipped
+                    timer.expiry += timer.periodMs;
+                    if (timer.expiry <= now)
+                    {
+                        timer.expiry += ((now - timer.expiry) / timer.periodMs + 1) * timer.periodMs;
+                    }
+                    link(index);
+                }
+                else
+                {
+                    expired.push_back({ id, std::move(timer.func), false });
+                    release(index);
+                }
+            }
+            m_tick++;
+
+            if (!m_timerCount)
+            {
+                m_tick = now + 1;
+                break;
+            }
+
+            // Flush in batches so callbacks see up to date state
+            executed += execute(expired, lock);
+        }
+        return executed + execute(expired, lock);
+    }
+
+private:
+
+    struct Expired
+    {
+        TimerId id;
+        std::function<void(void)> func;
+        bool periodic;
+    };
+
+    //! Runs callbacks without the lock held, periodic ones are skipped if cancelled since they expired
+    uint32_t execute(std::vector<Expired>& expired, std::unique_lock<std::mutex>& lock)
+    {
+        uint32_t executed = 0;
+        for (auto& timer : expired)
+        {
+            if (timer.periodic && !findTimer(timer.id))
+            {
+                continue;
+            }
+            lock.unlock();
+            timer.func();
+            executed++;
+            lock.lock();
+        }
+        expired.clear();
+        return executed;
+    }
+
+    TimerId schedule(uint64_t delayMs, uint64_t periodMs, const std::function<void(void)>& func)
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        uint32_t index;
+        if (!m_free.empty())
+        {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            index = (uint32_t)m_timers.size();
+            m_timers.push_back({});
+        }
+        auto& timer = m_timers[index];
+        timer.func = func;
+        timer.periodMs = periodMs;
+        timer.active = true;
+        // Catch up with the clock first in case wheel has been idle
+        auto now = m_clock->getTimeMs();
+        if (!m_timerCount && now >= m_tick)
+        {
+            m_tick = now + 1;
+        }
+        timer.expiry = now + std::max<uint64_t>(delayMs, 1);
+        link(index);
+        m_timerCount++;
+        wakeUp();
+        return makeId(index, timer.generation);
+    }
+};
+
+}
+}
@@ -0,0 +1,446 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "source/platforms/sl.chi/compute.h"
+
+namespace sl
+{
+namespace chi
+{
+
+enum class CommandOp : uint16_t
+{
+    eBindSharedState,
+    eBindKernel,
+    eBindSampler,
+    eBindConsts,
+    eBindTexture,
+    eBindRWTexture,
+    eBindRawBuffer,
+    eDispatch,
+    eTransition,
+    eUAVBarrier,
+    eCopyResource,
+    eCount
+};
+
+//! Every command starts with a header, 'size' includes the header and any
+//! inline payload and is always a multiple of 8 so commands stay aligned
+struct CommandHeader
+{
+    CommandOp op{};
+    uint16_t reserved{};
+    uint32_t size{};
+};
+
+struct CmdBindSharedState { uint32_t node; };
+struct CmdBindKernel { Kernel kernel; };
+struct CmdBindSampler { uint32_t binding; uint32_t reg; Sampler sampler; };
+//! Followed by 'dataSize' bytes of constants
+struct CmdBindConsts { uint32_t binding; uint32_t reg; uint32_t instances; uint32_t dataSize; };
+struct CmdBindTexture { uint32_t binding; uint32_t reg; Resource resource; uint32_t mipOffset; uint32_t mipLevels; };
+struct CmdBindRWTexture { uint32_t binding; uint32_t reg; Resource resource; uint32_t mipOffset; };
+struct CmdBindRawBuffer { uint32_t binding; uint32_t reg; Resource resource; };
+struct CmdDispatch { uint32_t blockX; uint32_t blockY; uint32_t blockZ; };
+//! Followed by 'count' transitions, padded so the array is 8 byte aligned
+struct CmdTransition { uint32_t count; uint32_t reserved; };
+//! Followed by 'count' resources
+struct CmdUAVBarrier { uint32_t count; uint32_t reserved; };
+struct CmdCopyResource { Resource dst; Resource src; };
+
+//! Receives decoded commands, implemented by translators
+class ICommandVisitor
+{
+public:
+    virtual ComputeStatus bindSharedState(const CmdBindSharedState& cmd) = 0;
+    virtual ComputeStatus bindKernel(const CmdBindKernel& cmd) = 0;
+    virtual ComputeStatus bindSampler(const CmdBindSampler& cmd) = 0;
+    virtual ComputeStatus bindConsts(const CmdBindConsts& cmd, const void* data) = 0;
+    virtual ComputeStatus bindTexture(const CmdBindTexture& cmd) = 0;
+    virtual ComputeStatus bindRWTexture(const CmdBindRWTexture& cmd) = 0;
+    virtual ComputeStatus bindRawBuffer(const CmdBindRawBuffer& cmd) = 0;
+    virtual ComputeStatus dispatch(const CmdDispatch& cmd) = 0;
+    virtual ComputeStatus transitionResources(const ResourceTransition* transitions, uint32_t count) = 0;
+    virtual ComputeStatus insertUAVBarriers(const Resource* resources, uint32_t count) = 0;
+    virtual ComputeStatus copyResource(const CmdCopyResource& cmd) = 0;
+};
+
+//! Backend-neutral recording of chi compute work
+//!
+//! Plugins record the same calls they would make on ICompute into a linear
+//! buffer, translation into native commands happens later on whichever
+//! thread owns the target command list. A recorded stream is immutable and
+//! can be translated any number of times.
+//!
+//! Recording drops redundant work:
+//!
+//! - binding the kernel which is already bound
+//! - binding the same sampler or resource to a slot which already has it
+//! - transitions of a resource to the state it is already in, consecutive
+//!   transitions of the same subresource are folded into one
+//!
+//! Slot tracking starts over with every bound kernel or shared state since
+//! backends keep bindings per kernel. Constants are never skipped because
+//! each bind advances the backend's constant buffer instance.
+//!
+//! Resources and kernels are stored as handles so a stream is only valid
+//! within the process and while the recorded objects are alive.
+class CommandStream
+{
+    struct SlotBinding
+    {
+        CommandOp op{};
+        uint32_t binding{};
+        uint32_t reg{};
+        uint64_t value{};
+        uint32_t extra[2]{};
+    };
+
+    std::vector<uint64_t> m_data;
+    size_t m_size{};
+    //! Offset of the last transition command if nothing was recorded after it
+    size_t m_openTransition = SIZE_MAX;
+    Kernel m_kernel{};
+    std::vector<SlotBinding> m_slots;
+    uint32_t m_commandCount{};
+    uint32_t m_skippedCount{};
+
+    static inline uint32_t align8(size_t size) { return uint32_t((size + 7) & ~size_t(7)); }
+
+    uint8_t* bytes() { return (uint8_t*)m_data.data(); }
+
+    template<typename T>
+    T* append(CommandOp op, size_t extraSize = 0)
+    {
+        auto size = align8(sizeof(CommandHeader) + sizeof(T) + extraSize);
+        auto offset = m_size;
+        m_size += size;
+        if (m_data.size() * sizeof(uint64_t) < m_size)
+        {
+            m_data.resize(std::max(m_data.size() * 2, m_size / sizeof(uint64_t)));
+        }
+        auto header = (CommandHeader*)(bytes() + offset);
+        *header = { op, 0, size };
+        m_openTransition = SIZE_MAX;
+        m_commandCount++;
+        return (T*)(header + 1);
+    }
+
+    //! Returns true if the slot already holds the same binding, updates it otherwise
+    bool isBound(CommandOp op, uint32_t binding, uint32_t reg, uint64_t value, uint32_t extra0 = 0, uint32_t extra1 = 0)
+    {
+        for (auto& slot : m_slots)
+        {
+            if (slot.op == op && slot.binding == binding && slot.reg == reg)
+            {
+                if (slot.value == value && slot.extra[0] == extra0 && slot.extra[1] == extra1)
+                {
+                    m_skippedCount++;
+                    return true;
+                }
+                slot.value = value;
+                slot.extra[0] = extra0;
+                slot.extra[1] = extra1;
+                return false;
+            }
+        }
+        m_slots.push_back({ op, binding, reg, value, { extra0, extra1 } });
+        return false;
+    }
+
+    bool foldTransition(const ResourceTransition& transition)
+    {
+        auto cmd = (CmdTransition*)(bytes() + m_openTransition + sizeof(CommandHeader));
+        auto existing = (ResourceTransition*)(cmd + 1);
+        for (uint32_t i = 0; i < cmd->count; i++)
+        {
+            if (existing[i].resource == transition.resource && existing[i].subresource == transition.subresource)
+            {
+                existing[i].to = transition.to;
+                m_skippedCount++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    //! Drops all commands, capacity is kept so steady state recording does not allocate
+    void reset()
+    {
+        m_size = 0;
+        m_openTransition = SIZE_MAX;
+        m_kernel = {};
+        m_slots.clear();
+        m_commandCount = 0;
+        m_skippedCount = 0;
+    }
+
+    inline const void* getData() const { return m_data.data(); }
+    inline size_t getSize() const { return m_size; }
+    inline uint32_t getCommandCount() const { return m_commandCount; }
+    //! Number of recorded calls which were redundant
+    inline uint32_t getSkippedCount() const { return m_skippedCount; }
+
+    void bindSharedState(uint32_t node = 0)
+    {
+        append<CmdBindSharedState>(CommandOp::eBindSharedState)->node = node;
+        m_kernel = {};
+        m_slots.clear();
+    }
+
+    void bindKernel(Kernel kernel)
+    {
+        if (kernel == m_kernel)
+        {
+            m_skippedCount++;
+            return;
+        }
+        append<CmdBindKernel>(CommandOp::eBindKernel)->kernel = kernel;
+        m_kernel = kernel;
+        m_slots.clear();
+    }
+
+    void bindSampler(uint32_t binding, uint32_t reg, Sampler sampler)
+    {
+        if (isBound(CommandOp::eBindSampler, binding, reg, (uint64_t)sampler)) return;
+        *append<CmdBindSampler>(CommandOp::eBindSampler) = { binding, reg, sampler };
+    }
+
+    void bindConsts(uint32_t binding, uint32_t reg, const void* data, size_t dataSize, uint32_t instances)
+    {
+        auto cmd = append<CmdBindConsts>(CommandOp::eBindConsts, dataSize);
+        *cmd = { binding, reg, instances, (uint32_t)dataSize };
+        memcpy(cmd + 1, data, dataSize);
+    }
+
+    void bindTexture(uint32_t binding, uint32_t reg, Resource resource, uint32_t mipOffset = 0, uint32_t mipLevels = 0)
+    {
+        if (isBound(CommandOp::eBindTexture, binding, reg, (uint64_t)resource, mipOffset, mipLevels)) return;
+        *append<CmdBindTexture>(CommandOp::eBindTexture) = { binding, reg, resource, mipOffset, mipLevels };
+    }
+
+    void bindRWTexture(uint32_t binding, uint32_t reg, Resource resource, uint32_t mipOffset = 0)
+    {
+        if (isBound(CommandOp::eBindRWTexture, binding, reg, (uint64_t)resource, mipOffset)) return;
+        *append<CmdBindRWTexture>(CommandOp::eBindRWTexture) = { binding, reg, resource, mipOffset };
+    }
+
+    void bindRawBuffer(uint32_t binding, uint32_t reg, Resource resource)
+    {
+        if (isBound(CommandOp::eBindRawBuffer, binding, reg, (uint64_t)resource)) return;
+        *append<CmdBindRawBuffer>(CommandOp::eBindRawBuffer) = { binding, reg, resource };
+    }
+
+    void dispatch(uint32_t blockX, uint32_t blockY, uint32_t blockZ = 1)
+    {
+        *append<CmdDispatch>(CommandOp::eDispatch) = { blockX, blockY, blockZ };
+    }
+
+    void transitionResources(const ResourceTransition* transitions, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            auto& transition = transitions[i];
+            if (transition.from != ResourceState::eUnknown && transition.from == transition.to)
+            {
+                m_skippedCount++;
+                continue;
+            }
+            if (m_openTransition != SIZE_MAX && foldTransition(transition))
+            {
+                continue;
+            }
+            if (m_openTransition == SIZE_MAX)
+            {
+                auto offset = m_size;
+                *append<CmdTransition>(CommandOp::eTransition) = {};
+                m_openTransition = offset;
+            }
+            // Grow the open command in place, it is always the last one in the stream
+            auto header = (CommandHeader*)(bytes() + m_openTransition);
+            auto cmd = (CmdTransition*)(header + 1);
+            auto used = sizeof(CommandHeader) + sizeof(CmdTransition) + cmd->count * sizeof(ResourceTransition);
+            auto size = align8(used + sizeof(ResourceTransition));
+            m_size = m_openTransition + size;
+            if (m_data.size() * sizeof(uint64_t) < m_size)
+            {
+                m_data.resize(std::max(m_data.size() * 2, m_size / sizeof(uint64_t)));
+                header = (CommandHeader*)(bytes() + m_openTransition);
+                cmd = (CmdTransition*)(header + 1);
+            }
+            header->size = size;
+            memcpy((uint8_t*)header + used, &transition, sizeof(ResourceTransition));
+            cmd->count++;
+        }
+    }
+
+    void insertUAVBarriers(const Resource* resources, uint32_t count)
+    {
+        auto cmd = append<CmdUAVBarrier>(CommandOp::eUAVBarrier, count * sizeof(Resource));
+        *cmd = { count, 0 };
+        memcpy(cmd + 1, resources, count * sizeof(Resource));
+    }
+
+    void copyResource(Resource dst, Resource src)
+    {
+        *append<CmdCopyResource>(CommandOp::eCopyResource) = { dst, src };
+    }
+
+    //! Decodes 'size' bytes of commands, stops at the first malformed command or visitor error
+    static ComputeStatus decode(const void* data, size_t size, ICommandVisitor& visitor)
+    {
+        auto p = (const uint8_t*)data;
+        size_t offset = 0;
+        while (offset < size)
+        {
+            if (size - offset < sizeof(CommandHeader))
+            {
+                return ComputeStatus::eInvalidArgument;
+            }
+            auto header = (const CommandHeader*)(p + offset);
+            if (header->size < sizeof(CommandHeader) || header->size > size - offset || (header->size & 7))
+            {
+                return ComputeStatus::eInvalidArgument;
+            }
+            auto payload = (const uint8_t*)(header + 1);
+            size_t payloadSize = header->size - sizeof(CommandHeader);
+            ComputeStatus status = ComputeStatus::eInvalidArgument;
+
+#define SL_CMD_PAYLOAD(T) if (payloadSize < sizeof(T)) return ComputeStatus::eInvalidArgument; auto& cmd = *(const T*)payload;
+            switch (header->op)
+            {
+                case CommandOp::eBindSharedState: { SL_CMD_PAYLOAD(CmdBindSharedState); status = visitor.bindSharedState(cmd); break; }
+                case CommandOp::eBindKernel: { SL_CMD_PAYLOAD(CmdBindKernel); status = visitor.bindKernel(cmd); break; }
+                case CommandOp::eBindSampler: { SL_CMD_PAYLOAD(CmdBindSampler); status = visitor.bindSampler(cmd); break; }
+                case CommandOp::eBindConsts:
+                {
+                    SL_CMD_PAYLOAD(CmdBindConsts);
+                    if (payloadSize - sizeof(cmd) < cmd.dataSize) return ComputeStatus::eInvalidArgument;
+                    status = visitor.bindConsts(cmd, &cmd + 1);
+                    break;
+                }
+                case CommandOp::eBindTexture: { SL_CMD_PAYLOAD(CmdBindTexture); status = visitor.bindTexture(cmd); break; }
+                case CommandOp::eBindRWTexture: { SL_CMD_PAYLOAD(CmdBindRWTexture); status = visitor.bindRWTexture(cmd); break; }
+                case CommandOp::eBindRawBuffer: { SL_CMD_PAYLOAD(CmdBindRawBuffer); status = visitor.bindRawBuffer(cmd); break; }
+                case CommandOp::eDispatch: { SL_CMD_PAYLOAD(CmdDispatch); status = visitor.dispatch(cmd); break; }
+                case CommandOp::eTransition:
+                {
+                    SL_CMD_PAYLOAD(CmdTransition);
+                    if ((payloadSize - sizeof(cmd)) / sizeof(ResourceTransition) < cmd.count) return ComputeStatus::eInvalidArgument;
+                    status = visitor.transitionResources((const ResourceTransition*)(&cmd + 1), cmd.count);
+                    break;
+                }
+                case CommandOp::eUAVBarrier:
+                {
+                    SL_CMD_PAYLOAD(CmdUAVBarrier);
+                    if ((payloadSize - sizeof(cmd)) / sizeof(Resource) < cmd.count) return ComputeStatus::eInvalidArgument;
+                    status = visitor.insertUAVBarriers((const Resource*)(&cmd + 1), cmd.count);
+                    break;
+                }
+                case CommandOp::eCopyResource: { SL_CMD_PAYLOAD(CmdCopyResource); status = visitor.copyResource(cmd); break; }
+                default: return ComputeStatus::eInvalidArgument;
+            }
+#undef SL_CMD_PAYLOAD
+
+            if (status != ComputeStatus::eOk)
+            {
+                return status;
+            }
+            offset += header->size;
+        }
+        return ComputeStatus::eOk;
+    }
+
+    inline ComputeStatus decode(ICommandVisitor& visitor) const
+    {
+        return decode(m_data.data(), m_size, visitor);
+    }
+};
+
+//! Translates a stream into native commands through ICompute
+//!
+//! Must run on the thread which records into 'cmdList', chi keeps its
+//! binding state per thread so several streams can be translated in parallel.
+class ComputeCommandTranslator : public ICommandVisitor
+{
+    ICompute* m_compute{};
+    CommandList m_cmdList{};
+
+public:
+    ComputeCommandTranslator(ICompute* compute, CommandList cmdList) : m_compute(compute), m_cmdList(cmdList) {}
+
+    virtual ComputeStatus bindSharedState(const CmdBindSharedState& cmd) override { return m_compute->bindSharedState(m_cmdList, cmd.node); }
+    virtual ComputeStatus bindKernel(const CmdBindKernel& cmd) override { return m_compute->bindKernel(cmd.kernel); }
+    virtual ComputeStatus bindSampler(const CmdBindSampler& cmd) override { return m_compute->bindSampler(cmd.binding, cmd.reg, cmd.sampler); }
+    virtual ComputeStatus bindConsts(const CmdBindConsts& cmd, const void* data) override { return m_compute->bindConsts(cmd.binding, cmd.reg, (void*)data, cmd.dataSize, cmd.instances); }
+    virtual ComputeStatus bindTexture(const CmdBindTexture& cmd) override { return m_compute->bindTexture(cmd.binding, cmd.reg, cmd.resource, cmd.mipOffset, cmd.mipLevels); }
+    virtual ComputeStatus bindRWTexture(const CmdBindRWTexture& cmd) override { return m_compute->bindRWTexture(cmd.binding, cmd.reg, cmd.resource, cmd.mipOffset); }
+    virtual ComputeStatus bindRawBuffer(const CmdBindRawBuffer& cmd) override { return m_compute->bindRawBuffer(cmd.binding, cmd.reg, cmd.resource); }
+    virtual ComputeStatus dispatch(const CmdDispatch& cmd) override { return m_compute->dispatch(cmd.blockX, cmd.blockY, cmd.blockZ); }
+    virtual ComputeStatus transitionResources(const ResourceTransition* transitions, uint32_t count) override { return m_compute->transitionResources(m_cmdList, transitions, count); }
+    virtual ComputeStatus insertUAVBarriers(const Resource* resources, uint32_t count) override { return m_compute->insertGPUBarrierList(m_cmdList, resources, count); }
+    virtual ComputeStatus copyResource(const CmdCopyResource& cmd) override { return m_compute->copyResource(m_cmdList, cmd.dst, cmd.src); }
+};
+
+//! Validates and counts commands without touching any device
+class NullCommandTranslator : public ICommandVisitor
+{
+public:
+    uint32_t counts[(uint32_t)CommandOp::eCount]{};
+    uint32_t transitionCount{};
+    Kernel kernel{};
+
+    virtual ComputeStatus bindSharedState(const CmdBindSharedState&) override { counts[(uint32_t)CommandOp::eBindSharedState]++; return ComputeStatus::eOk; }
+    virtual ComputeStatus bindKernel(const CmdBindKernel& cmd) override { counts[(uint32_t)CommandOp::eBindKernel]++; kernel = cmd.kernel; return ComputeStatus::eOk; }
+    virtual ComputeStatus bindSampler(const CmdBindSampler&) override { return bound(CommandOp::eBindSampler); }
+    virtual ComputeStatus bindConsts(const CmdBindConsts&, const void*) override { return bound(CommandOp::eBindConsts); }
+    virtual ComputeStatus bindTexture(const CmdBindTexture&) override { return bound(CommandOp::eBindTexture); }
+    virtual ComputeStatus bindRWTexture(const CmdBindRWTexture&) override { return bound(CommandOp::eBindRWTexture); }
+    virtual ComputeStatus bindRawBuffer(const CmdBindRawBuffer&) override { return bound(CommandOp::eBindRawBuffer); }
+    virtual ComputeStatus dispatch(const CmdDispatch&) override { return bound(CommandOp::eDispatch); }
+    virtual ComputeStatus transitionResources(const ResourceTransition*, uint32_t count) override
+    {
+        counts[(uint32_t)CommandOp::eTransition]++;
+        transitionCount += count;
+        return ComputeStatus::eOk;
+    }
+    virtual ComputeStatus insertUAVBarriers(const Resource*, uint32_t) override { counts[(uint32_t)CommandOp::eUAVBarrier]++; return ComputeStatus::eOk; }
+    virtual ComputeStatus copyResource(const CmdCopyResource&) override { counts[(uint32_t)CommandOp::eCopyResource]++; return ComputeStatus::eOk; }
+
+private:
+    //! Same rule as the backends, bindings and dispatches need a kernel
+    ComputeStatus bound(CommandOp op)
+    {
+        counts[(uint32_t)op]++;
+        return kernel ? ComputeStatus::eOk : ComputeStatus::eInvalidCall;
+    }
+};
+
+}
+}
@@ -392,6 +392,15 @@ struct DebugInfo
     uint32_t m_uLine = 0;
 };
 
+struct VRAMSegmentInfo
+{
+    std::string name;
+    uint64_t allocCount{};
+    uint64_t currentBytes{};
+    //! Highest 'currentBytes' reached since the segment was created or chi was shut down
+    uint64_t peakBytes{};
+};
+
 struct ICommandListContext
 {
     virtual RenderAPI getType() = 0;
@@ -425,6 +434,12 @@ struct ICommandListContext
     virtual void getLastPresentID(SwapChain chain, uint32_t& id) = 0;
     virtual void waitForVblank(SwapChain chain) = 0;
     virtual void monitoringThreadTick() { assert(false); }
+
+    // Shared with plugins, new members go at the end
+    //! Waits until all (or any) of the values are reached, 'timeoutMs' covers the whole batch
+    virtual WaitStatus waitCPUFences(const Fence* fences, const uint64_t* syncValues, uint32_t count, bool waitAll, uint32_t timeoutMs) = 0;
+    //! Answered from the fence timeline shared by all queues, driver is only queried while the cached value is behind
+    virtual bool isFenceValueCompleted(Fence fence, uint64_t syncValue) = 0;
 };
 
 // HashedResource uses std::shared_ptr<> to keep track of references to the underlying
@@ -490,6 +505,21 @@ struct IResourcePool
     virtual void recycle(HashedResource res) = 0;
     virtual void clear() = 0;
     virtual void collectGarbage(float deltaMs = 10000.0f) = 0;
+
+    //! Transient resources live between two use points (passes) within a frame
+    //!
+    //! Declarations with identical descriptions and disjoint [firstUse, lastUse] ranges
+    //! share one resource. 'source' is only used as a template and must stay valid until
+    //! 'compileTransients'. Resources are valid from 'compileTransients' until 'resetTransients'
+    //! and must only be accessed on one queue between their use points. They are owned by
+    //! the pool, passing one to 'recycle' does nothing.
+    virtual uint32_t declareTransient(Resource source, uint32_t firstUse, uint32_t lastUse, const char* debugName, ResourceState initialState = ResourceState::eCopyDestination) = 0;
+    virtual bool compileTransients() = 0;
+    virtual HashedResource getTransient(uint32_t handle) = 0;
+    //! Drops declarations, resources are kept for the next frame until garbage collected
+    virtual void resetTransients() = 0;
+    //! Shortens the lifetime of a transient declared with an unknown last use, takes effect on the next 'compileTransients'
+    virtual void endTransient(uint32_t handle, uint32_t lastUse) = 0;
 };
 
 // Common functions
@@ -624,10 +654,8 @@ public:
     //! Root signatures, constant updates, pipeline states etc. are all
     //! managed automatically for convenience.
     //!
-    //! IMPORTANT: Constants are stored in a circular buffer of 'instances' size 
-    //! so make sure to allocate enough space to avoid cpu/gpu race conditions.
-    //! 
-    //! Easiest approach is to use triple-buffering so num_dispatch_calls_per_frame * 3 (or in other words num_viewports * 3)
+    //! Constants are copied to per-frame upload memory on each bind and stay valid until the GPU is done with them.
+    //! 'instances' is no longer used and kept so existing callers compile.
     //!
     virtual ComputeStatus bindSharedState(CommandList cmdList, uint32_t node = 0) = 0;
     virtual ComputeStatus bindKernel(const Kernel kernel) = 0;
@@ -709,12 +737,51 @@ public:
 
     // check if an extension is available, vulkan only
     virtual ComputeStatus isDeviceExtensionSupported(const char* extension, uint32_t version) = 0;
+
+    // Interface is shared with plugins, new members go at the end
+
+    // Transition batching
+    //! Transitions requested on this thread until the matching 'endTransitionBatch' are coalesced and
+    //! recorded as one barrier batch, pending ones are flushed before any chi dispatch, copy, clear or barrier.
+    //!
+    //! NOTE: Batch must be ended before recording any work on 'cmdList' outside of chi (NGX evaluate etc.)
+    virtual ComputeStatus beginTransitionBatch(CommandList cmdList) = 0;
+    virtual ComputeStatus endTransitionBatch(CommandList cmdList) = 0;
+
+    // VRAM segments
+    //! Usage of every segment seen so far, global one is always first
+    virtual ComputeStatus getVRAMSegments(std::vector<VRAMSegmentInfo>& segments) = 0;
 };
 
 ICompute* getD3D11();
 ICompute *getD3D12();
 ICompute *getVulkan();
 
+//! Keeps a transition batch open for the lifetime of the scope
+struct ScopedTransitionBatch
+{
+    ScopedTransitionBatch(ICompute* compute, CommandList cmdList) : m_compute(compute), m_cmdList(cmdList)
+    {
+        if (m_compute && m_compute->beginTransitionBatch(m_cmdList) != ComputeStatus::eOk)
+        {
+            m_compute = {};
+        }
+    }
+    ~ScopedTransitionBatch()
+    {
+        if (m_compute)
+        {
+            m_compute->endTransitionBatch(m_cmdList);
+        }
+    }
+    ScopedTransitionBatch(const ScopedTransitionBatch&) = delete;
+    ScopedTransitionBatch& operator=(const ScopedTransitionBatch&) = delete;
+
+private:
+    ICompute* m_compute{};
+    CommandList m_cmdList{};
+};
+
 inline HashedResourceData::HashedResourceData(sl::Resource *pResource, ICompute* pCompute, bool bOwnResource) :
     resource(pResource),
     m_pCompute(pCompute),
@@ -100,6 +100,20 @@ struct D3D11CommandListContext : public ICommandListContext
         return WaitStatus::eError;
     }
 
+    WaitStatus waitCPUFences(const Fence* fences, const uint64_t* syncValues, uint32_t count, bool waitAll, uint32_t timeoutMs) override
+    {
+        assert(false);
+        SL_LOG_ERROR("Not implemented");
+        return WaitStatus::eError;
+    }
+
+    bool isFenceValueCompleted(Fence fence, uint64_t syncValue) override
+    {
+        assert(false);
+        SL_LOG_ERROR("Not implemented");
+        return false;
+    }
+
     void waitGPUFence(Fence fence, uint64_t syncValue, const DebugInfo &debugInfo) override
     {
         if (FAILED(m_cmdCtxImmediate->Wait((ID3D11Fence*)fence, syncValue)))
@@ -542,22 +556,8 @@ ComputeStatus D3D11::createKernel(void *blobData, unsigned int blobSize, const c
         return ComputeStatus::eInvalidArgument;
     }
 
-    size_t hash = 0;
-    const char* p = fileName;
-    while (*p)
-    {
-        hash_combine(hash, *p++);
-    }
-    p = entryPoint;
-    while (*p)
-    {
-        hash_combine(hash, *p++);
-    }
-    auto i = blobSize;
-    while (i--)
-    {
-        hash_combine(hash, ((char*)blobData)[i]);
-    }
+    Hash128 blobHash;
+    size_t hash = getKernelHash(blobData, blobSize, fileName, entryPoint, blobHash);
 
     ComputeStatus Res = ComputeStatus::eOk;
     KernelDataD3D11 *data = {};
@@ -584,9 +584,8 @@ ComputeStatus D3D11::createKernel(void *blobData, unsigned int blobSize, const c
         const char* blob = (const char*)blobData;
         if (blob[0] == 'D' && blob[1] == 'X' && blob[2] == 'B' && blob[3] == 'C')
         {
-            data->kernelBlob.resize(blobSize);
-            memcpy(data->kernelBlob.data(), blob, blobSize);
-            if (FAILED(m_device->CreateComputeShader(data->kernelBlob.data(), data->kernelBlob.size(), nullptr, &data->shader)))
+            setKernelBlob(data, blob, blobSize, blobHash);
+            if (FAILED(m_device->CreateComputeShader(data->getBlob(), data->getBlobSize(), nullptr, &data->shader)))
             {
                 SL_LOG_ERROR( "Failed to create shader %s:%s", fileName, entryPoint);
                 return ComputeStatus::eError;
@@ -1838,10 +1837,12 @@ ComputeStatus D3D11::getResourceFromSharedHandle(ResourceType type, Handle handl
 
 ComputeStatus D3D11::prepareTranslatedResources(CommandList cmdList, const std::vector<std::pair<chi::TranslatedResource, chi::ResourceDescription>>& resourceList)
 {
-    // Running on D3D11 immediate context and using D3D11 resources
-    CHI_CHECK(pushState(cmdList));
-    CHI_CHECK(bindSharedState(cmdList, 0));
-    CHI_CHECK(bindKernel(m_copyKernel));
+    // Running on D3D11 immediate context and using D3D11 resources, like the context itself
+    // this is never used by more than one thread at a time
+    m_copyStream.reset();
+    m_copyStream.bindSharedState(0);
+    m_copyStream.bindKernel(m_copyKernel);
+    uint32_t copyCount = 0;
     for (auto& [resource, desc] : resourceList)
     {
         // If shared directly nothing to do here!
@@ -1866,14 +1867,23 @@ ComputeStatus D3D11::prepareTranslatedResources(CommandList cmdList, const std::
         cb.texSize.y = (float)desc.height;
         cb.texSize.z = 1.0f / cb.texSize.x;
         cb.texSize.w = 1.0f / cb.texSize.y;
-        CHI_CHECK(bindConsts(0, 0, &cb, sizeof(CopyCB), 1)); // unlike vk/d3d12 on d3d11 there is just one buffer, driver takes care of updates
-        CHI_CHECK(bindTexture(1, 0, resource.source));
-        CHI_CHECK(bindRWTexture(2, 0, resource.clone)); // this is shared as d3d12 resource
+        m_copyStream.bindConsts(0, 0, &cb, sizeof(CopyCB), 1); // unlike vk/d3d12 on d3d11 there is just one buffer, driver takes care of updates
+        m_copyStream.bindTexture(1, 0, resource.source);
+        m_copyStream.bindRWTexture(2, 0, resource.clone); // this is shared as d3d12 resource
         uint32_t grid[] = { ((uint32_t)cb.texSize.x + 16 - 1) / 16, ((uint32_t)cb.texSize.y + 16 - 1) / 16, 1 };
-        CHI_CHECK(dispatch(grid[0], grid[1], grid[2]));
+        m_copyStream.dispatch(grid[0], grid[1], grid[2]);
+        copyCount++;
+    }
+    if (!copyCount)
+    {
+        // Everything is shared directly, no need to touch the host state
+        return ComputeStatus::eOk;
     }
+    CHI_CHECK(pushState(cmdList));
+    ComputeCommandTranslator translator(this, cmdList);
+    auto status = m_copyStream.decode(translator);
     CHI_CHECK(popState(cmdList));
-    return ComputeStatus::eOk;
+    return status;
 }
 
 }
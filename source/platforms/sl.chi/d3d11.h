@@ -27,6 +27,7 @@
 
 #include "source/core/sl.thread/thread.h"
 #include "source/platforms/sl.chi/generic.h"
+#include "source/platforms/sl.chi/commandStream.h"
 #include "source/core/sl.extra/extra.h"
 
 namespace sl
@@ -85,6 +86,8 @@ class D3D11 : public Generic
     ID3D11Device5* m_device5 = nullptr;
 
     chi::Kernel m_copyKernel{};
+    //! Copies for translated resources, recorded and then replayed on the immediate context
+    CommandStream m_copyStream;
 
     bool m_dbgSupportRs2RelaxedConversionRules = false;
 
@@ -28,6 +28,7 @@
 #include <wrl/client.h>
 
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/core/sl.interposer/d3d12/d3d12.h"
 #include "source/platforms/sl.chi/d3d12.h"
 #include "shaders/copy_to_buffer_cs.h"
@@ -325,20 +326,10 @@ class CommandListContext : public ICommandListContext
         }
         ID3D12Fence* fence{};
         uint64_t syncValue{};
-        void updateCompletedFenceValue()
-        {
-            uint64_t value = fence->GetCompletedValue();
-            if (value == -1)
-            {
-                SL_LOG_ERROR("We've lost the Device.");
-                return;
-            }
-            m_completedValue = value;
-        }
-        uint64_t m_completedValue = 0;
         DebugInfo m_debugInfo;
     };
     std::vector<WaitingContext> m_waitingQueue;
+    std::shared_ptr<FenceTimeline> m_timeline;
 
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_cmdQueue;
     ID3D12GraphicsCommandList* m_cmdList{};
@@ -347,11 +338,8 @@ class CommandListContext : public ICommandListContext
 
     void updateCompletedFenceValue()
     {
-        uint64_t value = m_fence->GetCompletedValue();
-        if (value != (uint64_t)-1) // we get -1 when device is lost
-        {
-            m_lastCompletedFenceValue = value;
-        }
+        // Driver is only queried while some of our signals are still in flight, last good value is kept if device is lost
+        m_lastCompletedFenceValue = m_timeline->getCompletedValue(m_fence.Get(), m_lastSignalledFenceValue);
     }
     Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
     uint64_t m_fenceValueGenerator = 0;
@@ -359,7 +347,6 @@ class CommandListContext : public ICommandListContext
     uint64_t m_lastCompletedFenceValue = 0;
 
     HANDLE m_fenceEvent{};
-    HANDLE m_fenceEventExternal{};
     std::vector<UINT64> m_fenceValue{};
     std::atomic<bool> m_cmdListIsRecording = false;
     uint32_t m_index = 0;
@@ -387,14 +374,16 @@ public:
         HRESULT hr = ((IDXGISwapChain*)chain)->GetLastPresentCount(&id);
     }
 
-    void init(const char* debugName, ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t count)
+    void init(const char* debugName, ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t count, const std::shared_ptr<FenceTimeline>& timeline)
     {
         m_name = extra::utf8ToUtf16(debugName);
+        m_timeline = timeline;
         m_cmdQueue = queue;
         auto cmdQueueDesc = m_cmdQueue->GetDesc();
         m_bufferCount = count;
         // To support DX11 fences have to be shared
         device->CreateFence(0, D3D12_FENCE_FLAG_SHARED, IID_PPV_ARGS(&m_fence));
+        m_timeline->registerFence(m_fence.Get());
         m_fenceValue.resize(count);
         for (uint32_t i = 0; i < count; i++)
         {
@@ -409,16 +398,15 @@ public:
         m_cmdList->SetName((m_name + L" command list").c_str());
 
         m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr); 
-        m_fenceEventExternal = CreateEvent(nullptr, FALSE, FALSE, nullptr);
     }
 
     void shutdown()
     {
         this->updateCompletedFenceValue();
         SL_SAFE_RELEASE(m_cmdList);
+        m_timeline->unregisterFence(m_fence.Get());
         m_fence = nullptr;
         CloseHandle(m_fenceEvent);
-        CloseHandle(m_fenceEventExternal);
         m_allocators.shutdown(m_lastCompletedFenceValue);
     }
 
@@ -528,23 +516,13 @@ public:
 
     WaitStatus waitWithoutDeadlock(uint32_t index, uint64_t value)
     {
-        if (SUCCEEDED(m_fence->SetEventOnCompletion(value, m_fenceEvent)))
+        auto status = m_timeline->wait(m_fence.Get(), value, (uint32_t)kMaxSemaphoreWaitMs);
+        if (status == WaitStatus::eTimeout)
         {
-            DWORD res{};
-            uint32_t waitTime = 0;
-            if (WaitForSingleObject(m_fenceEvent, kMaxSemaphoreWaitMs) == WAIT_TIMEOUT)
-            {
-                SL_LOG_WARN("Wait on gpu fence in '%S' timed out after %llums - index %u value %llu", m_name.c_str(), kMaxSemaphoreWaitMs, index, value);
-                signalAllWaitingOnQueues();
-                return WaitStatus::eTimeout;
-            }
-        }
-        else
-        {
-            SL_LOG_ERROR("Failed to SetEventOnCompletion");
-            return WaitStatus::eError;
+            SL_LOG_WARN("Wait on gpu fence in '%S' timed out after %llums - index %u value %llu", m_name.c_str(), kMaxSemaphoreWaitMs, index, value);
+            signalAllWaitingOnQueues();
         }
-        return WaitStatus::eNoTimeout;
+        return status;
     }
 
     WaitStatus flushAll()
@@ -605,8 +583,7 @@ public:
             SL_LOG_ERROR( "Invalid index");
             return true;
         }
-        this->updateCompletedFenceValue();
-        return m_lastCompletedFenceValue >= m_fenceValue[index];
+        return m_timeline->isCompleted(m_fence.Get(), m_fenceValue[index]);
     }
 
     bool signalAllWaitingOnQueues()
@@ -616,10 +593,9 @@ public:
         {
             // We are waiting on the GPU for these fences, signal them to get out of the deadlock
             auto syncValue = other.syncValue;
-            auto completedValue = other.fence->GetCompletedValue();
 
             // Desperate times - desperate measures, make sure to signal new value
-            if (completedValue < syncValue)
+            if (!m_timeline->isCompleted(other.fence, syncValue))
             {
                 SL_LOG_WARN("The fence [%s][%d] has timed out - we're letting it go",
                     other.m_debugInfo.m_sFile, other.m_debugInfo.m_uLine);
@@ -654,30 +630,34 @@ public:
             SL_LOG_ERROR( "Failed to signal on the command queue");
             return false;
         }
+        m_timeline->signaled(fence, syncValue);
         return true;
     }
 
     WaitStatus waitCPUFence(Fence fence, uint64_t syncValue)
     {
         // This can be called from any thread so make sure not to touch any internals
-        auto d3d12Fence = ((ID3D12Fence*)fence);
-        auto completedValue = d3d12Fence->GetCompletedValue();
-        if (completedValue < syncValue)
+        auto status = m_timeline->wait(fence, syncValue, (uint32_t)kMaxSemaphoreWaitMs);
+        if (status == WaitStatus::eTimeout)
         {
-            if (SUCCEEDED(d3d12Fence->SetEventOnCompletion(syncValue, m_fenceEventExternal)))
-            {
-                if (WaitForSingleObject(m_fenceEventExternal, kMaxSemaphoreWaitMs) == WAIT_TIMEOUT)
-                {
-                    SL_LOG_WARN("Wait on gpu fence in '%S' timed out after 500ms value %llu", m_name.c_str(), syncValue);
-                    return WaitStatus::eTimeout;
-                }
-            }
-            else
-            {
-                return WaitStatus::eError;
-            }
+            SL_LOG_WARN("Wait on gpu fence in '%S' timed out after %llums value %llu", m_name.c_str(), kMaxSemaphoreWaitMs, syncValue);
         }
-        return WaitStatus::eNoTimeout;
+        return status;
+    }
+
+    WaitStatus waitCPUFences(const Fence* fences, const uint64_t* syncValues, uint32_t count, bool waitAll, uint32_t timeoutMs) override
+    {
+        auto status = m_timeline->wait(fences, syncValues, count, waitAll, timeoutMs);
+        if (status == WaitStatus::eTimeout)
+        {
+            SL_LOG_WARN("Wait on %u gpu fence(s) in '%S' timed out after %ums", count, m_name.c_str(), timeoutMs);
+        }
+        return status;
+    }
+
+    bool isFenceValueCompleted(Fence fence, uint64_t syncValue) override
+    {
+        return m_timeline->isCompleted(fence, syncValue);
     }
 
     void waitGPUFence(Fence fence, uint64_t syncValue, const DebugInfo &debugInfo) override
@@ -798,9 +778,8 @@ public:
         for (uint32_t u = (uint32_t)m_waitingQueue.size() - 1; u < m_waitingQueue.size(); --u)
         {
             auto& w = m_waitingQueue[u];
-            w.updateCompletedFenceValue();
             // if the value has already passed - this element can be removed from the list
-            if (w.m_completedValue >= w.syncValue)
+            if (m_timeline->isCompleted(w.fence, w.syncValue))
             {
                 w = *m_waitingQueue.rbegin();
                 m_waitingQueue.pop_back();
@@ -809,6 +788,35 @@ public:
     }
 };
 
+//! Event used for CPU waits on fences, one per thread since waits on a thread never overlap
+//!
+//! Fences cannot cancel a pending SetEventOnCompletion so after a timeout the event
+//! may still be signaled later, it is dropped then and a new one is created.
+struct FenceWaitEvent
+{
+    HANDLE handle{};
+
+    ~FenceWaitEvent() { reset(); }
+
+    HANDLE get()
+    {
+        if (!handle)
+        {
+            handle = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        }
+        return handle;
+    }
+
+    void reset()
+    {
+        if (handle)
+        {
+            CloseHandle(handle);
+            handle = {};
+        }
+    }
+};
+
 ComputeStatus D3D12::init(Device device, param::IParameters* params)
 {
     // First check if this is dx11 on dx12
@@ -906,6 +914,82 @@ ComputeStatus D3D12::init(Device device, param::IParameters* params)
 
     genericPostInit();
 
+    loadPipelineCache(L"d3d12");
+
+    m_constantAllocator = std::make_unique<UploadAllocator<UploadPageD3D12>>([this](uint64_t size, UploadPageD3D12& page, uint8_t*& mapped)->bool
+    {
+        auto uploadHeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+        auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+        if (FAILED(m_device->CreateCommittedResource(&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&page.resource))))
+        {
+            SL_LOG_ERROR("Failed to create constant upload page");
+            return false;
+        }
+        page.resource->SetName(L"sl.chi.constants");
+        // Stays mapped for the lifetime of the page, we never read it on the CPU
+        CD3DX12_RANGE readRange(0, 0);
+        if (FAILED(page.resource->Map(0, &readRange, reinterpret_cast<void**>(&mapped))))
+        {
+            SL_LOG_ERROR("Failed to map constant upload page");
+            SL_SAFE_RELEASE(page.resource);
+            return false;
+        }
+        page.address = page.resource->GetGPUVirtualAddress();
+        return true;
+    }, [](UploadPageD3D12 page)->void
+    {
+        page.resource->Unmap(0, nullptr);
+        page.resource->Release();
+    });
+
+    // Batched waits need ID3D12Device1, device reference is held since contexts can outlive us
+    Microsoft::WRL::ComPtr<ID3D12Device1> device1;
+    m_device->QueryInterface(IID_PPV_ARGS(&device1));
+    m_fenceTimeline = std::make_shared<FenceTimeline>([](Fence fence, uint64_t& value)->bool
+    {
+        value = ((ID3D12Fence*)fence)->GetCompletedValue();
+        if (value == UINT64_MAX)
+        {
+            SL_LOG_ERROR("We've lost the Device.");
+            return false;
+        }
+        return true;
+    }, [device1](const Fence* fences, const uint64_t* values, uint32_t count, bool waitAll, uint32_t timeoutMs)->WaitStatus
+    {
+        thread_local FenceWaitEvent t_event;
+        HANDLE event = t_event.get();
+        if (!event)
+        {
+            SL_LOG_ERROR("Failed to create fence event");
+            return WaitStatus::eError;
+        }
+        HRESULT hr = E_NOTIMPL;
+        if (count == 1)
+        {
+            hr = ((ID3D12Fence*)fences[0])->SetEventOnCompletion(values[0], event);
+        }
+        else if (device1)
+        {
+            auto flags = waitAll ? D3D12_MULTIPLE_FENCE_WAIT_FLAG_ALL : D3D12_MULTIPLE_FENCE_WAIT_FLAG_ANY;
+            hr = device1->SetEventOnMultipleFenceCompletion((ID3D12Fence* const*)fences, values, count, flags, event);
+        }
+        WaitStatus status = WaitStatus::eError;
+        if (FAILED(hr))
+        {
+            SL_LOG_ERROR("Failed to SetEventOnCompletion");
+        }
+        else
+        {
+            auto res = WaitForSingleObject(event, timeoutMs);
+            status = res == WAIT_OBJECT_0 ? WaitStatus::eNoTimeout : res == WAIT_TIMEOUT ? WaitStatus::eTimeout : WaitStatus::eError;
+        }
+        if (status != WaitStatus::eNoTimeout)
+        {
+            t_event.reset();
+        }
+        return status;
+    });
+
     CHI_CHECK(createKernel((void*)copy_to_buffer_cs, copy_to_buffer_cs_len, "copy_to_buffer.cs", "main", m_copyKernel));
 
     return ComputeStatus::eOk;
@@ -957,6 +1041,8 @@ ComputeStatus D3D12::shutdown()
     m_kernels.clear();
 
     m_dispatchContext.clear();
+    m_constantAllocator.reset();
+    m_fenceTimeline.reset();
 
     auto res = Generic::shutdown();
 
@@ -1141,6 +1227,7 @@ ComputeStatus D3D12::getNativeResourceState(ResourceState states, uint32_t& reso
 
 ComputeStatus D3D12::createKernel(void *blobData, uint32_t blobSize, const char* fileName, const char *entryPoint, Kernel &kernel)
 {
+    SL_PROFILE_SCOPE("chi::createKernel");
     if (!blobData || !fileName || !entryPoint)
     {
         if (fileName && entryPoint)
@@ -1154,22 +1241,8 @@ ComputeStatus D3D12::createKernel(void *blobData, uint32_t blobSize, const char*
         return ComputeStatus::eInvalidArgument;
     }
 
-    size_t hash = 0;
-    const char* p = fileName;
-    while (*p)
-    {
-        hash_combine(hash, *p++);
-    }
-    p = entryPoint;
-    while (*p)
-    {
-        hash_combine(hash, *p++);
-    }
-    auto i = blobSize;
-    while (i--)
-    {
-        hash_combine(hash, ((char*)blobData)[i]);
-    }
+    Hash128 blobHash;
+    size_t hash = getKernelHash(blobData, blobSize, fileName, entryPoint, blobHash);
 
     ComputeStatus Res = ComputeStatus::eOk;
     KernelDataBase*data = {};
@@ -1196,8 +1269,7 @@ ComputeStatus D3D12::createKernel(void *blobData, uint32_t blobSize, const char*
         const char* blob = (const char*)blobData;
         if (blob[0] == 'D' && blob[1] == 'X' && blob[2] == 'B' && blob[3] == 'C')
         {
-            data->kernelBlob.resize(blobSize);
-            memcpy(data->kernelBlob.data(), blob, blobSize);
+            setKernelBlob(data, blob, blobSize, blobHash);
             SL_LOG_VERBOSE("Creating DXBC kernel %s:%s hash %llu", fileName, entryPoint, hash);
         }
         else
@@ -1242,7 +1314,7 @@ ComputeStatus D3D12::destroyKernel(Kernel& InKernel)
 ComputeStatus D3D12::createCommandListContext(CommandQueue queue, uint32_t count, ICommandListContext*& ctx, const char friendlyName[])
 {
     auto tmp = new CommandListContext();
-    tmp->init(friendlyName, m_device, (ID3D12CommandQueue*)queue, count);
+    tmp->init(friendlyName, m_device, (ID3D12CommandQueue*)queue, count, m_fenceTimeline);
     ctx = tmp;
     return ComputeStatus::eOk;
 }
@@ -1495,11 +1567,6 @@ ComputeStatus D3D12::bindConsts(uint32_t pos, uint32_t base, void *data, size_t
     auto& ctx = m_dispatchContext.getContext();
     if (!ctx.kernel) return ComputeStatus::eInvalidArgument;
 
-    if (instances < 3)
-    {
-        SL_LOG_WARN("Detected too low instance count for circular constant buffer - please use num_viewports * 3 formula");
-    }
-
     auto &kdd = (*ctx.kddMap)[ctx.kernel->hash];
     kdd.slot = pos;
     if (kdd.addSlot(kdd.slot))
@@ -1507,18 +1574,21 @@ ComputeStatus D3D12::bindConsts(uint32_t pos, uint32_t base, void *data, size_t
         kdd.rootRanges[kdd.slot].Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, base);
         kdd.rootParameters[kdd.slot].InitAsConstantBufferView(base);
     }
-    if (!kdd.cb[kdd.slot])
-    {
-        kdd.cb[kdd.slot] = new ConstantBuffer();
-        kdd.cb[kdd.slot]->create(m_device, (uint32_t)dataSize, instances);
-    }
 
     if (data)
     {
-        auto idx = kdd.cb[kdd.slot]->getIndex();
-        kdd.cb[kdd.slot]->copyStagingToGpu(data, idx);
-        kdd.handles[kdd.slot] = kdd.cb[kdd.slot]->getGpuVirtualAddress(idx);
-        kdd.cb[kdd.slot]->advanceIndex();
+        // Each bind gets its own copy, 'instances' is no longer needed to avoid overwriting constants in flight
+        auto frame = (uint64_t)m_finishedFrame.load();
+        m_constantAllocator->setCompletedValue(frame);
+        UploadAllocator<UploadPageD3D12>::Allocation allocation{};
+        auto alignedDataSize = extra::align((uint32_t)dataSize, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        if (!m_constantAllocator->allocate(alignedDataSize, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, frame + kUploadFrameDelay + 1, allocation))
+        {
+            SL_LOG_ERROR("Failed to allocate %llu bytes for constants", (uint64_t)dataSize);
+            return ComputeStatus::eError;
+        }
+        memcpy(allocation.cpu, data, dataSize);
+        kdd.handles[kdd.slot] = allocation.buffer.address + allocation.offset;
     }
 
 #ifndef SL_PRODUCTION
@@ -1608,9 +1678,12 @@ ComputeStatus D3D12::bindRawBuffer(uint32_t pos, uint32_t base, Resource resourc
 
 ComputeStatus D3D12::dispatch(uint32_t blocksX, uint32_t blocksY, uint32_t blocksZ)
 {
+    SL_PROFILE_SCOPE("chi::dispatch");
     auto& ctx = m_dispatchContext.getContext();
     if (!ctx.kernel) return ComputeStatus::eInvalidArgument;
 
+    flushTransitions(ctx.cmdList);
+
     auto &kdd = (*ctx.kddMap)[ctx.kernel->hash];
     ComputeStatus Res = ComputeStatus::eOk;
     
@@ -1643,19 +1716,35 @@ ComputeStatus D3D12::dispatch(uint32_t blocksX, uint32_t blocksY, uint32_t block
                 auto it = m_rootSignatureMap.find(hash);
                 if (it == m_rootSignatureMap.end())
                 {
-                    ID3DBlob *signature;
-                    ID3DBlob *error;
-                    D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
-                    if (error)
+                    // Serialized root signature is device independent, key does not include the node
+                    auto cacheKey = PipelineCache::makeKey(hash, 0);
+                    std::vector<uint8_t> cached;
+                    if (m_pipelineCache.find(cacheKey, PipelineCacheEntryType::eRootSignature, cached) &&
+                        FAILED(m_device->CreateRootSignature(node, cached.data(), cached.size(), IID_PPV_ARGS(&kdd.rootSignature))))
                     {
-                        SL_LOG_ERROR( "D3D12SerializeRootSignature failed %s", (const char*)error->GetBufferPointer());
-                        error->Release();
-                        return ComputeStatus::eError;
+                        SL_LOG_WARN("Discarding cached root signature with hash %llu", hash);
+                        m_pipelineCache.remove(cacheKey, PipelineCacheEntryType::eRootSignature);
+                        kdd.rootSignature = {};
                     }
-                    if (FAILED(m_device->CreateRootSignature(node, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&kdd.rootSignature))))
+                    if (!kdd.rootSignature)
                     {
-                        SL_LOG_ERROR( "Failed to create root signature");
-                        return ComputeStatus::eError;
+                        ID3DBlob *signature;
+                        ID3DBlob *error;
+                        D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+                        if (error)
+                        {
+                            SL_LOG_ERROR( "D3D12SerializeRootSignature failed %s", (const char*)error->GetBufferPointer());
+                            error->Release();
+                            return ComputeStatus::eError;
+                        }
+                        if (FAILED(m_device->CreateRootSignature(node, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&kdd.rootSignature))))
+                        {
+                            SL_LOG_ERROR( "Failed to create root signature");
+                            signature->Release();
+                            return ComputeStatus::eError;
+                        }
+                        m_pipelineCache.update(cacheKey, PipelineCacheEntryType::eRootSignature, signature->GetBufferPointer(), signature->GetBufferSize());
+                        signature->Release();
                     }
                     SL_LOG_VERBOSE("Created root signature 0x%llx with hash %llu", kdd.rootSignature, hash);
                     m_rootSignatureMap[hash] = kdd.rootSignature;
@@ -1674,12 +1763,37 @@ ComputeStatus D3D12::dispatch(uint32_t blocksX, uint32_t blocksY, uint32_t block
                 {
                     D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
                     psoDesc.pRootSignature = kdd.rootSignature;
-                    psoDesc.CS = { ctx.kernel->kernelBlob.data(), ctx.kernel->kernelBlob.size() };
+                    psoDesc.CS = { ctx.kernel->getBlob(), ctx.kernel->getBlobSize() };
                     psoDesc.NodeMask = node;
-                    if (FAILED(m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&kdd.pso))))
+
+                    // Hash already covers kernel and root signature
+                    auto cacheKey = PipelineCache::makeKey(hash, node);
+                    std::vector<uint8_t> cached;
+                    if (m_pipelineCache.find(cacheKey, PipelineCacheEntryType::ePipeline, cached))
+                    {
+                        psoDesc.CachedPSO = { cached.data(), cached.size() };
+                        if (FAILED(m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&kdd.pso))))
+                        {
+                            // Driver or adapter changed since the blob was stored
+                            SL_LOG_VERBOSE("Discarding cached pipeline state with hash %llu", hash);
+                            m_pipelineCache.remove(cacheKey, PipelineCacheEntryType::ePipeline);
+                            psoDesc.CachedPSO = {};
+                            kdd.pso = {};
+                        }
+                    }
+                    if (!kdd.pso)
                     {
-                        SL_LOG_ERROR( "Failed to create CS pipeline state");
-                        return ComputeStatus::eError;
+                        if (FAILED(m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&kdd.pso))))
+                        {
+                            SL_LOG_ERROR( "Failed to create CS pipeline state");
+                            return ComputeStatus::eError;
+                        }
+                        ID3DBlob* blob{};
+                        if (SUCCEEDED(kdd.pso->GetCachedBlob(&blob)) && blob)
+                        {
+                            m_pipelineCache.update(cacheKey, PipelineCacheEntryType::ePipeline, blob->GetBufferPointer(), blob->GetBufferSize());
+                            blob->Release();
+                        }
                     }
                     SL_LOG_VERBOSE("Created pipeline state 0x%llx with hash %llu", kdd.pso, hash);
                     m_psoMap[hash] = kdd.pso;
@@ -2090,6 +2204,7 @@ ComputeStatus D3D12::setDebugName(Resource res, const char name[])
 
 ComputeStatus D3D12::copyHostToDeviceBuffer(CommandList InCmdList, uint64_t InSize, const void *InData, Resource InUploadResource, Resource InTargetResource, unsigned long long InUploadOffset, unsigned long long InDstOffset)
 {
+    flushTransitions(InCmdList);
     UINT8 *StagingPtr = nullptr;
 
     ID3D12Resource *Resource = (ID3D12Resource*)(InTargetResource->native);
@@ -2115,6 +2230,7 @@ ComputeStatus D3D12::copyHostToDeviceBuffer(CommandList InCmdList, uint64_t InSi
 
 ComputeStatus D3D12::copyHostToDeviceTexture(CommandList cmdList, uint64_t InSize, uint64_t RowPitch, const void* InData, Resource InTargetResource, Resource& InUploadResource)
 {
+    flushTransitions(cmdList);
     if (!cmdList || !InData || !InTargetResource)
     {
         return ComputeStatus::eInvalidArgument;
@@ -2158,6 +2274,7 @@ ComputeStatus D3D12::copyHostToDeviceTexture(CommandList cmdList, uint64_t InSiz
 
 ComputeStatus D3D12::copyDeviceTextureToDeviceBuffer(CommandList cmdList, Resource srcTexture, Resource dstBuffer)
 {
+    flushTransitions(cmdList);
     if (!cmdList || !srcTexture || !dstBuffer)
     {
         return ComputeStatus::eInvalidArgument;
@@ -2183,6 +2300,7 @@ ComputeStatus D3D12::copyDeviceTextureToDeviceBuffer(CommandList cmdList, Resour
 
 ComputeStatus D3D12::clearView(CommandList InCmdList, Resource resource, const float4 Color, const RECT * pRects, uint32_t NumRects, CLEAR_TYPE &outType)
 {
+    flushTransitions(InCmdList);
     outType = CLEAR_UNDEFINED;
     
     ResourceDriverData Data = {};
@@ -2202,6 +2320,7 @@ ComputeStatus D3D12::clearView(CommandList InCmdList, Resource resource, const f
 
 ComputeStatus D3D12::insertGPUBarrierList(CommandList InCmdList, const Resource* resources, uint32_t resourceCount, BarrierType barrierType)
 {
+    flushTransitions(InCmdList);
     if (barrierType == BarrierType::eBarrierTypeUAV)
     {
         std::vector< D3D12_RESOURCE_BARRIER> Barriers;
@@ -2222,6 +2341,7 @@ ComputeStatus D3D12::insertGPUBarrierList(CommandList InCmdList, const Resource*
 
 ComputeStatus D3D12::insertGPUBarrier(CommandList InCmdList, Resource InResource, BarrierType InBarrierType)
 {
+    flushTransitions(InCmdList);
     if (InBarrierType == BarrierType::eBarrierTypeUAV)
     {
         D3D12_RESOURCE_BARRIER UAV = CD3DX12_RESOURCE_BARRIER::UAV((ID3D12Resource*)(InResource->native));
@@ -2265,6 +2385,7 @@ ComputeStatus D3D12::transitionResourceImpl(CommandList cmdList, const ResourceT
 
 ComputeStatus D3D12::copyResource(CommandList InCmdList, Resource InDstResource, Resource InSrcResource)
 {
+    flushTransitions(InCmdList);
     if (!InCmdList || !InDstResource || !InSrcResource) return ComputeStatus::eInvalidArgument;
     ((ID3D12GraphicsCommandList*)InCmdList)->CopyResource((ID3D12Resource*)(InDstResource->native), (ID3D12Resource*)(InSrcResource->native));
     return ComputeStatus::eOk;
@@ -2272,6 +2393,7 @@ ComputeStatus D3D12::copyResource(CommandList InCmdList, Resource InDstResource,
 
 ComputeStatus D3D12::cloneResource(Resource resource, Resource &clone, const char friendlyName[], ResourceState initialState, uint32_t creationMask, uint32_t visibilityMask)
 {
+    SL_PROFILE_SCOPE("chi::cloneResource");
     if (!resource || !resource->native) return ComputeStatus::eInvalidArgument;
 
     D3D12_RESOURCE_DESC desc1 = ((ID3D12Resource*)(resource->native))->GetDesc();
@@ -2363,6 +2485,7 @@ ComputeStatus D3D12::cloneResource(Resource resource, Resource &clone, const cha
 
 ComputeStatus D3D12::copyBufferToReadbackBuffer(CommandList InCmdList, Resource InResource, Resource OutResource, uint32_t InBytesToCopy) 
 {
+    flushTransitions(InCmdList);
     ID3D12Resource *InD3dResource = (ID3D12Resource*)(InResource->native);
     ID3D12Resource *OutD3dResource = (ID3D12Resource*)(OutResource->native);
     ID3D12GraphicsCommandList* CmdList = (ID3D12GraphicsCommandList*)InCmdList;
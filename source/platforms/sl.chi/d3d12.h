@@ -28,6 +28,8 @@
 
 #include "source/core/sl.thread/thread.h"
 #include "source/platforms/sl.chi/generic.h"
+#include "source/platforms/sl.chi/uploadAllocator.h"
+#include "source/platforms/sl.chi/fenceTimeline.h"
 #include "source/platforms/sl.chi/d3dx12.h"
 #include "source/core/sl.interposer/d3d12/d3d12CommandList.h"
 #include "source/core/sl.extra/extra.h"
@@ -47,101 +49,11 @@ struct D3D12ThreadContext : public CommonThreadContext
 constexpr unsigned int SL_MAX_D3D12_DESCRIPTORS          = 1024;
 constexpr unsigned int SL_DESCRIPTOR_WRAPAROUND_CAPACITY = 2;
 
-class GpuUploadBuffer
+//! Page of upload memory constants are sub-allocated from
+struct UploadPageD3D12
 {
-public:
-    ID3D12Resource *getResource() { return m_resource; }
-    virtual void release() { m_resource->Release(); }
-    UINT64 size() { return m_resource ? m_resource->GetDesc().Width : 0; }
-
-protected:
-    ID3D12Resource *m_resource = {};
-
-    GpuUploadBuffer() {}
-    ~GpuUploadBuffer()
-    {
-        if (m_resource)
-        {
-            m_resource->Unmap(0, nullptr);
-            release();
-            m_resource = {};
-        }
-    }
-
-    void allocate(ID3D12Device* device, UINT bufferSize, LPCWSTR resourceName = nullptr)
-    {
-        auto uploadHeapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-
-        auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-        if (FAILED(device->CreateCommittedResource(
-            &uploadHeapProperties,
-            D3D12_HEAP_FLAG_NONE,
-            &bufferDesc,
-            D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(&m_resource))))
-        {
-            SL_LOG_ERROR( "Failed to create GPU upload buffer");
-        }
-        if (resourceName)
-        {
-            m_resource->SetName(resourceName);
-        }
-    }
-
-    uint8_t* mapCpuWriteOnly()
-    {
-        uint8_t* mappedData;
-        // We don't unmap this until the app closes. Keeping buffer mapped for the lifetime of the resource is okay.
-        CD3DX12_RANGE readRange(0, 0);        // We do not intend to read from this resource on the CPU.
-        if (FAILED(m_resource->Map(0, &readRange, reinterpret_cast<void**>(&mappedData))))
-        {
-            SL_LOG_ERROR( "Failed to map GPU upload buffer");
-        }
-        return mappedData;
-    }
-};
-
-class ConstantBuffer : public GpuUploadBuffer
-{
-    uint8_t* m_mappedConstantData;
-    UINT m_alignedInstanceSize;
-    UINT m_numInstances;
-    UINT m_size;
-    UINT m_index = 0;
-
-    inline constexpr uint32_t align(uint32_t size, uint32_t alignment)
-    {
-        return (size + (alignment - 1)) & ~(alignment - 1);
-    }
-
-public:
-    ConstantBuffer() : m_alignedInstanceSize(0), m_numInstances(0), m_mappedConstantData(nullptr) {}
-
-    void create(ID3D12Device* device, UINT size, UINT numInstances = 1, LPCWSTR resourceName = nullptr)
-    {
-        m_size = size;
-        m_numInstances = numInstances;
-        m_index = 0;
-        m_alignedInstanceSize = align(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
-        UINT bufferSize = numInstances * m_alignedInstanceSize;
-        allocate(device, bufferSize, resourceName);
-        m_mappedConstantData = mapCpuWriteOnly();
-    }
-
-    UINT getIndex() const { return m_index; }
-    void advanceIndex() { m_index = (m_index + 1) % m_numInstances; }
-
-    void copyStagingToGpu(void *staging, UINT instanceIndex = 0)
-    {
-        memcpy(m_mappedConstantData + instanceIndex * m_alignedInstanceSize, staging, m_size);
-    }
-
-    UINT getNumInstances() { return m_numInstances; }
-    D3D12_GPU_VIRTUAL_ADDRESS getGpuVirtualAddress(UINT instanceIndex = 0)
-    {
-        return m_resource->GetGPUVirtualAddress() + instanceIndex * m_alignedInstanceSize;
-    }
+    ID3D12Resource* resource{};
+    D3D12_GPU_VIRTUAL_ADDRESS address{};
 };
 
 struct KernelDispatchData
@@ -154,7 +66,6 @@ struct KernelDispatchData
     std::vector<UINT64> handles = {};
     std::vector<CD3DX12_ROOT_PARAMETER> rootParameters = {};
     CD3DX12_DESCRIPTOR_RANGE rootRanges[32];
-    std::vector<ConstantBuffer*> cb = {};
     CD3DX12_STATIC_SAMPLER_DESC samplers[8] = {};
 
     ID3D12RootSignature* rootSignature = {};
@@ -167,7 +78,6 @@ struct KernelDispatchData
         handles = rhs.handles;
         rootParameters = rhs.rootParameters;
         memcpy(rootRanges, rhs.rootRanges, 32 * sizeof(CD3DX12_DESCRIPTOR_RANGE));
-        cb = rhs.cb;
         memcpy(samplers, rhs.samplers, 8 * sizeof(CD3DX12_STATIC_SAMPLER_DESC));
         rootSignature = rhs.rootSignature;
         pso = rhs.pso;
@@ -181,7 +91,6 @@ struct KernelDispatchData
             handles.resize(index + 1);
             handles[index] = 0;
             rootParameters.resize(index + 1);
-            cb.resize(index + 1);
             return true;
         }
         return false;
@@ -205,13 +114,6 @@ struct DispatchDataD3D12
     {
         if (kddMap)
         {
-            for (auto& [kernel, kdd] : *kddMap)
-            {
-                for (auto& cb : kdd.cb)
-                {
-                    delete cb;
-                }
-            }
             delete kddMap;
             kddMap = {};
         }
@@ -275,6 +177,10 @@ class D3D12 : public Generic
     std::map<size_t, ID3D12PipelineState*> m_psoMap = {};
     std::map<size_t, ID3D12RootSignature*> m_rootSignatureMap = {};
     thread::ThreadContext<DispatchDataD3D12> m_dispatchContext;
+    //! Constants for all kernels and threads, pages are recycled once frames using them are done
+    std::unique_ptr<UploadAllocator<UploadPageD3D12>> m_constantAllocator;
+    //! Completed fence values for all command list contexts, contexts keep it alive
+    std::shared_ptr<FenceTimeline> m_fenceTimeline;
 
     size_t hashRootSignature(const CD3DX12_ROOT_SIGNATURE_DESC& desc);
 
@@ -0,0 +1,345 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace sl
+{
+namespace chi
+{
+
+//! Fixed capacity scratch storage for descriptor writes
+//!
+//! Write and info types are template parameters so the builder does not depend
+//! on any graphics API. Storage lives inside the per-thread dispatch data and is
+//! reset before each update, nothing is allocated on the heap while dispatching.
+//! Info arrays handed out stay valid until the next reset so writes can point to them.
+template<typename Write, typename BufferInfo, typename ImageInfo, uint32_t kMaxWrites = 16, uint32_t kMaxInfos = 64>
+class DescriptorWriteBuilder
+{
+    Write m_writes[kMaxWrites]{};
+    BufferInfo m_buffers[kMaxInfos]{};
+    ImageInfo m_images[kMaxInfos]{};
+    uint32_t m_writeCount{};
+    uint32_t m_bufferCount{};
+    uint32_t m_imageCount{};
+
+    template<typename T>
+    static inline T* allocate(T* storage, uint32_t& used, uint32_t count)
+    {
+        if (count > kMaxInfos - used) return nullptr;
+        auto p = storage + used;
+        used += count;
+        return p;
+    }
+
+public:
+    inline void reset()
+    {
+        m_writeCount = m_bufferCount = m_imageCount = 0;
+    }
+
+    //! All allocators return nullptr when out of space
+    inline Write* addWrite()
+    {
+        if (m_writeCount == kMaxWrites) return nullptr;
+        auto write = &m_writes[m_writeCount++];
+        *write = {};
+        return write;
+    }
+    inline BufferInfo* allocateBuffers(uint32_t count) { return allocate(m_buffers, m_bufferCount, count); }
+    inline ImageInfo* allocateImages(uint32_t count) { return allocate(m_images, m_imageCount, count); }
+
+    inline const Write* getWrites() const { return m_writes; }
+    inline uint32_t getWriteCount() const { return m_writeCount; }
+};
+
+//! Descriptor pool pages handed out per frame and recycled in bulk
+//!
+//! Sets are allocated linearly from the open page, when it runs out another
+//! page is opened (recycled or created) so capacity grows with demand instead
+//! of thread or signature count. Each page remembers the last frame which
+//! allocated or bound one of its sets, pages idle for more than 'frameDelay'
+//! frames are reset as a whole. Frame delay matches the one used for deferred
+//! resource destruction since chi has no per-frame fence.
+//!
+//! Pool type and pool operations are provided by the backend so paging can
+//! be exercised without a device. Thread safe.
+template<typename Pool>
+class DescriptorPoolPages
+{
+public:
+    struct Page
+    {
+        Pool pool{};
+        std::atomic<uint32_t> lastFrame{};
+        //! Incremented on each reset, sets allocated before are no longer valid
+        std::atomic<uint64_t> epoch{};
+    };
+
+    using PFunCreatePool = std::function<bool(Pool& pool)>;
+    using PFunPoolOperation = std::function<void(Pool pool)>;
+
+private:
+    std::mutex m_mtx;
+    std::vector<std::unique_ptr<Page>> m_pages;
+    //! Pages which can take new allocations, last one is open
+    std::vector<Page*> m_free;
+    //! Full pages or pages from earlier frames waiting to be reset
+    std::vector<Page*> m_retired;
+    Page* m_open{};
+    uint32_t m_frame = UINT_MAX;
+    uint32_t m_frameDelay{};
+    PFunCreatePool m_create;
+    PFunPoolOperation m_reset;
+    PFunPoolOperation m_destroy;
+
+    void recycleLocked(uint32_t frame)
+    {
+        auto it = m_retired.begin();
+        while (it != m_retired.end())
+        {
+            if (frame > (*it)->lastFrame.load() + m_frameDelay)
+            {
+                m_reset((*it)->pool);
+                (*it)->epoch++;
+                m_free.push_back(*it);
+                it = m_retired.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    Page* openLocked()
+    {
+        if (m_free.empty())
+        {
+            auto page = std::make_unique<Page>();
+            if (!m_create(page->pool))
+            {
+                return nullptr;
+            }
+            m_free.push_back(page.get());
+            m_pages.push_back(std::move(page));
+        }
+        m_open = m_free.back();
+        m_free.pop_back();
+        return m_open;
+    }
+
+public:
+    DescriptorPoolPages(const PFunCreatePool& create, const PFunPoolOperation& reset, const PFunPoolOperation& destroy, uint32_t frameDelay = 3) :
+        m_frameDelay(frameDelay), m_create(create), m_reset(reset), m_destroy(destroy) {}
+
+    DescriptorPoolPages(const DescriptorPoolPages&) = delete;
+
+    ~DescriptorPoolPages() { destroy(); }
+
+    //! Allocates using 'tryAllocate(pool)' which returns false when the pool is full
+    template<typename F>
+    Page* allocate(uint32_t frame, F&& tryAllocate)
+    {
+        std::scoped_lock lock(m_mtx);
+        if (frame != m_frame)
+        {
+            // New frame starts with a fresh page, previous one can be reset once frame is done
+            if (m_open)
+            {
+                m_retired.push_back(m_open);
+                m_open = {};
+            }
+            m_frame = frame;
+            recycleLocked(frame);
+        }
+        for (uint32_t attempt = 0; attempt < 2; attempt++)
+        {
+            if (!m_open && !openLocked())
+            {
+                return nullptr;
+            }
+            if (tryAllocate(m_open->pool))
+            {
+                m_open->lastFrame.store(frame);
+                return m_open;
+            }
+            // Page is full, grow
+            m_retired.push_back(m_open);
+            m_open = {};
+        }
+        return nullptr;
+    }
+
+    //! Keeps a page alive for another frame, returns false if it was reset since 'epoch'
+    bool retain(Page* page, uint64_t epoch, uint32_t frame)
+    {
+        if (page->lastFrame.load(std::memory_order_acquire) == frame && page->epoch.load(std::memory_order_acquire) == epoch)
+        {
+            // Already used this frame so it cannot be recycled yet
+            return true;
+        }
+        std::scoped_lock lock(m_mtx);
+        if (page->epoch.load() != epoch)
+        {
+            return false;
+        }
+        page->lastFrame.store(std::max(page->lastFrame.load(), frame));
+        return true;
+    }
+
+    size_t getPageCount()
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_pages.size();
+    }
+
+    void destroy()
+    {
+        std::scoped_lock lock(m_mtx);
+        for (auto& page : m_pages)
+        {
+            m_destroy(page->pool);
+        }
+        m_pages.clear();
+        m_free.clear();
+        m_retired.clear();
+        m_open = {};
+        m_frame = UINT_MAX;
+    }
+};
+
+//! Remembers which descriptor set was written for a given set of bindings
+//!
+//! Bindings are described by a key, a flat array of values (handles, binding
+//! slots, types) produced by the backend. When a dispatch binds the same
+//! resources as a set which is still alive that set is bound again instead of
+//! writing a new one, this covers kernels alternating between a few inputs
+//! within a frame as well as identical bindings in consecutive frames.
+//!
+//! Each entry also records the resource generation it was written at, handles
+//! can be reused once a resource is destroyed so older entries never match.
+template<typename Set, typename Page, uint32_t kEntryCount = 8>
+class DescriptorSetCache
+{
+public:
+    struct Entry
+    {
+        uint64_t hash{};
+        uint64_t lastUse{};
+        Set set{};
+        Page* page{};
+        uint64_t epoch{};
+        uint64_t generation{};
+        std::vector<uint64_t> key;
+    };
+
+private:
+    Entry m_entries[kEntryCount]{};
+    Entry* m_current{};
+    uint64_t m_clock{};
+
+public:
+    static inline uint64_t hashKey(const uint64_t* key, size_t count)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull ^ count;
+        for (size_t i = 0; i < count; i++)
+        {
+            hash ^= key[i];
+            hash *= 0x100000001b3ull;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+
+    //! Entry bound most recently, null if none
+    inline Entry* getCurrent() const { return m_current; }
+
+    //! Entry bound most recently if still written at 'generation', null otherwise
+    inline Entry* getCurrent(uint64_t generation)
+    {
+        if (m_current && m_current->generation != generation)
+        {
+            m_current = {};
+        }
+        return m_current;
+    }
+
+    //! Returns entry with matching bindings, caller must check its page is still alive
+    Entry* find(const uint64_t* key, size_t count, uint64_t generation)
+    {
+        auto hash = hashKey(key, count);
+        for (auto& e : m_entries)
+        {
+            if (e.page && e.generation == generation && e.hash == hash && e.key.size() == count &&
+                (count == 0 || memcmp(e.key.data(), key, count * sizeof(uint64_t)) == 0))
+            {
+                e.lastUse = ++m_clock;
+                m_current = &e;
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    //! Stores a newly written set replacing the least recently used entry
+    Entry* insert(const uint64_t* key, size_t count, Set set, Page* page, uint64_t epoch, uint64_t generation)
+    {
+        auto e = &m_entries[0];
+        for (auto& candidate : m_entries)
+        {
+            if (candidate.lastUse < e->lastUse) e = &candidate;
+        }
+        e->hash = hashKey(key, count);
+        e->lastUse = ++m_clock;
+        e->set = set;
+        e->page = page;
+        e->epoch = epoch;
+        e->generation = generation;
+        // Capacity is kept so steady state does not allocate
+        e->key.assign(key, key + count);
+        m_current = e;
+        return e;
+    }
+
+    //! Drops an entry whose page was reset
+    void invalidate(Entry* e)
+    {
+        e->page = {};
+        e->lastUse = 0;
+        if (m_current == e) m_current = {};
+    }
+};
+
+}
+}
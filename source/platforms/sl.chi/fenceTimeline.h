@@ -0,0 +1,388 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include "source/platforms/sl.chi/compute.h"
+
+namespace sl
+{
+namespace chi
+{
+
+//! CPU side view of monotonic fences (D3D12 fences, VK timeline semaphores) shared by all queues
+//!
+//! Remembers the last value signaled and the last value seen completed for each
+//! registered fence so "is value X done" is answered from the cache, the driver
+//! is only asked while the cached value is behind. Fences which are not registered
+//! (owned by the host) are always queried since their handles can be recycled.
+//!
+//! Waits on several fences are handed to the backend as a single wait-any or
+//! wait-all with one timeout instead of looping over individual waits.
+//!
+//! Driver operations are provided by the backend so the timeline can run on
+//! SimulatedFences without a device. Thread safe.
+class FenceTimeline
+{
+public:
+    //! Returns false if the value could not be read (device lost)
+    using PFunGetCompletedValue = std::function<bool(Fence fence, uint64_t& value)>;
+    //! Blocks until all (or any) of the values are reached or 'timeoutMs' elapses
+    using PFunWait = std::function<WaitStatus(const Fence* fences, const uint64_t* values, uint32_t count, bool waitAll, uint32_t timeoutMs)>;
+
+private:
+    //! Covers every wait issued by chi (one fence per command list in flight)
+    static constexpr uint32_t kMaxFixedWaitCount = 16;
+
+    struct Entry
+    {
+        uint64_t signaled{};
+        uint64_t completed{};
+    };
+
+    std::mutex m_mtx;
+    std::unordered_map<Fence, Entry> m_fences;
+    PFunGetCompletedValue m_getCompletedValue;
+    PFunWait m_wait;
+
+    void markCompleted(Fence fence, uint64_t value)
+    {
+        std::scoped_lock lock(m_mtx);
+        auto it = m_fences.find(fence);
+        if (it != m_fences.end())
+        {
+            it->second.completed = std::max(it->second.completed, value);
+        }
+    }
+
+public:
+    FenceTimeline(const PFunGetCompletedValue& getCompletedValue, const PFunWait& wait) :
+        m_getCompletedValue(getCompletedValue), m_wait(wait) {}
+
+    FenceTimeline(const FenceTimeline&) = delete;
+
+    void registerFence(Fence fence, uint64_t initialValue = 0)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_fences[fence] = { initialValue, initialValue };
+    }
+
+    //! Must be called before the fence is destroyed
+    void unregisterFence(Fence fence)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_fences.erase(fence);
+    }
+
+    //! Records a signal issued on a queue or on the CPU
+    void signaled(Fence fence, uint64_t value)
+    {
+        std::scoped_lock lock(m_mtx);
+        auto it = m_fences.find(fence);
+        if (it != m_fences.end())
+        {
+            it->second.signaled = std::max(it->second.signaled, value);
+        }
+    }
+
+    uint64_t getSignaledValue(Fence fence)
+    {
+        std::scoped_lock lock(m_mtx);
+        auto it = m_fences.find(fence);
+        return it != m_fences.end() ? it->second.signaled : 0;
+    }
+
+    //! Returns last known completed value, driver is queried only if it is below 'needed'
+    //!
+    //! If the driver cannot be queried the last known value is returned.
+    uint64_t getCompletedValue(Fence fence, uint64_t needed = UINT64_MAX)
+    {
+        bool registered = false;
+        {
+            std::scoped_lock lock(m_mtx);
+            auto it = m_fences.find(fence);
+            if (it != m_fences.end())
+            {
+                if (it->second.completed >= needed)
+                {
+                    return it->second.completed;
+                }
+                registered = true;
+            }
+        }
+
+        // No lock while in the driver, other threads can refresh the same fence
+        uint64_t value = 0;
+        bool valid = m_getCompletedValue(fence, value);
+        if (!registered)
+        {
+            return valid ? value : 0;
+        }
+        std::scoped_lock lock(m_mtx);
+        auto it = m_fences.find(fence);
+        if (it == m_fences.end())
+        {
+            return valid ? value : 0;
+        }
+        if (valid)
+        {
+            it->second.completed = std::max(it->second.completed, value);
+        }
+        return it->second.completed;
+    }
+
+    inline bool isCompleted(Fence fence, uint64_t value)
+    {
+        return getCompletedValue(fence, value) >= value;
+    }
+
+    //! Waits on the CPU until all (or any) of the values are reached
+    //!
+    //! Values known to be done are not passed to the backend, nothing blocks if
+    //! the cache or a single query per fence is enough. For wait-any 'completedIndex'
+    //! receives the index of a value which was reached.
+    WaitStatus wait(const Fence* fences, const uint64_t* values, uint32_t count, bool waitAll, uint32_t timeoutMs, uint32_t* completedIndex = nullptr)
+    {
+        // Pending values are gathered on the stack, only waits on more fences than that allocate
+        Fence fixedFences[kMaxFixedWaitCount];
+        uint64_t fixedValues[kMaxFixedWaitCount];
+        uint32_t fixedIndices[kMaxFixedWaitCount];
+        std::vector<Fence> heapFences;
+        std::vector<uint64_t> heapValues;
+        std::vector<uint32_t> heapIndices;
+        Fence* pendingFences = fixedFences;
+        uint64_t* pendingValues = fixedValues;
+        uint32_t* pendingIndices = fixedIndices;
+        if (count > kMaxFixedWaitCount)
+        {
+            heapFences.resize(count);
+            heapValues.resize(count);
+            heapIndices.resize(count);
+            pendingFences = heapFences.data();
+            pendingValues = heapValues.data();
+            pendingIndices = heapIndices.data();
+        }
+
+        uint32_t pendingCount = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (isCompleted(fences[i], values[i]))
+            {
+                if (!waitAll)
+                {
+                    if (completedIndex) *completedIndex = i;
+                    return WaitStatus::eNoTimeout;
+                }
+            }
+            else
+            {
+                pendingFences[pendingCount] = fences[i];
+                pendingValues[pendingCount] = values[i];
+                pendingIndices[pendingCount] = i;
+                pendingCount++;
+            }
+        }
+        if (!pendingCount)
+        {
+            return WaitStatus::eNoTimeout;
+        }
+
+        auto status = m_wait(pendingFences, pendingValues, pendingCount, waitAll, timeoutMs);
+        if (status != WaitStatus::eNoTimeout)
+        {
+            return status;
+        }
+
+        if (waitAll)
+        {
+            for (uint32_t i = 0; i < pendingCount; i++)
+            {
+                markCompleted(pendingFences[i], pendingValues[i]);
+            }
+        }
+        else
+        {
+            // Backends do not report which value was reached, find it
+            uint32_t index = pendingIndices[0];
+            for (uint32_t i = 0; i < pendingCount; i++)
+            {
+                if (isCompleted(pendingFences[i], pendingValues[i]))
+                {
+                    index = pendingIndices[i];
+                    break;
+                }
+            }
+            if (completedIndex) *completedIndex = index;
+        }
+        return WaitStatus::eNoTimeout;
+    }
+
+    inline WaitStatus wait(Fence fence, uint64_t value, uint32_t timeoutMs)
+    {
+        return wait(&fence, &value, 1, true, timeoutMs);
+    }
+};
+
+//! CPU only fences for exercising FenceTimeline without a device
+//!
+//! Time is simulated, a blocking wait advances the clock in 1ms steps and
+//! completes values scheduled with 'signalAt' until the wait is satisfied or
+//! times out so results do not depend on the host scheduler.
+class SimulatedFences
+{
+    struct Scheduled
+    {
+        Fence fence{};
+        uint64_t value{};
+        uint64_t timeMs{};
+    };
+
+    std::mutex m_mtx;
+    std::unordered_map<Fence, uint64_t> m_values;
+    std::vector<Scheduled> m_scheduled;
+    uint64_t m_timeMs{};
+    uint64_t m_queryCount{};
+    uint64_t m_waitCount{};
+    bool m_deviceLost = false;
+
+    void advanceLocked(uint64_t ms)
+    {
+        m_timeMs += ms;
+        auto it = m_scheduled.begin();
+        while (it != m_scheduled.end())
+        {
+            if (it->timeMs <= m_timeMs)
+            {
+                auto& value = m_values[it->fence];
+                value = std::max(value, it->value);
+                it = m_scheduled.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+
+    bool reachedLocked(const Fence* fences, const uint64_t* values, uint32_t count, bool waitAll)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            bool reached = m_values[fences[i]] >= values[i];
+            if (reached != waitAll)
+            {
+                return reached;
+            }
+        }
+        return waitAll;
+    }
+
+public:
+    void signal(Fence fence, uint64_t value)
+    {
+        std::scoped_lock lock(m_mtx);
+        auto& current = m_values[fence];
+        current = std::max(current, value);
+    }
+
+    //! Value completes 'delayMs' from now
+    void signalAt(Fence fence, uint64_t value, uint64_t delayMs)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_scheduled.push_back({ fence, value, m_timeMs + delayMs });
+    }
+
+    void advance(uint64_t ms)
+    {
+        std::scoped_lock lock(m_mtx);
+        advanceLocked(ms);
+    }
+
+    void setDeviceLost(bool lost)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_deviceLost = lost;
+    }
+
+    bool getCompletedValue(Fence fence, uint64_t& value)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_queryCount++;
+        if (m_deviceLost)
+        {
+            return false;
+        }
+        value = m_values[fence];
+        return true;
+    }
+
+    WaitStatus wait(const Fence* fences, const uint64_t* values, uint32_t count, bool waitAll, uint32_t timeoutMs)
+    {
+        std::scoped_lock lock(m_mtx);
+        m_waitCount++;
+        for (uint32_t elapsed = 0;; elapsed++)
+        {
+            if (m_deviceLost)
+            {
+                return WaitStatus::eError;
+            }
+            if (reachedLocked(fences, values, count, waitAll))
+            {
+                return WaitStatus::eNoTimeout;
+            }
+            if (elapsed == timeoutMs)
+            {
+                return WaitStatus::eTimeout;
+            }
+            advanceLocked(1);
+        }
+    }
+
+    uint64_t getTime()
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_timeMs;
+    }
+
+    uint64_t getQueryCount()
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_queryCount;
+    }
+
+    uint64_t getWaitCount()
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_waitCount;
+    }
+};
+
+}
+}
@@ -37,10 +37,14 @@ struct IDXGIAdapter;
 struct IDXGISwapChain;
 
 #include "include/sl_helpers.h"
+#include "include/sl_version.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/core/sl.extra/extra.h"
+#include "source/core/sl.file/file.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/platforms/sl.chi/generic.h"
+#include "source/platforms/sl.chi/transientPlanner.h"
 #include "nvapi.h"
 
 // {B5504F36-CB88-4B2D-AE64-9CAE29E23CA9}
@@ -188,16 +192,14 @@ struct ResourcePool : IResourcePool
         assert(!res.dbgIsCorrupted());
         auto& list = m_allocated[res.accessHash()];
         auto it = list.begin();
-#if SL_DEBUG_RESOURCE_POOL
         int count = 0;
-#endif
         while(it != list.end())
         {
             if ((*it).second == res)
             {
                 it = list.erase(it);
-#if SL_DEBUG_RESOURCE_POOL
                 count++;
+#if SL_DEBUG_RESOURCE_POOL
                 continue;
 #else
                 break;
@@ -205,6 +207,11 @@ struct ResourcePool : IResourcePool
             }
             it++;
         }
+        if (!count)
+        {
+            // Transients are not allocated, pool keeps them until they are garbage collected
+            return;
+        }
 #if SL_DEBUG_RESOURCE_POOL
         assert(count == 1);
         for (auto& [timestamp, cached] : m_free[res.hash])
@@ -221,9 +228,89 @@ struct ResourcePool : IResourcePool
         std::scoped_lock lock(m_mtx);
         m_free.clear();
         m_allocated.clear();
+        m_transients.clear();
+        m_transientPlanner.clear();
+        m_transientResources.clear();
         m_compute->endVRAMSegment();
     }
 
+    virtual uint32_t declareTransient(Resource source, uint32_t firstUse, uint32_t lastUse, const char* debugName, ResourceState initialState) override final
+    {
+        ResourceDescription desc;
+        m_compute->getResourceDescription(source, desc);
+        desc.state = initialState;
+        ResourceFootprint footprint{};
+        m_compute->getResourceFootprint(source, footprint);
+        std::scoped_lock lock(m_mtx);
+        m_transients.push_back({ source, debugName ? debugName : "", initialState, {} });
+        return m_transientPlanner.add({ getHash(desc), footprint.totalBytes, firstUse, lastUse });
+    }
+
+    virtual bool compileTransients() override final
+    {
+        std::scoped_lock lock(m_mtx);
+        if (!m_transientPlanner.plan())
+        {
+            SL_LOG_ERROR("Transient resource declared with last use before first use");
+            return false;
+        }
+        auto now = std::chrono::system_clock::now();
+        auto& slots = m_transientPlanner.getSlots();
+        for (uint32_t i = 0; i < m_transientPlanner.getRequestCount(); i++)
+        {
+            auto& slot = slots[m_transientPlanner.getSlot(i)];
+            auto& resources = m_transientResources[slot.key];
+            if (resources.size() <= slot.index)
+            {
+                resources.resize(slot.index + 1);
+            }
+            auto& [timestamp, resource] = resources[slot.index];
+            auto& transient = m_transients[i];
+            if (!resource)
+            {
+                m_compute->beginVRAMSegment(m_vramSegment.c_str());
+                Resource res{};
+                auto status = m_compute->cloneResource(transient.source, res, transient.debugName.c_str(), transient.initialState);
+                m_compute->endVRAMSegment();
+                if (status != ComputeStatus::eOk || !res)
+                {
+                    SL_LOG_ERROR("Failed to create transient resource '%s'", transient.debugName.c_str());
+                    return false;
+                }
+                ResourceState state = transient.initialState;
+                m_compute->getResourceState(res->state, state);
+                resource = HashedResource(slot.key, state, res, m_compute, true);
+            }
+            else if (timestamp != now)
+            {
+                // Reused from an earlier frame, state could have changed
+                m_compute->getResourceState((Resource)resource, resource.accessState());
+            }
+            timestamp = now;
+            transient.resource = resource;
+        }
+        return true;
+    }
+
+    virtual HashedResource getTransient(uint32_t handle) override final
+    {
+        std::scoped_lock lock(m_mtx);
+        return handle < m_transients.size() ? m_transients[handle].resource : HashedResource{};
+    }
+
+    virtual void resetTransients() override final
+    {
+        std::scoped_lock lock(m_mtx);
+        m_transients.clear();
+        m_transientPlanner.clear();
+    }
+
+    virtual void endTransient(uint32_t handle, uint32_t lastUse) override final
+    {
+        std::scoped_lock lock(m_mtx);
+        m_transientPlanner.setLastUse(handle, lastUse);
+    }
+
     virtual void collectGarbage(float deltaMs = 1000.0f) override final
     {
         std::scoped_lock lock(m_mtx);
@@ -257,6 +344,25 @@ struct ResourcePool : IResourcePool
 #endif
             it++;
         }
+        // Transient resources which no declaration mapped to recently, next compile creates them again if needed
+        //
+        // Entries are indexed by planner slot so they are released in place, only empty ones at the end are dropped
+        auto now = std::chrono::system_clock::now();
+        for (auto& [hash, resources] : m_transientResources)
+        {
+            for (auto& [timestamp, resource] : resources)
+            {
+                std::chrono::duration<float, std::milli> deltaSinceLastUsed = now - timestamp;
+                if (resource && deltaSinceLastUsed.count() > deltaMs)
+                {
+                    resource = {};
+                }
+            }
+            while (!resources.empty() && !resources.back().second)
+            {
+                resources.pop_back();
+            }
+        }
         m_compute->endVRAMSegment();
     }
 
@@ -280,6 +386,19 @@ struct ResourcePool : IResourcePool
     std::string m_vramSegment{};
     std::map<uint64_t, std::vector<TimestampedResource>> m_free{};
     std::map<uint64_t, std::vector<TimestampedResource>> m_allocated{};
+
+    struct Transient
+    {
+        Resource source{};
+        std::string debugName;
+        ResourceState initialState{};
+        HashedResource resource{};
+    };
+    //! Declared this frame, index is the handle
+    std::vector<Transient> m_transients{};
+    TransientPlanner m_transientPlanner{};
+    //! Resources aliased by transients, keyed by description hash and indexed by planner slot
+    std::map<uint64_t, std::vector<TimestampedResource>> m_transientResources{};
 };
 
 ResourceState HashedResource::s_invalidState{};
@@ -296,9 +415,42 @@ ComputeStatus Generic::init(Device device, param::IParameters* params)
     m_parameters = params;
     m_typelessDevice = device;
     params->get(sl::param::global::kPreferenceFlags, (uint64_t*)&m_preferenceFlags);
+    param::getPointerParam(params, sl::param::global::kKernelCache, &m_kernelCache, true);
     return ComputeStatus::eOk;
 }
 
+Kernel Generic::getKernelHash(const void* blob, size_t blobSize, const char* fileName, const char* entryPoint, Hash128& blobHash)
+{
+    blobHash = hash::hash128(blob, blobSize);
+    uint64_t key = hash::hash64(fileName, strlen(fileName), blobHash.lo);
+    key = hash::hash64(entryPoint, strlen(entryPoint), key ^ blobHash.hi);
+    // Zero is reserved for null kernel
+    return key ? (Kernel)key : 1;
+}
+
+void Generic::setKernelBlob(KernelDataBase* data, const void* blob, size_t blobSize, const Hash128& blobHash)
+{
+    if (m_kernelCache)
+    {
+        data->sharedBlob = m_kernelCache->acquire(blobHash, blob, blobSize);
+        if (data->sharedBlob)
+        {
+            data->kernelCache = m_kernelCache;
+            return;
+        }
+    }
+    data->kernelBlob.resize(blobSize);
+    memcpy(data->kernelBlob.data(), blob, blobSize);
+}
+
+void Generic::loadPipelineCache(const wchar_t* api)
+{
+    auto cacheFile = fs::path(file::getTmpPath()) / L"NVIDIA" / L"Streamline" / (file::getExecutableName() + L".chi." + api + L".cache");
+    // Driver validates its own blobs, this only needs to catch changes in how chi builds them
+    auto compatibilityKey = extra::format("{}.{}.{}", SL_VERSION_MAJOR, SL_VERSION_MINOR, SL_VERSION_PATCH);
+    m_pipelineCache.load(cacheFile, compatibilityKey);
+}
+
 ComputeStatus Generic::shutdown()
 {
     Generic::clearCache();
@@ -315,7 +467,9 @@ ComputeStatus Generic::shutdown()
 
     CHI_CHECK(collectGarbage(UINT_MAX));
     SL_LOG_INFO("Delayed destroy resource list count %llu", m_resourcesToDestroy.size());
-    m_vramSegments.clear();
+
+    m_pipelineCache.save();
+    m_vramSegments.reset();
 
     return ComputeStatus::eOk;
 }
@@ -490,6 +644,7 @@ ComputeStatus Generic::getResourceState(Resource resource, ResourceState& state)
 
 ComputeStatus Generic::transitionResources(CommandList cmdList, const ResourceTransition* transitions, uint32_t count, extra::ScopedTasks* scopedTasks)
 {
+    SL_PROFILE_SCOPE("chi::transitionResources");
     if (!cmdList)
     {
         return ComputeStatus::eInvalidArgument;
@@ -549,93 +704,144 @@ ComputeStatus Generic::transitionResources(CommandList cmdList, const ResourceTr
         scopedTasks->tasks.push_back(lambda);
     }
 
-    return transitionResourceImpl(cmdList, transitionList.data(), (uint32_t)transitionList.size());
+    auto& ctx = getTransitionContext();
+    if (ctx.depth && ctx.cmdList == cmdList)
+    {
+        // Recorded on flush, before the next chi command or when the batch ends
+        ctx.pending.add(transitionList.data(), (uint32_t)transitionList.size());
+        return ComputeStatus::eOk;
+    }
+
+    ctx.immediate.clear();
+    ctx.immediate.add(transitionList.data(), (uint32_t)transitionList.size());
+    if (ctx.immediate.empty())
+    {
+        return ComputeStatus::eOk;
+    }
+    return transitionResourceImpl(cmdList, ctx.immediate.getTransitions(), ctx.immediate.getCount());
+}
+
+TransitionContext& Generic::getTransitionContext()
+{
+    auto& ctx = m_transitionContext.getContext();
+    ctx.pending.setWholeResourceBarriers(m_wholeResourceBarriers);
+    ctx.immediate.setWholeResourceBarriers(m_wholeResourceBarriers);
+    return ctx;
+}
+
+ComputeStatus Generic::beginTransitionBatch(CommandList cmdList)
+{
+    if (!cmdList)
+    {
+        return ComputeStatus::eInvalidArgument;
+    }
+    auto& ctx = getTransitionContext();
+    if (ctx.depth && ctx.cmdList != cmdList)
+    {
+        SL_LOG_ERROR("Transition batch is already open for a different command list on this thread");
+        return ComputeStatus::eInvalidCall;
+    }
+    if (!ctx.depth)
+    {
+        ctx.cmdList = cmdList;
+        ctx.pending.clear();
+    }
+    ctx.depth++;
+    return ComputeStatus::eOk;
+}
+
+ComputeStatus Generic::endTransitionBatch(CommandList cmdList)
+{
+    auto& ctx = getTransitionContext();
+    if (!ctx.depth || ctx.cmdList != cmdList)
+    {
+        SL_LOG_ERROR("No transition batch open for the command list on this thread");
+        return ComputeStatus::eInvalidCall;
+    }
+    auto status = flushTransitions(cmdList);
+    if (--ctx.depth == 0)
+    {
+        ctx.cmdList = {};
+    }
+    return status;
+}
+
+ComputeStatus Generic::flushTransitions(CommandList cmdList)
+{
+    auto& ctx = m_transitionContext.getContext();
+    if (!ctx.depth || ctx.cmdList != cmdList || ctx.pending.empty())
+    {
+        return ComputeStatus::eOk;
+    }
+    auto status = transitionResourceImpl(cmdList, ctx.pending.getTransitions(), ctx.pending.getCount());
+    ctx.pending.clear();
+    return status;
 }
 
 ComputeStatus Generic::beginVRAMSegment(const char* name)
 {
     if (!name) return ComputeStatus::eInvalidArgument;
-    std::scoped_lock lock(m_mutexVRAM);
-    auto& id = m_currentVRAMSegment[std::this_thread::get_id()];
-    assert(id.empty() || id == kGlobalVRAMSegment);
-    id = name;
+    auto id = m_vramSegments.intern(name);
+    if (id == VRAMSegmentTable::kInvalid)
+    {
+        SL_LOG_WARN_ONCE("Too many VRAM segments, '%s' and any new ones are accounted as '%s' only", name, kGlobalVRAMSegment);
+        id = VRAMSegmentTable::kGlobal;
+    }
+    auto& segment = m_vramContext.getContext().segment;
+    assert(segment == VRAMSegmentTable::kGlobal);
+    segment = id;
     return ComputeStatus::eOk;
 }
 
 ComputeStatus Generic::endVRAMSegment()
 {
-    std::scoped_lock lock(m_mutexVRAM);
-    auto& id = m_currentVRAMSegment[std::this_thread::get_id()];
-    assert(!id.empty() && id != kGlobalVRAMSegment);
-    id = kGlobalVRAMSegment;
+    auto& segment = m_vramContext.getContext().segment;
+    assert(segment != VRAMSegmentTable::kGlobal);
+    segment = VRAMSegmentTable::kGlobal;
     return ComputeStatus::eOk;
 }
 
 ComputeStatus Generic::getAllocatedBytes(uint64_t& bytes, const char* name)
 { 
     bytes = {};
-    std::scoped_lock lock(m_mutexVRAM);
-    auto it = m_vramSegments.find(name);
-    if(it == m_vramSegments.end()) return ComputeStatus::eInvalidArgument;
-    auto& seg = (*it).second;
-    bytes = seg.totalAllocatedSize;
+    if (!name) return ComputeStatus::eInvalidArgument;
+    auto id = m_vramSegments.find(name);
+    if (id == VRAMSegmentTable::kInvalid) return ComputeStatus::eInvalidArgument;
+    bytes = m_vramSegments.getBytes(id);
     return ComputeStatus::eOk; 
 }
 
-Generic::VRAMSegment Generic::manageVRAM(Resource res, VRAMOperation op)
+ComputeStatus Generic::getVRAMSegments(std::vector<VRAMSegmentInfo>& segments)
+{
+    m_vramSegments.getSnapshot(segments);
+    return ComputeStatus::eOk;
+}
+
+void Generic::manageVRAM(Resource res, VRAMOperation op)
 {
     ResourceDescription desc;
     getResourceDescription(res, desc);
     auto sizeInBytes = getResourceSize(res);
     auto name = getDebugName(res);
 
-    std::scoped_lock lock(m_mutexVRAM);
-
-    auto& id = m_currentVRAMSegment[std::this_thread::get_id()];
-    if (id != kGlobalVRAMSegment)
+    // Global segment always tracks everything, current one is per thread and set by 'beginVRAMSegment'
+    auto id = m_vramContext.getContext().segment;
+    auto account = [this, op, sizeInBytes](uint32_t segment)->void
     {
-        auto& seg = m_vramSegments[id];
         if (op == VRAMOperation::eFree)
         {
-            if (seg.allocCount == 0 || seg.totalAllocatedSize < sizeInBytes)
-            {
-                seg = {};
-            }
-            else
-            {
-                seg.allocCount--;
-                seg.totalAllocatedSize -= sizeInBytes;
-            }
-        }
-        else
-        {
-            seg.allocCount++;
-            seg.totalAllocatedSize += sizeInBytes;
-        }
-        
-        SL_LOG_VERBOSE("vram %s [%s %u %.1fMB usage:%.2fGB budget:%.2fGB] resource 0x%llx [%u:%u:%s] - '%S'", op == VRAMOperation::eFree ? "free" : "alloc", id.c_str(), seg.allocCount, 
-            double(seg.totalAllocatedSize / (1024 * 1024)), double(m_vramUsageBytes.load() / (1024 * 1024 * 1024)), double(m_vramBudgetBytes.load() / (1024 * 1024 * 1024)),
-            res->native, desc.width, desc.height, GFORMAT_STR[desc.format], name.c_str());
-    }
-
-    auto& seg = m_vramSegments[kGlobalVRAMSegment];
-    if (op == VRAMOperation::eFree)
-    {
-        if (seg.allocCount == 0 || seg.totalAllocatedSize < sizeInBytes)
-        {
-            seg = {};
+            m_vramSegments.free(segment, sizeInBytes);
         }
         else
         {
-            seg.allocCount--;
-            seg.totalAllocatedSize -= sizeInBytes;
+            m_vramSegments.allocate(segment, sizeInBytes);
         }
-    }
-    else
+    };
+    if (id != VRAMSegmentTable::kGlobal)
     {
-        seg.allocCount++;
-        seg.totalAllocatedSize += sizeInBytes;
+        account(id);
     }
+    account(VRAMSegmentTable::kGlobal);
     
     // Warn if global allocations are over the budget
     auto budgetedBytes = m_vramBudgetBytes.load();
@@ -645,13 +851,9 @@ Generic::VRAMSegment Generic::manageVRAM(Resource res, VRAMOperation op)
         SL_LOG_WARN("Allocated %.2fMB which is more than allowed by the VRAM budget %.2fMB", usedBytes / (1024.0 * 1024.0), budgetedBytes / (1024.0 * 1024.0));
     }
 
-    if (id == kGlobalVRAMSegment)
-    {
-        SL_LOG_VERBOSE("vram %s [%s %u %.1fMB usage:%.2fGB budget:%.2fGB] resource 0x%llx [%u:%u:%s] - '%S'", op == VRAMOperation::eFree ? "free" : "alloc", id.c_str(), seg.allocCount,
-            double(seg.totalAllocatedSize / (1024 * 1024)), double(m_vramUsageBytes.load() / (1024 * 1024 * 1024)), double(m_vramBudgetBytes.load() / (1024 * 1024 * 1024)),
-            res->native, desc.width, desc.height, GFORMAT_STR[desc.format], name.c_str());
-    }
-    return seg;
+    SL_LOG_VERBOSE("vram %s [%s %llu %.1fMB usage:%.2fGB budget:%.2fGB] resource 0x%llx [%u:%u:%s] - '%S'", op == VRAMOperation::eFree ? "free" : "alloc", m_vramSegments.getName(id), m_vramSegments.getAllocCount(id),
+        double(m_vramSegments.getBytes(id) / (1024 * 1024)), double(m_vramUsageBytes.load() / (1024 * 1024 * 1024)), double(m_vramBudgetBytes.load() / (1024 * 1024 * 1024)),
+        res->native, desc.width, desc.height, GFORMAT_STR[desc.format], name.c_str());
 }
 
 ComputeStatus Generic::createBuffer(const ResourceDescription& CreateResourceDesc, Resource& OutResource, const char InFriendlyName[])
@@ -770,6 +972,7 @@ ComputeStatus Generic::destroyResource(Resource resource, uint32_t frameDelay)
 
 ComputeStatus Generic::collectGarbage(uint32_t finishedFrame)
 {
+    SL_PROFILE_SCOPE("chi::collectGarbage");
     if (finishedFrame != UINT_MAX)
     {
         m_finishedFrame.store(finishedFrame);
@@ -28,7 +28,12 @@
 #include <atomic>
 #include <mutex>
 
+#include "source/core/sl.thread/thread.h"
 #include "source/platforms/sl.chi/compute.h"
+#include "source/platforms/sl.chi/kernelCache.h"
+#include "source/platforms/sl.chi/pipelineCache.h"
+#include "source/platforms/sl.chi/transitionBatch.h"
+#include "source/platforms/sl.chi/vramSegments.h"
 
 #if !defined(SL_WINDOWS)
 typedef struct GUID {
@@ -63,7 +68,22 @@ struct KernelDataBase
     size_t hash = {};
     std::string name = {};
     std::string entryPoint = {};
+    //! Local copy, only used when the process-wide kernel cache is not available
     std::vector<uint8_t> kernelBlob = {};
+    //! Copy shared with other plugins, owned by the kernel cache
+    const KernelBlob* sharedBlob = {};
+    IKernelCache* kernelCache = {};
+
+    ~KernelDataBase()
+    {
+        if (kernelCache)
+        {
+            kernelCache->release(sharedBlob);
+        }
+    }
+
+    inline const uint8_t* getBlob() const { return sharedBlob ? sharedBlob->data : kernelBlob.data(); }
+    inline size_t getBlobSize() const { return sharedBlob ? sharedBlob->size : kernelBlob.size(); }
 };
 
 struct TimestampedResource
@@ -95,6 +115,16 @@ struct TimestampedLambda
     uint32_t frameDelay;
 };
 
+//! Per thread transition state, batch stays open between begin/endTransitionBatch
+struct TransitionContext
+{
+    CommandList cmdList{};
+    uint32_t depth{};
+    TransitionBatch pending;
+    //! Used when no batch is open, coalesces a single request
+    TransitionBatch immediate;
+};
+
 enum class VRAMOperation
 {
     eAlloc,
@@ -109,12 +139,22 @@ protected:
 
     std::atomic<uint32_t> m_finishedFrame = 0;
 
+    //! There is no per-frame fence, upload memory uses finished frame index as
+    //! its timeline with the same delay as deferred destruction
+    static constexpr uint32_t kUploadFrameDelay = 3;
+
     Device m_typelessDevice{};
 
     RenderAPI m_platform{};
 
     param::IParameters* m_parameters = {};
 
+    //! Provided by the plugin manager, null when loaded by an older sl.interposer
+    IKernelCache* m_kernelCache = {};
+
+    //! Serialized root signatures and pipelines from previous runs, saved on shutdown
+    PipelineCache m_pipelineCache{};
+
     using ResourceList = std::vector<Resource>;
     using TimestampedResourceList = std::vector<TimestampedResource>;
     using TimestampedLambdaList = std::vector<TimestampedLambda>;
@@ -127,7 +167,6 @@ protected:
     std::mutex m_mutexResource;
     std::mutex m_mutexDynamicText;
     std::mutex m_mutexResourceTrack;
-    std::mutex m_mutexVRAM;
 
     std::atomic<uint64_t> m_vramBudgetBytes{};
     std::atomic<uint64_t> m_vramUsageBytes{};
@@ -142,38 +181,53 @@ protected:
     bool m_bFastUAVClearSupported = false;
     PreferenceFlags m_preferenceFlags{};
 
-    struct VRAMSegment
+    VRAMSegmentTable m_vramSegments;
+    struct VRAMContext
     {
-        uint64_t allocCount{};
-        uint64_t totalAllocatedSize{};
+        //! Segment allocations made on this thread are attributed to, in addition to the global one
+        uint32_t segment = VRAMSegmentTable::kGlobal;
     };
-    std::map<std::string, VRAMSegment> m_vramSegments{};
-    std::map<std::thread::id, std::string> m_currentVRAMSegment{};
+    thread::ThreadContext<VRAMContext> m_vramContext;
 
     std::map<void*, TranslatedResource> m_sharedResourceMap{};
 
+    thread::ThreadContext<TransitionContext> m_transitionContext;
+    //! Set by backends which always transition all subresources
+    bool m_wholeResourceBarriers = false;
+
     virtual int destroyResourceDeferredImpl(const Resource InResource) = 0;
     virtual ComputeStatus createBufferResourceImpl(ResourceDescription &InOutResourceDesc, Resource &OutResource, ResourceState InitialState, const char InFriendlyName[]) = 0;
     virtual ComputeStatus createTexture2DResourceSharedImpl(ResourceDescription &InOutResourceDesc, Resource &OutResource, bool UseNativeFormat, ResourceState InitialState, const char InFriendlyName[]) = 0;
     virtual ComputeStatus insertGPUBarrierList(CommandList cmdList, const Resource* InResources, unsigned int InResourceCount, BarrierType InBarrierType = eBarrierTypeUAV) override;
     virtual ComputeStatus transitionResourceImpl(CommandList cmdList, const ResourceTransition *transisitions, uint32_t count) = 0;
+    //! Records transitions batched on the calling thread for 'cmdList', must be called before recording any work
+    ComputeStatus flushTransitions(CommandList cmdList);
+    TransitionContext& getTransitionContext();
 
     virtual ComputeStatus beginVRAMSegment(const char* name) override final;
     virtual ComputeStatus endVRAMSegment() override final;
     virtual ComputeStatus getAllocatedBytes(uint64_t& bytes, const char* name = kGlobalVRAMSegment) override;
+    virtual ComputeStatus getVRAMSegments(std::vector<VRAMSegmentInfo>& segments) override;
 
     virtual std::wstring getDebugName(Resource res) = 0;
 
     ComputeStatus createTexture2DResourceShared(const ResourceDescription& CreateResourceDesc, Resource& OutResource, bool UseNativeFormat, const char InFriendlyName[]);
     ComputeStatus genericPostInit();
 
+    //! Blob is hashed only once, returned kernel key also covers file and entry point names
+    Kernel getKernelHash(const void* blob, size_t blobSize, const char* fileName, const char* entryPoint, Hash128& blobHash);
+    //! Shares the blob via process-wide cache or keeps a local copy
+    void setKernelBlob(KernelDataBase* data, const void* blob, size_t blobSize, const Hash128& blobHash);
+    //! Cache file is per executable and API, shared by all plugins
+    void loadPipelineCache(const wchar_t* api);
+
     bool savePFM(const std::string &path, const char* srcBuffer, const int width, const int height);
     uint64_t getResourceSize(Resource res);
 
     void setResourceTracked(chi::Resource resource, uint64_t tracked);
     bool isResourceTracked(chi::Resource resource);
 
-    VRAMSegment manageVRAM(Resource res, VRAMOperation op);
+    void manageVRAM(Resource res, VRAMOperation op);
 
 public:
 
@@ -263,6 +317,8 @@ public:
     ComputeStatus restorePipeline(CommandList cmdList)  override { return ComputeStatus::eOk; }
 
     ComputeStatus transitionResources(CommandList cmdList, const ResourceTransition* transitions, uint32_t count, extra::ScopedTasks* tasks = nullptr) override;
+    ComputeStatus beginTransitionBatch(CommandList cmdList) override;
+    ComputeStatus endTransitionBatch(CommandList cmdList) override;
     ComputeStatus getResourceState(Resource resource, ResourceState& state) override;
     ComputeStatus copyResource(CommandList cmdList, Resource dstResource, Resource srcResource) override { return ComputeStatus::eNoImplementation; }
     ComputeStatus cloneResource(Resource inResource, Resource &outResource, const char friendlyName[], ResourceState initialState, unsigned int creationMask, unsigned int visibilityMask) override { return ComputeStatus::eNoImplementation; }
@@ -0,0 +1,353 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SL_KERNEL_HASH_SSE2 1
+#endif
+
+namespace sl
+{
+namespace chi
+{
+
+struct Hash128
+{
+    uint64_t lo{};
+    uint64_t hi{};
+
+    inline bool operator==(const Hash128& rhs) const { return lo == rhs.lo && hi == rhs.hi; }
+    inline bool operator!=(const Hash128& rhs) const { return !(*this == rhs); }
+};
+
+//! 128-bit hash for kernel blobs
+//!
+//! Same structure as XXH3: eight 64-bit lanes consume 64 byte stripes with a
+//! 32x32->64 multiply per lane, lanes are scrambled every 512 bytes and folded
+//! into two 64-bit halves at the end. Stripes are processed two lanes at a time
+//! with SSE2 when available, scalar lanes produce identical results and are
+//! always compiled so both can be checked against each other.
+//!
+//! NOTE: Not bit compatible with XXH3. Keys and checksums are persisted by the pipeline
+//! cache so the output is frozen, any change must bump 'kVersion'. Inputs are read as
+//! little-endian, which covers every supported target.
+namespace hash
+{
+
+//! Part of the pipeline cache compatibility key, files written with another version are ignored
+constexpr uint32_t kVersion = 1;
+
+constexpr uint64_t kPrime32_1 = 0x9E3779B1ull;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ull;
+
+constexpr size_t kStripeSize = 64;
+constexpr size_t kStripesPerBlock = 8;
+constexpr size_t kBlockSize = kStripeSize * kStripesPerBlock;
+constexpr size_t kSecretSize = 128;
+
+struct Secret
+{
+    uint8_t bytes[kSecretSize]{};
+
+    constexpr Secret()
+    {
+        // splitmix64 sequence, any well mixed constant will do
+        uint64_t x = kPrime64_5;
+        for (size_t i = 0; i < kSecretSize; i += 8)
+        {
+            x += 0x9E3779B97F4A7C15ull;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z = z ^ (z >> 31);
+            for (size_t j = 0; j < 8; j++)
+            {
+                bytes[i + j] = uint8_t(z >> (j * 8));
+            }
+        }
+    }
+};
+
+inline const uint8_t* getSecret()
+{
+    static constexpr Secret s_secret{};
+    return s_secret.bytes;
+}
+
+inline uint64_t read64(const void* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t mulFold64(uint64_t a, uint64_t b)
+{
+    // Portable 64x64->128 multiply, only used when finalizing
+    uint64_t aLo = a & 0xffffffff, aHi = a >> 32;
+    uint64_t bLo = b & 0xffffffff, bHi = b >> 32;
+    uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    uint64_t cross = (ll >> 32) + (hl & 0xffffffff) + lh;
+    uint64_t hi = hh + (hl >> 32) + (cross >> 32);
+    uint64_t lo = (cross << 32) | (ll & 0xffffffff);
+    return lo ^ hi;
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    h ^= h >> 32;
+    return h;
+}
+
+struct ScalarLanes
+{
+    static inline void accumulateStripe(uint64_t* acc, const uint8_t* input, const uint8_t* key)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            uint64_t data = read64(input + i * 8);
+            uint64_t dataKey = data ^ read64(key + i * 8);
+            acc[i ^ 1] += data;
+            acc[i] += (dataKey & 0xffffffff) * (dataKey >> 32);
+        }
+    }
+
+    static inline void scramble(uint64_t* acc, const uint8_t* key)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            uint64_t a = acc[i];
+            a ^= a >> 47;
+            a ^= read64(key + i * 8);
+            acc[i] = a * kPrime32_1;
+        }
+    }
+};
+
+#if SL_KERNEL_HASH_SSE2
+struct SSE2Lanes
+{
+    static inline void accumulateStripe(uint64_t* acc, const uint8_t* input, const uint8_t* key)
+    {
+        auto xacc = (__m128i*)acc;
+        for (size_t i = 0; i < kStripeSize / 16; i++)
+        {
+            __m128i data = _mm_loadu_si128((const __m128i*)input + i);
+            __m128i dataKey = _mm_xor_si128(data, _mm_loadu_si128((const __m128i*)key + i));
+            __m128i product = _mm_mul_epu32(dataKey, _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            __m128i a = _mm_loadu_si128(xacc + i);
+            _mm_storeu_si128(xacc + i, _mm_add_epi64(a, _mm_add_epi64(product, swapped)));
+        }
+    }
+
+    static inline void scramble(uint64_t* acc, const uint8_t* key)
+    {
+        auto xacc = (__m128i*)acc;
+        const __m128i prime = _mm_set1_epi32((int)kPrime32_1);
+        for (size_t i = 0; i < kStripeSize / 16; i++)
+        {
+            __m128i a = _mm_loadu_si128(xacc + i);
+            a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+            a = _mm_xor_si128(a, _mm_loadu_si128((const __m128i*)key + i));
+            __m128i productLo = _mm_mul_epu32(a, prime);
+            __m128i productHi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+            _mm_storeu_si128(xacc + i, _mm_add_epi64(productLo, _mm_slli_epi64(productHi, 32)));
+        }
+    }
+};
+using DefaultLanes = SSE2Lanes;
+#else
+using DefaultLanes = ScalarLanes;
+#endif
+
+inline uint64_t mergeAccumulators(const uint64_t* acc, const uint8_t* key, uint64_t start)
+{
+    uint64_t result = start;
+    for (size_t i = 0; i < 4; i++)
+    {
+        result += mulFold64(acc[2 * i] ^ read64(key + 16 * i), acc[2 * i + 1] ^ read64(key + 16 * i + 8));
+    }
+    return avalanche(result);
+}
+
+template<typename Lanes = DefaultLanes>
+inline Hash128 hash128(const void* data, size_t size, uint64_t seed = 0)
+{
+    auto input = (const uint8_t*)data;
+    auto secret = getSecret();
+    alignas(16) uint64_t acc[8] = { kPrime32_1 ^ seed, kPrime64_1, kPrime64_2 + seed, kPrime64_3, kPrime64_4 ^ seed, kPrime32_1, kPrime64_5 - seed, kPrime64_2 };
+
+    // Full blocks
+    size_t offset = 0;
+    while (size - offset > kBlockSize)
+    {
+        for (size_t s = 0; s < kStripesPerBlock; s++)
+        {
+            Lanes::accumulateStripe(acc, input + offset + s * kStripeSize, secret + s * 8);
+        }
+        Lanes::scramble(acc, secret + kSecretSize - kStripeSize);
+        offset += kBlockSize;
+    }
+
+    // Remaining full stripes, last one is always handled below
+    size_t stripe = 0;
+    while (size - offset > kStripeSize)
+    {
+        Lanes::accumulateStripe(acc, input + offset, secret + stripe * 8);
+        offset += kStripeSize;
+        stripe++;
+    }
+
+    // Last stripe overlaps with the previous one, short input is zero padded
+    if (size >= kStripeSize)
+    {
+        Lanes::accumulateStripe(acc, input + size - kStripeSize, secret + kSecretSize - kStripeSize - 7);
+    }
+    else
+    {
+        alignas(16) uint8_t last[kStripeSize]{};
+        if (size)
+        {
+            memcpy(last, input, size);
+        }
+        Lanes::accumulateStripe(acc, last, secret + kSecretSize - kStripeSize - 7);
+    }
+
+    Hash128 h;
+    h.lo = mergeAccumulators(acc, secret + 11, uint64_t(size) * kPrime64_1);
+    h.hi = mergeAccumulators(acc, secret + kSecretSize - kStripeSize - 11, ~(uint64_t(size) * kPrime64_2));
+    return h;
+}
+
+inline uint64_t hash64(const void* data, size_t size, uint64_t seed = 0)
+{
+    auto h = hash128(data, size, seed);
+    return h.lo ^ (h.hi * kPrime64_1);
+}
+
+}
+
+struct Hash128Hasher
+{
+    inline size_t operator()(const Hash128& h) const { return size_t(h.lo); }
+};
+
+//! Immutable kernel blob shared by all chi instances in the process
+struct KernelBlob
+{
+    Hash128 hash{};
+    const uint8_t* data{};
+    size_t size{};
+};
+
+//! Process-wide kernel blob cache
+//!
+//! Owned by the plugin manager and published to plugins via 'param::global::kKernelCache'.
+//! Plugins embedding identical shaders (copy, mvec etc.) end up with one copy
+//! of the blob which is looked up by its 128-bit hash, per device objects like
+//! shader modules or PSOs remain with each chi instance.
+//!
+//! Memory is owned by the implementation, plugins only hold references so
+//! the interface is safe to use across module boundaries.
+class IKernelCache
+{
+public:
+    //! Returns shared blob matching 'hash', 'blob' is copied if not cached yet
+    virtual const KernelBlob* acquire(const Hash128& hash, const void* blob, size_t size) = 0;
+    virtual void release(const KernelBlob* blob) = 0;
+};
+
+class KernelCache : public IKernelCache
+{
+    struct Entry
+    {
+        KernelBlob blob{};
+        std::vector<uint8_t> data;
+        uint32_t refCount{};
+    };
+
+    std::mutex m_mtx;
+    std::unordered_map<Hash128, Entry, Hash128Hasher> m_entries;
+
+public:
+    KernelCache() = default;
+    KernelCache(const KernelCache&) = delete;
+
+    virtual const KernelBlob* acquire(const Hash128& hash, const void* blob, size_t size) override
+    {
+        std::scoped_lock lock(m_mtx);
+        auto& entry = m_entries[hash];
+        if (!entry.refCount)
+        {
+            entry.data.assign((const uint8_t*)blob, (const uint8_t*)blob + size);
+            entry.blob = { hash, entry.data.data(), entry.data.size() };
+        }
+        else if (entry.blob.size != size)
+        {
+            // Should never happen with a 128-bit hash, do not hand out the wrong blob
+            return nullptr;
+        }
+        entry.refCount++;
+        return &entry.blob;
+    }
+
+    virtual void release(const KernelBlob* blob) override
+    {
+        if (!blob) return;
+        std::scoped_lock lock(m_mtx);
+        auto it = m_entries.find(blob->hash);
+        if (it != m_entries.end() && --it->second.refCount == 0)
+        {
+            m_entries.erase(it);
+        }
+    }
+
+    size_t getBlobCount()
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_entries.size();
+    }
+
+    void clear()
+    {
+        std::scoped_lock lock(m_mtx);
+        m_entries.clear();
+    }
+};
+
+}
+}
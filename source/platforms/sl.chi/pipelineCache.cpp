@@ -0,0 +1,332 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "source/core/sl.log/log.h"
+#include "source/core/sl.file/file.h"
+#include "source/platforms/sl.chi/pipelineCache.h"
+
+namespace sl
+{
+namespace chi
+{
+
+//! 'SLPC'
+constexpr uint32_t kPipelineCacheMagic = 0x534c5043;
+//! Bump when the layout of the cache file changes
+constexpr uint32_t kPipelineCacheFormat = 1;
+
+#pragma pack(push, 1)
+struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t format;
+    uint64_t compatibilityHash;
+    uint32_t session;
+    uint32_t entryCount;
+};
+
+struct PipelineCacheEntryHeader
+{
+    uint64_t keyLo;
+    uint64_t keyHi;
+    uint32_t type;
+    uint32_t lastSession;
+    uint64_t size;
+    uint64_t checksum;
+};
+#pragma pack(pop)
+
+bool PipelineCache::readFile(EntryMap& entries, uint32_t& session)
+{
+    if (!file::exists(m_cacheFile.wstring().c_str()))
+    {
+        return false;
+    }
+
+    file::MappedView view(m_cacheFile.wstring().c_str());
+    auto p = view.data();
+    auto end = p + view.size();
+    PipelineCacheFileHeader header{};
+    if (view.size() < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, p, sizeof(header));
+    p += sizeof(header);
+    if (header.magic != kPipelineCacheMagic || header.format != kPipelineCacheFormat || header.compatibilityHash != m_compatibilityHash)
+    {
+        SL_LOG_INFO("Pipeline cache '%S' is out of date, ignoring", m_cacheFile.wstring().c_str());
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.entryCount; i++)
+    {
+        PipelineCacheEntryHeader entryHeader{};
+        if (size_t(end - p) < sizeof(entryHeader))
+        {
+            break;
+        }
+        memcpy(&entryHeader, p, sizeof(entryHeader));
+        p += sizeof(entryHeader);
+        if (entryHeader.size > uint64_t(end - p))
+        {
+            break;
+        }
+        if (entryHeader.type > (uint32_t)PipelineCacheEntryType::eDriverCache || hash::hash64(p, (size_t)entryHeader.size) != entryHeader.checksum)
+        {
+            SL_LOG_WARN("Pipeline cache '%S' has corrupted entry %u, skipping", m_cacheFile.wstring().c_str(), i);
+            p += entryHeader.size;
+            continue;
+        }
+        auto& entry = entries[{ { entryHeader.keyLo, entryHeader.keyHi }, (PipelineCacheEntryType)entryHeader.type }];
+        entry.data.assign(p, p + entryHeader.size);
+        entry.lastSession = entryHeader.lastSession;
+        p += entryHeader.size;
+    }
+    session = header.session;
+    return true;
+}
+
+bool PipelineCache::load(const std::filesystem::path& cacheFile, const std::string& compatibilityKey, const PipelineCacheLimits& limits)
+{
+    std::scoped_lock lock(m_mtx);
+    m_cacheFile = cacheFile;
+    // Keys and checksums come from 'hash', a different algorithm must not match old entries
+    m_compatibilityHash = hash::hash64(compatibilityKey.data(), compatibilityKey.size(), hash::kVersion);
+    m_limits = limits;
+    m_entries.clear();
+    m_removed.clear();
+    m_dirty = false;
+
+    uint32_t session = 0;
+    bool loaded = readFile(m_entries, session);
+    m_session = session + 1;
+    if (loaded)
+    {
+        SL_LOG_VERBOSE("Loaded %llu pipeline cache entries from '%S'", (uint64_t)m_entries.size(), m_cacheFile.wstring().c_str());
+    }
+    return loaded;
+}
+
+void PipelineCache::evict()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (m_session - std::min(m_session, it->second.lastSession) > m_limits.maxIdleSessions)
+        {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    uint64_t totalBytes = 0;
+    std::vector<EntryMap::iterator> byAge;
+    for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+    {
+        totalBytes += it->second.data.size() + sizeof(PipelineCacheEntryHeader);
+        byAge.push_back(it);
+    }
+    if (totalBytes + sizeof(PipelineCacheFileHeader) <= m_limits.maxBytes)
+    {
+        return;
+    }
+    std::stable_sort(byAge.begin(), byAge.end(), [](const EntryMap::iterator& a, const EntryMap::iterator& b)->bool
+    {
+        return a->second.lastSession < b->second.lastSession;
+    });
+    for (auto& it : byAge)
+    {
+        if (totalBytes + sizeof(PipelineCacheFileHeader) <= m_limits.maxBytes)
+        {
+            break;
+        }
+        totalBytes -= it->second.data.size() + sizeof(PipelineCacheEntryHeader);
+        m_entries.erase(it);
+        m_dirty = true;
+    }
+}
+
+bool PipelineCache::save()
+{
+    std::scoped_lock lock(m_mtx);
+    if (m_cacheFile.empty())
+    {
+        return false;
+    }
+
+    // Other chi instances may have saved since we loaded, keep their entries
+    EntryMap onDisk;
+    uint32_t diskSession = 0;
+    if (readFile(onDisk, diskSession))
+    {
+        for (auto& [key, entry] : onDisk)
+        {
+            if (std::find_if(m_removed.begin(), m_removed.end(), [&key](const EntryKey& k)->bool { return !(k < key) && !(key < k); }) != m_removed.end())
+            {
+                continue;
+            }
+            auto it = m_entries.find(key);
+            if (it == m_entries.end())
+            {
+                m_entries[key] = std::move(entry);
+            }
+            else
+            {
+                it->second.lastSession = std::max(it->second.lastSession, entry.lastSession);
+            }
+        }
+    }
+    else
+    {
+        // Missing or stale file must be replaced
+        m_dirty = true;
+    }
+
+    evict();
+
+    if (!m_dirty)
+    {
+        return true;
+    }
+
+    if (!file::createDirectoryRecursively(m_cacheFile.parent_path().wstring().c_str()))
+    {
+        return false;
+    }
+
+    // Write next to the cache and swap so readers never see a partial file
+    auto tmpFile = m_cacheFile;
+    tmpFile += L".tmp";
+    auto f = file::open(tmpFile.wstring().c_str(), L"wb");
+    if (!f)
+    {
+        SL_LOG_WARN("Failed to write pipeline cache '%S'", tmpFile.wstring().c_str());
+        return false;
+    }
+    PipelineCacheFileHeader header{ kPipelineCacheMagic, kPipelineCacheFormat, m_compatibilityHash, std::max(m_session, diskSession), (uint32_t)m_entries.size() };
+    bool success = file::writeChunk(f, &header, sizeof(header)) == sizeof(header);
+    for (auto& [key, entry] : m_entries)
+    {
+        if (!success) break;
+        PipelineCacheEntryHeader entryHeader{ key.hash.lo, key.hash.hi, (uint32_t)key.type, entry.lastSession, entry.data.size(), hash::hash64(entry.data.data(), entry.data.size()) };
+        success = file::writeChunk(f, &entryHeader, sizeof(entryHeader)) == sizeof(entryHeader) &&
+            file::writeChunk(f, entry.data.data(), entry.data.size()) == entry.data.size();
+    }
+    file::close(f);
+
+    std::error_code ec;
+    if (success)
+    {
+        fs::rename(tmpFile, m_cacheFile, ec);
+        success = !ec;
+    }
+    if (!success)
+    {
+        SL_LOG_WARN("Failed to write pipeline cache '%S' %s", m_cacheFile.wstring().c_str(), ec.message().c_str());
+        fs::remove(tmpFile, ec);
+        return false;
+    }
+    SL_LOG_VERBOSE("Saved %llu pipeline cache entries to '%S'", (uint64_t)m_entries.size(), m_cacheFile.wstring().c_str());
+    m_dirty = false;
+    return true;
+}
+
+bool PipelineCache::find(const Hash128& key, PipelineCacheEntryType type, std::vector<uint8_t>& data)
+{
+    std::scoped_lock lock(m_mtx);
+    auto it = m_entries.find({ key, type });
+    if (it == m_entries.end())
+    {
+        return false;
+    }
+    if (it->second.lastSession != m_session)
+    {
+        it->second.lastSession = m_session;
+        m_dirty = true;
+    }
+    data = it->second.data;
+    return true;
+}
+
+bool PipelineCache::findOnDisk(const Hash128& key, PipelineCacheEntryType type, std::vector<uint8_t>& data)
+{
+    std::scoped_lock lock(m_mtx);
+    EntryMap onDisk;
+    uint32_t diskSession = 0;
+    if (!readFile(onDisk, diskSession))
+    {
+        return false;
+    }
+    auto it = onDisk.find({ key, type });
+    if (it == onDisk.end())
+    {
+        return false;
+    }
+    data = std::move(it->second.data);
+    return true;
+}
+
+void PipelineCache::update(const Hash128& key, PipelineCacheEntryType type, const void* data, size_t size)
+{
+    std::scoped_lock lock(m_mtx);
+    auto& entry = m_entries[{ key, type }];
+    entry.data.assign((const uint8_t*)data, (const uint8_t*)data + size);
+    entry.lastSession = m_session;
+    m_removed.erase(std::remove_if(m_removed.begin(), m_removed.end(), [&key, type](const EntryKey& k)->bool { return k.hash == key && k.type == type; }), m_removed.end());
+    m_dirty = true;
+}
+
+void PipelineCache::remove(const Hash128& key, PipelineCacheEntryType type)
+{
+    std::scoped_lock lock(m_mtx);
+    if (m_entries.erase({ key, type }))
+    {
+        m_removed.push_back({ key, type });
+        m_dirty = true;
+    }
+}
+
+size_t PipelineCache::getEntryCount()
+{
+    std::scoped_lock lock(m_mtx);
+    return m_entries.size();
+}
+
+uint64_t PipelineCache::getTotalBytes()
+{
+    std::scoped_lock lock(m_mtx);
+    uint64_t total = 0;
+    for (auto& [key, entry] : m_entries)
+    {
+        total += entry.data.size();
+    }
+    return total;
+}
+
+}
+}
@@ -0,0 +1,130 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "source/platforms/sl.chi/kernelCache.h"
+
+namespace sl
+{
+namespace chi
+{
+
+enum class PipelineCacheEntryType : uint32_t
+{
+    //! Serialized root signature, keyed by root signature hash
+    eRootSignature,
+    //! Driver specific pipeline blob (D3D12 cached PSO), keyed by kernel and root signature hash
+    ePipeline,
+    //! Opaque driver cache covering all pipelines (VkPipelineCache data)
+    eDriverCache,
+};
+
+struct PipelineCacheLimits
+{
+    uint64_t maxBytes = 32 * 1024 * 1024;
+    uint32_t maxIdleSessions = 16;
+};
+
+//! Persistent cache of serialized root signatures and pipelines
+//!
+//! Index and blobs live in a single versioned file. Every chi instance in the
+//! process (one per plugin) loads the same file and merges its entries back on
+//! save, so kernels shared by plugins are stored once. Blobs are checksummed,
+//! anything truncated or produced by a different SL build is discarded.
+//!
+//! Driver blobs are validated by the driver as well (D3D12 cached PSO and
+//! VkPipelineCache headers), backends must drop entries which get rejected.
+//!
+//! Eviction: entries not used in 'maxIdleSessions' saves are dropped, then
+//! least recently used ones until the file fits in 'maxBytes'.
+//!
+//! Does not depend on any graphics API. Thread safe.
+class PipelineCache
+{
+public:
+    //! Reads cache from disk, returns false if there was nothing valid to load
+    //!
+    //! Files written with a different 'compatibilityKey' or 'hash::kVersion' are ignored.
+    bool load(const std::filesystem::path& cacheFile, const std::string& compatibilityKey, const PipelineCacheLimits& limits = {});
+    //! Merges with the current file on disk, applies eviction and writes if anything changed
+    bool save();
+
+    bool find(const Hash128& key, PipelineCacheEntryType type, std::vector<uint8_t>& data);
+    //! Reads entry from the file as saved by other chi instances since 'load', used to merge driver caches
+    bool findOnDisk(const Hash128& key, PipelineCacheEntryType type, std::vector<uint8_t>& data);
+    void update(const Hash128& key, PipelineCacheEntryType type, const void* data, size_t size);
+    //! Drops an entry which was rejected by the driver
+    void remove(const Hash128& key, PipelineCacheEntryType type);
+
+    size_t getEntryCount();
+    uint64_t getTotalBytes();
+
+    static inline Hash128 makeKey(uint64_t kernelHash, uint64_t bindingHash)
+    {
+        return { kernelHash, bindingHash };
+    }
+
+private:
+    struct EntryKey
+    {
+        Hash128 hash{};
+        PipelineCacheEntryType type{};
+
+        inline bool operator<(const EntryKey& rhs) const
+        {
+            if (hash.lo != rhs.hash.lo) return hash.lo < rhs.hash.lo;
+            if (hash.hi != rhs.hash.hi) return hash.hi < rhs.hash.hi;
+            return type < rhs.type;
+        }
+    };
+
+    struct Entry
+    {
+        std::vector<uint8_t> data;
+        uint32_t lastSession{};
+    };
+
+    using EntryMap = std::map<EntryKey, Entry>;
+
+    bool readFile(EntryMap& entries, uint32_t& session);
+    void evict();
+
+    std::mutex m_mtx;
+    std::filesystem::path m_cacheFile{};
+    uint64_t m_compatibilityHash{};
+    PipelineCacheLimits m_limits{};
+    uint32_t m_session{};
+    EntryMap m_entries;
+    //! Removed during this session, must not come back when merging with the file
+    std::vector<EntryKey> m_removed;
+    bool m_dirty = false;
+};
+
+}
+}
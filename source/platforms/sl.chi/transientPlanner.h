@@ -0,0 +1,184 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <functional>
+
+namespace sl
+{
+namespace chi
+{
+
+//! Assigns transient resources to physical slots so resources with disjoint lifetimes alias
+//!
+//! Each request has a compatibility key (only identical descriptions can share a
+//! resource), a size and an inclusive [firstUse, lastUse] range of use points within
+//! the frame. Per key this is interval graph coloring: requests are visited by first
+//! use and take the lowest free slot, slots become free once past their last use.
+//! The number of slots equals the largest number of overlapping lifetimes which is optimal.
+//!
+//! Taking the lowest free slot keeps assignments stable between frames declaring the
+//! same resources so physical resources are not shuffled around.
+//!
+//! Does not depend on any graphics API.
+class TransientPlanner
+{
+public:
+    static constexpr uint32_t kInvalidSlot = ~0u;
+
+    struct Request
+    {
+        uint64_t key{};
+        uint64_t size{};
+        uint32_t firstUse{};
+        uint32_t lastUse{};
+    };
+
+    struct Slot
+    {
+        uint64_t key{};
+        uint64_t size{};
+        //! Index among slots with the same key
+        uint32_t index{};
+    };
+
+private:
+    std::vector<Request> m_requests;
+    std::vector<uint32_t> m_assignment;
+    std::vector<Slot> m_slots;
+
+public:
+    void clear()
+    {
+        m_requests.clear();
+        m_assignment.clear();
+        m_slots.clear();
+    }
+
+    //! Returns request index
+    uint32_t add(const Request& request)
+    {
+        m_requests.push_back(request);
+        return (uint32_t)m_requests.size() - 1;
+    }
+
+    //! Ends a lifetime early, once known, so requests added later can alias it
+    //!
+    //! Assignments of the other requests do not change as long as none of them
+    //! has its first use after 'lastUse'.
+    void setLastUse(uint32_t request, uint32_t lastUse)
+    {
+        if (request < m_requests.size())
+        {
+            m_requests[request].lastUse = lastUse;
+        }
+    }
+
+    //! Returns false if any request has its last use before the first one
+    bool plan()
+    {
+        m_slots.clear();
+        m_assignment.assign(m_requests.size(), kInvalidSlot);
+        for (auto& r : m_requests)
+        {
+            if (r.lastUse < r.firstUse)
+            {
+                return false;
+            }
+        }
+
+        std::vector<uint32_t> order(m_requests.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)->bool
+        {
+            auto& ra = m_requests[a];
+            auto& rb = m_requests[b];
+            if (ra.key != rb.key) return ra.key < rb.key;
+            return ra.firstUse < rb.firstUse;
+        });
+
+        using Busy = std::pair<uint32_t, uint32_t>; // last use, slot
+        std::priority_queue<Busy, std::vector<Busy>, std::greater<Busy>> busy;
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> free;
+        uint32_t keySlotCount = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            auto& r = m_requests[order[i]];
+            if (i == 0 || r.key != m_requests[order[i - 1]].key)
+            {
+                busy = {};
+                free = {};
+                keySlotCount = 0;
+            }
+            while (!busy.empty() && busy.top().first < r.firstUse)
+            {
+                free.push(busy.top().second);
+                busy.pop();
+            }
+            uint32_t slot;
+            if (free.empty())
+            {
+                slot = (uint32_t)m_slots.size();
+                m_slots.push_back({ r.key, r.size, keySlotCount++ });
+            }
+            else
+            {
+                slot = free.top();
+                free.pop();
+                m_slots[slot].size = std::max(m_slots[slot].size, r.size);
+            }
+            m_assignment[order[i]] = slot;
+            busy.push({ r.lastUse, slot });
+        }
+        return true;
+    }
+
+    inline uint32_t getRequestCount() const { return (uint32_t)m_requests.size(); }
+    inline const Request& getRequest(uint32_t request) const { return m_requests[request]; }
+    //! Valid after 'plan', index into 'getSlots'
+    inline uint32_t getSlot(uint32_t request) const { return request < m_assignment.size() ? m_assignment[request] : kInvalidSlot; }
+    inline const std::vector<Slot>& getSlots() const { return m_slots; }
+
+    uint64_t getRequestedBytes() const
+    {
+        uint64_t total = 0;
+        for (auto& r : m_requests) total += r.size;
+        return total;
+    }
+
+    uint64_t getAllocatedBytes() const
+    {
+        uint64_t total = 0;
+        for (auto& s : m_slots) total += s.size;
+        return total;
+    }
+};
+
+}
+}
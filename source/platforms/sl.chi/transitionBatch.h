@@ -0,0 +1,127 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <vector>
+
+#include "source/platforms/sl.chi/compute.h"
+
+namespace sl
+{
+namespace chi
+{
+
+//! Accumulates resource transitions which are recorded as a single barrier batch
+//!
+//! Requests are coalesced as they come in:
+//!
+//! - transitions between compatible states (from & to) are dropped
+//! - consecutive transitions of the same subresource are chained into one (A->B, B->C becomes A->C)
+//! - chains which end up in a compatible state again are removed (A->B, B->A)
+//! - with whole resource barriers (backend ignores subresources) per subresource requests are merged
+//!
+//! Nothing may read or write a pending resource until the batch is flushed, backends
+//! flush before any dispatch, copy, clear or barrier. Order of requests is preserved.
+//!
+//! Does not depend on any graphics API, 'from' state must be resolved before adding.
+class TransitionBatch
+{
+    std::vector<ResourceTransition> m_transitions;
+    bool m_wholeResource = false;
+    uint32_t m_requested{};
+
+    static inline bool isNoOp(ResourceState from, ResourceState to)
+    {
+        return from == to || (from & to) != 0;
+    }
+
+public:
+    //! Vulkan barriers always cover all subresources
+    inline void setWholeResourceBarriers(bool value) { m_wholeResource = value; }
+
+    void add(const ResourceTransition& tr)
+    {
+        m_requested++;
+
+        // Only the most recent pending transition of a subresource can be extended, going past
+        // one covering all subresources would change the order in which they reach their states
+        for (size_t i = m_transitions.size(); i-- > 0;)
+        {
+            auto& prev = m_transitions[i];
+            if (prev.resource != tr.resource)
+            {
+                continue;
+            }
+            if (prev.subresource != tr.subresource && !m_wholeResource)
+            {
+                if (prev.subresource == kAllSubResources || tr.subresource == kAllSubResources)
+                {
+                    break;
+                }
+                continue;
+            }
+            // Intermediate state is never observed so start from where the resource was before the batch
+            prev.to = tr.to;
+            if (isNoOp(prev.from, prev.to))
+            {
+                m_transitions.erase(m_transitions.begin() + i);
+            }
+            return;
+        }
+
+        if (isNoOp(tr.from, tr.to))
+        {
+            return;
+        }
+        m_transitions.push_back(tr);
+        if (m_wholeResource)
+        {
+            m_transitions.back().subresource = kAllSubResources;
+        }
+    }
+
+    inline void add(const ResourceTransition* transitions, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            add(transitions[i]);
+        }
+    }
+
+    //! Capacity is kept so steady state does not allocate
+    inline void clear()
+    {
+        m_transitions.clear();
+        m_requested = 0;
+    }
+
+    inline bool empty() const { return m_transitions.empty(); }
+    inline const ResourceTransition* getTransitions() const { return m_transitions.data(); }
+    inline uint32_t getCount() const { return (uint32_t)m_transitions.size(); }
+    //! Number of transitions requested since last clear, including the ones coalesced away
+    inline uint32_t getRequestedCount() const { return m_requested; }
+};
+
+}
+}
@@ -0,0 +1,234 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace sl
+{
+namespace chi
+{
+
+//! Linear allocator for data uploaded every dispatch (constants)
+//!
+//! Mapped upload pages come from the backend. Allocations are carved linearly
+//! out of the open page, once full the page is retired with the highest fence
+//! value it was used with and reused after that value completes. Requests larger
+//! than a page get a dedicated page which is destroyed once completed.
+//!
+//! Unlike a ring per kernel nothing is overwritten while in flight, if the GPU
+//! falls behind more pages are created. Memory is shared by all kernels.
+//!
+//! Buffer type and operations are provided by the backend so the allocator
+//! can be exercised with simulated fences. Thread safe.
+template<typename Buffer>
+class UploadAllocator
+{
+public:
+    struct Allocation
+    {
+        Buffer buffer{};
+        uint64_t offset{};
+        uint8_t* cpu{};
+    };
+
+    using PFunCreateBuffer = std::function<bool(uint64_t size, Buffer& buffer, uint8_t*& mapped)>;
+    using PFunDestroyBuffer = std::function<void(Buffer buffer)>;
+
+private:
+    struct Page
+    {
+        Buffer buffer{};
+        uint8_t* mapped{};
+        uint64_t size{};
+        uint64_t used{};
+        uint64_t fence{};
+    };
+
+    std::mutex m_mtx;
+    std::vector<std::unique_ptr<Page>> m_pages;
+    //! Pages which can take new allocations
+    std::vector<Page*> m_free;
+    //! Waiting for the GPU
+    std::vector<Page*> m_retired;
+    Page* m_open{};
+    uint64_t m_pageSize{};
+    uint32_t m_maxFreePages{};
+    uint64_t m_completed{};
+    PFunCreateBuffer m_create;
+    PFunDestroyBuffer m_destroy;
+
+    void destroyPageLocked(Page* page)
+    {
+        m_destroy(page->buffer);
+        for (auto it = m_pages.begin(); it != m_pages.end(); it++)
+        {
+            if (it->get() == page)
+            {
+                m_pages.erase(it);
+                break;
+            }
+        }
+    }
+
+    void recycleLocked()
+    {
+        auto it = m_retired.begin();
+        while (it != m_retired.end())
+        {
+            auto page = *it;
+            if (page->fence <= m_completed)
+            {
+                it = m_retired.erase(it);
+                if (page->size > m_pageSize)
+                {
+                    destroyPageLocked(page);
+                }
+                else
+                {
+                    page->used = 0;
+                    m_free.push_back(page);
+                }
+            }
+            else
+            {
+                it++;
+            }
+        }
+        // Give back memory after a spike or a GPU stall
+        while (m_free.size() > m_maxFreePages)
+        {
+            destroyPageLocked(m_free.back());
+            m_free.pop_back();
+        }
+    }
+
+    Page* createPageLocked(uint64_t size)
+    {
+        auto page = std::make_unique<Page>();
+        page->size = size;
+        if (!m_create(size, page->buffer, page->mapped) || !page->mapped)
+        {
+            return nullptr;
+        }
+        m_pages.push_back(std::move(page));
+        return m_pages.back().get();
+    }
+
+    static inline uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+public:
+    UploadAllocator(const PFunCreateBuffer& create, const PFunDestroyBuffer& destroy, uint64_t pageSize = 256 * 1024, uint32_t maxFreePages = 8) :
+        m_pageSize(pageSize), m_maxFreePages(maxFreePages), m_create(create), m_destroy(destroy) {}
+
+    UploadAllocator(const UploadAllocator&) = delete;
+
+    ~UploadAllocator() { destroy(); }
+
+    //! Allocates 'size' bytes aligned to 'alignment' (power of two), memory is in use by the GPU until 'fence' completes
+    bool allocate(uint64_t size, uint64_t alignment, uint64_t fence, Allocation& allocation)
+    {
+        std::scoped_lock lock(m_mtx);
+        if (size > m_pageSize)
+        {
+            // Dedicated page, retired right away so open page is not wasted
+            recycleLocked();
+            auto page = createPageLocked(alignUp(size, alignment));
+            if (!page) return false;
+            page->used = size;
+            page->fence = fence;
+            m_retired.push_back(page);
+            allocation = { page->buffer, 0, page->mapped };
+            return true;
+        }
+        if (!m_open || alignUp(m_open->used, alignment) + size > m_open->size)
+        {
+            if (m_open)
+            {
+                m_retired.push_back(m_open);
+                m_open = {};
+            }
+            recycleLocked();
+
+            Page* page{};
+            if (m_free.empty())
+            {
+                page = createPageLocked(m_pageSize);
+                if (!page) return false;
+            }
+            else
+            {
+                page = m_free.back();
+                m_free.pop_back();
+            }
+            m_open = page;
+        }
+        auto offset = alignUp(m_open->used, alignment);
+        m_open->used = offset + size;
+        m_open->fence = std::max(m_open->fence, fence);
+        allocation = { m_open->buffer, offset, m_open->mapped + offset };
+        return true;
+    }
+
+    //! All work with fence values up to and including 'completed' is done
+    void setCompletedValue(uint64_t completed)
+    {
+        std::scoped_lock lock(m_mtx);
+        if (completed > m_completed)
+        {
+            m_completed = completed;
+            recycleLocked();
+        }
+    }
+
+    size_t getPageCount()
+    {
+        std::scoped_lock lock(m_mtx);
+        return m_pages.size();
+    }
+
+    void destroy()
+    {
+        std::scoped_lock lock(m_mtx);
+        for (auto& page : m_pages)
+        {
+            m_destroy(page->buffer);
+        }
+        m_pages.clear();
+        m_free.clear();
+        m_retired.clear();
+        m_open = {};
+    }
+};
+
+}
+}
@@ -0,0 +1,175 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+
+#include "source/platforms/sl.chi/compute.h"
+
+namespace sl
+{
+namespace chi
+{
+
+//! VRAM attribution by segment (plugin, resource pool) without locking on allocation
+//!
+//! Segment names are interned once, allocations are then attributed by id with a
+//! few atomic operations instead of string keyed lookups under a mutex. Counters
+//! live in fixed storage and segments are never removed so names and ids can be
+//! read from any thread without locking. Peak is the highest usage reached by any
+//! update, exact since every update sees the running total.
+//!
+//! Does not depend on any graphics API. Thread safe.
+class VRAMSegmentTable
+{
+public:
+    static constexpr uint32_t kGlobal = 0;
+    static constexpr uint32_t kMaxSegments = 64;
+    static constexpr uint32_t kInvalid = ~0u;
+
+private:
+    struct Segment
+    {
+        std::string name;
+        std::atomic<uint64_t> allocCount{};
+        std::atomic<uint64_t> bytes{};
+        std::atomic<uint64_t> peakBytes{};
+    };
+
+    //! Only taken when interning
+    std::mutex m_mtx;
+    Segment m_segments[kMaxSegments];
+    std::atomic<uint32_t> m_count{};
+
+    template<typename F>
+    static inline uint64_t update(std::atomic<uint64_t>& value, F&& op)
+    {
+        uint64_t current = value.load(std::memory_order_relaxed);
+        uint64_t next = op(current);
+        while (!value.compare_exchange_weak(current, next, std::memory_order_relaxed))
+        {
+            next = op(current);
+        }
+        return next;
+    }
+
+public:
+    VRAMSegmentTable()
+    {
+        m_segments[kGlobal].name = kGlobalVRAMSegment;
+        m_count.store(1);
+    }
+
+    VRAMSegmentTable(const VRAMSegmentTable&) = delete;
+
+    //! Returns kInvalid if not interned yet
+    uint32_t find(const char* name) const
+    {
+        auto count = m_count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (m_segments[i].name == name)
+            {
+                return i;
+            }
+        }
+        return kInvalid;
+    }
+
+    //! Returns kInvalid if all segments are taken
+    uint32_t intern(const char* name)
+    {
+        auto id = find(name);
+        if (id != kInvalid)
+        {
+            return id;
+        }
+        std::scoped_lock lock(m_mtx);
+        id = find(name);
+        if (id != kInvalid)
+        {
+            return id;
+        }
+        auto count = m_count.load();
+        if (count == kMaxSegments)
+        {
+            return kInvalid;
+        }
+        // Name must be in place before the id becomes visible to 'find'
+        m_segments[count].name = name;
+        m_count.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    void allocate(uint32_t id, uint64_t bytes)
+    {
+        auto& s = m_segments[id];
+        s.allocCount.fetch_add(1, std::memory_order_relaxed);
+        auto current = s.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        update(s.peakBytes, [current](uint64_t peak)->uint64_t { return std::max(peak, current); });
+    }
+
+    void free(uint32_t id, uint64_t bytes)
+    {
+        // Resources can be freed in a different segment than the one they were allocated in, never go below zero
+        auto& s = m_segments[id];
+        update(s.allocCount, [](uint64_t count)->uint64_t { return count ? count - 1 : 0; });
+        update(s.bytes, [bytes](uint64_t current)->uint64_t { return current > bytes ? current - bytes : 0; });
+    }
+
+    inline uint32_t getCount() const { return m_count.load(std::memory_order_acquire); }
+    inline const char* getName(uint32_t id) const { return m_segments[id].name.c_str(); }
+    inline uint64_t getAllocCount(uint32_t id) const { return m_segments[id].allocCount.load(std::memory_order_relaxed); }
+    inline uint64_t getBytes(uint32_t id) const { return m_segments[id].bytes.load(std::memory_order_relaxed); }
+    inline uint64_t getPeakBytes(uint32_t id) const { return m_segments[id].peakBytes.load(std::memory_order_relaxed); }
+
+    void getSnapshot(std::vector<VRAMSegmentInfo>& segments) const
+    {
+        auto count = getCount();
+        segments.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            segments[i] = { m_segments[i].name, getAllocCount(i), getBytes(i), getPeakBytes(i) };
+        }
+    }
+
+    //! Zeroes counters, names and ids are kept
+    void reset()
+    {
+        for (auto& s : m_segments)
+        {
+            s.allocCount.store(0);
+            s.bytes.store(0);
+            s.peakBytes.store(0);
+        }
+    }
+};
+
+}
+}
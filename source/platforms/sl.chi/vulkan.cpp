@@ -21,6 +21,7 @@
 */
 
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/platforms/sl.chi/vulkan.h"
 #include "source/core/sl.param/parameters.h"
 #include "source/core/sl.security/secureLoadLibrary.h"
@@ -36,6 +37,9 @@
 #define VK_CHECK_RE(res, f) res = f;if(res < 0){SL_LOG_ERROR("%s failed - error %d",#f,res); return res;} else if(res != 0) {SL_LOG_WARN("%s - warning %d",#f,res);}
 #define VK_CHECK_RWS(f) {auto _r = f;if(_r < 0){SL_LOG_ERROR("%s failed - error %d",#f,_r); return WaitStatus::eError;} else if(_r == VK_TIMEOUT) {SL_LOG_WARN("%s - timed out", #f); return WaitStatus::eTimeout;}}
 
+// Same limit as kMaxSemaphoreWaitUs for waits going through the fence timeline
+constexpr uint32_t kMaxSemaphoreWaitMs = 500;
+
 #define CHECK_REFLEX() do { if (!m_reflex){ SL_LOG_WARN_ONCE("No reflex"); return ComputeStatus::eError; } } while(false)
 
 namespace sl
@@ -75,6 +79,7 @@ class CommandListContextVK : public ICommandListContext
         uint64_t value;
     };
     std::vector<WaitInfo> m_waitingQueue;
+    std::shared_ptr<FenceTimeline> m_timeline;
 
     VkLayerDispatchTable m_ddt;
     interposer::VkTable* m_vk;
@@ -104,9 +109,10 @@ class CommandListContextVK : public ICommandListContext
 
 public:
 
-    void init(ICompute* c, interposer::VkTable* vkMap, const char* debugName, VkDevice dev, CommandQueueVk* queue, uint32_t count)
+    void init(ICompute* c, interposer::VkTable* vkMap, const char* debugName, VkDevice dev, CommandQueueVk* queue, uint32_t count, const std::shared_ptr<FenceTimeline>& timeline)
     {
         m_compute = c;
+        m_timeline = timeline;
         m_device = dev;
         m_vk = vkMap;
         m_ddt = m_vk->dispatchDeviceMap[dev];
@@ -170,6 +176,7 @@ public:
                 VK_CHECK_RV(m_ddt.CreateSemaphore(dev, &createInfo, NULL, &m_fence[i]));
 
                 m_fenceValue[i] = 0;
+                m_timeline->registerFence(m_fence[i]);
 
                 sl::Resource r;
                 r.native = m_fence[i];
@@ -208,6 +215,7 @@ public:
         {
             m_ddt.FreeCommandBuffers(m_device, m_allocator[i], 1, &m_cmdBuffer[i]);
             m_ddt.DestroyCommandPool(m_device, m_allocator[i], nullptr);
+            m_timeline->unregisterFence(m_fence[i]);
             m_ddt.DestroySemaphore(m_device, m_fence[i], nullptr);
             m_ddt.DestroyFence(m_device, m_acquireFence[i], NULL);
             m_ddt.DestroySemaphore(m_device, m_acquireSemaphore[i], nullptr);
@@ -260,18 +268,14 @@ public:
         auto idx = m_index;
         auto syncValue = m_fenceValue[m_index];
         
-        uint64_t completedValue;
-        VK_CHECK_RF(m_ddt.GetSemaphoreCounterValue(m_device, m_fence[idx], &completedValue));
-        if (completedValue < syncValue)
+        auto status = m_timeline->wait(m_fence[idx], syncValue, kMaxSemaphoreWaitMs);
+        if (status == WaitStatus::eError)
+        {
+            return false;
+        }
+        else if (status == WaitStatus::eTimeout)
         {
-            VkSemaphoreWaitInfo waitInfo;
-            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-            waitInfo.pNext = NULL;
-            waitInfo.flags = 0;
-            waitInfo.semaphoreCount = 1;
-            waitInfo.pSemaphores = &m_fence[idx];
-            waitInfo.pValues = &syncValue;
-            VK_CHECK_RF(m_ddt.WaitSemaphores(m_device, &waitInfo, kMaxSemaphoreWaitUs));
+            SL_LOG_WARN("Wait on '%S' index %u value %llu timed out", m_name.c_str(), idx, syncValue);
         }
 
         // One time usage since we wait for the last workload to finish
@@ -339,6 +343,7 @@ public:
         submitInfo.pCommandBuffers = &m_cmdBuffer[idx];
         submitInfo.pWaitDstStageMask = waitDstStageMask;
         VK_CHECK_RF(m_ddt.QueueSubmit(m_cmdQueue, 1, &submitInfo, info ? (VkFence)info->fence : nullptr));
+        m_timeline->signaled(m_fence[idx], syncValue);
 
         //SL_LOG_INFO("Submitting on %S index %u value %llu", name.c_str(), index, syncValue);
 
@@ -348,16 +353,7 @@ public:
     WaitStatus flushAll()
     {
         // Wait for the last signaled value to complete on all semaphores
-        VkSemaphoreWaitInfo waitInfo;
-        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-        waitInfo.pNext = NULL;
-        waitInfo.flags = 0;
-        waitInfo.semaphoreCount = m_bufferCount;
-        waitInfo.pSemaphores = &m_fence[0];
-        waitInfo.pValues = &m_fenceValue[0];
-        VK_CHECK_RWS(m_ddt.WaitSemaphores(m_device, &waitInfo, kMaxSemaphoreWaitUs));
-       
-        return WaitStatus::eNoTimeout;
+        return waitCPUFences((const Fence*)m_fence.data(), m_fenceValue.data(), m_bufferCount, true, kMaxSemaphoreWaitMs);
     }
 
     uint32_t getPrevCommandListIndex() override
@@ -397,14 +393,10 @@ public:
         for (auto& other : m_waitingQueue)
         {
             // We are waiting on GPU for these queues, signal them to get out of the deadlock
-            uint64_t completedValue{};
-            VK_CHECK_RF(m_ddt.GetSemaphoreCounterValue(m_device, other.fence, &completedValue));
-            
-            // Desperate times desperate measures, make sure to signal new value
-            auto syncValue = other.value;
-            while (completedValue >= syncValue)
+            // Desperate times desperate measures, semaphore values cannot go back so skip the ones which got there
+            if (m_timeline->isCompleted(other.fence, other.value))
             {
-                syncValue++;
+                continue;
             }
             
             VkSemaphoreSignalInfo info{};
@@ -420,45 +412,33 @@ public:
 
     WaitStatus waitForCommandListToFinish(uint32_t i)
     {
-        if (!didCommandListFinish(i))
-        {
-            VkSemaphoreWaitInfo waitInfo;
-            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-            waitInfo.pNext = NULL;
-            waitInfo.flags = 0;
-            waitInfo.semaphoreCount = 1;
-            waitInfo.pSemaphores = &m_fence[i];
-            waitInfo.pValues = &m_fenceValue[i];
-            VK_CHECK_RWS(m_ddt.WaitSemaphores(m_device, &waitInfo, kMaxSemaphoreWaitUs));
-        }
         //SL_LOG_INFO("Flushing on %S index %u value %llu", name.c_str(), i, fenceValue[i]);
-        return WaitStatus::eNoTimeout;
+        return waitCPUFence(m_fence[i], m_fenceValue[i]);
     }
 
     bool didCommandListFinish(uint32_t index)
     {
-        uint64_t completedValue;
-        VK_CHECK_RF(m_ddt.GetSemaphoreCounterValue(m_device, m_fence[index], &completedValue));
-        return completedValue >= m_fenceValue[m_index];
+        return m_timeline->isCompleted(m_fence[index], m_fenceValue[index]);
     }
 
     WaitStatus waitCPUFence(Fence fence, uint64_t syncValue)
     {
-        auto semaphore = (VkSemaphore)fence;
-        uint64_t completedValue;
-        VK_CHECK_RWS(m_ddt.GetSemaphoreCounterValue(m_device, semaphore, &completedValue));
-        if (completedValue < syncValue)
+        return waitCPUFences(&fence, &syncValue, 1, true, kMaxSemaphoreWaitMs);
+    }
+
+    WaitStatus waitCPUFences(const Fence* fences, const uint64_t* syncValues, uint32_t count, bool waitAll, uint32_t timeoutMs) override
+    {
+        auto status = m_timeline->wait(fences, syncValues, count, waitAll, timeoutMs);
+        if (status == WaitStatus::eTimeout)
         {
-            VkSemaphoreWaitInfo waitInfo;
-            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-            waitInfo.pNext = NULL;
-            waitInfo.flags = 0;
-            waitInfo.semaphoreCount = 1;
-            waitInfo.pSemaphores = &semaphore;
-            waitInfo.pValues = &syncValue;
-            VK_CHECK_RWS(m_ddt.WaitSemaphores(m_device, &waitInfo, kMaxSemaphoreWaitUs));
+            SL_LOG_WARN("Wait on %u semaphore(s) in '%S' timed out after %ums", count, m_name.c_str(), timeoutMs);
         }
-        return WaitStatus::eNoTimeout;
+        return status;
+    }
+
+    bool isFenceValueCompleted(Fence fence, uint64_t syncValue) override
+    {
+        return m_timeline->isCompleted(fence, syncValue);
     }
 
     void syncGPU(const GPUSyncInfo* info)
@@ -497,6 +477,10 @@ public:
         submitInfo.pSignalSemaphores = (VkSemaphore*)signalSemaphores.data();
         submitInfo.pWaitDstStageMask = waitDstStageMask;
         VK_CHECK_RV(m_ddt.QueueSubmit(m_cmdQueue, 1, &submitInfo, info ? (VkFence)info->fence : VK_NULL_HANDLE));
+        for (size_t i = 0; i < signalSemaphores.size(); i++)
+        {
+            m_timeline->signaled(signalSemaphores[i], signalValues[i]);
+        }
     }
 
     bool signalGPUFenceAt(uint32_t index) override
@@ -565,28 +549,13 @@ public:
         
         if (ft == eCurrent)
         {
-            VkSemaphoreWaitInfo waitInfo;
-            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-            waitInfo.pNext = NULL;
-            waitInfo.flags = 0;
-            waitInfo.semaphoreCount = 1;
-            waitInfo.pSemaphores = &m_fence[m_lastIndex];
-            waitInfo.pValues = &m_fenceValue[m_lastIndex];
-            VK_CHECK_RWS(m_ddt.WaitSemaphores(m_device, &waitInfo, kMaxSemaphoreWaitUs));
             //SL_LOG_INFO("Flush current %S index %u value %llu", name.c_str(), index, syncValue);
+            return waitCPUFence(m_fence[m_lastIndex], m_fenceValue[m_lastIndex]);
         }
         else if (ft == eDefault)
         {
             // Default, wait for previous frame at this index (N frames behind to finish)
-            auto syncValue = m_fenceValue[m_lastIndex] - 1;
-            VkSemaphoreWaitInfo waitInfo;
-            waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
-            waitInfo.pNext = NULL;
-            waitInfo.flags = 0;
-            waitInfo.semaphoreCount = 1;
-            waitInfo.pSemaphores = &m_fence[m_lastIndex];
-            waitInfo.pValues = &syncValue;
-            VK_CHECK_RWS(m_ddt.WaitSemaphores(m_device, &waitInfo, kMaxSemaphoreWaitUs));
+            return waitCPUFence(m_fence[m_lastIndex], m_fenceValue[m_lastIndex] - 1);
         }
 
         return WaitStatus::eNoTimeout;
@@ -739,44 +708,13 @@ VkImageAspectFlags toVkAspectFlags(uint32_t nativeFormat, bool isImageViewForTex
 DispatchData::~DispatchData()
 {
     assert(pddt != nullptr && device != NULL);
-    if (pddt != nullptr && device != NULL)
-    {
-        for (auto&[bindingDesc, poolDescCombo] : signatureToDesc)
-        {
-            if (bindingDesc != nullptr)
-            {
-                poolDescCombo.descSetData.descSet.clear();
-                poolDescCombo.descSetData = {};
-                pddt->DestroyDescriptorPool(device, poolDescCombo.pool, nullptr);
-            }
-        }
-    }
+    // Descriptor sets are owned by the shared descriptor pages
     signatureToDesc.clear();
 
-    assert(compute != nullptr);
+    // Constant buffers are owned by the shared upload allocator
     for (auto&[pso, bindingDesc] : psoToSignature)
     {
-        if (bindingDesc != nullptr)
-        {
-            if (compute != nullptr)
-            {
-                for (auto& descriptor : bindingDesc->descriptors)
-                {
-                    if (descriptor.second.type == DescriptorType::eConstantBuffer)
-                    {
-                        for (auto& handle : descriptor.second.handles)
-                        {
-                            if (handle != nullptr)
-                            {
-                                compute->destroyResource(reinterpret_cast<Resource>(handle), 0);
-                            }
-                        }
-                    }
-                }
-            }
-
-            delete bindingDesc;
-        }
+        delete bindingDesc;
     }
     psoToSignature.clear();
 }
@@ -912,6 +850,9 @@ ComputeStatus Vulkan::init(Device device, param::IParameters* params)
     // For callbacks we just need VkDevice
     Generic::init(m_device, params);
 
+    // Image barriers in 'transitionResourceImpl' always cover all mips and array layers
+    m_wholeResourceBarriers = true;
+
     interposer::VkTable* vk{};
     if (!param::getPointerParam(m_parameters, sl::param::global::kVulkanTable, &vk))
     {
@@ -941,6 +882,104 @@ ComputeStatus Vulkan::init(Device device, param::IParameters* params)
         m_reflex->initDispatchTable(m_ddt);
     }
 
+    {
+        // Driver checks vendor, device and cache UUID in the header and ignores data which does not match
+        loadPipelineCache(L"vulkan");
+        std::vector<uint8_t> cached;
+        m_pipelineCache.find(PipelineCache::makeKey(0, 0), PipelineCacheEntryType::eDriverCache, cached);
+        VkPipelineCacheCreateInfo info = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+        info.initialDataSize = cached.size();
+        info.pInitialData = cached.data();
+        if (m_ddt.CreatePipelineCache(m_device, &info, nullptr, &m_pipelineCacheVk) != VK_SUCCESS)
+        {
+            info.initialDataSize = 0;
+            info.pInitialData = nullptr;
+            if (m_ddt.CreatePipelineCache(m_device, &info, nullptr, &m_pipelineCacheVk) != VK_SUCCESS)
+            {
+                SL_LOG_WARN("Failed to create pipeline cache");
+                m_pipelineCacheVk = {};
+            }
+        }
+    }
+
+    m_descriptorPages = std::make_unique<DescriptorPages>([this](VkDescriptorPool& pool)->bool
+    {
+        // Every descriptor type used by chi kernels
+        const VkDescriptorPoolSize poolSizes[] =
+        {
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, kDescriptorsPerPage },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, kDescriptorsPerPage },
+            { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, kDescriptorsPerPage },
+            { VK_DESCRIPTOR_TYPE_SAMPLER, kDescriptorsPerPage },
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, kDescriptorsPerPage }
+        };
+        VkDescriptorPoolCreateInfo info = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+        info.maxSets = kDescriptorSetsPerPage;
+        info.poolSizeCount = (uint32_t)countof(poolSizes);
+        info.pPoolSizes = poolSizes;
+        if (m_ddt.CreateDescriptorPool(m_device, &info, nullptr, &pool) != VK_SUCCESS)
+        {
+            SL_LOG_ERROR("Failed to create descriptor pool page");
+            return false;
+        }
+        setDebugNameVk(pool, "SL_descriptor_pool_page");
+        return true;
+    },
+    [this](VkDescriptorPool pool) { m_ddt.ResetDescriptorPool(m_device, pool, 0); },
+    [this](VkDescriptorPool pool) { m_ddt.DestroyDescriptorPool(m_device, pool, nullptr); });
+
+    // Contexts can outlive us, only capture what the callbacks need
+    m_fenceTimeline = std::make_shared<FenceTimeline>([getCounterValue = m_ddt.GetSemaphoreCounterValue, device = m_device](Fence fence, uint64_t& value)->bool
+    {
+        auto res = getCounterValue(device, (VkSemaphore)fence, &value);
+        if (res != VK_SUCCESS)
+        {
+            SL_LOG_ERROR("vkGetSemaphoreCounterValue failed - error %d", res);
+            return false;
+        }
+        return true;
+    }, [waitSemaphores = m_ddt.WaitSemaphores, device = m_device](const Fence* fences, const uint64_t* values, uint32_t count, bool waitAll, uint32_t timeoutMs)->WaitStatus
+    {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.flags = waitAll ? 0 : VK_SEMAPHORE_WAIT_ANY_BIT;
+        waitInfo.semaphoreCount = count;
+        waitInfo.pSemaphores = (const VkSemaphore*)fences;
+        waitInfo.pValues = values;
+        auto res = waitSemaphores(device, &waitInfo, uint64_t(timeoutMs) * 1000000);
+        if (res == VK_TIMEOUT)
+        {
+            return WaitStatus::eTimeout;
+        }
+        else if (res != VK_SUCCESS)
+        {
+            SL_LOG_ERROR("vkWaitSemaphores failed - error %d", res);
+            return WaitStatus::eError;
+        }
+        return WaitStatus::eNoTimeout;
+    });
+
+    m_constantAllocator = std::make_unique<UploadAllocator<Resource>>([this](uint64_t size, Resource& page, uint8_t*& mapped)->bool
+    {
+        ResourceDescription desc = ResourceDescription{ (uint32_t)size, 1, chi::NativeFormatUnknown, chi::eHeapTypeUpload, chi::ResourceState::eConstantBuffer };
+        if (createBuffer(desc, page, "sl.chi.constants") != ComputeStatus::eOk)
+        {
+            SL_LOG_ERROR("Failed to create constant upload page");
+            return false;
+        }
+        // Stays mapped for the lifetime of the page
+        void* data{};
+        if (m_ddt.MapMemory(m_device, (VkDeviceMemory)((sl::Resource*)page)->memory, 0, size, 0, &data) != VK_SUCCESS)
+        {
+            SL_LOG_ERROR("Failed to map constant upload page");
+            destroyResource(page, 0);
+            return false;
+        }
+        mapped = (uint8_t*)data;
+        return true;
+    },
+    [this](Resource page) { destroyResource(page, 0); });
+
     if(m_idt.CreateDebugUtilsMessengerEXT)
     {
         // The report flags determine what type of messages for the layers will be displayed
@@ -1054,7 +1093,7 @@ ComputeStatus Vulkan::init(Device device, param::IParameters* params)
     pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
     pipelineInfo.stage.module = csm;
     pipelineInfo.stage.pName = "main";
-    result = m_ddt.CreateComputePipelines(m_device, nullptr, 1, &pipelineInfo, 0, &m_imageViewClear.doClear);
+    result = m_ddt.CreateComputePipelines(m_device, m_pipelineCacheVk, 1, &pipelineInfo, 0, &m_imageViewClear.doClear);
     if (result != VK_SUCCESS) {
         return ComputeStatus::eError;
     }
@@ -1073,6 +1112,9 @@ ComputeStatus Vulkan::init(Device device, param::IParameters* params)
 ComputeStatus Vulkan::shutdown()
 {
     m_dispatchContext.clear();
+    m_descriptorPages.reset();
+    m_constantAllocator.reset();
+    m_fenceTimeline.reset();
 
     assert(m_device != NULL);
 
@@ -1123,6 +1165,37 @@ ComputeStatus Vulkan::shutdown()
         m_debugUtilsMessenger = VK_NULL_HANDLE;
     }
 
+    if (m_pipelineCacheVk)
+    {
+        // Other plugins store their pipelines under the same key, merge so nothing gets lost
+        std::vector<uint8_t> onDisk;
+        if (m_pipelineCache.findOnDisk(PipelineCache::makeKey(0, 0), PipelineCacheEntryType::eDriverCache, onDisk))
+        {
+            VkPipelineCacheCreateInfo info = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+            info.initialDataSize = onDisk.size();
+            info.pInitialData = onDisk.data();
+            VkPipelineCache other{};
+            if (m_ddt.CreatePipelineCache(m_device, &info, nullptr, &other) == VK_SUCCESS)
+            {
+                m_ddt.MergePipelineCaches(m_device, m_pipelineCacheVk, 1, &other);
+                m_ddt.DestroyPipelineCache(m_device, other, nullptr);
+            }
+        }
+
+        // Saved by Generic::shutdown
+        size_t size = 0;
+        if (m_ddt.GetPipelineCacheData(m_device, m_pipelineCacheVk, &size, nullptr) == VK_SUCCESS && size)
+        {
+            std::vector<uint8_t> data(size);
+            if (m_ddt.GetPipelineCacheData(m_device, m_pipelineCacheVk, &size, data.data()) == VK_SUCCESS)
+            {
+                m_pipelineCache.update(PipelineCache::makeKey(0, 0), PipelineCacheEntryType::eDriverCache, data.data(), size);
+            }
+        }
+        m_ddt.DestroyPipelineCache(m_device, m_pipelineCacheVk, nullptr);
+        m_pipelineCacheVk = {};
+    }
+
     delete m_vk;
     m_vk = {};
 
@@ -1251,27 +1324,14 @@ ComputeStatus Vulkan::restorePipeline(CommandList cmdList)
 
 ComputeStatus Vulkan::createKernel(void *blob, unsigned int blobSize, const char* fileName, const char *entryPoint, Kernel &kernel)
 {
+    SL_PROFILE_SCOPE("chi::createKernel");
     if (!blob || !fileName || !entryPoint)
     {
         return ComputeStatus::eInvalidArgument;
     }
 
-    size_t hash = 0;
-    const char* p = fileName;
-    while (*p)
-    {
-        hash_combine(hash, *p++);
-    }
-    p = entryPoint;
-    while (*p)
-    {
-        hash_combine(hash, *p++);
-    }
-    auto i = blobSize;
-    while (i--)
-    {
-        hash_combine(hash, ((char*)blob)[i]);
-    }
+    Hash128 blobHash;
+    size_t hash = getKernelHash(blob, blobSize, fileName, entryPoint, blobHash);
 
     ComputeStatus Res = ComputeStatus::eOk;
     KernelDataVK *data = {};
@@ -1295,14 +1355,13 @@ ComputeStatus Vulkan::createKernel(void *blob, unsigned int blobSize, const char
         uint32_t header = *(uint32_t*)blob;
         if (header == kSPIRVMagicNumber)
         {
-            data->kernelBlob.resize(blobSize);
-            memcpy(data->kernelBlob.data(), blob, blobSize);
+            setKernelBlob(data, blob, blobSize, blobHash);
             SL_LOG_VERBOSE("Creating SPIR-V kernel %s:%s hash %llu", fileName, entryPoint, hash);
                         
             VkShaderModuleCreateInfo moduleCreateInfo{};
             moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-            moduleCreateInfo.codeSize = blobSize;
-            moduleCreateInfo.pCode = (uint32_t*)blob;
+            moduleCreateInfo.codeSize = data->getBlobSize();
+            moduleCreateInfo.pCode = (const uint32_t*)data->getBlob();
             VK_CHECK(m_ddt.CreateShaderModule(m_device, &moduleCreateInfo, NULL, &data->shaderModule));
         }
         else
@@ -1337,7 +1396,7 @@ ComputeStatus Vulkan::destroyKernel(Kernel& kernel)
 ComputeStatus Vulkan::createCommandListContext(CommandQueue queue, uint32_t count, ICommandListContext*& ctx, const char friendlyName[])
 { 
     auto tmp = new CommandListContextVK();
-    tmp->init(this, m_vk, friendlyName, m_device, (CommandQueueVk*)queue, count);
+    tmp->init(this, m_vk, friendlyName, m_device, (CommandQueueVk*)queue, count, m_fenceTimeline);
     ctx = tmp;
     return ComputeStatus::eOk;
 }
@@ -1482,48 +1541,38 @@ ComputeStatus Vulkan::bindConsts(uint32_t base, uint32_t reg, void *data, size_t
     auto& thread = m_dispatchContext.getContext();
     if (!thread.kernel) return ComputeStatus::eInvalidArgument;
 
-    if (instances < 3)
+    // Each bind gets its own copy, 'instances' is no longer needed to avoid overwriting constants in flight.
+    // Alignment covers the largest minUniformBufferOffsetAlignment allowed by the spec.
+    auto frame = (uint64_t)m_finishedFrame.load();
+    m_constantAllocator->setCompletedValue(frame);
+    UploadAllocator<Resource>::Allocation allocation{};
+    auto alignedDataSize = extra::align((uint32_t)dataSize, 256U);
+    if (!m_constantAllocator->allocate(alignedDataSize, 256, frame + kUploadFrameDelay + 1, allocation))
     {
-        SL_LOG_WARN("Detected too low instance count for circular constant buffer - please use num_viewports * 3 formula");
+        SL_LOG_ERROR("Failed to allocate %llu bytes for constants", (uint64_t)dataSize);
+        return ComputeStatus::eError;
     }
+    memcpy(allocation.cpu, data, dataSize);
 
-    // VK alignment requirement is 0x40
-    auto alignedDataSize = extra::align((uint32_t)dataSize, 64U);
-
-    // Implementation aligned with d3d12, we allocate CB_SIZE * instances buffer and access at different offset on each bind
+    // Dynamic offset selects constants within the page, descriptor only changes with the page
     if (thread.signature->descriptors.find(base) != thread.signature->descriptors.end())
     {
         auto& slot = thread.signature->descriptors[base];
         assert(slot.type == DescriptorType::eConstantBuffer);
-        slot.instance = (slot.instance + 1) % instances;
-        uint32_t offset = slot.instance * alignedDataSize;
-        memcpy((uint8_t*)slot.mapped + offset, data, dataSize);
-        if (thread.signature->offsets[slot.offsetIndex] != offset)
-        {
-            thread.signature->offsets[slot.offsetIndex] = offset;
-            // ensure descriptor update occurs for all of the new offsets the first time.
-            slot.dirty = true;
-        }
+        slot.dirty |= slot.handles.front() != allocation.buffer;
+        slot.handles.front() = allocation.buffer;
+        thread.signature->offsets[slot.offsetIndex] = (uint32_t)allocation.offset;
     }
     else
     {
         BindingSlot slot = {};
-        slot.instance = 0;
         slot.type = DescriptorType::eConstantBuffer;
         slot.registerIndex = base;
-        ResourceDescription cbDesc = ResourceDescription{alignedDataSize * instances,1,chi::NativeFormatUnknown,chi::eHeapTypeUpload, chi::ResourceState::eConstantBuffer};
-        Resource cb;
-        CHI_CHECK(createBuffer(cbDesc, cb, "const buffer"));
-        slot.handles.push_back(cb);
-        slot.mapped = {};
-        auto info = (sl::Resource*)cb;
-        VK_CHECK(m_ddt.MapMemory(m_device, (VkDeviceMemory)info->memory, 0, cbDesc.width, 0, &slot.mapped));
+        slot.handles.push_back(allocation.buffer);
         slot.dataRange = (uint32_t)dataSize;
         slot.offsetIndex = (uint32_t)thread.signature->offsets.size();
-        uint32_t offset = slot.instance * alignedDataSize;
-        memcpy((uint8_t*)slot.mapped + offset, data, dataSize);
         thread.signature->descriptors[base] = slot;
-        thread.signature->offsets.push_back(offset);
+        thread.signature->offsets.push_back((uint32_t)allocation.offset);
     }
     return ComputeStatus::eOk;
 }
@@ -1632,12 +1681,12 @@ ComputeStatus Vulkan::bindRawBuffer(uint32_t base, uint32_t reg, Resource InReso
 
 ComputeStatus Vulkan::processDescriptors(DispatchData& thread)
 {
-    bool needsUpdate = false;
-    if (thread.signatureToDesc.find(thread.signature) == thread.signatureToDesc.end())
+    // This is not per thread and can be reused
+    if (!thread.kernel->pipelineLayout)
     {
+        assert(!thread.kernel->descriptorSetLayout);
+
         std::vector<VkDescriptorSetLayoutBinding> bindings = { };
-        std::vector<VkDescriptorPoolSize> poolSizes = { };
-        uint32_t totalDescriptorCount{};
         for (auto it : thread.signature->descriptors)
         {
             auto& slot = it.second;
@@ -1645,219 +1694,207 @@ ComputeStatus Vulkan::processDescriptors(DispatchData& thread)
             binding.binding = slot.registerIndex;
             binding.descriptorCount = (uint32_t)slot.handles.size();
             binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-            VkDescriptorPoolSize ps = {};
-            ps.descriptorCount = (uint32_t)slot.handles.size();
-            totalDescriptorCount += ps.descriptorCount;
             if (slot.type == DescriptorType::eStorageBuffer)
             {
-                ps.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
                 binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
             }
             else if (slot.type == DescriptorType::eStorageTexture)
             {
-                ps.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
                 binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
             }
             else if (slot.type == DescriptorType::eTexture)
             {
-                ps.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
                 binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
             }
             else if (slot.type == DescriptorType::eSampler)
             {
-                ps.type = VK_DESCRIPTOR_TYPE_SAMPLER;
                 binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
             }
             else if (slot.type == DescriptorType::eConstantBuffer)
             {
-                ps.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
                 binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             }
             bindings.push_back(binding);
-            poolSizes.push_back(ps);
         }
 
-        // This is not per thread and can be reused
-        if (!thread.kernel->pipelineLayout)
-        {
-            assert(!thread.kernel->descriptorSetLayout);
+        VkDescriptorSetLayoutCreateInfo dslInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+        dslInfo.bindingCount = (uint32_t)bindings.size();
+        dslInfo.pBindings = bindings.data();
+        //dslInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+        VK_CHECK(m_ddt.CreateDescriptorSetLayout(m_device, &dslInfo, 0, &thread.kernel->descriptorSetLayout));
+        setDebugNameVk(thread.kernel->descriptorSetLayout, "SL_thread_kernel_descriptorSetLayout");
 
-            VkDescriptorSetLayoutCreateInfo dslInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
-            dslInfo.bindingCount = (uint32_t)bindings.size();
-            dslInfo.pBindings = bindings.data();
-            //dslInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
-            VK_CHECK(m_ddt.CreateDescriptorSetLayout(m_device, &dslInfo, 0, &thread.kernel->descriptorSetLayout));
-            setDebugNameVk(thread.kernel->descriptorSetLayout, "SL_thread_kernel_descriptorSetLayout");
+        VkPipelineLayoutCreateInfo plInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+        plInfo.setLayoutCount = 1;
+        plInfo.pSetLayouts = &thread.kernel->descriptorSetLayout;
+        plInfo.pushConstantRangeCount = 0;
+        plInfo.pPushConstantRanges = {};
+        VK_CHECK(m_ddt.CreatePipelineLayout(m_device, &plInfo, 0, &thread.kernel->pipelineLayout));
+        setDebugNameVk(thread.kernel->pipelineLayout, "SL_thread_kernel_pipelineLayout");
+    }
 
-            VkPipelineLayoutCreateInfo plInfo = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
-            plInfo.setLayoutCount = 1;
-            plInfo.pSetLayouts = &thread.kernel->descriptorSetLayout;
-            plInfo.pushConstantRangeCount = 0;
-            plInfo.pPushConstantRanges = {};
-            VK_CHECK(m_ddt.CreatePipelineLayout(m_device, &plInfo, 0, &thread.kernel->pipelineLayout));
-            setDebugNameVk(thread.kernel->pipelineLayout, "SL_thread_kernel_pipelineLayout");
-        }
+    if (!thread.kernel->pipeline)
+    {
+        VkComputePipelineCreateInfo pipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
+        pipelineInfo.layout = thread.kernel->pipelineLayout;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = thread.kernel->shaderModule;
+        pipelineInfo.stage.pName = "main";
+        VK_CHECK(m_ddt.CreateComputePipelines(m_device, m_pipelineCacheVk, 1, &pipelineInfo, 0, &thread.kernel->pipeline));
+        setDebugNameVk(thread.kernel->pipeline, "SL_thread_kernel_pipeline");
+    }
 
-        auto id = GetCurrentThreadId();
-        VkDescriptorPoolCreateInfo descriptorPoolInfo =
+    auto frame = m_finishedFrame.load();
+    // Destroyed resources can hand their handles to new ones, sets written before are not reused
+    auto generation = m_resourceGeneration.load();
+    auto& cache = thread.signatureToDesc[thread.signature].cache;
+    bool needsUpdate = false;
+    for (auto& it : thread.signature->descriptors)
+    {
+        needsUpdate |= it.second.dirty;
+    }
+    auto clearDirty = [&thread]()
+    {
+        for (auto& it : thread.signature->descriptors)
         {
-            VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            nullptr,
-            (VkDescriptorPoolCreateFlags)0,
-            ((uint32_t)thread.kernel->numDescriptorSets * totalDescriptorCount),
-            (uint32_t)(poolSizes.size()),
-            poolSizes.data()
-        };
-        PoolDescCombo& combo = thread.signatureToDesc[thread.signature];
-        VK_CHECK(m_ddt.CreateDescriptorPool(m_device, &descriptorPoolInfo, nullptr, &combo.pool));
-        std::stringstream name{};
-        name << "SL_thread_" << id << "_descriptor_pool";
-        setDebugNameVk(combo.pool, name.str().c_str());
-
-        combo.descSetData.descSet.resize(thread.kernel->numDescriptorSets);
-        for (uint32_t i = 0; i < thread.kernel->numDescriptorSets; i++)
+            it.second.dirty = false;
+        }
+    };
+    if (auto current = cache.getCurrent(generation); current && !needsUpdate)
+    {
+        // Same bindings as last time, set is good as long as its page was not recycled
+        if (m_descriptorPages->retain(current->page, current->epoch, frame))
         {
-            VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO , nullptr, combo.pool, 1, &thread.kernel->descriptorSetLayout };
-            VK_CHECK(m_ddt.AllocateDescriptorSets(m_device, &allocInfo, &combo.descSetData.descSet[i]));
-            name = std::stringstream{};
-            name << "SL_thread_" << id << "_kernel_descriptor_set_" << i;
-            setDebugNameVk(combo.descSetData.descSet[i], name.str().c_str());
+            return ComputeStatus::eOk;
         }
-
-        needsUpdate = true;
+        cache.invalidate(current);
     }
 
-    auto writeBufferDescriptorSet = [](VkDescriptorSet dstSet, VkDescriptorType type, uint32_t binding, VkDescriptorBufferInfo* bufferInfo, uint32_t descriptorCount = 1)->VkWriteDescriptorSet
+    // Describe current bindings, if a live set holds exactly these there is nothing to write
+    auto& key = thread.bindingKey;
+    key.clear();
+    for (auto& it : thread.signature->descriptors)
     {
-        VkWriteDescriptorSet descSet{};
-        descSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descSet.dstSet = dstSet;
-        descSet.descriptorType = type;
-        descSet.dstBinding = binding;
-        descSet.pBufferInfo = bufferInfo;
-        descSet.descriptorCount = descriptorCount;
-        return descSet;
-    };
+        auto& slot = it.second;
+        key.push_back(((uint64_t)slot.registerIndex << 32) | ((uint64_t)slot.type << 16) | (uint64_t)slot.handles.size());
+        if (slot.type == DescriptorType::eConstantBuffer)
+        {
+            key.push_back((uint64_t)(uintptr_t)reinterpret_cast<Resource>(slot.handles.front())->native);
+            key.push_back(slot.dataRange);
+        }
+        else
+        {
+            for (auto h : slot.handles)
+            {
+                key.push_back((uint64_t)(uintptr_t)h);
+            }
+        }
+    }
+    if (auto entry = cache.find(key.data(), key.size(), generation))
+    {
+        if (m_descriptorPages->retain(entry->page, entry->epoch, frame))
+        {
+            clearDirty();
+            return ComputeStatus::eOk;
+        }
+        cache.invalidate(entry);
+    }
 
-    auto writeImageDescriptorSet = [](VkDescriptorSet dstSet, VkDescriptorType type, uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t descriptorCount = 1)->VkWriteDescriptorSet
+    VkDescriptorSet descSet{};
+    auto page = m_descriptorPages->allocate(frame, [this, &thread, &descSet](VkDescriptorPool pool)->bool
     {
-        VkWriteDescriptorSet descSet{};
-        descSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descSet.dstSet = dstSet;
-        descSet.descriptorType = type;
-        descSet.dstBinding = binding;
-        descSet.pImageInfo = imageInfo;
-        descSet.descriptorCount = descriptorCount;
-        return descSet;
-    };
+        VkDescriptorSetAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO , nullptr, pool, 1, &thread.kernel->descriptorSetLayout };
+        return m_ddt.AllocateDescriptorSets(m_device, &allocInfo, &descSet) == VK_SUCCESS;
+    });
+    if (!page)
+    {
+        SL_LOG_ERROR("Failed to allocate descriptor set");
+        return ComputeStatus::eError;
+    }
 
-    auto& combo = thread.signatureToDesc[thread.signature];
+    auto& builder = thread.descriptorWrites;
+    builder.reset();
+    for (auto& it : thread.signature->descriptors)
     {
-        std::vector<VkWriteDescriptorSet> writeDescriptorSets = {};
-        std::vector<VkDescriptorBufferInfo> buffers[16];
-        std::vector<VkDescriptorImageInfo> images[16];
-        for (auto& it : thread.signature->descriptors)
+        auto& slot = it.second;
+        auto count = (uint32_t)slot.handles.size();
+        bool isBuffer = slot.type == DescriptorType::eStorageBuffer || slot.type == DescriptorType::eConstantBuffer;
+        auto write = builder.addWrite();
+        auto buffers = isBuffer ? builder.allocateBuffers(count) : nullptr;
+        auto images = isBuffer ? nullptr : builder.allocateImages(count);
+        if (!write || (!buffers && !images))
         {
-            auto& slot = it.second;
-            assert(slot.registerIndex < 16);
-            needsUpdate |= slot.dirty;
+            // Nothing is cached so the partially written set is never bound, it is reclaimed with its page
+            SL_LOG_ERROR("Too many descriptors bound to a single kernel");
+            return ComputeStatus::eError;
         }
-        if (needsUpdate)
-        {
-            combo.descSetData.descSetIndex = (combo.descSetData.descSetIndex + 1) % thread.kernel->numDescriptorSets;
-            auto& descSet = combo.descSetData.descSet[combo.descSetData.descSetIndex];
+        write->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write->dstSet = descSet;
+        write->dstBinding = slot.registerIndex;
+        write->descriptorCount = count;
+        write->pBufferInfo = buffers;
+        write->pImageInfo = images;
 
-            for (auto& it : thread.signature->descriptors)
+        if (slot.type == DescriptorType::eStorageBuffer)
+        {
+            write->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            for (uint32_t i = 0; i < count; i++)
             {
-                auto& slot = it.second;
-                if (slot.type == DescriptorType::eStorageBuffer)
-                {
-                    for (auto& h : slot.handles)
-                    {
-                        VkDescriptorBufferInfo info = {};
-                        auto buffer = (VkBuffer)h;
-                        if (buffer)
-                        {
-                            info =
-                            {
-                                buffer,                           // VkBuffer        buffer;
-                                0,                                // VkDeviceSize    offset;
-                                VK_WHOLE_SIZE                     // VkDeviceSize    range;
-                            };
-                        }
-                        buffers[slot.registerIndex].push_back(info);
-                    }
-                    writeDescriptorSets.push_back(writeBufferDescriptorSet(descSet, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, slot.registerIndex, buffers[slot.registerIndex].data(), (uint32_t)slot.handles.size()));
-                }
-                else if (slot.type == DescriptorType::eStorageTexture)
-                {
-                    for (auto& h : slot.handles)
-                    {
-                        VkDescriptorImageInfo info = { nullptr, (VkImageView)h, VK_IMAGE_LAYOUT_GENERAL };
-                        images[slot.registerIndex].push_back(info);
-                    }
-                    writeDescriptorSets.push_back(writeImageDescriptorSet(descSet, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, slot.registerIndex, images[slot.registerIndex].data(), (uint32_t)slot.handles.size()));
-                }
-                else if (slot.type == DescriptorType::eTexture)
-                {
-                    for (auto& h : slot.handles)
-                    {
-                        VkDescriptorImageInfo info = { nullptr, (VkImageView)h, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-                        images[slot.registerIndex].push_back(info);
-                    }
-                    writeDescriptorSets.push_back(writeImageDescriptorSet(descSet, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, slot.registerIndex, images[slot.registerIndex].data(), (uint32_t)slot.handles.size()));
-                }
-                else if (slot.type == DescriptorType::eSampler)
-                {
-                    for (auto& h : slot.handles)
-                    {
-                        VkDescriptorImageInfo info = { (VkSampler)h,nullptr,VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-                        images[slot.registerIndex].push_back(info);
-                    }
-                    writeDescriptorSets.push_back(writeImageDescriptorSet(descSet, VK_DESCRIPTOR_TYPE_SAMPLER, slot.registerIndex, images[slot.registerIndex].data(), (uint32_t)slot.handles.size()));
-                }
-                else if (slot.type == DescriptorType::eConstantBuffer)
-                {
-                    auto buffer = reinterpret_cast<VkBuffer>(reinterpret_cast<Resource>(slot.handles.front())->native);
-                    VkDescriptorBufferInfo info = {};
-                    if (buffer)
-                    {
-                        info =
-                        {
-                            buffer,                           // VkBuffer        buffer;
-                            0,                                // VkDeviceSize    offset;
-                            slot.dataRange                    // VkDeviceSize    range;
-                        };
-                    }
-                    buffers[slot.registerIndex].push_back(info);
-                    writeDescriptorSets.push_back(writeBufferDescriptorSet(descSet, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, slot.registerIndex, buffers[slot.registerIndex].data(), (uint32_t)slot.handles.size()));
-                }
-                slot.dirty = false;
+                auto buffer = (VkBuffer)slot.handles[i];
+                buffers[i] = buffer ? VkDescriptorBufferInfo{ buffer, 0, VK_WHOLE_SIZE } : VkDescriptorBufferInfo{};
+            }
+        }
+        else if (slot.type == DescriptorType::eConstantBuffer)
+        {
+            write->descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            auto buffer = reinterpret_cast<VkBuffer>(reinterpret_cast<Resource>(slot.handles.front())->native);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                buffers[i] = buffer ? VkDescriptorBufferInfo{ buffer, 0, slot.dataRange } : VkDescriptorBufferInfo{};
+            }
+        }
+        else if (slot.type == DescriptorType::eStorageTexture)
+        {
+            write->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                images[i] = { nullptr, (VkImageView)slot.handles[i], VK_IMAGE_LAYOUT_GENERAL };
+            }
+        }
+        else if (slot.type == DescriptorType::eTexture)
+        {
+            write->descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                images[i] = { nullptr, (VkImageView)slot.handles[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+            }
+        }
+        else if (slot.type == DescriptorType::eSampler)
+        {
+            write->descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                images[i] = { (VkSampler)slot.handles[i], nullptr, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
             }
-            auto sz = static_cast<uint32_t>(writeDescriptorSets.size());
-            m_ddt.UpdateDescriptorSets(m_device, sz, writeDescriptorSets.data(), 0, NULL);
         }
     }
+    m_ddt.UpdateDescriptorSets(m_device, builder.getWriteCount(), builder.getWrites(), 0, NULL);
 
-    if (!thread.kernel->pipeline)
-    {
-        VkComputePipelineCreateInfo pipelineInfo = { VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO };
-        pipelineInfo.layout = thread.kernel->pipelineLayout;
-        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-        pipelineInfo.stage.module = thread.kernel->shaderModule;
-        pipelineInfo.stage.pName = "main";
-        VK_CHECK(m_ddt.CreateComputePipelines(m_device, nullptr, 1, &pipelineInfo, 0, &thread.kernel->pipeline));
-        setDebugNameVk(thread.kernel->pipeline, "SL_thread_kernel_pipeline");
-    }
+    // Only a fully written set can be reused
+    cache.insert(key.data(), key.size(), descSet, page, page->epoch.load(), generation);
+    clearDirty();
     return ComputeStatus::eOk;
 }
 
 ComputeStatus Vulkan::dispatch(unsigned int blockX, unsigned int blockY, unsigned int blockZ)
 {
+    SL_PROFILE_SCOPE("chi::dispatch");
     auto& thread = m_dispatchContext.getContext();
     if (!thread.kernel) return ComputeStatus::eInvalidArgument;
 
+    flushTransitions(m_cmdBuffer);
+
     if (thread.kernel->shaderModule)
     {
         ComputeStatus ret = processDescriptors(thread);
@@ -1867,10 +1904,10 @@ ComputeStatus Vulkan::dispatch(unsigned int blockX, unsigned int blockY, unsigne
             return ret;
         }
 
-        auto& combo = thread.signatureToDesc[thread.signature];
+        auto& descriptors = thread.signatureToDesc[thread.signature];
 
         m_ddt.CmdBindPipeline(m_cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, thread.kernel->pipeline);
-        m_ddt.CmdBindDescriptorSets(m_cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, thread.kernel->pipelineLayout, 0, 1, &(combo.descSetData.descSet[combo.descSetData.descSetIndex]), (uint32_t)thread.signature->offsets.size(), thread.signature->offsets.data());
+        m_ddt.CmdBindDescriptorSets(m_cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, thread.kernel->pipelineLayout, 0, 1, &(descriptors.cache.getCurrent()->set), (uint32_t)thread.signature->offsets.size(), thread.signature->offsets.data());
         m_ddt.CmdDispatch(m_cmdBuffer, blockX, blockY, blockZ);
     }
 
@@ -2230,6 +2267,7 @@ ComputeStatus Vulkan::createBufferResourceImpl(ResourceDescription &resDesc, Res
 
 ComputeStatus Vulkan::copyHostToDeviceBuffer(CommandList InCmdList, uint64_t InSize, const void *InData, Resource InUploadResource, Resource InTargetResource, unsigned long long InUploadOffset, unsigned long long InDstOffset)
 {
+    flushTransitions(InCmdList);
     sl::Resource* dstResource = (sl::Resource*)InTargetResource;
     if (dstResource->type != ResourceType::eBuffer) return ComputeStatus::eInvalidArgument;
     VkBuffer dst = (VkBuffer)dstResource->native;
@@ -2270,6 +2308,7 @@ ComputeStatus Vulkan::copyHostToDeviceBuffer(CommandList InCmdList, uint64_t InS
 
 ComputeStatus Vulkan::copyHostToDeviceTexture(CommandList InCmdList, uint64_t InSize, uint64_t RowPitch, const void* InData, Resource InTargetResource, Resource& InUploadResource)
 {
+    flushTransitions(InCmdList);
     auto commandBuffer = (VkCommandBuffer)InCmdList;
 
     auto dstResource = (sl::Resource*)InTargetResource;
@@ -2341,6 +2380,7 @@ ComputeStatus Vulkan::copyHostToDeviceTexture(CommandList InCmdList, uint64_t In
 
 ComputeStatus Vulkan::insertGPUBarrier(CommandList InCmdList, Resource InResource, BarrierType InBarrierType)
 {
+    flushTransitions(InCmdList);
     VkCommandBuffer commandBuffer = (VkCommandBuffer)InCmdList;
 
     if (InBarrierType == BarrierType::eBarrierTypeUAV)
@@ -2708,6 +2748,7 @@ ComputeStatus Vulkan::unmapResource(CommandList cmdList, Resource resource, uint
 
 ComputeStatus Vulkan::copyResource(CommandList InCmdList, Resource InDstResource, Resource InSrcResource)
 {
+    flushTransitions(InCmdList);
     auto src = (sl::Resource*)InSrcResource;
     auto dst = (sl::Resource*)InDstResource;
     if (src->type != dst->type)
@@ -2757,6 +2798,7 @@ bool Vulkan::isFormatSupported(Format format, VkFormatFeatureFlagBits flag)
 
 ComputeStatus Vulkan::cloneResource(Resource InResource, Resource &OutResource, const char friendlyName[], ResourceState initialState, unsigned int InCreationMask, unsigned int InVisibilityMask)
 {
+    SL_PROFILE_SCOPE("chi::cloneResource");
     auto src = (sl::Resource*)InResource;
     ResourceDescription desc;
     CHI_CHECK(getResourceDescription(src, desc));
@@ -2781,6 +2823,7 @@ ComputeStatus Vulkan::cloneResource(Resource InResource, Resource &OutResource,
 
 ComputeStatus Vulkan::clearView(CommandList InCmdList, Resource InResource, const float4 Color, const RECT* pRects, unsigned int NumRects, CLEAR_TYPE &outType)
 {
+    flushTransitions(InCmdList);
     outType = CLEAR_UNDEFINED;
     
     VkCommandBuffer commandBuffer = (VkCommandBuffer)InCmdList;
@@ -2872,6 +2915,9 @@ int Vulkan::destroyResourceDeferredImpl(const Resource resource)
 {
     // Note: From SL 2.0 there is no special VK Resource structure, it is all unified with d3d
     
+    // Handle values can be recycled by the driver, cached descriptor sets must not be reused past this point
+    m_resourceGeneration++;
+
     // Try to find a buffer to free first
     bool destroyBuffer = false;
     bool destroyImage = false;
@@ -3079,6 +3125,7 @@ ComputeStatus Vulkan::setDebugName(Resource InOutResource, const char InFriendly
 
 ComputeStatus Vulkan::copyBufferToReadbackBuffer(CommandList InCmdList, Resource InResource, Resource OutResource, unsigned int InBytesToCopy)
 {
+    flushTransitions(InCmdList);
     VkCommandBuffer commandBuffer = (VkCommandBuffer)InCmdList;
 
     // Throw in a memory barrier here, because the VK cubin resource transition implementations are just dummies that don't do anything,
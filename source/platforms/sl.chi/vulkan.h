@@ -32,6 +32,9 @@
 
 #include "source/core/sl.thread/thread.h"
 #include "source/platforms/sl.chi/generic.h"
+#include "source/platforms/sl.chi/descriptorBuilder.h"
+#include "source/platforms/sl.chi/uploadAllocator.h"
+#include "source/platforms/sl.chi/fenceTimeline.h"
 #include "source/core/sl.interposer/vulkan/layer.h"
 
 #define CHI_CHECK_VK(f) { auto _r = f; if (_r != chi::ComputeStatus::ComputeStatus::eOk) { SL_LOG_ERROR( "%s failed error %u", #f, _r); return VK_INCOMPLETE; } };
@@ -46,7 +49,11 @@ class IReflexVk;
 constexpr uint64_t kMaxSemaphoreWaitUs = 500000000; // 500ms max wait on any semaphore;
 constexpr int kDescriptorCount = 32;
 constexpr int kDynamicOffsetCount = 32;
-constexpr int kDescriptorSetCount = 64;
+// Descriptor pool page capacity, pages are added as needed
+constexpr uint32_t kDescriptorSetsPerPage = 256;
+constexpr uint32_t kDescriptorsPerPage = 1024;
+
+using DescriptorPages = DescriptorPoolPages<VkDescriptorPool>;
 
 struct VulkanThreadContext : public CommonThreadContext
 {
@@ -69,23 +76,18 @@ struct KernelDataVK : public KernelDataBase
     VkDescriptorSet descriptorSet{};
     VkDescriptorSetLayout descriptorSetLayout{};
     size_t descriptorIndex = 0;
-    size_t numDescriptorSets = kDescriptorSetCount;
 
     void destroy(const VkLayerDispatchTable& ddt, VkDevice device);
 };
 
-struct PoolDescCombo
+struct SignatureDescriptors
 {
-    PoolDescCombo() {};
-    PoolDescCombo(const PoolDescCombo& rhs) = delete;
-    PoolDescCombo& operator=(const PoolDescCombo& rhs) = delete;
+    SignatureDescriptors() {};
+    SignatureDescriptors(const SignatureDescriptors& rhs) = delete;
+    SignatureDescriptors& operator=(const SignatureDescriptors& rhs) = delete;
 
-    VkDescriptorPool pool{};
-    struct
-    {
-        std::vector<VkDescriptorSet> descSet{};
-        size_t descSetIndex { kDescriptorSetCount - 1};
-    } descSetData{};
+    // Sets written for this signature, current entry is the one to bind
+    DescriptorSetCache<VkDescriptorSet, DescriptorPages::Page> cache{};
 };
 
 enum class DescriptorType
@@ -109,8 +111,6 @@ struct BindingSlot
     inline BindingSlot& operator=(const BindingSlot& rhs)
     {
         dirty = rhs.dirty;
-        mapped = rhs.mapped;
-        instance = rhs.instance;
         offsetIndex = rhs.offsetIndex;
         dataRange = rhs.dataRange;
         registerIndex = rhs.registerIndex;
@@ -120,8 +120,6 @@ struct BindingSlot
     }
 
     // dynamic buffers only
-    void* mapped = {};
-    uint32_t instance = {};
     uint32_t offsetIndex = {};
     uint32_t dataRange = {};
     // generic
@@ -152,12 +150,16 @@ struct DispatchData
 
     KernelDataVK *kernel;
     ResourceBindingDesc* signature = {};
-    std::map<ResourceBindingDesc*, PoolDescCombo> signatureToDesc = {};
+    std::map<ResourceBindingDesc*, SignatureDescriptors> signatureToDesc = {};
     std::map<size_t, ResourceBindingDesc*> psoToSignature = {};
 
     VkLayerDispatchTable* pddt{};
     VkDevice device{};
     ICompute* compute{};
+
+    // Scratch space reused by each descriptor update on this thread
+    DescriptorWriteBuilder<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo> descriptorWrites{};
+    std::vector<uint64_t> bindingKey{};
 };
 
 struct CommandQueueVk : public sl::Resource
@@ -213,6 +215,17 @@ class Vulkan : public Generic
     IReflexVk* m_reflex;
     
     thread::ThreadContext<DispatchData> m_dispatchContext;
+    // Bumped when resources are destroyed, part of the key used to reuse descriptor sets
+    std::atomic<uint64_t> m_resourceGeneration{};
+    // Shared by all threads, sets are allocated per frame
+    std::unique_ptr<DescriptorPages> m_descriptorPages;
+    //! Constants for all kernels and threads, pages are recycled once frames using them are done
+    std::unique_ptr<UploadAllocator<Resource>> m_constantAllocator;
+    //! Completed semaphore values for all command list contexts, contexts keep it alive
+    std::shared_ptr<FenceTimeline> m_fenceTimeline;
+
+    //! Seeded from and written back to the persistent pipeline cache
+    VkPipelineCache m_pipelineCacheVk{};
 
     struct PerfData
     {
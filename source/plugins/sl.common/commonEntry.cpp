@@ -31,6 +31,7 @@
 #include "include/sl_consts.h"
 #include "include/sl_helpers.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/core/sl.file/file.h"
 #include "source/core/sl.plugin/plugin.h"
 #include "source/core/sl.param/parameters.h"
@@ -150,6 +151,12 @@ struct CommonEntryContext
 
     std::mutex resourceTagMutex{};
     std::map<uint64_t, CommonResource> idToResourceMap;
+    //! Volatile tag copies are pool transients, use points advance as tags are set within a frame
+    std::mutex volatileCopyMutex{};
+    uint64_t volatileCopyFrame = ~0ull;
+    uint32_t volatileCopyPoint{};
+    //! Transient handle of the copy made for a tag this frame
+    std::map<uint64_t, uint32_t> volatileCopyHandles;
     // Common constants must be set every frame, we allow up to 3 frames in flight
     common::ViewportIdFrameData<3, true> constants = { "common" };
 
@@ -234,8 +241,77 @@ void getCommonTag(BufferType tagType, uint32_t id, CommonResource& res, const sl
     ctx.requiredTags.insert({ id, tagType, inputs ? ResourceLifecycle::eValidUntilEvaluate : ResourceLifecycle::eValidUntilPresent });
 }
 
+//! Ends the lifetime of the copy made for a tag this frame
+//!
+//! Once the host sets the tag again (or clears it) the previous copy is never read by
+//! work recorded later, copies declared after this point can alias it.
+void retireVolatileCopy(uint64_t uid)
+{
+    auto& ctx = (*common::getContext());
+    std::lock_guard<std::mutex> lock(ctx.volatileCopyMutex);
+    if (ctx.volatileCopyFrame != getCurrentFrame())
+    {
+        return;
+    }
+    auto it = ctx.volatileCopyHandles.find(uid);
+    if (it != ctx.volatileCopyHandles.end())
+    {
+        ctx.pool->endTransient(it->second, ctx.volatileCopyPoint++);
+        ctx.volatileCopyHandles.erase(it);
+    }
+}
+
+//! Returns resource to copy a volatile tag into
+//!
+//! Copies are live from the point their tag is set until it is set again within the
+//! same frame or the frame ends, so copies of tags set repeatedly between evaluate
+//! calls (views, eyes, multiple passes sharing a viewport id) alias each other. The same
+//! resources are handed out again next frame, as long as the host sets its tags in the
+//! same order each tag keeps its resource. Tags from the previous frame are still valid
+//! so a resource which another tag refers to (host changed the order) is not reused,
+//! such copy comes from the pool instead.
+chi::HashedResource allocateVolatileCopy(chi::Resource source, uint64_t uid, const char* debugName)
+{
+    // Last use is not known until the tag is set again, see 'retireVolatileCopy'
+    constexpr uint32_t kEndOfFrame = UINT_MAX;
+
+    auto& ctx = (*common::getContext());
+    chi::HashedResource clone{};
+    {
+        std::lock_guard<std::mutex> lock(ctx.volatileCopyMutex);
+        auto frame = getCurrentFrame();
+        if (frame != ctx.volatileCopyFrame)
+        {
+            ctx.pool->resetTransients();
+            ctx.volatileCopyFrame = frame;
+            ctx.volatileCopyPoint = 0;
+            ctx.volatileCopyHandles.clear();
+        }
+        auto handle = ctx.pool->declareTransient(source, ctx.volatileCopyPoint++, kEndOfFrame, debugName);
+        ctx.volatileCopyHandles[uid] = handle;
+        if (ctx.pool->compileTransients())
+        {
+            clone = ctx.pool->getTransient(handle);
+        }
+    }
+    if (clone)
+    {
+        std::lock_guard<std::mutex> lock(ctx.resourceTagMutex);
+        for (auto& [otherUid, other] : ctx.idToResourceMap)
+        {
+            if (otherUid != uid && other.getNative() == clone.getNative())
+            {
+                clone = {};
+                break;
+            }
+        }
+    }
+    return clone ? clone : ctx.pool->allocate(source, debugName);
+}
+
 sl::Result slSetTagInternal(const sl::Resource* resource, BufferType tag, uint32_t id, const Extent* ext, ResourceLifecycle lifecycle, CommandBuffer* cmdBuffer, bool localTag, const PrecisionInfo* pi)
 {
+    SL_PROFILE_SCOPE("common::setTag");
     auto& ctx = (*common::getContext());
     uint64_t uid = ((uint64_t)tag << 32) | (uint64_t)id;
     CommonResource cr{};
@@ -294,7 +370,9 @@ sl::Result slSetTagInternal(const sl::Resource* resource, BufferType tag, uint32
 
                 if (prevTag.clone)
                 {
+                    // No-op if the copy was a transient
                     ctx.pool->recycle(prevTag.clone);
+                    retireVolatileCopy(uid);
                 }
                 else
                 {
@@ -302,7 +380,7 @@ sl::Result slSetTagInternal(const sl::Resource* resource, BufferType tag, uint32
                 }
 
                 // Defaults to eCopyDestination state 
-                cr.clone = ctx.pool->allocate(actualResource, extra::format("sl.tag.{}.volatile.{}", sl::getBufferTypeAsStr(tag), id).c_str());
+                cr.clone = allocateVolatileCopy(actualResource, uid, extra::format("sl.tag.{}.volatile.{}", sl::getBufferTypeAsStr(tag), id).c_str());
 
                 // Get tagged resource's state
                 chi::ResourceState state{};
@@ -356,6 +434,7 @@ sl::Result slSetTagInternal(const sl::Resource* resource, BufferType tag, uint32
     {
         // Host can set null as a tag or even change the life-cycle of a tag, in that case any previously allocated copies must be recycled
         ctx.pool->recycle(prevTag.clone);
+        retireVolatileCopy(uid);
     }
     prevTag = cr;
     return Result::eOk;
@@ -371,6 +450,9 @@ sl::Result slSetTagInternal(const sl::Resource* resource, BufferType tag, uint32
 //  The requirement is that when setting tags, the developer should chain the extensions right after the tag that they belong to.
 sl::Result slSetTag(const sl::ViewportHandle& viewport, const sl::ResourceTag* resources, uint32_t numResources, sl::CommandBuffer* cmdBuffer)
 {
+    // Volatile tags are copied one by one, transitions to and from copy source end up in shared barrier batches
+    auto& ctx = (*common::getContext());
+    chi::ScopedTransitionBatch transitionBatch(cmdBuffer ? ctx.compute : nullptr, common::getNativeCommandBuffer(cmdBuffer));
     for (uint32_t i = 0; i < numResources; i++)
     {
         auto tag = &resources[i];
@@ -457,6 +539,7 @@ common::GetDataResult getCommonConstants(const common::EventData& ev, Constants*
 
 sl::Result slEvaluateFeature(sl::Feature feature, const sl::FrameToken& frame, const sl::BaseStructure** inputs, uint32_t numInputs, sl::CommandBuffer* cmdBuffer)
 {
+    SL_PROFILE_SCOPE("common::evaluateFeature");
     // Check if host provided tags or constants in the eval call
 
     auto viewport = findStruct<ViewportHandle>((const void**)inputs, numInputs);
@@ -1411,6 +1494,8 @@ void slOnPluginShutdown()
 
     auto& ctx = (*common::getContext());
 
+    common::destroyTimers();
+
     if (ctx.enablePCLPluginInCommonWAR)
     {
         sl::pcl::implOnPluginShutdown(parameters);
@@ -1684,30 +1769,32 @@ void updateEmbeddedJSON(json& config)
 //! The only exported function - gateway to all functionality
 SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
-    //! Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetTag);
-    SL_EXPORT_FUNCTION(slSetConstants);
-    SL_EXPORT_FUNCTION(slEvaluateFeature)
-
-    //! Hooks defined in the JSON config above
-
-    //! D3D12
-    SL_EXPORT_FUNCTION(slHookPresent);
-    SL_EXPORT_FUNCTION(slHookPresent1);
-    SL_EXPORT_FUNCTION(slHookAfterPresent);
-    SL_EXPORT_FUNCTION(slHookResizeSwapChainPre);
-    
-    //! Vulkan
-    SL_EXPORT_FUNCTION(slHookVkPresent);
-    SL_EXPORT_FUNCTION(slHookVkAfterPresent);
-    SL_EXPORT_FUNCTION(slHookVkCmdBindPipeline);
-    SL_EXPORT_FUNCTION(slHookVkCmdBindDescriptorSets);
-    SL_EXPORT_FUNCTION(slHookVkBeginCommandBuffer);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        //! Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetTag),
+        SL_EXPORT_FUNCTION(slSetConstants),
+        SL_EXPORT_FUNCTION(slEvaluateFeature),
+
+        //! Hooks defined in the JSON config above
+
+        //! D3D12
+        SL_EXPORT_FUNCTION(slHookPresent),
+        SL_EXPORT_FUNCTION(slHookPresent1),
+        SL_EXPORT_FUNCTION(slHookAfterPresent),
+        SL_EXPORT_FUNCTION(slHookResizeSwapChainPre),
+
+        //! Vulkan
+        SL_EXPORT_FUNCTION(slHookVkPresent),
+        SL_EXPORT_FUNCTION(slHookVkAfterPresent),
+        SL_EXPORT_FUNCTION(slHookVkCmdBindPipeline),
+        SL_EXPORT_FUNCTION(slHookVkCmdBindDescriptorSets),
+        SL_EXPORT_FUNCTION(slHookVkBeginCommandBuffer),
+    };
+    return s_exports.find(functionName);
 }
 
 }
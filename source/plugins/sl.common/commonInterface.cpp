@@ -36,7 +36,9 @@
 #include "include/sl.h"
 #include "source/core/sl.api/internal.h"
 #include "source/core/sl.log/log.h"
+#include "source/core/sl.log/profiler.h"
 #include "source/core/sl.thread/thread.h"
+#include "source/core/sl.thread/timerWheel.h"
 #include "source/core/sl.plugin/plugin.h"
 #include "source/core/sl.extra/extra.h"
 #include "source/core/sl.param/parameters.h"
@@ -115,8 +117,15 @@ struct CommonInterfaceContext
     }
 
     UINT64 m_maxMemoryUsage = 0;
+
+    //! Services periodic jobs so they stay off the present path
+    thread::TimerWheel* timers{};
+    thread::TimerId vramPollTimer{};
 };
 
+//! DXGI budget changes slowly, a few frames of latency is fine for allocation decisions
+constexpr uint64_t kVRAMPollIntervalMs = 50;
+
 //! Our secondary context
 CommonInterfaceContext ctx;
 
@@ -557,8 +566,46 @@ sl::Result slEvaluateFeatureInternal(sl::Feature feature, const sl::FrameToken&
 
 //! D3D12
 
+void updateVRAMBudget()
+{
+    if (ctx.manageVRAMBudget)
+    {
+        if (ctx.emulateLowVRAMScenario)
+        {
+            ctx.compute->setVRAMBudget(UINT64_MAX, UINT64_MAX);
+        }
+        else if (ctx.adapter)
+        {
+            //! IMPORTANT: Overhead for calling 'QueryVideoMemoryInfo' is 0.01ms 
+            DXGI_QUERY_VIDEO_MEMORY_INFO videoMemoryInfo{};
+            ctx.adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &videoMemoryInfo);
+            ctx.compute->setVRAMBudget(videoMemoryInfo.CurrentUsage, videoMemoryInfo.Budget);
+            // to reduce the LOG spam - print only when the new maximum is reached
+            if (videoMemoryInfo.CurrentUsage > ctx.m_maxMemoryUsage)
+            {
+                ctx.m_maxMemoryUsage = videoMemoryInfo.CurrentUsage;
+                SL_LOG_VERBOSE("Total VRAM used: %.2lf GB", ctx.m_maxMemoryUsage / (double)(1024 * 1024 * 1024));
+            }
+        }
+    }
+    else
+    {
+        // Do not manage any budget, assume endless resources
+        ctx.compute->setVRAMBudget(0, UINT64_MAX);
+    }
+}
+
+void destroyTimers()
+{
+    // Joins the timer thread so no job can run past this point
+    delete ctx.timers;
+    ctx.timers = {};
+    ctx.vramPollTimer = {};
+}
+
 void presentCommon(UINT Flags)
 {
+    SL_PROFILE_SCOPE("common::presentCommon");
     if ((Flags & DXGI_PRESENT_TEST))
     {
         return;
@@ -566,30 +613,10 @@ void presentCommon(UINT Flags)
 
     if (ctx.compute)
     {
-        if (ctx.manageVRAMBudget)
-        {
-            if (ctx.emulateLowVRAMScenario)
-            {
-                ctx.compute->setVRAMBudget(UINT64_MAX, UINT64_MAX);
-            }
-            else if (ctx.adapter)
-            {
-                //! IMPORTANT: Overhead for calling 'QueryVideoMemoryInfo' is 0.01ms 
-                DXGI_QUERY_VIDEO_MEMORY_INFO videoMemoryInfo{};
-                ctx.adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &videoMemoryInfo);
-                ctx.compute->setVRAMBudget(videoMemoryInfo.CurrentUsage, videoMemoryInfo.Budget);
-                // to reduce the LOG spam - print only when the new maximum is reached
-                if (videoMemoryInfo.CurrentUsage > ctx.m_maxMemoryUsage)
-                {
-                    ctx.m_maxMemoryUsage = videoMemoryInfo.CurrentUsage;
-                    SL_LOG_VERBOSE("Total VRAM used: %.2lf GB", ctx.m_maxMemoryUsage / (double)(1024 * 1024 * 1024));
-                }
-            }
-        }
-        else
+        // Once the adapter is known budget is polled on the timer thread
+        if (!ctx.vramPollTimer)
         {
-            // Do not manage any budget, assume endless resources
-            ctx.compute->setVRAMBudget(0, UINT64_MAX);
+            updateVRAMBudget();
         }
 
         if (!ctx.currentFrame)
@@ -605,6 +632,16 @@ void presentCommon(UINT Flags)
                 }
             }
 
+            if (ctx.adapter && ctx.manageVRAMBudget && !ctx.emulateLowVRAMScenario && !ctx.vramPollTimer)
+            {
+                updateVRAMBudget();
+                if (!ctx.timers)
+                {
+                    ctx.timers = new thread::TimerWheel(L"sl.common.timers", THREAD_PRIORITY_BELOW_NORMAL);
+                }
+                ctx.vramPollTimer = ctx.timers->schedulePeriodic(kVRAMPollIntervalMs, updateVRAMBudget);
+            }
+
 #ifndef SL_PRODUCTION
             // Check for UI and register our callback
             imgui::ImGUI* ui{};
@@ -175,6 +175,8 @@ struct SystemCaps
 
 std::pair<sl::chi::ICompute*, sl::chi::ICompute*> createCompute(void* device, RenderAPI deviceType, bool dx11On12);
 bool destroyCompute();
+//! Stops periodic jobs, must be called before adapters or compute are released
+void destroyTimers();
 
 // Get info about the GPU, id can be null in which case we get info for GPU 0
 using PFunGetGPUInfo = bool(SystemCaps& info);
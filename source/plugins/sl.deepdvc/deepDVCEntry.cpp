@@ -540,20 +540,23 @@ HRESULT slHookPresent(IDXGISwapChain* swapChain, UINT SyncInterval, UINT Flags,
 
 SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
-    // Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetData);
-    SL_EXPORT_FUNCTION(slDeepDVCSetOptions);
-    SL_EXPORT_FUNCTION(slDeepDVCGetState);
+    static const plugin::ExportTable s_exports =
+    {
+        // Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetData),
+        SL_EXPORT_FUNCTION(slDeepDVCSetOptions),
+        SL_EXPORT_FUNCTION(slDeepDVCGetState),
 
 #ifdef DEEPDVC_PRESENT_HOOK
-    SL_EXPORT_FUNCTION(slHookCreateSwapChain);
-    SL_EXPORT_FUNCTION(slHookCreateSwapChainForHwnd);
-    SL_EXPORT_FUNCTION(slHookPresent);
-    SL_EXPORT_FUNCTION(slHookPresent1);
+        SL_EXPORT_FUNCTION(slHookCreateSwapChain),
+        SL_EXPORT_FUNCTION(slHookCreateSwapChainForHwnd),
+        SL_EXPORT_FUNCTION(slHookPresent),
+        SL_EXPORT_FUNCTION(slHookPresent1),
 #endif
-    return nullptr;
+    };
+    return s_exports.find(functionName);
 }
 }
@@ -603,16 +603,18 @@ void slOnPluginShutdown()
 
 SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-
-    // App-facing Entrypoints
-    SL_EXPORT_FUNCTION(slDirectSRGetOptimalSettings);
-    SL_EXPORT_FUNCTION(slDirectSRGetVariantInfo);
-    SL_EXPORT_FUNCTION(slDirectSRSetOptions);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+
+        // App-facing Entrypoints
+        SL_EXPORT_FUNCTION(slDirectSRGetOptimalSettings),
+        SL_EXPORT_FUNCTION(slDirectSRGetVariantInfo),
+        SL_EXPORT_FUNCTION(slDirectSRSetOptions),
+    };
+    return s_exports.find(functionName);
 }
 
 }
@@ -1121,21 +1121,23 @@ internal::shared::Status getSharedData(BaseStructure* requestedData, const BaseS
 
 SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
-    // Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetData);
-    SL_EXPORT_FUNCTION(slGetData);
-    SL_EXPORT_FUNCTION(slAllocateResources);
-    SL_EXPORT_FUNCTION(slFreeResources);
-    SL_EXPORT_FUNCTION(slIsSupported);
-
-    SL_EXPORT_FUNCTION(slDLSSSetOptions);
-    SL_EXPORT_FUNCTION(slDLSSGetOptimalSettings);
-    SL_EXPORT_FUNCTION(slDLSSGetState);    
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        // Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetData),
+        SL_EXPORT_FUNCTION(slGetData),
+        SL_EXPORT_FUNCTION(slAllocateResources),
+        SL_EXPORT_FUNCTION(slFreeResources),
+        SL_EXPORT_FUNCTION(slIsSupported),
+
+        SL_EXPORT_FUNCTION(slDLSSSetOptions),
+        SL_EXPORT_FUNCTION(slDLSSGetOptimalSettings),
+        SL_EXPORT_FUNCTION(slDLSSGetState),
+    };
+    return s_exports.find(functionName);
 }
 
 }
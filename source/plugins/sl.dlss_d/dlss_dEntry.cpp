@@ -1381,21 +1381,23 @@ sl::Result slIsSupported(const sl::AdapterInfo& adapterInfo)
 
 SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
-    // Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetData);
-    SL_EXPORT_FUNCTION(slGetData);
-    SL_EXPORT_FUNCTION(slAllocateResources);
-    SL_EXPORT_FUNCTION(slFreeResources);
-    SL_EXPORT_FUNCTION(slIsSupported);
-
-    SL_EXPORT_FUNCTION(slDLSSDSetOptions);
-    SL_EXPORT_FUNCTION(slDLSSDGetOptimalSettings);
-    SL_EXPORT_FUNCTION(slDLSSDGetState);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        // Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetData),
+        SL_EXPORT_FUNCTION(slGetData),
+        SL_EXPORT_FUNCTION(slAllocateResources),
+        SL_EXPORT_FUNCTION(slFreeResources),
+        SL_EXPORT_FUNCTION(slIsSupported),
+
+        SL_EXPORT_FUNCTION(slDLSSDSetOptions),
+        SL_EXPORT_FUNCTION(slDLSSDGetOptimalSettings),
+        SL_EXPORT_FUNCTION(slDLSSDGetState),
+    };
+    return s_exports.find(functionName);
 }
 
 }
@@ -4298,26 +4298,28 @@ VkResult slHookVkPresent(VkQueue Queue, const VkPresentInfoKHR* PresentInfo, boo
 //! The only exported function - gateway to all functionality
 SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
-    //! Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-
-    // Hooks
-    SL_EXPORT_FUNCTION(slHookCreateSwapChainForCoreWindow);
-    SL_EXPORT_FUNCTION(slHookCreateSwapChainForHwnd);
-    SL_EXPORT_FUNCTION(slHookCreateSwapChain);
-    SL_EXPORT_FUNCTION(slHookPresent);
-    SL_EXPORT_FUNCTION(slHookPresent1);
-    SL_EXPORT_FUNCTION(slHookVkCreateSwapchainKHR);
-    SL_EXPORT_FUNCTION(slHookVkCreateSwapchainKHRPost);
-    SL_EXPORT_FUNCTION(slHookVkDestroySwapchainKHR);
-    SL_EXPORT_FUNCTION(slHookVkCreateWin32SurfaceKHR);
-    SL_EXPORT_FUNCTION(slHookVkDestroySurfaceKHR);
-    SL_EXPORT_FUNCTION(slHookVkGetSwapchainImagesKHR);
-    SL_EXPORT_FUNCTION(slHookVkPresent);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        //! Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+
+        // Hooks
+        SL_EXPORT_FUNCTION(slHookCreateSwapChainForCoreWindow),
+        SL_EXPORT_FUNCTION(slHookCreateSwapChainForHwnd),
+        SL_EXPORT_FUNCTION(slHookCreateSwapChain),
+        SL_EXPORT_FUNCTION(slHookPresent),
+        SL_EXPORT_FUNCTION(slHookPresent1),
+        SL_EXPORT_FUNCTION(slHookVkCreateSwapchainKHR),
+        SL_EXPORT_FUNCTION(slHookVkCreateSwapchainKHRPost),
+        SL_EXPORT_FUNCTION(slHookVkDestroySwapchainKHR),
+        SL_EXPORT_FUNCTION(slHookVkCreateWin32SurfaceKHR),
+        SL_EXPORT_FUNCTION(slHookVkDestroySurfaceKHR),
+        SL_EXPORT_FUNCTION(slHookVkGetSwapchainImagesKHR),
+        SL_EXPORT_FUNCTION(slHookVkPresent),
+    };
+    return s_exports.find(functionName);
 }
 }
 
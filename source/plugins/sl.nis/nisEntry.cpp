@@ -561,14 +561,16 @@ sl::Result slNISGetState(const sl::ViewportHandle& viewport, sl::NISState& state
 
 SL_EXPORT void *slGetPluginFunction(const char *functionName)
 {
-    // Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetData);
-    SL_EXPORT_FUNCTION(slNISSetOptions);
-    SL_EXPORT_FUNCTION(slNISGetState);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        // Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetData),
+        SL_EXPORT_FUNCTION(slNISSetOptions),
+        SL_EXPORT_FUNCTION(slNISGetState),
+    };
+    return s_exports.find(functionName);
 }
 }
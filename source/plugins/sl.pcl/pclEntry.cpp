@@ -178,18 +178,20 @@ sl::Result slPCLSetOptions(const sl::PCLOptions& options)
 //! The only exported function - gateway to all functionality
 SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
-    //! Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetData);
-    SL_EXPORT_FUNCTION(slGetData);
-    
-    SL_EXPORT_FUNCTION(slPCLGetState);
-    SL_EXPORT_FUNCTION(slPCLSetMarker);
-    SL_EXPORT_FUNCTION(slPCLSetOptions);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        //! Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetData),
+        SL_EXPORT_FUNCTION(slGetData),
+
+        SL_EXPORT_FUNCTION(slPCLGetState),
+        SL_EXPORT_FUNCTION(slPCLSetMarker),
+        SL_EXPORT_FUNCTION(slPCLSetOptions),
+    };
+    return s_exports.find(functionName);
 }
 
 }
@@ -743,22 +743,24 @@ sl::Result slReflexSetOptions(const sl::ReflexOptions& options)
 //! The only exported function - gateway to all functionality
 SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
-    //! Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetData);
-    SL_EXPORT_FUNCTION(slGetData);
-    
-    SL_EXPORT_FUNCTION(slReflexGetState);
-    SL_EXPORT_FUNCTION(slReflexSetMarker);
-    SL_EXPORT_FUNCTION(slReflexSleep);
-    SL_EXPORT_FUNCTION(slReflexSetOptions);
-
-    SL_EXPORT_FUNCTION(slReflexSetCameraData);
-    SL_EXPORT_FUNCTION(slReflexGetPredictedCameraData);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        //! Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetData),
+        SL_EXPORT_FUNCTION(slGetData),
+
+        SL_EXPORT_FUNCTION(slReflexGetState),
+        SL_EXPORT_FUNCTION(slReflexSetMarker),
+        SL_EXPORT_FUNCTION(slReflexSleep),
+        SL_EXPORT_FUNCTION(slReflexSetOptions),
+
+        SL_EXPORT_FUNCTION(slReflexSetCameraData),
+        SL_EXPORT_FUNCTION(slReflexGetPredictedCameraData),
+    };
+    return s_exports.find(functionName);
 }
 
 }
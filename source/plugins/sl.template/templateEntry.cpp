@@ -420,21 +420,23 @@ void updateEmbeddedJSON(json& config)
 //! The only exported function - gateway to all functionality
 SL_EXPORT void* slGetPluginFunction(const char* functionName)
 {
-    //! Core API
-    SL_EXPORT_FUNCTION(slOnPluginLoad);
-    SL_EXPORT_FUNCTION(slOnPluginShutdown);
-    SL_EXPORT_FUNCTION(slOnPluginStartup);
-    SL_EXPORT_FUNCTION(slSetConstants);
-    SL_EXPORT_FUNCTION(slGetSettings);
-    SL_EXPORT_FUNCTION(slAllocateResources);
-    SL_EXPORT_FUNCTION(slFreeResources);
-
-    //! Hooks defined in the JSON config above
-
-    //! D3D12
-    SL_EXPORT_FUNCTION(slHookPresent);
-
-    return nullptr;
+    static const plugin::ExportTable s_exports =
+    {
+        //! Core API
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetConstants),
+        SL_EXPORT_FUNCTION(slGetSettings),
+        SL_EXPORT_FUNCTION(slAllocateResources),
+        SL_EXPORT_FUNCTION(slFreeResources),
+
+        //! Hooks defined in the JSON config above
+
+        //! D3D12
+        SL_EXPORT_FUNCTION(slHookPresent),
+    };
+    return s_exports.find(functionName);
 }
 
 }
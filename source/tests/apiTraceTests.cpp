@@ -0,0 +1,434 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "source/tests/test.h"
+#include "source/core/sl.api/apiTrace.h"
+
+using namespace sl;
+using namespace sl::api::trace;
+
+namespace
+{
+
+struct TestFrameToken : FrameToken
+{
+    uint32_t value{};
+    operator uint32_t() const override { return value; }
+};
+
+std::wstring getTracePath(const char* name)
+{
+    return (fs::temp_directory_path() / ("sl.tests." + std::string(name) + "." + std::to_string(getpid()) + ".trace")).wstring();
+}
+
+//! Entry points which fail the test if called, tests override what they expect
+ReplayFunctions getUnexpectedFunctions()
+{
+    ReplayFunctions api{};
+    api.setFeatureLoaded = [](Feature, bool)->Result { SL_EXPECT(!"unexpected call"); return Result::eOk; };
+    api.setTag = [](const ViewportHandle&, const ResourceTag*, uint32_t, CommandBuffer*)->Result { SL_EXPECT(!"unexpected call"); return Result::eOk; };
+    api.setConstants = [](const Constants&, const FrameToken&, const ViewportHandle&)->Result { SL_EXPECT(!"unexpected call"); return Result::eOk; };
+    api.allocateResources = [](CommandBuffer*, Feature, const ViewportHandle&)->Result { SL_EXPECT(!"unexpected call"); return Result::eOk; };
+    api.freeResources = [](Feature, const ViewportHandle&)->Result { SL_EXPECT(!"unexpected call"); return Result::eOk; };
+    api.evaluateFeature = [](Feature, const FrameToken&, const BaseStructure**, uint32_t, CommandBuffer*)->Result { SL_EXPECT(!"unexpected call"); return Result::eOk; };
+    api.getNewFrameToken = [](FrameToken*& token, const uint32_t* index)->Result
+    {
+        static TestFrameToken s_token;
+        s_token.value = index ? *index : 0;
+        token = &s_token;
+        return Result::eOk;
+    };
+    api.getFeatureFunction = [](Feature, const char*, void*&)->Result { SL_EXPECT(!"unexpected call"); return Result::eOk; };
+    return api;
+}
+
+}
+
+SL_TEST(apiTraceRoundTrip)
+{
+    auto path = getTracePath("apiTraceRoundTrip");
+    {
+        Recorder recorder(path.c_str(), 42);
+        Resource resource(ResourceType::eTex2d, (void*)0x1234, 5);
+        resource.width = 1920;
+        resource.height = 1080;
+        PrecisionInfo precision(PrecisionInfo::eLinearTransform, 1.0f, 2.0f);
+        ResourceTag tags[2] = { ResourceTag(&resource, kBufferTypeDepth, ResourceLifecycle::eValidUntilPresent), ResourceTag(nullptr, kBufferTypeMotionVectors, ResourceLifecycle::eOnlyValidNow) };
+        tags[0].next = &precision;
+        ViewportHandle viewport(3);
+        recorder.record(CallId::eSetTag, [&](Writer& w)->void
+        {
+            w.value((uint32_t)viewport);
+            w.value(2u);
+            for (auto& tag : tags) w.chain(&tag);
+            w.handle((void*)0x99);
+        });
+        Constants consts{};
+        consts.jitterOffset = { 0.25f, -0.5f };
+        recorder.record(CallId::eSetConstants, [&](Writer& w)->void
+        {
+            w.value(7u);
+            w.value((uint32_t)viewport);
+            w.chain(&consts);
+        });
+        // Unknown calls are skipped by size
+        recorder.record((CallId)77, [&](Writer& w)->void { w.value(1u); });
+        recorder.record(CallId::eGetFeatureFunction, [&](Writer& w)->void
+        {
+            w.value((Feature)1);
+            w.string("slDLSSSetOptions");
+        });
+    }
+
+    Replayer replayer;
+    SL_REQUIRE(replayer.load(path.c_str()));
+    SL_EXPECT(replayer.getHeader().sdkVersion == 42);
+    SL_EXPECT(replayer.getHeader().constantsSize == sizeof(Constants));
+
+    static uint32_t s_calls;
+    s_calls = 0;
+    auto api = getUnexpectedFunctions();
+    api.setTag = [](const ViewportHandle& viewport, const ResourceTag* tags, uint32_t count, CommandBuffer* cmdBuffer)->Result
+    {
+        s_calls++;
+        SL_EXPECT((uint32_t)viewport == 3 && count == 2 && cmdBuffer == (CommandBuffer*)0x99);
+        SL_EXPECT(tags[0].resource && tags[0].resource->native == (void*)0x1234 && tags[0].resource->width == 1920 && tags[0].resource->height == 1080);
+        SL_EXPECT(tags[0].type == kBufferTypeDepth && tags[0].lifecycle == ResourceLifecycle::eValidUntilPresent);
+        SL_EXPECT(tags[0].next && tags[0].next->structType == PrecisionInfo::s_structType && ((const PrecisionInfo*)tags[0].next)->scale == 2.0f);
+        SL_EXPECT(!tags[1].resource && tags[1].type == kBufferTypeMotionVectors);
+        return Result::eOk;
+    };
+    api.setConstants = [](const Constants& consts, const FrameToken& frame, const ViewportHandle& viewport)->Result
+    {
+        s_calls++;
+        SL_EXPECT(consts.jitterOffset.x == 0.25f && consts.jitterOffset.y == -0.5f);
+        SL_EXPECT((uint32_t)frame == 7 && (uint32_t)viewport == 3);
+        return Result::eOk;
+    };
+    api.getFeatureFunction = [](Feature feature, const char* name, void*&)->Result
+    {
+        s_calls++;
+        SL_EXPECT(feature == 1 && !strcmp(name, "slDLSSSetOptions"));
+        return Result::eErrorFeatureMissing;
+    };
+    ReplayStats stats{};
+    SL_EXPECT(replayer.replay(api, stats));
+    SL_EXPECT(s_calls == 3);
+    SL_EXPECT(stats.skipped == 1);
+    SL_EXPECT(stats.failed == 1);
+    SL_EXPECT(stats.calls[(size_t)CallId::eSetTag] == 1);
+    fs::remove(path);
+}
+
+SL_TEST(apiTraceCopiesOnlyDeclaredStructVersion)
+{
+    // A host built against version 1 passes a smaller Constants, nothing past it may be read
+    Constants consts{};
+    consts.structVersion = kStructVersion1;
+    consts.cameraFOV = 1.5f;
+    consts.minRelativeLinearDepthObjectSeparation = 99.0f;
+    std::vector<uint8_t> data;
+    Writer(data).structure(&consts);
+    auto payload = getConstantsV1Size() - sizeof(BaseStructure);
+    SL_EXPECT(getConstantsV1Size() < sizeof(Constants));
+    SL_EXPECT(data.size() == sizeof(StructType) + 2 * sizeof(uint32_t) + payload);
+
+    auto path = getTracePath("apiTraceStructVersion");
+    {
+        Recorder recorder(path.c_str(), 1);
+        recorder.record(CallId::eSetConstants, [&](Writer& w)->void
+        {
+            w.value(1u);
+            w.value(0u);
+            w.chain(&consts);
+        });
+    }
+    Replayer replayer;
+    SL_REQUIRE(replayer.load(path.c_str()));
+    auto api = getUnexpectedFunctions();
+    api.setConstants = [](const Constants& consts, const FrameToken&, const ViewportHandle&)->Result
+    {
+        SL_EXPECT(consts.structVersion == kStructVersion1);
+        SL_EXPECT(consts.cameraFOV == 1.5f);
+        SL_EXPECT(consts.minRelativeLinearDepthObjectSeparation == 0.0f);
+        return Result::eOk;
+    };
+    ReplayStats stats{};
+    SL_EXPECT(replayer.replay(api, stats));
+    SL_EXPECT(stats.calls[(size_t)CallId::eSetConstants] == 1 && stats.failed == 0);
+    fs::remove(path);
+}
+
+SL_TEST(apiTraceRejectsBadFiles)
+{
+    auto path = getTracePath("apiTraceBadFiles");
+    {
+        Recorder recorder(path.c_str(), 1);
+        recorder.record(CallId::eFreeResources, [&](Writer& w)->void
+        {
+            w.value((Feature)1);
+            w.value(0u);
+        });
+    }
+    auto trace = file::read(path.c_str());
+    SL_REQUIRE(trace.size() > sizeof(FileHeader) + sizeof(RecordHeader));
+
+    // Truncated record fails the replay
+    auto truncated = trace;
+    truncated.pop_back();
+    file::write(path.c_str(), truncated);
+    Replayer replayer;
+    SL_REQUIRE(replayer.load(path.c_str()));
+    ReplayStats stats{};
+    SL_EXPECT(!replayer.replay(getUnexpectedFunctions(), stats));
+
+    // Newer format version is refused up front
+    auto newer = trace;
+    auto version = (uint16_t)(kTraceVersion + 1);
+    memcpy(newer.data() + offsetof(FileHeader, version), &version, sizeof(version));
+    file::write(path.c_str(), newer);
+    SL_EXPECT(!Replayer().load(path.c_str()));
+
+    // Not a trace at all
+    file::write(path.c_str(), std::vector<uint8_t>(64, 0));
+    SL_EXPECT(!Replayer().load(path.c_str()));
+    fs::remove(path);
+}
+
+namespace
+{
+
+//! Backend which accepts every call and keeps what the replayer passed in
+struct NullBackend
+{
+    static inline uint32_t s_calls[(size_t)CallId::eCount];
+    static inline Feature s_feature;
+    static inline bool s_enabled;
+    static inline uint32_t s_viewport;
+    static inline uint32_t s_frame;
+    static inline uint32_t s_numTags;
+    static inline uint32_t s_numInputs;
+    static inline CommandBuffer* s_cmdBuffer;
+    static inline float s_precisionScale;
+    static inline std::string s_function;
+
+    static void reset()
+    {
+        memset(s_calls, 0, sizeof(s_calls));
+        s_feature = {};
+        s_enabled = {};
+        s_viewport = s_frame = s_numTags = s_numInputs = 0;
+        s_cmdBuffer = {};
+        s_precisionScale = 0.0f;
+        s_function.clear();
+    }
+
+    static ReplayFunctions get()
+    {
+        ReplayFunctions api{};
+        api.setFeatureLoaded = [](Feature feature, bool enabled)->Result
+        {
+            s_calls[(size_t)CallId::eSetFeatureLoaded]++;
+            s_feature = feature;
+            s_enabled = enabled;
+            return Result::eOk;
+        };
+        api.setTag = [](const ViewportHandle& viewport, const ResourceTag*, uint32_t count, CommandBuffer* cmdBuffer)->Result
+        {
+            s_calls[(size_t)CallId::eSetTag]++;
+            s_viewport = viewport;
+            s_numTags = count;
+            s_cmdBuffer = cmdBuffer;
+            return Result::eOk;
+        };
+        api.setConstants = [](const Constants&, const FrameToken& frame, const ViewportHandle& viewport)->Result
+        {
+            s_calls[(size_t)CallId::eSetConstants]++;
+            s_frame = frame;
+            s_viewport = viewport;
+            return Result::eOk;
+        };
+        api.allocateResources = [](CommandBuffer* cmdBuffer, Feature feature, const ViewportHandle& viewport)->Result
+        {
+            s_calls[(size_t)CallId::eAllocateResources]++;
+            s_cmdBuffer = cmdBuffer;
+            s_feature = feature;
+            s_viewport = viewport;
+            return Result::eOk;
+        };
+        api.freeResources = [](Feature feature, const ViewportHandle& viewport)->Result
+        {
+            s_calls[(size_t)CallId::eFreeResources]++;
+            s_feature = feature;
+            s_viewport = viewport;
+            return Result::eOk;
+        };
+        api.evaluateFeature = [](Feature feature, const FrameToken& frame, const BaseStructure** inputs, uint32_t count, CommandBuffer* cmdBuffer)->Result
+        {
+            s_calls[(size_t)CallId::eEvaluateFeature]++;
+            s_feature = feature;
+            s_frame = frame;
+            s_numInputs = count;
+            s_cmdBuffer = cmdBuffer;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                if (inputs[i]->structType == PrecisionInfo::s_structType)
+                {
+                    s_precisionScale = ((const PrecisionInfo*)inputs[i])->scale;
+                }
+            }
+            return Result::eOk;
+        };
+        api.getNewFrameToken = [](FrameToken*& token, const uint32_t* index)->Result
+        {
+            // Also called to rebuild tokens for other calls so it is not counted here
+            static TestFrameToken s_token;
+            s_token.value = index ? *index : 0;
+            token = &s_token;
+            return Result::eOk;
+        };
+        api.getFeatureFunction = [](Feature feature, const char* name, void*& function)->Result
+        {
+            s_calls[(size_t)CallId::eGetFeatureFunction]++;
+            s_feature = feature;
+            s_function = name;
+            function = nullptr;
+            return Result::eOk;
+        };
+        return api;
+    }
+};
+
+}
+
+SL_TEST(apiTraceReplaysEveryCallOnNullBackend)
+{
+    auto path = getTracePath("apiTraceNullBackend");
+    const uint32_t frameIndex = 11;
+    {
+        // Same encoders sl.api uses when 'recordAPITrace' is set
+        Recorder recorder(path.c_str(), 3);
+        TestFrameToken frame;
+        frame.value = frameIndex;
+        ViewportHandle viewport(2);
+        auto cmdBuffer = (CommandBuffer*)0x77;
+
+        recorder.recordSetFeatureLoaded((Feature)5, true);
+        recorder.recordGetNewFrameToken(&frameIndex);
+        recorder.recordGetNewFrameToken(nullptr);
+        Resource resource(ResourceType::eTex2d, (void*)0x10, 0);
+        ResourceTag tags[3] = { ResourceTag(&resource, kBufferTypeDepth, ResourceLifecycle::eValidUntilPresent), ResourceTag(&resource, kBufferTypeMotionVectors, ResourceLifecycle::eValidUntilPresent), ResourceTag(nullptr, kBufferTypeHUDLessColor, ResourceLifecycle::eOnlyValidNow) };
+        recorder.recordSetTag(viewport, tags, 3, cmdBuffer);
+        recorder.recordSetConstants(Constants{}, frame, viewport);
+        recorder.recordAllocateResources(cmdBuffer, (Feature)5, viewport);
+        PrecisionInfo precision(PrecisionInfo::eLinearTransform, 0.0f, 4.0f);
+        // Null inputs are dropped when recording
+        const BaseStructure* inputs[] = { &viewport, nullptr, &precision };
+        recorder.recordEvaluateFeature((Feature)5, frame, inputs, 3, cmdBuffer);
+        recorder.recordFreeResources((Feature)5, viewport);
+        recorder.recordGetFeatureFunction((Feature)5, "slDLSSGetOptimalSettings");
+    }
+
+    Replayer replayer;
+    SL_REQUIRE(replayer.load(path.c_str()));
+    NullBackend::reset();
+    ReplayStats stats{};
+    SL_EXPECT(replayer.replay(NullBackend::get(), stats));
+    SL_EXPECT(stats.failed == 0 && stats.skipped == 0);
+    for (size_t i = 0; i < (size_t)CallId::eCount; i++)
+    {
+        auto expected = (CallId)i == CallId::eGetNewFrameToken ? 2u : 1u;
+        SL_EXPECT(stats.calls[i] == expected);
+        if ((CallId)i != CallId::eGetNewFrameToken)
+        {
+            SL_EXPECT(NullBackend::s_calls[i] == 1);
+        }
+    }
+    SL_EXPECT(NullBackend::s_enabled);
+    SL_EXPECT(NullBackend::s_feature == 5);
+    SL_EXPECT(NullBackend::s_viewport == 2);
+    SL_EXPECT(NullBackend::s_frame == frameIndex);
+    SL_EXPECT(NullBackend::s_numTags == 3);
+    SL_EXPECT(NullBackend::s_numInputs == 2);
+    SL_EXPECT(NullBackend::s_precisionScale == 4.0f);
+    SL_EXPECT(NullBackend::s_cmdBuffer == (CommandBuffer*)0x77);
+    SL_EXPECT(NullBackend::s_function == "slDLSSGetOptimalSettings");
+
+    // Resolve callbacks see every recorded resource and command buffer
+    static uint32_t s_resources, s_cmdBuffers;
+    s_resources = s_cmdBuffers = 0;
+    replayer.setResolveCallbacks([](Resource& resource)->void
+    {
+        s_resources++;
+        SL_EXPECT(resource.native == (void*)0x10);
+        resource.native = (void*)0x20;
+    }, [](void* recorded)->CommandBuffer*
+    {
+        s_cmdBuffers++;
+        SL_EXPECT(recorded == (void*)0x77);
+        return (CommandBuffer*)0x88;
+    });
+    NullBackend::reset();
+    ReplayStats resolved{};
+    SL_EXPECT(replayer.replay(NullBackend::get(), resolved));
+    SL_EXPECT(s_resources == 2);
+    SL_EXPECT(s_cmdBuffers == 3);
+    SL_EXPECT(NullBackend::s_cmdBuffer == (CommandBuffer*)0x88);
+    fs::remove(path);
+}
+
+SL_TEST(apiTraceBenchmarkRecordReplay)
+{
+    // A typical frame: constants, a few tags and one evaluate
+    auto path = getTracePath("apiTraceBenchmark");
+    constexpr uint32_t kFrames = 100000;
+    Resource resource(ResourceType::eTex2d, (void*)0x10, 0);
+    ResourceTag tags[4] = { ResourceTag(&resource, kBufferTypeDepth, ResourceLifecycle::eValidUntilPresent), ResourceTag(&resource, kBufferTypeMotionVectors, ResourceLifecycle::eValidUntilPresent),
+        ResourceTag(&resource, kBufferTypeScalingInputColor, ResourceLifecycle::eValidUntilPresent), ResourceTag(&resource, kBufferTypeScalingOutputColor, ResourceLifecycle::eValidUntilPresent) };
+    ViewportHandle viewport(0);
+    const BaseStructure* inputs[] = { &viewport };
+    double recordNs{};
+    {
+        Recorder recorder(path.c_str(), 1);
+        TestFrameToken frame;
+        Constants consts{};
+        recordNs = sl::test::measureNs(kFrames, [&](uint32_t i)
+        {
+            frame.value = i;
+            recorder.recordSetConstants(consts, frame, viewport);
+            recorder.recordSetTag(viewport, tags, 4, (CommandBuffer*)0x77);
+            recorder.recordEvaluateFeature((Feature)0, frame, inputs, 1, (CommandBuffer*)0x77);
+        }) / 3;
+    }
+
+    Replayer replayer;
+    SL_REQUIRE(replayer.load(path.c_str()));
+    NullBackend::reset();
+    ReplayStats stats{};
+    auto start = std::chrono::steady_clock::now();
+    SL_EXPECT(replayer.replay(NullBackend::get(), stats));
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    SL_EXPECT(stats.calls[(size_t)CallId::eEvaluateFeature] == kFrames && stats.failed == 0);
+    sl::test::report("%.1fns record, %.1fns replay per call on a null backend", recordNs, elapsed.count() / (kFrames * 3));
+    fs::remove(path);
+}
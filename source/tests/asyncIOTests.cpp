@@ -0,0 +1,173 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "source/tests/test.h"
+#include "source/core/sl.file/asyncIO.h"
+
+using namespace sl;
+using namespace sl::file;
+
+namespace
+{
+
+//! Fresh directory per test so runs do not see each other's files
+struct TempDir
+{
+    TempDir(const char* name)
+    {
+        path = fs::temp_directory_path() / ("sl.tests." + std::string(name) + "." + std::to_string(getpid()));
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~TempDir()
+    {
+        std::error_code ec;
+        fs::remove_all(path, ec);
+    }
+
+    std::wstring file(const wchar_t* name) const { return (path / name).wstring(); }
+
+    fs::path path;
+};
+
+std::vector<uint8_t> bytes(const char* str)
+{
+    return std::vector<uint8_t>(str, str + strlen(str));
+}
+
+std::string readAll(const std::wstring& path)
+{
+    std::ifstream stream(fs::path(path), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+}
+
+SL_TEST(asyncIOPreservesOrderPerFile)
+{
+    TempDir dir("asyncIOOrder");
+    AsyncIO io(L"sl.tests.io", 4);
+    std::vector<IORequestId> completed;
+    std::mutex mtx;
+    auto onComplete = [&](IOCompletion& c)->void
+    {
+        SL_EXPECT(c.success);
+        std::scoped_lock lock(mtx);
+        completed.push_back(c.id);
+    };
+
+    // Overwrite in the middle of a run of appends starts the file over
+    auto log = dir.file(L"log.txt");
+    io.append(log.c_str(), bytes("a"), onComplete);
+    io.append(log.c_str(), bytes("b"), onComplete);
+    io.write(log.c_str(), bytes("c"), onComplete);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        io.append(log.c_str(), bytes("d"), onComplete);
+        io.append(dir.file((std::to_wstring(i % 8) + L".bin").c_str()).c_str(), bytes("x"), onComplete);
+    }
+    SL_EXPECT(io.flush());
+    SL_EXPECT(io.getPendingCount() == 0);
+    SL_EXPECT(completed.size() == 203);
+    SL_EXPECT(readAll(log) == "c" + std::string(100, 'd'));
+    SL_EXPECT(readAll(dir.file(L"3.bin")) == std::string(13, 'x'));
+}
+
+SL_TEST(asyncIOReadAndFailures)
+{
+    TempDir dir("asyncIORead");
+    AsyncIO io(L"sl.tests.io");
+    auto path = dir.file(L"data.bin");
+    io.write(path.c_str(), bytes("hello"));
+    std::string contents;
+    io.read(path.c_str(), [&contents](IOCompletion& c)->void
+    {
+        SL_EXPECT(c.success && c.op == IOOperation::eRead && c.bytes == 5);
+        contents.assign(c.data->begin(), c.data->end());
+    });
+
+    bool missingReported = false;
+    io.read(dir.file(L"missing.bin").c_str(), [&missingReported](IOCompletion& c)->void
+    {
+        missingReported = !c.success && c.bytes == 0;
+    });
+    bool badPathReported = false;
+    io.write(dir.file(L"no/such/dir.bin").c_str(), bytes("x"), [&badPathReported](IOCompletion& c)->void
+    {
+        badPathReported = !c.success;
+    });
+    SL_EXPECT(io.flush());
+    SL_EXPECT(contents == "hello");
+    SL_EXPECT(missingReported);
+    SL_EXPECT(badPathReported);
+}
+
+SL_TEST(asyncIOFlushDoesNotWaitForLaterRequests)
+{
+    TempDir dir("asyncIOFlush");
+    AsyncIO io(L"sl.tests.io", 2);
+    auto path = dir.file(L"stream.bin");
+
+    // Keep the queue busy for the whole test, flush must still return
+    std::atomic<bool> quit = false;
+    std::atomic<uint32_t> submitted = 0;
+    std::thread producer([&]()->void
+    {
+        while (!quit)
+        {
+            io.append(path.c_str(), bytes("0123456789"));
+            submitted++;
+        }
+    });
+    while (submitted < 100) std::this_thread::yield();
+
+    IORequestId marker{};
+    std::atomic<bool> markerDone = false;
+    marker = io.append(dir.file(L"marker.bin").c_str(), bytes("m"), [&markerDone](IOCompletion&)->void { markerDone = true; });
+    SL_EXPECT(marker != 0);
+    SL_EXPECT(io.flush(10000));
+    SL_EXPECT(markerDone);
+    quit = true;
+    producer.join();
+}
+
+SL_TEST(asyncIOFlushFromCallbackDoesNotBlock)
+{
+    TempDir dir("asyncIOCallback");
+    AsyncIO io(L"sl.tests.io");
+    auto path = dir.file(L"a.bin");
+    std::atomic<bool> called = false;
+    bool flushed = true;
+    io.write(path.c_str(), bytes("a"), [&](IOCompletion&)->void
+    {
+        // The request being completed counts as outstanding, so this reports false instead of deadlocking
+        flushed = io.flush();
+        io.append(path.c_str(), bytes("b"));
+        called = true;
+    });
+    SL_EXPECT(io.flush(10000));
+    SL_EXPECT(called);
+    SL_EXPECT(!flushed);
+    SL_EXPECT(io.flush(10000));
+    SL_EXPECT(readAll(path) == "ab");
+}
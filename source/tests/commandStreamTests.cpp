@@ -0,0 +1,269 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <cstring>
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/commandStream.h"
+
+using namespace sl::chi;
+
+namespace
+{
+
+//! Keeps decoded payloads next to the counts so tests can check what came out
+struct RecordingTranslator : NullCommandTranslator
+{
+    std::vector<ResourceTransition> transitions;
+    std::vector<Resource> textures;
+    std::vector<Resource> rwTextures;
+    std::vector<CmdDispatch> dispatches;
+    std::vector<float> consts;
+    std::vector<Resource> barriers;
+    std::vector<CmdCopyResource> copies;
+
+    virtual ComputeStatus bindConsts(const CmdBindConsts& cmd, const void* data) override
+    {
+        consts.insert(consts.end(), (const float*)data, (const float*)data + cmd.dataSize / sizeof(float));
+        return NullCommandTranslator::bindConsts(cmd, data);
+    }
+    virtual ComputeStatus bindTexture(const CmdBindTexture& cmd) override
+    {
+        textures.push_back(cmd.resource);
+        return NullCommandTranslator::bindTexture(cmd);
+    }
+    virtual ComputeStatus bindRWTexture(const CmdBindRWTexture& cmd) override
+    {
+        rwTextures.push_back(cmd.resource);
+        return NullCommandTranslator::bindRWTexture(cmd);
+    }
+    virtual ComputeStatus dispatch(const CmdDispatch& cmd) override
+    {
+        dispatches.push_back(cmd);
+        return NullCommandTranslator::dispatch(cmd);
+    }
+    virtual ComputeStatus transitionResources(const ResourceTransition* list, uint32_t count) override
+    {
+        transitions.insert(transitions.end(), list, list + count);
+        return NullCommandTranslator::transitionResources(list, count);
+    }
+    virtual ComputeStatus insertUAVBarriers(const Resource* resources, uint32_t count) override
+    {
+        barriers.insert(barriers.end(), resources, resources + count);
+        return NullCommandTranslator::insertUAVBarriers(resources, count);
+    }
+    virtual ComputeStatus copyResource(const CmdCopyResource& cmd) override
+    {
+        copies.push_back(cmd);
+        return NullCommandTranslator::copyResource(cmd);
+    }
+
+    uint32_t count(CommandOp op) const { return counts[(uint32_t)op]; }
+};
+
+Resource fakeResource(uintptr_t value)
+{
+    return (Resource)value;
+}
+
+}
+
+SL_TEST(commandStreamRoundTrip)
+{
+    auto a = fakeResource(0x1000);
+    auto b = fakeResource(0x2000);
+    auto c = fakeResource(0x3000);
+    float consts[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+    CommandStream stream;
+    stream.bindSharedState(0);
+    stream.bindKernel(42);
+    stream.bindSampler(0, 0, eSamplerLinearClamp);
+    stream.bindConsts(1, 0, consts, sizeof(consts), 3);
+    stream.bindTexture(2, 0, a);
+    stream.bindRWTexture(3, 0, c);
+    stream.dispatch(8, 4, 2);
+    Resource barriers[] = { a, c };
+    stream.insertUAVBarriers(barriers, 2);
+    stream.copyResource(b, a);
+    SL_EXPECT(stream.getCommandCount() == 9);
+    SL_EXPECT(stream.getSkippedCount() == 0);
+    SL_EXPECT(stream.getSize() % 8 == 0);
+
+    RecordingTranslator translator;
+    SL_REQUIRE(stream.decode(translator) == ComputeStatus::eOk);
+    SL_EXPECT(translator.kernel == 42);
+    SL_EXPECT(translator.count(CommandOp::eBindSharedState) == 1);
+    SL_EXPECT(translator.count(CommandOp::eBindSampler) == 1);
+    SL_REQUIRE(translator.consts.size() == 4);
+    SL_EXPECT(translator.consts[0] == 1.0f && translator.consts[3] == 4.0f);
+    SL_EXPECT(translator.textures.size() == 1 && translator.textures[0] == a);
+    SL_EXPECT(translator.rwTextures.size() == 1 && translator.rwTextures[0] == c);
+    SL_REQUIRE(translator.dispatches.size() == 1);
+    SL_EXPECT(translator.dispatches[0].blockX == 8 && translator.dispatches[0].blockY == 4 && translator.dispatches[0].blockZ == 2);
+    SL_EXPECT(translator.barriers.size() == 2 && translator.barriers[1] == c);
+    SL_REQUIRE(translator.copies.size() == 1);
+    SL_EXPECT(translator.copies[0].dst == b && translator.copies[0].src == a);
+
+    // Streams are immutable, translating again gives the same result
+    RecordingTranslator again;
+    SL_EXPECT(stream.decode(again) == ComputeStatus::eOk);
+    SL_EXPECT(memcmp(again.counts, translator.counts, sizeof(again.counts)) == 0);
+}
+
+SL_TEST(commandStreamDropsRedundantBinds)
+{
+    auto a = fakeResource(0x1000);
+    auto c = fakeResource(0x3000);
+    float consts[4]{};
+
+    CommandStream stream;
+    stream.bindSharedState(0);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        stream.bindKernel(42);
+        stream.bindTexture(0, 0, a);
+        stream.bindRWTexture(1, 0, c);
+        stream.bindConsts(2, 0, consts, sizeof(consts), 3);
+        stream.dispatch(8, 8, i + 1);
+    }
+    // Kernel and both resources are recorded once, constants and dispatches every time
+    SL_EXPECT(stream.getSkippedCount() == 6);
+    SL_EXPECT(stream.getCommandCount() == 10);
+
+    // A different kernel starts with empty slots
+    stream.bindKernel(43);
+    stream.bindTexture(0, 0, a);
+    stream.dispatch(1, 1);
+    RecordingTranslator translator;
+    SL_REQUIRE(stream.decode(translator) == ComputeStatus::eOk);
+    SL_EXPECT(translator.count(CommandOp::eBindKernel) == 2);
+    SL_EXPECT(translator.textures.size() == 2);
+    SL_EXPECT(translator.dispatches.size() == 4);
+}
+
+SL_TEST(commandStreamFoldsTransitions)
+{
+    auto a = fakeResource(0x1000);
+    auto b = fakeResource(0x2000);
+    auto c = fakeResource(0x3000);
+
+    CommandStream stream;
+    ResourceTransition first[] = { { a, ResourceState::eStorageRW }, { b, ResourceState::eTextureRead, ResourceState::eTextureRead } };
+    stream.transitionResources(first, 2);
+    ResourceTransition second[] = { { a, ResourceState::eTextureRead }, { c, ResourceState::eStorageRW } };
+    stream.transitionResources(second, 2);
+    SL_EXPECT(stream.getCommandCount() == 1);
+
+    RecordingTranslator translator;
+    SL_REQUIRE(stream.decode(translator) == ComputeStatus::eOk);
+    SL_EXPECT(translator.count(CommandOp::eTransition) == 1);
+    // 'b' is already in the requested state, 'a' ends up in its last state
+    SL_REQUIRE(translator.transitions.size() == 2);
+    SL_EXPECT(translator.transitions[0].resource == a && translator.transitions[0].to == ResourceState::eTextureRead);
+    SL_EXPECT(translator.transitions[1].resource == c && translator.transitions[1].to == ResourceState::eStorageRW);
+
+    // Anything recorded in between closes the batch
+    stream.dispatch(1, 1);
+    stream.transitionResources(first, 1);
+    RecordingTranslator split;
+    split.kernel = 1;
+    SL_REQUIRE(stream.decode(split) == ComputeStatus::eOk);
+    SL_EXPECT(split.count(CommandOp::eTransition) == 2);
+}
+
+SL_TEST(commandStreamRecordsTranslatedResourceCopies)
+{
+    // Same sequence the D3D11 backend records to copy translated resources
+    Resource sources[] = { fakeResource(0x10), fakeResource(0x20) };
+    Resource clones[] = { fakeResource(0x11), fakeResource(0x21) };
+    CommandStream stream;
+    for (uint32_t frame = 0; frame < 2; frame++)
+    {
+        stream.reset();
+        stream.bindSharedState(0);
+        stream.bindKernel(7);
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            float texSize[4] = { 64.0f * (i + 1), 32.0f, 1.0f / (64.0f * (i + 1)), 1.0f / 32.0f };
+            stream.bindConsts(0, 0, texSize, sizeof(texSize), 1);
+            stream.bindTexture(1, 0, sources[i]);
+            stream.bindRWTexture(2, 0, clones[i]);
+            stream.dispatch((uint32_t(texSize[0]) + 15) / 16, (uint32_t(texSize[1]) + 15) / 16, 1);
+        }
+    }
+    RecordingTranslator translator;
+    SL_REQUIRE(stream.decode(translator) == ComputeStatus::eOk);
+    SL_EXPECT(translator.count(CommandOp::eBindSharedState) == 1);
+    SL_EXPECT(translator.count(CommandOp::eBindKernel) == 1);
+    SL_REQUIRE(translator.dispatches.size() == 2);
+    SL_EXPECT(translator.dispatches[0].blockX == 4 && translator.dispatches[0].blockY == 2);
+    SL_EXPECT(translator.dispatches[1].blockX == 8 && translator.dispatches[1].blockY == 2);
+    SL_EXPECT(translator.textures.size() == 2 && translator.textures[1] == sources[1]);
+    SL_EXPECT(translator.rwTextures.size() == 2 && translator.rwTextures[1] == clones[1]);
+    SL_EXPECT(translator.consts.size() == 8 && translator.consts[4] == 128.0f);
+}
+
+SL_TEST(commandStreamRejectsMalformedData)
+{
+    auto a = fakeResource(0x1000);
+    float consts[4]{};
+    CommandStream stream;
+    stream.bindKernel(1);
+    stream.bindConsts(0, 0, consts, sizeof(consts), 1);
+    ResourceTransition transition{ a, ResourceState::eStorageRW };
+    stream.transitionResources(&transition, 1);
+    Resource barrier = a;
+    stream.insertUAVBarriers(&barrier, 1);
+    stream.dispatch(1, 1);
+
+    // Truncated streams only decode when cut at a command boundary
+    uint32_t boundaries = 0;
+    for (size_t size = 0; size < stream.getSize(); size++)
+    {
+        NullCommandTranslator translator;
+        if (CommandStream::decode(stream.getData(), size, translator) == ComputeStatus::eOk)
+        {
+            boundaries++;
+        }
+    }
+    SL_EXPECT(boundaries == stream.getCommandCount());
+
+    std::vector<uint8_t> data((const uint8_t*)stream.getData(), (const uint8_t*)stream.getData() + stream.getSize());
+    auto header = (CommandHeader*)data.data();
+    NullCommandTranslator translator;
+    header->op = (CommandOp)99;
+    SL_EXPECT(CommandStream::decode(data.data(), data.size(), translator) == ComputeStatus::eInvalidArgument);
+    header->op = CommandOp::eTransition;
+    ((CmdTransition*)(header + 1))->count = 1000000;
+    SL_EXPECT(CommandStream::decode(data.data(), data.size(), translator) == ComputeStatus::eInvalidArgument);
+    header->op = CommandOp::eBindKernel;
+    header->size = 12;
+    SL_EXPECT(CommandStream::decode(data.data(), data.size(), translator) == ComputeStatus::eInvalidArgument);
+
+    // Binding without a kernel is an invalid call
+    CommandStream unbound;
+    unbound.bindTexture(0, 0, a);
+    NullCommandTranslator noKernel;
+    SL_EXPECT(unbound.decode(noKernel) == ComputeStatus::eInvalidCall);
+}
@@ -0,0 +1,290 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include <map>
+#include <memory>
+#include <thread>
+#include <random>
+
+#include "source/tests/test.h"
+#include "source/core/sl.plugin-manager/deferredPlugins.h"
+
+using namespace sl;
+using namespace sl::plugin_manager;
+
+namespace
+{
+
+struct MockPlugin
+{
+    std::string name;
+    std::vector<std::string> requiredPlugins;
+    std::atomic<PluginState> state{ PluginState::eDeferred };
+    bool failsToLoad = false;
+    std::atomic<uint32_t> loadCount{};
+};
+
+//! Stands in for the plugin manager, loading just records the order
+struct MockManager
+{
+    std::mutex mtx;
+    std::vector<std::unique_ptr<MockPlugin>> plugins;
+    std::vector<std::string> loadOrder;
+    std::map<std::string, std::string> errors;
+    std::atomic<uint32_t> loadedCallbacks{};
+    //! Plugins are not mapped yet, nothing can load
+    bool ready = true;
+    //! Set if a plugin was loaded before one of its dependencies
+    bool orderViolated = false;
+
+    DeferredPluginLoader<MockPlugin> loader{ mtx,
+        [this](const std::string& name)->MockPlugin*
+        {
+            for (auto& p : plugins)
+            {
+                if (p->name == name) return p.get();
+            }
+            return nullptr;
+        },
+        [this](MockPlugin* plugin)->PluginState
+        {
+            if (!ready) return PluginState::eDeferred;
+            for (auto& required : plugin->requiredPlugins)
+            {
+                if (get(required)->state.load() != PluginState::eLoaded) orderViolated = true;
+            }
+            plugin->loadCount++;
+            loadOrder.push_back(plugin->name);
+            // Give other threads a chance to race for the same plugin
+            std::this_thread::yield();
+            return plugin->failsToLoad ? PluginState::eFailed : PluginState::eLoaded;
+        },
+        [this](MockPlugin* plugin, const std::string& error) { errors[plugin->name] = error; },
+        [this](MockPlugin* plugin) { loadedCallbacks++; } };
+
+    MockPlugin* add(const std::string& name, std::vector<std::string> required = {})
+    {
+        plugins.push_back(std::make_unique<MockPlugin>());
+        auto p = plugins.back().get();
+        p->name = name;
+        p->requiredPlugins = std::move(required);
+        return p;
+    }
+
+    MockPlugin* get(const std::string& name)
+    {
+        for (auto& p : plugins)
+        {
+            if (p->name == name) return p.get();
+        }
+        return nullptr;
+    }
+};
+
+PluginManifest makeManifest(Feature id, const std::string& name, std::vector<std::string> required = {})
+{
+    PluginManifest m{};
+    m.id = id;
+    m.name = name;
+    m.api = { 0, 0, 1 };
+    m.priority = 1;
+    m.requiredPlugins = std::move(required);
+    return m;
+}
+
+}
+
+SL_TEST(deferredPluginsLoadDependenciesFirst)
+{
+    MockManager m;
+    m.add("sl.a");
+    m.add("sl.b", { "sl.a" });
+    auto c = m.add("sl.c", { "sl.b", "sl.a" });
+
+    SL_EXPECT(m.loader.resolve(c));
+    SL_REQUIRE(m.loadOrder.size() == 3);
+    SL_EXPECT(m.loadOrder[0] == "sl.a" && m.loadOrder[1] == "sl.b" && m.loadOrder[2] == "sl.c");
+    SL_EXPECT(!m.orderViolated);
+    SL_EXPECT(m.loadedCallbacks == 3);
+
+    // Loaded once, later uses do not load again
+    SL_EXPECT(m.loader.resolve(c));
+    SL_EXPECT(m.loader.resolve(m.get("sl.a")));
+    SL_EXPECT(m.loadOrder.size() == 3);
+}
+
+SL_TEST(deferredPluginsResolvedWithoutLocking)
+{
+    MockManager m;
+    auto a = m.add("sl.a");
+    auto b = m.add("sl.b");
+    b->failsToLoad = true;
+    SL_EXPECT(m.loader.resolve(a));
+    SL_EXPECT(!m.loader.resolve(b));
+
+    // Owner holds its lock (loading another plugin, rebuilding hooks), evaluate path must not wait
+    std::scoped_lock lock(m.mtx);
+    SL_EXPECT(m.loader.resolve(a));
+    SL_EXPECT(!m.loader.resolve(b));
+}
+
+SL_TEST(deferredPluginsFailures)
+{
+    MockManager m;
+    auto broken = m.add("sl.broken");
+    broken->failsToLoad = true;
+    auto dependent = m.add("sl.dependent", { "sl.broken" });
+    auto orphan = m.add("sl.orphan", { "sl.missing" });
+
+    SL_EXPECT(!m.loader.resolve(dependent));
+    SL_EXPECT(broken->state == PluginState::eFailed);
+    SL_EXPECT(dependent->state == PluginState::eFailed);
+    SL_EXPECT(dependent->loadCount == 0);
+    SL_EXPECT(m.errors["sl.dependent"].find("sl.broken") != std::string::npos);
+
+    SL_EXPECT(!m.loader.resolve(orphan));
+    SL_EXPECT(orphan->loadCount == 0);
+    SL_EXPECT(m.errors["sl.orphan"].find("sl.missing") != std::string::npos);
+
+    // Failure is final
+    broken->failsToLoad = false;
+    SL_EXPECT(!m.loader.resolve(broken));
+    SL_EXPECT(broken->loadCount == 1);
+    SL_EXPECT(m.loadedCallbacks == 0);
+}
+
+SL_TEST(deferredPluginsCircularDependency)
+{
+    MockManager m;
+    auto a = m.add("sl.a", { "sl.b" });
+    auto b = m.add("sl.b", { "sl.a" });
+    SL_EXPECT(!m.loader.resolve(a));
+    SL_EXPECT(a->state == PluginState::eFailed);
+    SL_EXPECT(b->state == PluginState::eFailed);
+    SL_EXPECT(m.loadOrder.empty());
+}
+
+SL_TEST(deferredPluginsRetryWhenTooEarly)
+{
+    MockManager m;
+    m.add("sl.a");
+    auto b = m.add("sl.b", { "sl.a" });
+    m.ready = false;
+    SL_EXPECT(!m.loader.resolve(b));
+    SL_EXPECT(b->state == PluginState::eDeferred);
+    SL_EXPECT(m.get("sl.a")->state == PluginState::eDeferred);
+    SL_EXPECT(m.errors.empty());
+
+    m.ready = true;
+    SL_EXPECT(m.loader.resolve(b));
+    SL_EXPECT(m.loadOrder.size() == 2);
+}
+
+SL_TEST(deferredPluginsConcurrentFirstUse)
+{
+    for (uint32_t iteration = 0; iteration < 20; iteration++)
+    {
+        MockManager m;
+        // Chain of dependencies with a few independent plugins and one broken one
+        m.add("sl.p0");
+        for (uint32_t i = 1; i < 6; i++)
+        {
+            m.add("sl.p" + std::to_string(i), { "sl.p" + std::to_string(i - 1) });
+        }
+        m.add("sl.x");
+        m.add("sl.y", { "sl.p2", "sl.x" });
+        m.add("sl.bad")->failsToLoad = true;
+        m.add("sl.z", { "sl.bad" });
+
+        constexpr uint32_t kThreads = 8;
+        std::atomic<uint32_t> wrong{};
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < kThreads; t++)
+        {
+            threads.emplace_back([&m, &wrong, t, iteration]()
+            {
+                std::mt19937 rng(t * 31 + iteration);
+                for (uint32_t n = 0; n < 200; n++)
+                {
+                    auto& plugin = m.plugins[rng() % m.plugins.size()];
+                    bool expected = plugin->name != "sl.bad" && plugin->name != "sl.z";
+                    if (m.loader.resolve(plugin.get()) != expected) wrong++;
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        SL_EXPECT(wrong == 0);
+        SL_EXPECT(!m.orderViolated);
+        for (auto& p : m.plugins)
+        {
+            // Each plugin is loaded exactly once, or never if a dependency failed
+            SL_EXPECT(p->loadCount == (p->name == "sl.z" ? 0u : 1u));
+        }
+        SL_EXPECT(m.loadedCallbacks == m.plugins.size() - 2);
+    }
+}
+
+SL_TEST(deferredPluginsSelection)
+{
+    Version api{ 0, 0, 1 };
+    std::vector<PluginManifest> manifests;
+    manifests.push_back(makeManifest(1, "sl.plain"));
+    manifests.push_back(makeManifest(2, "sl.hooks"));
+    manifests.back().hasHooks = true;
+    manifests.push_back(makeManifest(3, "sl.base"));
+    manifests.push_back(makeManifest(4, "sl.user", { "sl.base" }));
+    manifests.push_back(makeManifest(5, "sl.dup"));
+    manifests.push_back(makeManifest(5, "sl.dup2"));
+    manifests.push_back(makeManifest(kFeatureCommon, "sl.common"));
+    manifests.push_back(makeManifest(6, "sl.notRequested"));
+    manifests.push_back(makeManifest(7, "sl.newerApi"));
+    manifests.back().api = { 0, 0, 2 };
+    manifests.push_back(makeManifest(8, "sl.exclusive"));
+    manifests.back().exclusiveHooks = { "IDXGISwapChain_Present" };
+    manifests.push_back(makeManifest(9, "sl.incompatible"));
+    manifests.back().incompatiblePlugins = { "sl.plain" };
+
+    auto deferred = selectDeferredPlugins(manifests, api, [](Feature id) { return id != 6; });
+    SL_REQUIRE(deferred.size() == manifests.size());
+    std::map<std::string, bool> byName;
+    for (size_t i = 0; i < manifests.size(); i++)
+    {
+        byName[manifests[i].name] = deferred[i];
+    }
+    SL_EXPECT(byName["sl.plain"]);
+    SL_EXPECT(byName["sl.user"]);
+    SL_EXPECT(!byName["sl.hooks"]);
+    // Required by a requested plugin so it is loaded up front
+    SL_EXPECT(!byName["sl.base"]);
+    SL_EXPECT(!byName["sl.dup"] && !byName["sl.dup2"]);
+    SL_EXPECT(!byName["sl.common"]);
+    SL_EXPECT(!byName["sl.notRequested"]);
+    SL_EXPECT(!byName["sl.newerApi"]);
+    SL_EXPECT(!byName["sl.exclusive"]);
+    SL_EXPECT(!byName["sl.incompatible"]);
+}
@@ -0,0 +1,346 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <map>
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/descriptorBuilder.h"
+
+using namespace sl::chi;
+
+namespace
+{
+
+struct FakePool
+{
+    int id{};
+};
+
+struct FakeBufferInfo
+{
+    uint64_t buffer{};
+    uint64_t range{};
+};
+
+struct FakeImageInfo
+{
+    uint64_t view{};
+    uint32_t layout{};
+};
+
+//! Mirrors the fields of 'VkWriteDescriptorSet' the builder is used with
+struct FakeWrite
+{
+    uint32_t binding{};
+    uint32_t count{};
+    const FakeBufferInfo* buffers{};
+    const FakeImageInfo* images{};
+};
+
+using SmallWriteBuilder = DescriptorWriteBuilder<FakeWrite, FakeBufferInfo, FakeImageInfo, 4, 8>;
+
+//! Pools with a fixed number of sets, frame delay matches the chi default
+struct FakeDevice
+{
+    static constexpr int kSetsPerPool = 4;
+
+    std::map<int, int> used;
+    int created{};
+    int resets{};
+    int destroyed{};
+
+    DescriptorPoolPages<FakePool> pages{
+        [this](FakePool& pool) { pool.id = ++created; used[pool.id] = 0; return true; },
+        [this](FakePool pool) { used[pool.id] = 0; resets++; },
+        [this](FakePool) { destroyed++; } };
+
+    DescriptorPoolPages<FakePool>::Page* allocate(uint32_t frame)
+    {
+        return pages.allocate(frame, [this](FakePool pool)
+        {
+            if (used[pool.id] == kSetsPerPool) return false;
+            used[pool.id]++;
+            return true;
+        });
+    }
+};
+
+}
+
+SL_TEST(descriptorPoolPagesGrowWhenFull)
+{
+    FakeDevice device;
+    for (int i = 0; i < 10; i++)
+    {
+        SL_REQUIRE(device.allocate(0));
+    }
+    SL_EXPECT(device.pages.getPageCount() == 3);
+    SL_EXPECT(device.resets == 0);
+}
+
+SL_TEST(descriptorPoolPagesReachSteadyState)
+{
+    FakeDevice device;
+    // Pages stay in flight for the frame delay, after that they are reset and reused
+    for (uint32_t frame = 0; frame < 4; frame++)
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            SL_REQUIRE(device.allocate(frame));
+        }
+    }
+    auto peak = device.pages.getPageCount();
+    for (uint32_t frame = 4; frame < 100; frame++)
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            SL_REQUIRE(device.allocate(frame));
+        }
+    }
+    SL_EXPECT(device.pages.getPageCount() <= peak + 3);
+    SL_EXPECT(device.resets > 0);
+}
+
+SL_TEST(descriptorPoolPagesRetainDetectsReset)
+{
+    FakeDevice device;
+    auto page = device.allocate(0);
+    SL_REQUIRE(page);
+    auto epoch = page->epoch.load();
+    // Retained every frame so the page is never recycled
+    for (uint32_t frame = 1; frame < 10; frame++)
+    {
+        SL_EXPECT(device.pages.retain(page, epoch, frame));
+        device.allocate(frame);
+    }
+    SL_EXPECT(page->epoch.load() == epoch);
+    for (uint32_t frame = 10; frame < 20; frame++)
+    {
+        device.allocate(frame);
+    }
+    SL_EXPECT(page->epoch.load() != epoch);
+    SL_EXPECT(!device.pages.retain(page, epoch, 20));
+}
+
+SL_TEST(descriptorPoolPagesDestroyEveryPool)
+{
+    int created = 0;
+    int destroyed = 0;
+    {
+        FakeDevice device;
+        for (uint32_t frame = 0; frame < 50; frame++)
+        {
+            for (int i = 0; i < 10; i++)
+            {
+                SL_REQUIRE(device.allocate(frame));
+            }
+        }
+        device.pages.destroy();
+        created = device.created;
+        destroyed = device.destroyed;
+        SL_EXPECT(device.pages.getPageCount() == 0);
+    }
+    SL_EXPECT(created > 0);
+    SL_EXPECT(destroyed == created);
+}
+
+SL_TEST(descriptorPoolPagesCreateFailure)
+{
+    DescriptorPoolPages<FakePool> pages([](FakePool&) { return false; }, [](FakePool) {}, [](FakePool) {});
+    SL_EXPECT(!pages.allocate(0, [](FakePool) { return true; }));
+    SL_EXPECT(pages.getPageCount() == 0);
+}
+
+SL_TEST(descriptorSetCacheEvictsLeastRecentlyUsed)
+{
+    struct Page {};
+    Page a, b, c;
+    DescriptorSetCache<int, Page, 2> cache;
+    uint64_t k1[2] = { 1, 2 };
+    uint64_t k2[2] = { 1, 3 };
+    uint64_t k3[1] = { 9 };
+
+    SL_EXPECT(!cache.find(k1, 2, 0));
+    cache.insert(k1, 2, 11, &a, 0, 0);
+    cache.insert(k2, 2, 22, &b, 0, 0);
+    SL_REQUIRE(cache.find(k1, 2, 0));
+    SL_EXPECT(cache.find(k1, 2, 0)->set == 11);
+    SL_EXPECT(cache.getCurrent()->set == 11);
+
+    // k2 is the oldest so it is replaced
+    cache.insert(k3, 1, 33, &c, 0, 0);
+    SL_EXPECT(!cache.find(k2, 2, 0));
+    SL_EXPECT(cache.find(k1, 2, 0));
+    SL_REQUIRE(cache.find(k3, 1, 0));
+    SL_EXPECT(cache.find(k3, 1, 0)->set == 33);
+    // Same values with a different count is a different key
+    SL_EXPECT(!cache.find(k1, 1, 0));
+}
+
+SL_TEST(descriptorSetCacheInvalidate)
+{
+    struct Page {};
+    Page a;
+    DescriptorSetCache<int, Page> cache;
+    uint64_t key[3] = { 4, 5, 6 };
+    cache.insert(key, 3, 7, &a, 1, 0);
+    auto entry = cache.find(key, 3, 0);
+    SL_REQUIRE(entry);
+    SL_EXPECT(entry->epoch == 1);
+    cache.invalidate(entry);
+    SL_EXPECT(!cache.find(key, 3, 0));
+    SL_EXPECT(!cache.getCurrent());
+}
+
+SL_TEST(descriptorSetCacheResourceGeneration)
+{
+    struct Page {};
+    Page a;
+    DescriptorSetCache<int, Page> cache;
+    // Same handle values before and after the resource behind them was destroyed
+    uint64_t key[2] = { 0x1000, 0x2000 };
+    cache.insert(key, 2, 7, &a, 0, 5);
+    SL_REQUIRE(cache.getCurrent(5));
+    SL_EXPECT(cache.getCurrent(5)->set == 7);
+
+    // Fast path must not rebind a set written before a resource was destroyed
+    SL_EXPECT(!cache.getCurrent(6));
+    SL_EXPECT(!cache.getCurrent());
+    SL_EXPECT(!cache.find(key, 2, 6));
+
+    cache.insert(key, 2, 8, &a, 0, 6);
+    SL_REQUIRE(cache.find(key, 2, 6));
+    SL_EXPECT(cache.find(key, 2, 6)->set == 8);
+    SL_EXPECT(cache.getCurrent(6)->set == 8);
+}
+
+SL_TEST(descriptorWriteBuilderBatchesWrites)
+{
+    SmallWriteBuilder builder;
+    // Buffer and image slots interleaved the way a signature lists them
+    const uint32_t counts[] = { 2, 3, 1, 4 };
+    for (uint32_t slot = 0; slot < 4; slot++)
+    {
+        auto write = builder.addWrite();
+        SL_REQUIRE(write);
+        write->binding = slot;
+        write->count = counts[slot];
+        if (slot % 2 == 0)
+        {
+            auto buffers = builder.allocateBuffers(counts[slot]);
+            SL_REQUIRE(buffers);
+            for (uint32_t i = 0; i < counts[slot]; i++)
+            {
+                buffers[i] = { slot * 100ull + i, 256 };
+            }
+            write->buffers = buffers;
+        }
+        else
+        {
+            auto images = builder.allocateImages(counts[slot]);
+            SL_REQUIRE(images);
+            for (uint32_t i = 0; i < counts[slot]; i++)
+            {
+                images[i] = { slot * 100ull + i, 1 };
+            }
+            write->images = images;
+        }
+    }
+
+    // One batch in slot order, infos are still intact after all allocations
+    SL_REQUIRE(builder.getWriteCount() == 4);
+    auto writes = builder.getWrites();
+    for (uint32_t slot = 0; slot < 4; slot++)
+    {
+        SL_EXPECT(writes[slot].binding == slot && writes[slot].count == counts[slot]);
+        for (uint32_t i = 0; i < counts[slot]; i++)
+        {
+            if (slot % 2 == 0)
+            {
+                SL_EXPECT(!writes[slot].images && writes[slot].buffers[i].buffer == slot * 100ull + i);
+            }
+            else
+            {
+                SL_EXPECT(!writes[slot].buffers && writes[slot].images[i].view == slot * 100ull + i);
+            }
+        }
+    }
+    // Infos of the same type are packed back to back
+    SL_EXPECT(writes[2].buffers == writes[0].buffers + counts[0]);
+    SL_EXPECT(writes[3].images == writes[1].images + counts[1]);
+}
+
+SL_TEST(descriptorWriteBuilderWriteOverflow)
+{
+    SmallWriteBuilder builder;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        SL_REQUIRE(builder.addWrite());
+    }
+    SL_EXPECT(!builder.addWrite());
+    SL_EXPECT(!builder.addWrite());
+    SL_EXPECT(builder.getWriteCount() == 4);
+}
+
+SL_TEST(descriptorWriteBuilderInfoOverflow)
+{
+    SmallWriteBuilder builder;
+    SL_REQUIRE(builder.allocateBuffers(6));
+    // Failed allocation does not consume anything, what is left can still be used
+    SL_EXPECT(!builder.allocateBuffers(3));
+    auto last = builder.allocateBuffers(2);
+    SL_EXPECT(last != nullptr);
+    SL_EXPECT(!builder.allocateBuffers(1));
+
+    // Buffer and image storage are independent
+    SL_EXPECT(builder.allocateImages(8) != nullptr);
+    SL_EXPECT(!builder.allocateImages(1));
+
+    // Counts which would wrap around must not pass the capacity check
+    builder.reset();
+    SL_REQUIRE(builder.allocateBuffers(1));
+    SL_EXPECT(!builder.allocateBuffers(UINT32_MAX));
+    SL_EXPECT(!builder.allocateImages(UINT32_MAX));
+    SL_EXPECT(builder.allocateBuffers(7) != nullptr);
+
+    // Empty slots do not use any storage
+    SL_EXPECT(builder.allocateBuffers(0) != nullptr);
+}
+
+SL_TEST(descriptorWriteBuilderReset)
+{
+    SmallWriteBuilder builder;
+    auto first = builder.addWrite();
+    auto buffers = builder.allocateBuffers(8);
+    SL_REQUIRE(first && buffers);
+    first->binding = 5;
+    first->buffers = buffers;
+
+    // Storage is reused in place for the next update and writes start out cleared
+    builder.reset();
+    SL_EXPECT(builder.getWriteCount() == 0);
+    auto write = builder.addWrite();
+    SL_EXPECT(write == first);
+    SL_EXPECT(write->binding == 0 && write->buffers == nullptr);
+    SL_EXPECT(builder.allocateBuffers(8) == buffers);
+}
@@ -0,0 +1,112 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <string>
+
+#include "source/tests/test.h"
+#include "source/core/sl.plugin/exportTable.h"
+
+using namespace sl::plugin;
+
+namespace
+{
+
+void slOnPluginLoad() {}
+void slOnPluginShutdown() {}
+void slOnPluginStartup() {}
+void slSetTag() {}
+void slSetConstants() {}
+void slEvaluateFeature() {}
+void slHookPresent() {}
+void slHookPresent1() {}
+void slHookVkPresent() {}
+
+}
+
+SL_TEST(exportTableFindsEveryExport)
+{
+    static const ExportTable s_exports =
+    {
+        SL_EXPORT_FUNCTION(slOnPluginLoad),
+        SL_EXPORT_FUNCTION(slOnPluginShutdown),
+        SL_EXPORT_FUNCTION(slOnPluginStartup),
+        SL_EXPORT_FUNCTION(slSetTag),
+        SL_EXPORT_FUNCTION(slSetConstants),
+        SL_EXPORT_FUNCTION(slEvaluateFeature),
+        SL_EXPORT_FUNCTION(slHookPresent),
+        SL_EXPORT_FUNCTION(slHookPresent1),
+        SL_EXPORT_FUNCTION(slHookVkPresent),
+    };
+    SL_EXPECT(s_exports.size() == 9);
+    SL_EXPECT(s_exports.find("slOnPluginLoad") == (void*)slOnPluginLoad);
+    SL_EXPECT(s_exports.find("slHookPresent") == (void*)slHookPresent);
+    SL_EXPECT(s_exports.find("slHookPresent1") == (void*)slHookPresent1);
+    SL_EXPECT(s_exports.find("slHookVkPresent") == (void*)slHookVkPresent);
+
+    // Names are compared, not pointers, so copies of the string resolve too
+    std::string copy = "slSetConstants";
+    SL_EXPECT(s_exports.find(copy.c_str()) == (void*)slSetConstants);
+}
+
+SL_TEST(exportTableRejectsUnknownNames)
+{
+    static const ExportTable s_exports = { SL_EXPORT_FUNCTION(slSetTag), SL_EXPORT_FUNCTION(slEvaluateFeature) };
+    SL_EXPECT(s_exports.find(nullptr) == nullptr);
+    SL_EXPECT(s_exports.find("") == nullptr);
+    SL_EXPECT(s_exports.find("slSetTa") == nullptr);
+    SL_EXPECT(s_exports.find("slSetTags") == nullptr);
+    // Same length and tail as an export
+    SL_EXPECT(s_exports.find("xlSetTag") == nullptr);
+}
+
+SL_TEST(exportTableHandlesSharedTailsAndDuplicates)
+{
+    // Identical length and last eight characters force hashing of whole names
+    static int a, b, c, d;
+    const ExportTable exports =
+    {
+        { "slFirst_GetFeature", &a },
+        { "slOther_GetFeature", &b },
+        { "slFirst_GetFeature", &c },
+        { "x", &d },
+    };
+    SL_EXPECT(exports.find("slFirst_GetFeature") == &a);
+    SL_EXPECT(exports.find("slOther_GetFeature") == &b);
+    SL_EXPECT(exports.find("x") == &d);
+    SL_EXPECT(exports.find("slThird_GetFeature") == nullptr);
+}
+
+SL_TEST(exportTableManyExports)
+{
+    // Every name must land in its own slot no matter how many there are
+    std::vector<std::string> names;
+    for (uint32_t i = 0; i < 500; i++) names.push_back("slHookFunction" + std::to_string(i));
+    std::vector<ExportedFunction> exports;
+    for (auto& name : names) exports.push_back({ name.c_str(), (void*)&name });
+    const ExportTable table(exports);
+    for (auto& name : names)
+    {
+        SL_EXPECT(table.find(name.c_str()) == (void*)&name);
+    }
+    SL_EXPECT(table.find("slHookFunction500") == nullptr);
+}
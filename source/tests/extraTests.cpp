@@ -0,0 +1,303 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <random>
+#include <thread>
+
+#include "source/tests/test.h"
+#include "source/core/sl.extra/extra.h"
+
+using namespace sl::extra;
+
+namespace
+{
+
+//! Distributions are built from raw mt19937 output so the streams are identical on every standard library
+struct Random
+{
+    double uniform() { return m_rng() / 4294967296.0; }
+    double exponential() { return -std::log(1.0 - uniform()); }
+    //! Frame time like samples, mostly around 16ms with an occasional hitch
+    double frameTime() { return uniform() < 0.02 ? 33.0 + 10.0 * uniform() : 15.0 + 2.0 * uniform(); }
+
+    std::mt19937 m_rng{ 1 };
+};
+
+double exactQuantile(std::vector<double> values, double p)
+{
+    std::sort(values.begin(), values.end());
+    auto pos = p * (values.size() - 1);
+    auto i = (size_t)pos;
+    return i + 1 < values.size() ? values[i] + (values[i + 1] - values[i]) * (pos - i) : values[i];
+}
+
+double exactMedian(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    auto i = values.size() / 2;
+    return values.size() % 2 ? values[i] : (values[i] + values[i - 1]) / 2;
+}
+
+}
+
+SL_TEST(averageMeterMedianIsExactOverSlidingWindow)
+{
+    Random rnd;
+    TAverageValueMeter<7> meter;
+    SL_EXPECT(meter.getMedian() == 0.0);
+    std::vector<double> samples;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        auto value = std::floor(rnd.uniform() * 20);
+        samples.push_back(value);
+        meter.add(value);
+        // Covers the partially filled window and both odd and even counts
+        auto first = samples.size() > 7 ? samples.end() - 7 : samples.begin();
+        SL_EXPECT(meter.getMedian() == exactMedian({ first, samples.end() }));
+    }
+    meter.reset();
+    meter.add(1.0);
+    meter.add(2.0);
+    SL_EXPECT(meter.getMedian() == 1.5);
+}
+
+SL_TEST(averageMeterMedianTracksRecentSamples)
+{
+    // A level shift must show up as soon as it is the majority of the window, not at the next window boundary
+    AverageValueMeter meter;
+    for (uint32_t i = 0; i < kAverageMeterWindowSize; i++) meter.add(10.0);
+    for (uint32_t i = 0; i < kAverageMeterWindowSize / 2 + 1; i++) meter.add(20.0);
+    SL_EXPECT(meter.getMedian() == 20.0);
+}
+
+SL_TEST(averageMeterPercentilesAreOptIn)
+{
+    // Cost check, the default meter carries no sketch and the opted in one pays for two generations of three estimators
+    SL_EXPECT(sizeof(AverageValueMeter) < sizeof(TAverageValueMeter<kAverageMeterWindowSize, true>));
+    SL_EXPECT(sizeof(AverageValueMeter) <= sizeof(double) * (kAverageMeterWindowSize + 8));
+    SL_EXPECT(sizeof(TPercentileSketch<kAverageMeterWindowSize>) == sizeof(TPercentileSketch<100000>));
+
+    TAverageValueMeter<kAverageMeterWindowSize, true> meter;
+    for (uint32_t i = 0; i < 1000; i++) meter.add(i % 10);
+    SL_EXPECT(meter.getP50() >= 4.0 && meter.getP50() <= 5.0);
+    SL_EXPECT(meter.getP90() >= 8.0 && meter.getP90() <= 9.0);
+    SL_EXPECT(meter.getMedian() == 4.5);
+}
+
+SL_TEST(p2QuantileIsExactForFewSamples)
+{
+    P2Quantile q(0.5);
+    SL_EXPECT(q.get() == 0.0);
+    q.add(3.0);
+    SL_EXPECT(q.get() == 3.0);
+    q.add(1.0);
+    SL_EXPECT(q.get() == 2.0);
+    q.add(2.0);
+    SL_EXPECT(q.get() == 2.0);
+    SL_EXPECT(q.getNumSamples() == 3);
+}
+
+SL_TEST(p2QuantileAccuracy)
+{
+    // Relative error against the exact quantile of the same stream
+    struct Case
+    {
+        double p;
+        double tolerance;
+    };
+    for (uint32_t dist = 0; dist < 3; dist++)
+    {
+        for (auto c : { Case{ 0.5, 0.02 }, Case{ 0.9, 0.03 }, Case{ 0.99, 0.05 } })
+        {
+            Random rnd;
+            P2Quantile q(c.p);
+            std::vector<double> values;
+            for (uint32_t i = 0; i < 20000; i++)
+            {
+                auto x = dist == 0 ? rnd.uniform() + 1.0 : dist == 1 ? rnd.exponential() : rnd.frameTime();
+                values.push_back(x);
+                q.add(x);
+            }
+            auto exact = exactQuantile(values, c.p);
+            SL_EXPECT(std::abs(q.get() - exact) <= c.tolerance * exact);
+        }
+    }
+}
+
+SL_TEST(percentileSketchReportsLastCompleteWindow)
+{
+    TPercentileSketch<100> sketch;
+    for (uint32_t i = 0; i < 100; i++) sketch.add(10.0);
+    SL_EXPECT(sketch.getP50() == 10.0);
+    // Samples of the window being collected do not leak into the result until it completes
+    for (uint32_t i = 0; i < 99; i++) sketch.add(50.0);
+    SL_EXPECT(sketch.getP50() == 10.0);
+    sketch.add(50.0);
+    SL_EXPECT(sketch.getP50() == 50.0);
+    sketch.reset();
+    SL_EXPECT(sketch.getP99() == 0.0);
+}
+
+namespace
+{
+
+struct Streamable
+{
+    int value;
+};
+
+std::ostream& operator<<(std::ostream& stream, const Streamable& s)
+{
+    return stream << "Streamable(" << s.value << ")";
+}
+
+}
+
+SL_TEST(timerTicksMatchSteadyClock)
+{
+    // Calibration, ticks and the reported frequency must agree with an independent clock
+    SL_REQUIRE(timer::getFrequency() > 0);
+    auto ticks = timer::getTicks();
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto elapsedTicks = timer::getTicks() - ticks;
+    auto expectedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    auto elapsedUs = timer::ticksToUs(elapsedTicks);
+    SL_EXPECT(elapsedUs >= 50000);
+    // Both reads straddle the sleep so only scheduling noise separates them
+    SL_EXPECT(std::abs(elapsedUs - expectedUs) <= expectedUs / 20 + 1000);
+
+    // Monotonic even when read back to back
+    auto previous = timer::getTicks();
+    for (uint32_t i = 0; i < 100000; i++)
+    {
+        auto current = timer::getTicks();
+        SL_EXPECT(current >= previous);
+        previous = current;
+    }
+}
+
+SL_TEST(timerTicksToUsDoesNotOverflow)
+{
+    auto frequency = timer::getFrequency();
+    SL_EXPECT(timer::ticksToUs(0) == 0);
+    SL_EXPECT(timer::ticksToUs(frequency) == 1000000);
+    SL_EXPECT(timer::ticksToUs(frequency / 2) == 500000);
+    // A month of ticks, multiplying first would overflow at 1GHz
+    const int64_t month = 30ll * 24 * 3600;
+    SL_EXPECT(timer::ticksToUs(frequency * month) == month * 1000000);
+    SL_EXPECT(timer::ticksToUs(frequency * month + frequency / 1000) == month * 1000000 + 1000);
+}
+
+SL_TEST(timerScopedCPUTimerMeasuresSleep)
+{
+    AverageValueMeter meter;
+    {
+        ScopedCPUTimer timer(&meter);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    SL_EXPECT(meter.getNumSamples() == 1);
+    SL_EXPECT(meter.getElapsedTimeUs() >= 20000);
+    SL_EXPECT(meter.getValue() >= 20.0 && meter.getValue() < 1000.0);
+
+    // Consecutive timestamps measure the time in between
+    meter.reset();
+    meter.begin();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    meter.timestamp();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    meter.timestamp();
+    SL_EXPECT(meter.getNumSamples() == 2);
+    SL_EXPECT(meter.getMean() >= 5.0);
+    SL_EXPECT(meter.timeFromLastTimestampUs() < 1000000);
+}
+
+SL_TEST(timerBenchmarkOverhead)
+{
+    constexpr uint32_t kIterations = 1000000;
+    auto ticksNs = sl::test::measureNs(kIterations, [](uint32_t)
+    {
+        sl::test::keep((uint64_t)timer::getTicks());
+    });
+    AverageValueMeter meter;
+    auto scopedNs = sl::test::measureNs(kIterations, [&](uint32_t)
+    {
+        ScopedCPUTimer timer(&meter);
+    });
+    SL_EXPECT(meter.getNumSamples() == kIterations);
+    // An empty scope has to stay well below the resolution meters report in
+    SL_EXPECT(meter.getMedian() < 0.1);
+    sl::test::report("%.1fns getTicks, %.1fns ScopedCPUTimer", ticksNs, scopedNs);
+}
+
+SL_TEST(formatIntegersAndHex)
+{
+    SL_EXPECT(format("sl.param.sharedData.{}", 12u) == "sl.param.sharedData.12");
+    SL_EXPECT(format("{}.{}.{}", 1, -2, 3ull) == "1.-2.3");
+    SL_EXPECT(format("{}", (long long)INT64_MIN) == "-9223372036854775808");
+    SL_EXPECT(format("a{}%xb", (uint64_t)0xdeadbeefcafe) == "adeadbeefcafeb");
+    // Negative values print as their two's complement like std::hex did
+    SL_EXPECT(format("{}%x", -1) == "ffffffff");
+    SL_EXPECT(format("{}%x", (short)-2) == "fffe");
+    // Only '%x' directly after the placeholder is consumed
+    SL_EXPECT(format("{}%y", 2) == "2%y");
+    SL_EXPECT(format("{}", true) == "1");
+    SL_EXPECT(format("{}", 'c') == "c");
+}
+
+SL_TEST(formatFloatsUseTwoFixedDecimals)
+{
+    SL_EXPECT(format("{}ms", 2.0f) == "2.00ms");
+    SL_EXPECT(format("{}", 0.125) == "0.12");
+    SL_EXPECT(format("{}", 0.375) == "0.38");
+    SL_EXPECT(format("{}", 123456.789) == "123456.79");
+
+    // Same result as the stream based implementation for arbitrary values
+    std::mt19937_64 rng(3);
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        auto value = (double)(int64_t)rng() / 1e9;
+        char expected[64];
+        snprintf(expected, sizeof(expected), "x%.2fy", value);
+        SL_EXPECT(format("x{}y", value) == expected);
+    }
+}
+
+SL_TEST(formatStrings)
+{
+    std::string str = "hello";
+    const char* cstr = "cs";
+    const char* null = nullptr;
+    char array[8] = "arr";
+    SL_EXPECT(format("{} {} {}", str, cstr, array) == "hello cs arr");
+    SL_EXPECT(format("{}", std::string_view("sv")) == "sv");
+    SL_EXPECT(format("[{}]", null) == "[]");
+    SL_EXPECT(format("{}", "literal") == "literal");
+    SL_EXPECT(format("no placeholders") == "no placeholders");
+    SL_EXPECT(format("") == "");
+    SL_EXPECT(format("{}", Streamable{ 4 }) == "Streamable(4)");
+
+    // Longer than the stack buffer
+    auto longStr = format("{}{}", std::string(300, 'x'), std::string(10, 'y'));
+    SL_EXPECT(longStr == std::string(300, 'x') + std::string(10, 'y'));
+}
@@ -0,0 +1,196 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <map>
+#include <climits>
+#include <unordered_map>
+
+#include "source/tests/test.h"
+#include "source/core/sl.plugin-manager/featureIndex.h"
+
+using namespace sl;
+using namespace sl::plugin_manager;
+
+namespace
+{
+
+//! Ids as shipped, sparse on purpose
+const Feature kShippedFeatures[] = { 0, 2, 3, 4, 5, 6, 1000, 1001, 1002, 1003, 9999, UINT_MAX };
+
+//! Same slot handling as the plugin manager, ordinals are assigned in load order
+struct FeatureSlots
+{
+    FeatureIndex index;
+    std::vector<const void*> slots;
+
+    void map(const std::vector<Feature>& features)
+    {
+        index.clear();
+        slots.clear();
+        for (auto& f : features)
+        {
+            index.add(f, (uint32_t)slots.size());
+            slots.push_back(&f);
+        }
+    }
+
+    const void* get(Feature feature) const
+    {
+        auto ordinal = index.find(feature);
+        return ordinal < slots.size() ? slots[ordinal] : nullptr;
+    }
+};
+
+}
+
+SL_TEST(featureIndexMapsShippedIds)
+{
+    FeatureIndex index;
+    uint32_t ordinal = 0;
+    for (auto f : kShippedFeatures)
+    {
+        index.add(f, ordinal++);
+    }
+    ordinal = 0;
+    for (auto f : kShippedFeatures)
+    {
+        SL_EXPECT(index.find(f) == ordinal++);
+    }
+    // Only sl.imgui and sl.common end up in the list
+    SL_EXPECT(index.sparse.size() == 2);
+
+    // Ids which were never loaded
+    for (Feature f : { 1u, 7u, 999u, 1004u, 2047u, 2048u, 10000u, UINT_MAX - 1 })
+    {
+        SL_EXPECT(index.find(f) == FeatureIndex::kInvalidOrdinal);
+    }
+}
+
+SL_TEST(featureIndexBoundaries)
+{
+    FeatureIndex index;
+    index.add(0, 0);
+    index.add(FeatureIndex::kDirectCount - 1, 1);
+    index.add(FeatureIndex::kDirectCount, 2);
+    SL_EXPECT(index.find(0) == 0);
+    SL_EXPECT(index.find(FeatureIndex::kDirectCount - 1) == 1);
+    SL_EXPECT(index.find(FeatureIndex::kDirectCount) == 2);
+    SL_EXPECT(index.sparse.size() == 1);
+
+    // Ordinals past the byte table still map, through the list
+    index.add(7, 254);
+    index.add(8, 255);
+    index.add(9, 100000);
+    SL_EXPECT(index.find(7) == 254);
+    SL_EXPECT(index.find(8) == 255);
+    SL_EXPECT(index.find(9) == 100000);
+}
+
+SL_TEST(featureIndexRemap)
+{
+    FeatureIndex index;
+    index.add(9999, 0);
+    index.add(3, 1);
+    // Same id mapped again, e.g. a newer duplicate replacing the first plugin
+    index.add(9999, 5);
+    index.add(3, 300);
+    SL_EXPECT(index.find(9999) == 5);
+    SL_EXPECT(index.find(3) == 300);
+    SL_EXPECT(index.sparse.size() == 2);
+    // Moving back into the byte table drops the list entry
+    index.add(3, 2);
+    SL_EXPECT(index.find(3) == 2);
+    SL_EXPECT(index.sparse.size() == 1);
+
+    index.remove(9999);
+    index.remove(3);
+    index.remove(42);
+    SL_EXPECT(index.find(9999) == FeatureIndex::kInvalidOrdinal);
+    SL_EXPECT(index.find(3) == FeatureIndex::kInvalidOrdinal);
+    SL_EXPECT(index.sparse.empty());
+}
+
+SL_TEST(featureIndexReloadWithOtherPlugins)
+{
+    // slShutdown followed by slInit with a different set of features
+    FeatureSlots slots;
+    std::vector<Feature> first = { UINT_MAX, 0, 3, 1000 };
+    slots.map(first);
+    SL_EXPECT(slots.get(0) == &first[1]);
+    SL_EXPECT(slots.get(1000) == &first[3]);
+    SL_EXPECT(slots.get(UINT_MAX) == &first[0]);
+
+    std::vector<Feature> second = { UINT_MAX, 4, 1001, 9999 };
+    slots.map(second);
+    SL_EXPECT(slots.get(UINT_MAX) == &second[0]);
+    SL_EXPECT(slots.get(4) == &second[1]);
+    SL_EXPECT(slots.get(1001) == &second[2]);
+    SL_EXPECT(slots.get(9999) == &second[3]);
+    // Nothing from the previous mapping leaks through
+    SL_EXPECT(slots.get(0) == nullptr);
+    SL_EXPECT(slots.get(3) == nullptr);
+    SL_EXPECT(slots.get(1000) == nullptr);
+    SL_EXPECT(slots.index.sparse.size() == 2);
+
+    // Plugin failing to start clears its slot, other ordinals stay valid
+    slots.slots[slots.index.find(4)] = nullptr;
+    SL_EXPECT(slots.get(4) == nullptr);
+    SL_EXPECT(slots.get(1001) == &second[2]);
+}
+
+SL_TEST(featureIndexBenchmarkLookup)
+{
+    // Typical title with DLSS, Reflex, PCL, DLSS-G and sl.common, lookups from tag/constants/evaluate calls
+    const Feature loaded[] = { UINT_MAX, 0, 3, 4, 1000, 1001, 2, 9999 };
+    const Feature lookups[] = { 0, 1000, 3, 4, 0, 1000, 1001, 3 };
+
+    FeatureIndex index;
+    std::map<Feature, const void*> ordered;
+    std::unordered_map<Feature, const void*> hashed;
+    std::vector<const void*> slots;
+    for (auto& f : loaded)
+    {
+        index.add(f, (uint32_t)slots.size());
+        slots.push_back(&f);
+        ordered[f] = &f;
+        hashed[f] = &f;
+    }
+
+    constexpr uint32_t kIterations = 20000000;
+    auto indexNs = sl::test::measureNs(kIterations, [&](uint32_t i)
+    {
+        auto ordinal = index.find(lookups[i & 7]);
+        sl::test::keep((uint64_t)(uintptr_t)(ordinal < slots.size() ? slots[ordinal] : nullptr));
+    });
+    auto mapNs = sl::test::measureNs(kIterations, [&](uint32_t i)
+    {
+        auto it = ordered.find(lookups[i & 7]);
+        sl::test::keep((uint64_t)(uintptr_t)(it != ordered.end() ? it->second : nullptr));
+    });
+    auto hashNs = sl::test::measureNs(kIterations, [&](uint32_t i)
+    {
+        auto it = hashed.find(lookups[i & 7]);
+        sl::test::keep((uint64_t)(uintptr_t)(it != hashed.end() ? it->second : nullptr));
+    });
+    sl::test::report("%.2fns index, %.2fns std::map, %.2fns std::unordered_map", indexNs, mapNs, hashNs);
+}
@@ -0,0 +1,214 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <atomic>
+#include <thread>
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/fenceTimeline.h"
+
+using namespace sl::chi;
+
+namespace
+{
+
+struct SimulatedTimeline
+{
+    SimulatedFences sim;
+    FenceTimeline timeline{
+        [this](Fence fence, uint64_t& value) { return sim.getCompletedValue(fence, value); },
+        [this](const Fence* fences, const uint64_t* values, uint32_t count, bool waitAll, uint32_t timeoutMs) { return sim.wait(fences, values, count, waitAll, timeoutMs); } };
+};
+
+Fence fakeFence(uintptr_t value)
+{
+    return (Fence)value;
+}
+
+}
+
+SL_TEST(fenceTimelineCachesCompletedValues)
+{
+    SimulatedTimeline t;
+    auto a = fakeFence(0x10);
+    t.timeline.registerFence(a);
+    t.sim.signal(a, 5);
+    t.timeline.signaled(a, 5);
+    SL_EXPECT(t.timeline.getSignaledValue(a) == 5);
+
+    SL_EXPECT(t.timeline.isCompleted(a, 3));
+    SL_EXPECT(t.sim.getQueryCount() == 1);
+    // Known to be done, driver is not asked again
+    SL_EXPECT(t.timeline.isCompleted(a, 5));
+    SL_EXPECT(t.timeline.isCompleted(a, 1));
+    SL_EXPECT(t.sim.getQueryCount() == 1);
+    SL_EXPECT(!t.timeline.isCompleted(a, 6));
+    SL_EXPECT(t.sim.getQueryCount() == 2);
+}
+
+SL_TEST(fenceTimelineQueriesHostFences)
+{
+    SimulatedTimeline t;
+    auto host = fakeFence(0x30);
+    t.sim.signal(host, 2);
+    SL_EXPECT(t.timeline.isCompleted(host, 2));
+    SL_EXPECT(t.timeline.isCompleted(host, 2));
+    SL_EXPECT(t.sim.getQueryCount() == 2);
+
+    // Same once a fence is unregistered
+    auto a = fakeFence(0x10);
+    t.timeline.registerFence(a);
+    t.sim.signal(a, 4);
+    SL_EXPECT(t.timeline.isCompleted(a, 4));
+    t.timeline.unregisterFence(a);
+    auto queries = t.sim.getQueryCount();
+    SL_EXPECT(t.timeline.isCompleted(a, 4));
+    SL_EXPECT(t.sim.getQueryCount() == queries + 1);
+    SL_EXPECT(t.timeline.getSignaledValue(a) == 0);
+}
+
+SL_TEST(fenceTimelineWaitAll)
+{
+    SimulatedTimeline t;
+    Fence fences[2] = { fakeFence(0x10), fakeFence(0x20) };
+    uint64_t values[2] = { 10, 7 };
+    t.timeline.registerFence(fences[0]);
+    t.timeline.registerFence(fences[1]);
+    t.sim.signalAt(fences[0], 10, 3);
+    t.sim.signalAt(fences[1], 7, 8);
+
+    // Single wait on both fences, done when the slower one completes
+    SL_EXPECT(t.timeline.wait(fences, values, 2, true, 100) == WaitStatus::eNoTimeout);
+    SL_EXPECT(t.sim.getTime() == 8);
+    SL_EXPECT(t.sim.getWaitCount() == 1);
+    auto queries = t.sim.getQueryCount();
+    SL_EXPECT(t.timeline.isCompleted(fences[0], 10) && t.timeline.isCompleted(fences[1], 7));
+    SL_EXPECT(t.sim.getQueryCount() == queries);
+
+    // Nothing pending, nothing to wait for
+    SL_EXPECT(t.timeline.wait(fences, values, 2, true, 100) == WaitStatus::eNoTimeout);
+    SL_EXPECT(t.sim.getWaitCount() == 1);
+    SL_EXPECT(t.timeline.wait(nullptr, nullptr, 0, true, 0) == WaitStatus::eNoTimeout);
+}
+
+SL_TEST(fenceTimelineWaitAny)
+{
+    SimulatedTimeline t;
+    Fence fences[2] = { fakeFence(0x10), fakeFence(0x20) };
+    uint64_t values[2] = { 20, 15 };
+    t.timeline.registerFence(fences[0]);
+    t.timeline.registerFence(fences[1]);
+    t.sim.signalAt(fences[0], 20, 50);
+    t.sim.signalAt(fences[1], 15, 4);
+
+    uint32_t index = 99;
+    SL_EXPECT(t.timeline.wait(fences, values, 2, false, 100, &index) == WaitStatus::eNoTimeout);
+    SL_EXPECT(index == 1);
+    SL_EXPECT(t.sim.getTime() == 4);
+    SL_EXPECT(!t.timeline.isCompleted(fences[0], 20));
+
+    // Completed value is found in the cache without waiting
+    index = 99;
+    SL_EXPECT(t.timeline.wait(fences, values, 2, false, 0, &index) == WaitStatus::eNoTimeout);
+    SL_EXPECT(index == 1);
+    SL_EXPECT(t.sim.getWaitCount() == 1);
+}
+
+SL_TEST(fenceTimelineTimeoutAndDeviceLost)
+{
+    SimulatedTimeline t;
+    auto a = fakeFence(0x10);
+    t.timeline.registerFence(a);
+    t.sim.signalAt(a, 20, 30);
+    SL_EXPECT(t.timeline.wait(a, 20, 10) == WaitStatus::eTimeout);
+    SL_EXPECT(t.sim.getTime() == 10);
+    SL_EXPECT(t.timeline.wait(a, 20, 100) == WaitStatus::eNoTimeout);
+    SL_EXPECT(t.sim.getTime() == 30);
+
+    // Last known value is kept, waits fail
+    t.sim.setDeviceLost(true);
+    SL_EXPECT(t.timeline.getCompletedValue(a) == 20);
+    SL_EXPECT(!t.timeline.isCompleted(a, 21));
+    SL_EXPECT(t.timeline.wait(a, 21, 10) == WaitStatus::eError);
+    SL_EXPECT(t.timeline.getCompletedValue(fakeFence(0x30)) == 0);
+}
+
+SL_TEST(fenceTimelineWaitOnManyFences)
+{
+    // More fences than fit on the stack
+    SimulatedTimeline t;
+    const uint32_t kCount = 40;
+    std::vector<Fence> fences;
+    std::vector<uint64_t> values;
+    for (uint32_t i = 0; i < kCount; i++)
+    {
+        fences.push_back(fakeFence(0x100 + i));
+        values.push_back(i + 1);
+        t.timeline.registerFence(fences.back());
+        t.sim.signalAt(fences.back(), i + 1, i + 1);
+    }
+    SL_EXPECT(t.timeline.wait(fences.data(), values.data(), kCount, true, 1000) == WaitStatus::eNoTimeout);
+    SL_EXPECT(t.sim.getTime() == kCount);
+    SL_EXPECT(t.sim.getWaitCount() == 1);
+    for (uint32_t i = 0; i < kCount; i++)
+    {
+        SL_EXPECT(t.timeline.getCompletedValue(fences[i], values[i]) == values[i]);
+    }
+
+    for (uint32_t i = 0; i < kCount; i++)
+    {
+        values[i] += kCount;
+        t.sim.signalAt(fences[i], values[i], 2 * kCount - i);
+    }
+    uint32_t index = 0;
+    SL_EXPECT(t.timeline.wait(fences.data(), values.data(), kCount, false, 1000, &index) == WaitStatus::eNoTimeout);
+    SL_EXPECT(index == kCount - 1);
+}
+
+SL_TEST(fenceTimelineConcurrentSignals)
+{
+    SimulatedTimeline t;
+    auto a = fakeFence(0x10);
+    t.timeline.registerFence(a);
+    std::atomic<uint32_t> completed{};
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&t, &completed, a]()
+        {
+            for (uint64_t value = 1; value <= 200; value++)
+            {
+                t.sim.signal(a, value);
+                t.timeline.signaled(a, value);
+                if (t.timeline.isCompleted(a, value)) completed++;
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    SL_EXPECT(completed == 1600);
+    SL_EXPECT(t.timeline.getCompletedValue(a) == 200);
+    SL_EXPECT(t.timeline.getSignaledValue(a) == 200);
+}
@@ -0,0 +1,266 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <thread>
+
+#include "source/tests/test.h"
+#include "source/core/sl.file/file.h"
+
+using namespace sl;
+
+namespace
+{
+
+//! Fresh directory per test under the temp directory
+struct TempDir
+{
+    fs::path dir;
+
+    TempDir(const char* name)
+    {
+        dir = fs::temp_directory_path() / "sl.tests" / name;
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+        fs::create_directories(dir);
+    }
+    ~TempDir()
+    {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+    fs::path write(const char* name, size_t size)
+    {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            data[i] = pattern(i);
+        }
+        auto path = dir / name;
+        file::write(path.wstring().c_str(), data);
+        return path;
+    }
+
+    static uint8_t pattern(size_t i) { return uint8_t((i >> 12) ^ (i * 7)); }
+};
+
+uint64_t checksum(const uint8_t* data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+}
+
+SL_TEST(fileMappedViewContents)
+{
+    TempDir dir("fileMappedViewContents");
+    auto path = dir.write("data.bin", 10000);
+    file::MappedView view(path.wstring().c_str());
+    SL_REQUIRE(view.isValid());
+    SL_EXPECT(!view.empty());
+    SL_EXPECT(view.size() == 10000);
+    SL_EXPECT(view.end() - view.begin() == 10000);
+    SL_EXPECT(view.asString().size() == 10000);
+
+    auto copy = file::read(path.wstring().c_str());
+    SL_REQUIRE(copy.size() == view.size());
+    SL_EXPECT(memcmp(copy.data(), view.data(), copy.size()) == 0);
+}
+
+SL_TEST(fileMappedViewEmptyFile)
+{
+    TempDir dir("fileMappedViewEmptyFile");
+    auto path = dir.write("empty.json", 0);
+    file::MappedView view(path.wstring().c_str());
+    SL_EXPECT(view.isValid());
+    SL_EXPECT(view.empty());
+    SL_EXPECT(view.size() == 0);
+    SL_EXPECT(view.data() == nullptr);
+    SL_EXPECT(view.begin() == view.end());
+    SL_EXPECT(view.asString().empty());
+}
+
+SL_TEST(fileMappedViewMissingFile)
+{
+    TempDir dir("fileMappedViewMissingFile");
+    file::MappedView view((dir.dir / "missing.json").wstring().c_str());
+    SL_EXPECT(!view.isValid());
+    SL_EXPECT(view.empty());
+    SL_EXPECT(view.data() == nullptr);
+
+    // Directories cannot be opened or mapped as files on any platform
+    file::MappedView directory;
+    SL_EXPECT(!directory.map(dir.dir.wstring().c_str()));
+    SL_EXPECT(!directory.isValid());
+}
+
+SL_TEST(fileMappedViewLargeFile)
+{
+    TempDir dir("fileMappedViewLargeFile");
+    // Not a multiple of the page size so the tail of the last page is outside the file
+    size_t size = 64 * 1024 * 1024 + 123;
+    auto path = dir.write("large.bin", size);
+    file::MappedView view(path.wstring().c_str());
+    SL_REQUIRE(view.isValid());
+    SL_REQUIRE(view.size() == size);
+    bool matches = true;
+    for (size_t i = 0; i < size; i += 4093)
+    {
+        matches &= view.data()[i] == TempDir::pattern(i);
+    }
+    SL_EXPECT(matches);
+    SL_EXPECT(view.data()[size - 1] == TempDir::pattern(size - 1));
+}
+
+SL_TEST(fileMappedViewBeyond4GB)
+{
+    // Sparse file so sizes which do not fit 32 bits are covered without writing gigabytes
+    TempDir dir("fileMappedViewBeyond4GB");
+    auto path = dir.dir / "sparse.bin";
+    uint64_t size = (5ull << 30) + 1;
+    {
+        std::ofstream out(path, std::ios::binary);
+    }
+    std::error_code ec;
+    fs::resize_file(path, size, ec);
+    if (ec || sizeof(size_t) < 8)
+    {
+        sl::test::report("skipped, sparse files are not supported here");
+        return;
+    }
+    {
+        std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(size - 1);
+        out.put('x');
+    }
+
+    file::MappedView view(path.wstring().c_str());
+    SL_REQUIRE(view.isValid());
+    SL_EXPECT(view.size() == size);
+    SL_EXPECT(view.data()[0] == 0);
+    SL_EXPECT(view.data()[size - 1] == 'x');
+}
+
+SL_TEST(fileMappedViewMove)
+{
+    TempDir dir("fileMappedViewMove");
+    auto a = dir.write("a.bin", 100);
+    auto b = dir.write("b.bin", 200);
+
+    file::MappedView first(a.wstring().c_str());
+    auto data = first.data();
+    file::MappedView second(std::move(first));
+    SL_EXPECT(!first.isValid() && first.data() == nullptr);
+    SL_EXPECT(second.isValid() && second.data() == data && second.size() == 100);
+
+    file::MappedView third(b.wstring().c_str());
+    third = std::move(second);
+    SL_EXPECT(third.size() == 100 && third.data() == data);
+    SL_EXPECT(!second.isValid());
+
+    // Remapping releases the previous view
+    SL_REQUIRE(third.map(b.wstring().c_str()));
+    SL_EXPECT(third.size() == 200);
+    third.unmap();
+    SL_EXPECT(!third.isValid() && third.empty());
+}
+
+SL_TEST(fileMappedViewOutlivesFile)
+{
+    TempDir dir("fileMappedViewOutlivesFile");
+    auto path = dir.write("plugin.json", 5000);
+    file::MappedView view(path.wstring().c_str());
+    SL_REQUIRE(view.isValid());
+    auto expected = checksum(view.data(), view.size());
+
+    // OTA replaces files in place, an existing view keeps the old contents
+    std::error_code ec;
+    fs::remove(path, ec);
+    if (!ec)
+    {
+        dir.write("plugin.json", 10);
+        SL_EXPECT(view.size() == 5000);
+        SL_EXPECT(checksum(view.data(), view.size()) == expected);
+    }
+}
+
+SL_TEST(fileMappedViewConcurrent)
+{
+    TempDir dir("fileMappedViewConcurrent");
+    size_t size = 1024 * 1024 + 17;
+    auto path = dir.write("shared.bin", size);
+    auto expected = checksum(file::read(path.wstring().c_str()).data(), size);
+
+    // One long lived view while other threads keep mapping and unmapping the same file
+    file::MappedView pinned(path.wstring().c_str());
+    SL_REQUIRE(pinned.isValid());
+
+    constexpr uint32_t kThreads = 8;
+    std::atomic<uint32_t> mismatches{};
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&]()
+        {
+            for (uint32_t i = 0; i < 20; i++)
+            {
+                file::MappedView view(path.wstring().c_str());
+                if (!view.isValid() || view.size() != size || checksum(view.data(), view.size()) != expected)
+                {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    SL_EXPECT(mismatches == 0);
+    SL_EXPECT(checksum(pinned.data(), pinned.size()) == expected);
+}
+
+SL_TEST(fileBenchmarkMappedView)
+{
+    TempDir dir("fileBenchmarkMappedView");
+    size_t size = 16 * 1024 * 1024;
+    auto path = dir.write("large.bin", size);
+
+    // Typical consumer touches the header and a few entries, not every byte
+    auto readNs = sl::test::measureNs(20, [&](uint32_t)
+    {
+        auto data = file::read(path.wstring().c_str());
+        sl::test::keep(data[0] + data[size / 2] + data[size - 1]);
+    });
+    auto mapNs = sl::test::measureNs(20, [&](uint32_t)
+    {
+        file::MappedView view(path.wstring().c_str());
+        sl::test::keep(view.data()[0] + view.data()[size / 2] + view.data()[size - 1]);
+    });
+    sl::test::report("16MB file, %.1fus read, %.1fus mapped", readNs / 1000.0, mapNs / 1000.0);
+}
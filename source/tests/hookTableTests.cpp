@@ -0,0 +1,278 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <thread>
+
+#include "source/tests/test.h"
+#include "source/core/sl.plugin-manager/hookTable.h"
+
+using namespace sl;
+using namespace sl::plugin_manager;
+
+namespace
+{
+
+//! Stand-in for a hooked API call, plugins append their id so the order can be checked
+struct CallTrace
+{
+    std::vector<uint32_t> calls;
+    bool skip = false;
+};
+
+using PFunMockHook = void(CallTrace& trace);
+
+template<uint32_t kId>
+void mockHook(CallTrace& trace)
+{
+    trace.calls.push_back(kId);
+}
+
+void mockSkipHook(CallTrace& trace)
+{
+    trace.calls.push_back(99);
+    trace.skip = true;
+}
+
+struct HookLists
+{
+    std::vector<HookPair> before[(uint32_t)FunctionHookID::eMaxNum];
+    std::vector<HookPair> after[(uint32_t)FunctionHookID::eMaxNum];
+
+    void addBefore(FunctionHookID id, PFunMockHook* hook, Feature feature) { before[(uint32_t)id].push_back({ (void*)hook, feature }); }
+    void addAfter(FunctionHookID id, PFunMockHook* hook, Feature feature) { after[(uint32_t)id].push_back({ (void*)hook, feature }); }
+    std::unique_ptr<HookTable> build() const { return HookTable::build(before, after); }
+};
+
+//! Same flow as the interposer, before hooks can skip the base call, after hooks always run
+//! Lookup through a virtual interface with a status check, as done before the masks existed
+struct IMockManager
+{
+    virtual HookList getBeforeHooks(FunctionHookID id) = 0;
+};
+
+struct MockManager : IMockManager
+{
+    HookTablePublisher* publisher{};
+    std::atomic<uint32_t> status{};
+
+    virtual HookList getBeforeHooks(FunctionHookID id) override
+    {
+        if (status.load() != 0) return {};
+        return publisher->get()->getBefore(id);
+    }
+};
+
+void dispatch(const HookTable* table, FunctionHookID id, CallTrace& trace)
+{
+    for (auto [hook, feature] : table->getBefore(id))
+    {
+        ((PFunMockHook*)hook)(trace);
+    }
+    if (!trace.skip)
+    {
+        trace.calls.push_back(0);
+    }
+    for (auto [hook, feature] : table->getAfter(id))
+    {
+        ((PFunMockHook*)hook)(trace);
+    }
+}
+
+}
+
+SL_TEST(hookTableFlatten)
+{
+    HookLists lists;
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<1>, 10);
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<2>, 20);
+    lists.addBefore(FunctionHookID::eVulkan_Present, mockHook<3>, 30);
+    lists.addAfter(FunctionHookID::eIDXGISwapChain_ResizeBuffers, mockHook<4>, 10);
+    auto table = lists.build();
+
+    SL_EXPECT(table->beforeMask == ((1ull << (uint32_t)FunctionHookID::eIDXGISwapChain_Present) | (1ull << (uint32_t)FunctionHookID::eVulkan_Present)));
+    SL_EXPECT(table->afterMask == (1ull << (uint32_t)FunctionHookID::eIDXGISwapChain_ResizeBuffers));
+    SL_EXPECT(table->before.size() == 3 && table->after.size() == 1);
+
+    auto present = table->getBefore(FunctionHookID::eIDXGISwapChain_Present);
+    SL_REQUIRE(present.size() == 2);
+    SL_EXPECT(present.data()[0].second == 10 && present.data()[1].second == 20);
+    SL_EXPECT(table->getBefore(FunctionHookID::eVulkan_Present).size() == 1);
+    SL_EXPECT(table->getAfter(FunctionHookID::eIDXGISwapChain_ResizeBuffers).size() == 1);
+
+    // Every function without hooks returns an empty view
+    uint32_t hooked = 0;
+    for (uint32_t i = 0; i < (uint32_t)FunctionHookID::eMaxNum; i++)
+    {
+        hooked += !table->getBefore((FunctionHookID)i).empty();
+        hooked += !table->getAfter((FunctionHookID)i).empty();
+        SL_EXPECT(table->beforeOffsets[i] <= table->beforeOffsets[i + 1]);
+    }
+    SL_EXPECT(hooked == 3);
+    SL_EXPECT(table->beforeOffsets[(uint32_t)FunctionHookID::eMaxNum] == 3);
+
+    // Empty lists give an empty table
+    HookLists none;
+    auto empty = none.build();
+    SL_EXPECT(empty->beforeMask == 0 && empty->afterMask == 0);
+    SL_EXPECT(empty->getBefore(FunctionHookID::eIDXGISwapChain_Present).empty());
+}
+
+SL_TEST(hookTableMockDispatch)
+{
+    // Lists are filled in plugin priority order, dispatch must keep it
+    HookLists lists;
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<1>, 1);
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<2>, 2);
+    lists.addAfter(FunctionHookID::eIDXGISwapChain_Present, mockHook<3>, 1);
+    lists.addAfter(FunctionHookID::eIDXGISwapChain_Present, mockHook<4>, 2);
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_ResizeBuffers, mockSkipHook, 3);
+    lists.addAfter(FunctionHookID::eIDXGISwapChain_ResizeBuffers, mockHook<5>, 3);
+    auto table = lists.build();
+
+    CallTrace present;
+    dispatch(table.get(), FunctionHookID::eIDXGISwapChain_Present, present);
+    SL_EXPECT((present.calls == std::vector<uint32_t>{ 1, 2, 0, 3, 4 }));
+
+    CallTrace resize;
+    dispatch(table.get(), FunctionHookID::eIDXGISwapChain_ResizeBuffers, resize);
+    SL_EXPECT((resize.calls == std::vector<uint32_t>{ 99, 5 }));
+
+    CallTrace unhooked;
+    dispatch(table.get(), FunctionHookID::eVulkan_Present, unhooked);
+    SL_EXPECT((unhooked.calls == std::vector<uint32_t>{ 0 }));
+}
+
+SL_TEST(hookTableRetiredAfterTwoPresents)
+{
+    HookLists lists;
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<1>, 1);
+    HookTablePublisher publisher;
+    publisher.publish(lists.build());
+    SL_EXPECT(publisher.getRetiredCount() == 0);
+
+    auto first = publisher.get();
+    publisher.publish(lists.build());
+    publisher.publish(lists.build());
+    SL_EXPECT(publisher.get() != first);
+    SL_EXPECT(publisher.getRetiredCount() == 2);
+
+    // Present in flight while the table was replaced could still use it
+    publisher.onPresent();
+    SL_EXPECT(publisher.getRetiredCount() == 2);
+    publisher.onPresent();
+    SL_EXPECT(publisher.getRetiredCount() == 0);
+    SL_EXPECT(publisher.get()->getBefore(FunctionHookID::eIDXGISwapChain_Present).size() == 1);
+}
+
+SL_TEST(hookTableRepublishWhileDispatching)
+{
+    // Feature toggled on and off while the render thread keeps presenting
+    HookLists on, off;
+    on.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<1>, 1);
+    on.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<2>, 2);
+    on.addAfter(FunctionHookID::eIDXGISwapChain_Present, mockHook<3>, 1);
+    off.addAfter(FunctionHookID::eIDXGISwapChain_Present, mockHook<3>, 1);
+
+    HookTablePublisher publisher;
+    publisher.publish(on.build());
+
+    std::atomic<bool> done{};
+    std::atomic<uint32_t> torn{};
+    std::thread render([&]()
+    {
+        while (!done.load())
+        {
+            CallTrace trace;
+            dispatch(publisher.get(), FunctionHookID::eIDXGISwapChain_Present, trace);
+            // Each present sees one complete table, never a mix
+            if (trace.calls != std::vector<uint32_t>{ 1, 2, 0, 3 } && trace.calls != std::vector<uint32_t>{ 0, 3 })
+            {
+                torn++;
+            }
+            publisher.onPresent();
+        }
+    });
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        publisher.publish(i % 2 ? on.build() : off.build());
+    }
+    done = true;
+    render.join();
+    SL_EXPECT(torn == 0);
+
+    publisher.onPresent();
+    publisher.onPresent();
+    SL_EXPECT(publisher.getRetiredCount() == 0);
+}
+
+SL_TEST(hookTableBenchmarkDispatch)
+{
+    HookLists lists;
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<1>, 1);
+    lists.addBefore(FunctionHookID::eIDXGISwapChain_Present, mockHook<2>, 2);
+    lists.addAfter(FunctionHookID::eIDXGISwapChain_Present, mockHook<3>, 1);
+    HookTablePublisher publisher;
+    publisher.publish(lists.build());
+    HookMasks masks;
+    masks.before = publisher.get()->beforeMask;
+    masks.after = publisher.get()->afterMask;
+
+    MockManager manager;
+    manager.publisher = &publisher;
+    IMockManager* volatile instance = &manager;
+
+    // Most interposed calls have no hooks, with the masks they never reach the manager
+    constexpr uint32_t kIterations = 10000000;
+    const auto unhooked = (uint32_t)FunctionHookID::eIDXGISwapChain_GetDesc;
+    auto maskNs = sl::test::measureNs(kIterations, [&](uint32_t i)
+    {
+        auto id = (FunctionHookID)(unhooked + (i & 1));
+        HookList hooks{};
+        if (masks.before.load(std::memory_order_relaxed) & (1ull << (uint32_t)id))
+        {
+            hooks = instance->getBeforeHooks(id);
+        }
+        sl::test::keep(hooks.size());
+    });
+    auto virtualNs = sl::test::measureNs(kIterations, [&](uint32_t i)
+    {
+        sl::test::keep(instance->getBeforeHooks((FunctionHookID)(unhooked + (i & 1))).size());
+    });
+    // Hooked call, both paths end up in the table
+    auto tableNs = sl::test::measureNs(kIterations, [&](uint32_t)
+    {
+        for (auto& hook : instance->getBeforeHooks(FunctionHookID::eIDXGISwapChain_Present))
+        {
+            sl::test::keep((uint64_t)(uintptr_t)hook.first);
+        }
+    });
+    CallTrace trace;
+    trace.calls.reserve(8);
+    auto dispatchNs = sl::test::measureNs(1000000, [&](uint32_t)
+    {
+        trace.calls.clear();
+        dispatch(publisher.get(), FunctionHookID::eIDXGISwapChain_Present, trace);
+    });
+    sl::test::report("unhooked call %.2fns with mask, %.2fns through the interface, hooked lookup %.2fns, mock present dispatch %.2fns",
+        maskNs, virtualNs, tableNs, dispatchNs);
+}
@@ -0,0 +1,261 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <random>
+#include <unordered_set>
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/kernelCache.h"
+
+using namespace sl::chi;
+
+namespace
+{
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    for (auto& b : data)
+    {
+        b = uint8_t(rng());
+    }
+    return data;
+}
+
+uint32_t popcount64(uint64_t v)
+{
+    uint32_t count = 0;
+    for (; v; v &= v - 1) count++;
+    return count;
+}
+
+struct HashSet
+{
+    std::unordered_set<Hash128, Hash128Hasher> hashes;
+    uint32_t collisions = 0;
+
+    void add(const Hash128& h)
+    {
+        if (!hashes.insert(h).second) collisions++;
+    }
+};
+
+}
+
+SL_TEST(kernelHashLanesMatch)
+{
+#if SL_KERNEL_HASH_SSE2
+    // Every tail length around the stripe and block boundaries, at unaligned offsets and with seeds
+    auto data = randomBytes(4 * hash::kBlockSize + 64, 1);
+    uint32_t mismatches = 0;
+    for (size_t size = 0; size <= 4 * hash::kBlockSize; size++)
+    {
+        for (size_t offset : { 0, 1, 7, 13 })
+        {
+            if (offset + size > data.size()) continue;
+            for (uint64_t seed : { 0ull, 1ull, 0x9E3779B97F4A7C15ull })
+            {
+                auto p = data.data() + offset;
+                if (hash::hash128<hash::ScalarLanes>(p, size, seed) != hash::hash128<hash::SSE2Lanes>(p, size, seed))
+                {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    SL_EXPECT(mismatches == 0);
+
+    auto large = randomBytes(1024 * 1024 + 3, 2);
+    SL_EXPECT(hash::hash128<hash::ScalarLanes>(large.data(), large.size()) == hash::hash128<hash::SSE2Lanes>(large.data(), large.size()));
+#else
+    sl::test::report("skipped, SSE2 lanes are not compiled on this target");
+#endif
+}
+
+SL_TEST(kernelHashDefaults)
+{
+    auto data = randomBytes(1000, 3);
+    SL_EXPECT(hash::hash128(data.data(), data.size()) == hash::hash128<hash::DefaultLanes>(data.data(), data.size(), 0));
+    SL_EXPECT(hash::hash128(data.data(), data.size(), 1) != hash::hash128(data.data(), data.size(), 2));
+    auto h = hash::hash128(data.data(), data.size());
+    SL_EXPECT(hash::hash64(data.data(), data.size()) == (h.lo ^ (h.hi * hash::kPrime64_1)));
+
+    // Null pointer is fine for empty input
+    SL_EXPECT(hash::hash128(nullptr, 0) == hash::hash128(data.data(), 0));
+}
+
+SL_TEST(kernelHashKnownValues)
+{
+    // Pipeline cache files store these hashes, if this fails 'hash::kVersion' must be bumped
+    // together with the expected values
+    SL_REQUIRE(hash::kVersion == 1);
+    struct Expected
+    {
+        size_t size;
+        uint64_t lo;
+        uint64_t hi;
+    };
+    const Expected expected[] = {
+        { 0, 0x58ed3ff9916dd54eull, 0x74c896eeb6570802ull },
+        { 3, 0xbe6370b455e88eedull, 0x8ef785312e76987aull },
+        { 64, 0x62d7259a1e193423ull, 0x5f937fb1215179b8ull },
+        { 65, 0x9669e8db192e85d5ull, 0x1a65d5e5853198c2ull },
+        { 512, 0x994712be23babb3aull, 0x13b16c70616197a2ull },
+        { 513, 0xbd9fa76488a98738ull, 0x211a89ce171929f4ull },
+        { 1500, 0x0a37421b82e37223ull, 0x0c16bd5244b19ba1ull },
+    };
+    std::vector<uint8_t> data(1500);
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = uint8_t(i * 131 + 7);
+    }
+    for (auto& e : expected)
+    {
+        auto h = hash::hash128(data.data(), e.size);
+        SL_EXPECT(h.lo == e.lo && h.hi == e.hi);
+        SL_EXPECT(hash::hash128<hash::ScalarLanes>(data.data(), e.size) == h);
+    }
+    auto seeded = hash::hash128(data.data(), 100, 0x1234);
+    SL_EXPECT(seeded.lo == 0x2c1fe09b2ff9def2ull && seeded.hi == 0x4c9614590e12c187ull);
+}
+
+SL_TEST(kernelHashNoCollisions)
+{
+    HashSet set;
+    // Counters, the typical worst case for weak hashes, zero is covered by the zero buffers below
+    for (uint64_t i = 1; i <= 100000; i++)
+    {
+        set.add(hash::hash128(&i, sizeof(i)));
+    }
+    // Zero buffers which only differ in length, short inputs are zero padded internally
+    std::vector<uint8_t> zeros(4 * hash::kBlockSize + 1);
+    for (size_t size = 0; size < zeros.size(); size++)
+    {
+        set.add(hash::hash128(zeros.data(), size));
+    }
+    // Single bit set at every position of a buffer spanning several blocks
+    std::vector<uint8_t> bits(2048);
+    for (size_t bit = 0; bit < bits.size() * 8; bit++)
+    {
+        bits[bit / 8] = uint8_t(1 << (bit % 8));
+        set.add(hash::hash128(bits.data(), bits.size()));
+        bits[bit / 8] = 0;
+    }
+    // Same data with different seeds, as used for kernel keys
+    auto data = randomBytes(300, 4);
+    for (uint64_t seed = 1; seed < 10000; seed++)
+    {
+        set.add(hash::hash128(data.data(), data.size(), seed));
+    }
+    SL_EXPECT(set.collisions == 0);
+
+    // Truncated to 32 bits there should be about n^2 / 2^33 collisions for a well distributed hash
+    std::unordered_set<uint32_t> truncated;
+    uint32_t truncatedCollisions = 0;
+    for (auto& h : set.hashes)
+    {
+        if (!truncated.insert(uint32_t(h.hi)).second) truncatedCollisions++;
+    }
+    double n = (double)set.hashes.size();
+    double expected = n * n / 8589934592.0;
+    sl::test::report("%zu hashes, %u collisions in 32 bits, %.1f expected", set.hashes.size(), truncatedCollisions, expected);
+    SL_EXPECT(truncatedCollisions < expected * 3 + 10);
+}
+
+SL_TEST(kernelHashAvalanche)
+{
+    // Flipping any input bit should flip each output bit with probability close to 1/2
+    constexpr uint32_t kSamples = 16;
+    for (size_t size : { (size_t)8, (size_t)64, (size_t)200, hash::kBlockSize * 2 + 5 })
+    {
+        uint32_t flips[128]{};
+        uint32_t trials = 0;
+        double worstDistance = 0.0;
+        for (uint32_t sample = 0; sample < kSamples; sample++)
+        {
+            auto data = randomBytes(size, 100 + sample);
+            auto base = hash::hash128(data.data(), size);
+            for (size_t bit = 0; bit < size * 8; bit++)
+            {
+                data[bit / 8] ^= uint8_t(1 << (bit % 8));
+                auto h = hash::hash128(data.data(), size);
+                data[bit / 8] ^= uint8_t(1 << (bit % 8));
+                uint64_t lo = h.lo ^ base.lo, hi = h.hi ^ base.hi;
+                for (uint32_t i = 0; i < 64; i++)
+                {
+                    flips[i] += (lo >> i) & 1;
+                    flips[64 + i] += (hi >> i) & 1;
+                }
+                trials++;
+                // Average distance is checked below, a single input change must never leave the hash intact
+                SL_EXPECT(popcount64(lo) + popcount64(hi) > 0);
+            }
+        }
+        for (uint32_t i = 0; i < 128; i++)
+        {
+            double probability = flips[i] / (double)trials;
+            worstDistance = std::max(worstDistance, std::abs(probability - 0.5));
+        }
+        sl::test::report("%zu bytes, %u flips, worst output bit bias %.3f", size, trials, worstDistance);
+        SL_EXPECT(worstDistance < 0.05);
+    }
+}
+
+SL_TEST(kernelCacheSharesBlobs)
+{
+    KernelCache cache;
+    auto blob = randomBytes(5000, 5);
+    auto hash = hash::hash128(blob.data(), blob.size());
+    auto a = cache.acquire(hash, blob.data(), blob.size());
+    auto b = cache.acquire(hash, blob.data(), blob.size());
+    SL_REQUIRE(a && a == b);
+    SL_EXPECT(a->data != blob.data() && memcmp(a->data, blob.data(), blob.size()) == 0);
+    SL_EXPECT(cache.getBlobCount() == 1);
+
+    // Size mismatch under the same hash is refused rather than returning the wrong blob
+    SL_EXPECT(cache.acquire(hash, blob.data(), blob.size() - 1) == nullptr);
+
+    cache.release(a);
+    SL_EXPECT(cache.getBlobCount() == 1);
+    cache.release(b);
+    SL_EXPECT(cache.getBlobCount() == 0);
+}
+
+SL_TEST(kernelHashBenchmark)
+{
+    for (size_t size : { (size_t)64, (size_t)1024, (size_t)64 * 1024, (size_t)4 * 1024 * 1024 })
+    {
+        auto data = randomBytes(size, 6);
+        uint32_t iterations = uint32_t(std::max<size_t>(16, 64 * 1024 * 1024 / size));
+        auto defaultNs = sl::test::measureNs(iterations, [&](uint32_t i)
+        {
+            sl::test::keep(hash::hash128(data.data(), size, i).lo);
+        });
+        auto scalarNs = sl::test::measureNs(iterations, [&](uint32_t i)
+        {
+            sl::test::keep(hash::hash128<hash::ScalarLanes>(data.data(), size, i).lo);
+        });
+        sl::test::report("%zu bytes, %.2f GB/s default lanes, %.2f GB/s scalar lanes", size, size / defaultNs, size / scalarNs);
+    }
+}
@@ -0,0 +1,172 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "source/tests/test.h"
+#include "source/core/sl.plugin/loaderConfig.h"
+
+using namespace sl::plugin;
+using json = nlohmann::json;
+
+namespace
+{
+
+//! Same layout as 'PluginManager::populateLoaderJSON'
+json makeLoaderConfig()
+{
+    json config;
+    config["host"]["version"] = { {"major", 2}, {"minor", 7}, {"build", 30} };
+    config["version"] = { {"major", 2}, {"minor", 8}, {"build", 0} };
+    config["api"] = { {"major", 0}, {"minor", 0}, {"build", 1} };
+    config["appId"] = 0x10da4u;
+    config["deviceType"] = 1;
+    config["paths"] = { "C:/Games/Titel/Bin\u00e4r/x64", "D:/\u30b2\u30fc\u30e0/streamline", "" };
+    config["ngx"]["engineType"] = 3;
+    config["ngx"]["engineVersion"] = "5.3.2";
+    config["ngx"]["projectId"] = "a0f57b54-1daf-4934-90ae-c4035c19df04";
+    config["preferences"]["flags"] = 0xffffffffffffffffull;
+    config["interposerEnabled"] = true;
+    config["forceNonNVDA"] = false;
+    return config;
+}
+
+//! Both copies a plugin can receive, decoded the way 'plugin::onLoad' does
+void decodeBoth(const json& config, int indent, json& fromText, json& fromBinary)
+{
+    std::string text;
+    std::vector<uint8_t> cbor;
+    SL_REQUIRE(serializeLoaderConfig(config, indent, text, cbor));
+    SL_REQUIRE(!cbor.empty());
+    parseLoaderConfig(text.c_str(), nullptr, nullptr, 0, fromText);
+    parseLoaderConfig(text.c_str(), text.c_str(), cbor.data(), cbor.size(), fromBinary);
+}
+
+}
+
+SL_TEST(loaderConfigRoundTrip)
+{
+    auto config = makeLoaderConfig();
+    for (int indent : { -1, 0, 1, 4 })
+    {
+        json fromText, fromBinary;
+        decodeBoth(config, indent, fromText, fromBinary);
+        SL_EXPECT(fromText == config);
+        SL_EXPECT(fromBinary == config);
+        SL_EXPECT(fromText.dump() == fromBinary.dump());
+    }
+}
+
+SL_TEST(loaderConfigEquivalentTypes)
+{
+    // Plugins read values with typed accessors, both paths must produce the same number kinds
+    json config;
+    config["unsigned"] = 4000000000u;
+    config["unsigned64"] = 0x123456789abcdefull;
+    config["negative"] = -5;
+    config["negative64"] = INT64_MIN;
+    config["zero"] = 0;
+    config["float"] = 0.1;
+    config["exact"] = 1.5;
+    config["tiny"] = 1e-300;
+    config["null"] = nullptr;
+    config["emptyObject"] = json::object();
+    config["emptyArray"] = json::array();
+    config["nested"] = json::array({ json::array({ 1, "two", 3.0, false }), json::object({ {"key", json::array()} }) });
+    config["escapes"] = "quote\" backslash\\ newline\n tab\t nul";
+    config["escapes"].get_ref<std::string&>().push_back('\0');
+    config["emoji"] = "\xf0\x9f\x98\x80";
+
+    json fromText, fromBinary;
+    decodeBoth(config, -1, fromText, fromBinary);
+    SL_EXPECT(fromText == config);
+    SL_EXPECT(fromBinary == config);
+    for (auto& [key, value] : fromText.items())
+    {
+        SL_EXPECT(fromBinary.at(key).type() == value.type());
+    }
+    SL_EXPECT(fromBinary.at("unsigned64").get<uint64_t>() == 0x123456789abcdefull);
+    SL_EXPECT(fromBinary.at("negative64").get<int64_t>() == INT64_MIN);
+    SL_EXPECT(fromBinary.at("float").get<double>() == fromText.at("float").get<double>());
+    SL_EXPECT(fromBinary.at("escapes").get<std::string>().size() == config.at("escapes").get<std::string>().size());
+}
+
+SL_TEST(loaderConfigInvalidUtf8FallsBackToText)
+{
+    auto config = makeLoaderConfig();
+    // Path converted from a broken UTF-16 string
+    config["paths"].push_back("C:/Games/\xff\xfe/Bin");
+
+    std::string text;
+    std::vector<uint8_t> cbor{ 1, 2, 3 };
+    SL_EXPECT(!serializeLoaderConfig(config, 1, text, cbor));
+    SL_EXPECT(cbor.empty());
+
+    // Text is still valid JSON, only the broken path is different
+    json loader;
+    parseLoaderConfig(text.c_str(), nullptr, nullptr, 0, loader);
+    SL_EXPECT(loader["paths"].size() == config["paths"].size());
+    SL_EXPECT(loader["paths"][0] == config["paths"][0]);
+    SL_EXPECT(loader["paths"].back() != config["paths"].back());
+    SL_EXPECT(loader["appId"] == config["appId"]);
+}
+
+SL_TEST(loaderConfigStaleBinaryIgnored)
+{
+    auto config = makeLoaderConfig();
+    std::string text;
+    std::vector<uint8_t> cbor;
+    SL_REQUIRE(serializeLoaderConfig(config, -1, text, cbor));
+
+    // Blob published for a different call, e.g. 'onLoad' text while 'onStartup' runs
+    auto other = config;
+    other["deviceType"] = 2;
+    std::string otherText = other.dump();
+
+    json loader;
+    parseLoaderConfig(otherText.c_str(), text.c_str(), cbor.data(), cbor.size(), loader);
+    SL_EXPECT(loader == other);
+    parseLoaderConfig(text.c_str(), text.c_str(), nullptr, 0, loader);
+    SL_EXPECT(loader == config);
+}
+
+SL_TEST(loaderConfigBenchmarkDecode)
+{
+    auto config = makeLoaderConfig();
+    std::string text;
+    std::vector<uint8_t> cbor;
+    SL_REQUIRE(serializeLoaderConfig(config, 1, text, cbor));
+
+    // Every plugin decodes the config twice, once in 'onLoad' and once in 'onStartup'
+    auto textNs = sl::test::measureNs(20000, [&](uint32_t)
+    {
+        json loader;
+        parseLoaderConfig(text.c_str(), nullptr, nullptr, 0, loader);
+        sl::test::keep(loader.size());
+    });
+    auto binaryNs = sl::test::measureNs(20000, [&](uint32_t)
+    {
+        json loader;
+        parseLoaderConfig(text.c_str(), text.c_str(), cbor.data(), cbor.size(), loader);
+        sl::test::keep(loader.size());
+    });
+    sl::test::report("%zu bytes text, %zu bytes CBOR, %.2fus text, %.2fus CBOR", text.size(), cbor.size(), textNs / 1000.0, binaryNs / 1000.0);
+}
@@ -0,0 +1,93 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <cstring>
+#include <cstdarg>
+
+#include "source/tests/test.h"
+#include "source/core/sl.log/log.h"
+
+namespace sl
+{
+namespace log
+{
+
+bool g_slEnableLogPreMetaDataUniqueWAR = false;
+
+//! Warnings and errors go to stdout next to the failed checks, everything else is dropped
+struct TestLog : ILog
+{
+    virtual void logva(uint32_t level, ConsoleForeground color, const char* file, int line, const char* func, int type, bool isMetaDataUnique, const char* fmt, ...) override
+    {
+        if (type == 0) return;
+        va_list args;
+        va_start(args, fmt);
+        printf("  [%s] ", type == 1 ? "warn" : "error");
+        vprintf(fmt, args);
+        printf("\n");
+        va_end(args);
+    }
+    virtual void enableConsole(bool flag) override {}
+    virtual LogLevel getLogLevel() const override { return LogLevel(1); }
+    virtual void setLogLevel(LogLevel level) override {}
+    virtual void setLogPath(const wchar_t* path) override {}
+    virtual void setLogName(const wchar_t* name) override {}
+    virtual void setLogCallback(void* logMessageCallback) override {}
+    virtual void setLogMessageDelay(float logMessageDelayMS) override {}
+    virtual const wchar_t* getLogPath() override { return L""; }
+    virtual const wchar_t* getLogName() override { return L""; }
+    virtual void flush() override {}
+    virtual void shutdown() override {}
+};
+
+ILog* getInterface()
+{
+    static TestLog s_log;
+    return &s_log;
+}
+
+void destroyInterface()
+{
+}
+
+}
+}
+
+//! Runs all tests, or only those whose name contains the first argument
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    uint32_t run = 0, failed = 0;
+    for (auto& test : sl::test::getTests())
+    {
+        if (filter && !strstr(test.name, filter)) continue;
+        auto failures = sl::test::getFailureCount();
+        test.func();
+        run++;
+        bool passed = sl::test::getFailureCount() == failures;
+        printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", test.name);
+        failed += passed ? 0 : 1;
+    }
+    printf("%u tests, %u failed\n", run, failed);
+    return failed ? 1 : 0;
+}
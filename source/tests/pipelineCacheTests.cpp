@@ -0,0 +1,240 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <cstdio>
+#include <filesystem>
+
+#include "source/tests/test.h"
+// Built into the tests directly, the chi project is Windows only
+#include "source/platforms/sl.chi/pipelineCache.cpp"
+
+using namespace sl::chi;
+
+namespace
+{
+
+//! Fresh cache file per test under the temp directory
+struct CacheFile
+{
+    std::filesystem::path dir;
+    std::filesystem::path path;
+
+    CacheFile(const char* name)
+    {
+        dir = std::filesystem::temp_directory_path() / "sl.tests" / name;
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        path = dir / "cache" / "sl.pipelines";
+    }
+    ~CacheFile()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+};
+
+void update(PipelineCache& cache, uint64_t lo, uint64_t hi, PipelineCacheEntryType type, size_t size, uint8_t value)
+{
+    std::vector<uint8_t> data(size, value);
+    cache.update(PipelineCache::makeKey(lo, hi), type, data.data(), data.size());
+}
+
+bool has(PipelineCache& cache, uint64_t lo, uint64_t hi, PipelineCacheEntryType type)
+{
+    std::vector<uint8_t> data;
+    return cache.find(PipelineCache::makeKey(lo, hi), type, data);
+}
+
+}
+
+SL_TEST(pipelineCacheRoundTrip)
+{
+    CacheFile file("pipelineCacheRoundTrip");
+    {
+        PipelineCache cache;
+        SL_EXPECT(!cache.load(file.path, "k1"));
+        update(cache, 1, 2, PipelineCacheEntryType::ePipeline, 1000, 1);
+        update(cache, 1, 2, PipelineCacheEntryType::eRootSignature, 2000, 2);
+        SL_EXPECT(cache.getEntryCount() == 2);
+        SL_REQUIRE(cache.save());
+    }
+    PipelineCache cache;
+    SL_REQUIRE(cache.load(file.path, "k1"));
+    SL_EXPECT(cache.getEntryCount() == 2);
+    std::vector<uint8_t> data;
+    SL_REQUIRE(cache.find(PipelineCache::makeKey(1, 2), PipelineCacheEntryType::eRootSignature, data));
+    SL_EXPECT(data.size() == 2000 && data[0] == 2 && data.back() == 2);
+    SL_REQUIRE(cache.find(PipelineCache::makeKey(1, 2), PipelineCacheEntryType::ePipeline, data));
+    SL_EXPECT(data.size() == 1000 && data[0] == 1);
+    SL_EXPECT(!has(cache, 2, 1, PipelineCacheEntryType::ePipeline));
+}
+
+SL_TEST(pipelineCacheRejectsOtherBuild)
+{
+    CacheFile file("pipelineCacheRejectsOtherBuild");
+    {
+        PipelineCache cache;
+        cache.load(file.path, "k1");
+        update(cache, 1, 2, PipelineCacheEntryType::ePipeline, 10, 1);
+        SL_REQUIRE(cache.save());
+    }
+    PipelineCache cache;
+    SL_EXPECT(!cache.load(file.path, "k2"));
+    SL_EXPECT(cache.getEntryCount() == 0);
+}
+
+SL_TEST(pipelineCacheRejectsOtherHashVersion)
+{
+    CacheFile file("pipelineCacheRejectsOtherHashVersion");
+    {
+        PipelineCache cache;
+        cache.load(file.path, "k1");
+        update(cache, 1, 2, PipelineCacheEntryType::ePipeline, 10, 1);
+        SL_REQUIRE(cache.save());
+    }
+
+    // Same compatibility key as written by a build with a different hash algorithm
+    PipelineCacheFileHeader header{};
+    auto fp = fopen(file.path.string().c_str(), "r+b");
+    SL_REQUIRE(fp);
+    SL_REQUIRE(fread(&header, sizeof(header), 1, fp) == 1);
+    SL_EXPECT(header.compatibilityHash == hash::hash64("k1", 2, hash::kVersion));
+    header.compatibilityHash = hash::hash64("k1", 2, hash::kVersion + 1);
+    fseek(fp, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, fp);
+    fclose(fp);
+
+    PipelineCache cache;
+    SL_EXPECT(!cache.load(file.path, "k1"));
+    SL_EXPECT(cache.getEntryCount() == 0);
+}
+
+SL_TEST(pipelineCacheMergesInstances)
+{
+    CacheFile file("pipelineCacheMergesInstances");
+    {
+        PipelineCache cache;
+        cache.load(file.path, "k1");
+        update(cache, 1, 2, PipelineCacheEntryType::ePipeline, 100, 1);
+        update(cache, 3, 4, PipelineCacheEntryType::ePipeline, 100, 2);
+        SL_REQUIRE(cache.save());
+    }
+    // Two plugins load the same file, one adds an entry and the other removes one
+    PipelineCache a;
+    PipelineCache b;
+    SL_REQUIRE(a.load(file.path, "k1"));
+    SL_REQUIRE(b.load(file.path, "k1"));
+    update(b, 5, 6, PipelineCacheEntryType::eRootSignature, 50, 3);
+    SL_REQUIRE(b.save());
+    a.remove(PipelineCache::makeKey(1, 2), PipelineCacheEntryType::ePipeline);
+    std::vector<uint8_t> data;
+    SL_EXPECT(a.findOnDisk(PipelineCache::makeKey(5, 6), PipelineCacheEntryType::eRootSignature, data));
+    SL_REQUIRE(a.save());
+
+    PipelineCache merged;
+    SL_REQUIRE(merged.load(file.path, "k1"));
+    SL_EXPECT(merged.getEntryCount() == 2);
+    SL_EXPECT(has(merged, 5, 6, PipelineCacheEntryType::eRootSignature));
+    SL_EXPECT(has(merged, 3, 4, PipelineCacheEntryType::ePipeline));
+    SL_EXPECT(!has(merged, 1, 2, PipelineCacheEntryType::ePipeline));
+}
+
+SL_TEST(pipelineCacheEvictsIdleEntries)
+{
+    CacheFile file("pipelineCacheEvictsIdleEntries");
+    PipelineCacheLimits limits;
+    limits.maxIdleSessions = 2;
+    {
+        PipelineCache cache;
+        cache.load(file.path, "k1", limits);
+        update(cache, 1, 1, PipelineCacheEntryType::ePipeline, 10, 1);
+        update(cache, 2, 2, PipelineCacheEntryType::ePipeline, 10, 2);
+        SL_REQUIRE(cache.save());
+    }
+    // Only the first entry is used in the following sessions
+    for (int session = 0; session < 4; session++)
+    {
+        PipelineCache cache;
+        SL_REQUIRE(cache.load(file.path, "k1", limits));
+        SL_EXPECT(has(cache, 1, 1, PipelineCacheEntryType::ePipeline));
+        SL_REQUIRE(cache.save());
+    }
+    PipelineCache cache;
+    SL_REQUIRE(cache.load(file.path, "k1", limits));
+    SL_EXPECT(cache.getEntryCount() == 1);
+    SL_EXPECT(!has(cache, 2, 2, PipelineCacheEntryType::ePipeline));
+}
+
+SL_TEST(pipelineCacheEvictsLeastRecentlyUsedOverBudget)
+{
+    CacheFile file("pipelineCacheEvictsLeastRecentlyUsedOverBudget");
+    {
+        PipelineCache cache;
+        cache.load(file.path, "k1");
+        update(cache, 1, 1, PipelineCacheEntryType::ePipeline, 2000, 1);
+        SL_REQUIRE(cache.save());
+    }
+    PipelineCacheLimits limits;
+    limits.maxBytes = 3000;
+    {
+        PipelineCache cache;
+        SL_REQUIRE(cache.load(file.path, "k1", limits));
+        update(cache, 2, 2, PipelineCacheEntryType::ePipeline, 2000, 2);
+        SL_REQUIRE(cache.save());
+        SL_EXPECT(cache.getTotalBytes() <= limits.maxBytes);
+    }
+    PipelineCache cache;
+    SL_REQUIRE(cache.load(file.path, "k1"));
+    SL_EXPECT(cache.getEntryCount() == 1);
+    SL_EXPECT(has(cache, 2, 2, PipelineCacheEntryType::ePipeline));
+}
+
+SL_TEST(pipelineCacheSkipsCorruptedEntries)
+{
+    CacheFile file("pipelineCacheSkipsCorruptedEntries");
+    {
+        PipelineCache cache;
+        cache.load(file.path, "k1");
+        update(cache, 1, 1, PipelineCacheEntryType::ePipeline, 64, 1);
+        update(cache, 2, 2, PipelineCacheEntryType::ePipeline, 64, 2);
+        SL_REQUIRE(cache.save());
+    }
+    // Flip a byte in the last blob, its checksum no longer matches
+    auto size = std::filesystem::file_size(file.path);
+    auto fp = fopen(file.path.string().c_str(), "r+b");
+    SL_REQUIRE(fp);
+    fseek(fp, (long)size - 5, SEEK_SET);
+    fputc(0xaa, fp);
+    fclose(fp);
+    {
+        PipelineCache cache;
+        SL_REQUIRE(cache.load(file.path, "k1"));
+        SL_EXPECT(cache.getEntryCount() == 1);
+        SL_EXPECT(has(cache, 1, 1, PipelineCacheEntryType::ePipeline));
+    }
+    // Truncated header
+    std::filesystem::resize_file(file.path, 10);
+    PipelineCache cache;
+    SL_EXPECT(!cache.load(file.path, "k1"));
+    SL_EXPECT(cache.getEntryCount() == 0);
+}
@@ -0,0 +1,371 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "source/tests/test.h"
+// Built into the tests directly, the plugin manager project is Windows only
+#include "source/core/sl.plugin-manager/pluginCache.cpp"
+
+using namespace sl::plugin_manager;
+using json = nlohmann::json;
+
+namespace
+{
+
+//! Fresh directory per test holding fake plugin binaries and the cache file
+struct PluginDir
+{
+    std::filesystem::path dir;
+    std::filesystem::path cacheFile;
+
+    PluginDir(const char* name)
+    {
+        dir = std::filesystem::temp_directory_path() / "sl.tests" / name;
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        std::filesystem::create_directories(dir);
+        cacheFile = dir / "cache" / "sl.plugins";
+    }
+    ~PluginDir()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    //! Writes a binary with a recognizable byte pattern, 'seed' makes the contents unique
+    std::filesystem::path writePlugin(const char* name, size_t size, uint8_t seed = 0)
+    {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            data[i] = uint8_t(i * 31 + seed);
+        }
+        auto path = dir / name;
+        writeFile(path, data);
+        return path;
+    }
+
+    static void writeFile(const std::filesystem::path& path, const std::vector<uint8_t>& data)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write((const char*)data.data(), data.size());
+    }
+
+    static std::vector<uint8_t> readFile(const std::filesystem::path& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    //! Rewrites one byte in place and restores the timestamp so only the digest can tell
+    static void patchByte(const std::filesystem::path& path, size_t offset)
+    {
+        auto modTime = std::filesystem::last_write_time(path);
+        auto data = readFile(path);
+        data[offset] ^= 0xff;
+        writeFile(path, data);
+        std::filesystem::last_write_time(path, modTime);
+    }
+};
+
+//! Same layout as the JSON returned by 'slOnPluginLoad'
+json makeConfig(uint32_t id, const char* name, int priority)
+{
+    json config;
+    config["id"] = id;
+    config["name"] = name;
+    config["priority"] = priority;
+    config["version"] = { {"major", 2}, {"minor", 4}, {"build", 15} };
+    config["api"] = { {"major", 0}, {"minor", 0}, {"build", 1} };
+    config["hooks"] = json::array({ {{"class", "IDXGISwapChain"}, {"target", "Present"}, {"replacement", "slHookPresent"}, {"base", "before"}} });
+    config["required_plugins"] = { "sl.common" };
+    config["exclusive_hooks"] = { "IDXGISwapChain_Present" };
+    config["incompatible_plugins"] = json::array();
+    return config;
+}
+
+//! Caches one plugin and persists it
+void populate(const PluginDir& dir, const std::filesystem::path& plugin, const char* version = "sl-1.0")
+{
+    PluginManifestCache cache;
+    cache.load(dir.cacheFile, version);
+    SL_REQUIRE(cache.update(plugin, makeConfig(1, "sl.test", 10)));
+    SL_REQUIRE(cache.save());
+}
+
+bool isCached(const PluginDir& dir, const std::filesystem::path& plugin, const char* version = "sl-1.0")
+{
+    PluginManifestCache cache;
+    cache.load(dir.cacheFile, version);
+    PluginManifest manifest{};
+    return cache.find(plugin, manifest);
+}
+
+}
+
+SL_TEST(pluginManifestCacheRoundTrip)
+{
+    PluginDir dir("pluginManifestCacheRoundTrip");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    {
+        PluginManifestCache cache;
+        SL_EXPECT(!cache.load(dir.cacheFile, "sl-1.0"));
+        PluginManifest manifest{};
+        SL_EXPECT(!cache.find(plugin, manifest));
+        SL_REQUIRE(cache.update(plugin, makeConfig(7, "sl.test", 42)));
+        SL_REQUIRE(cache.save());
+    }
+
+    PluginManifestCache cache;
+    SL_REQUIRE(cache.load(dir.cacheFile, "sl-1.0"));
+    PluginManifest manifest{};
+    SL_REQUIRE(cache.find(plugin, manifest));
+    SL_EXPECT(manifest.id == 7);
+    SL_EXPECT(manifest.name == "sl.test");
+    SL_EXPECT(manifest.priority == 42);
+    SL_EXPECT(manifest.version.major == 2 && manifest.version.minor == 4 && manifest.version.build == 15);
+    SL_EXPECT(manifest.api.major == 0 && manifest.api.minor == 0 && manifest.api.build == 1);
+    SL_EXPECT(manifest.hasHooks);
+    SL_EXPECT(manifest.requiredPlugins == std::vector<std::string>{ "sl.common" });
+    SL_EXPECT(manifest.exclusiveHooks == std::vector<std::string>{ "IDXGISwapChain_Present" });
+    SL_EXPECT(manifest.incompatiblePlugins.empty());
+}
+
+SL_TEST(pluginManifestCacheSizeChange)
+{
+    PluginDir dir("pluginManifestCacheSizeChange");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin);
+    SL_REQUIRE(isCached(dir, plugin));
+
+    auto modTime = std::filesystem::last_write_time(plugin);
+    dir.writePlugin("sl.test.dll", 4097);
+    std::filesystem::last_write_time(plugin, modTime);
+    SL_EXPECT(!isCached(dir, plugin));
+}
+
+SL_TEST(pluginManifestCacheModTimeChange)
+{
+    PluginDir dir("pluginManifestCacheModTimeChange");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin);
+    SL_REQUIRE(isCached(dir, plugin));
+
+    // Identical contents, only the timestamp moves as it does when a plugin is copied over
+    std::filesystem::last_write_time(plugin, std::filesystem::last_write_time(plugin) + std::chrono::seconds(10));
+    SL_EXPECT(!isCached(dir, plugin));
+}
+
+SL_TEST(pluginManifestCacheContentChange)
+{
+    PluginDir dir("pluginManifestCacheContentChange");
+    // Larger than both digest blocks so head and tail are hashed separately
+    auto size = 3 * kManifestDigestBlockSize;
+    auto head = dir.writePlugin("head.dll", size);
+    auto tail = dir.writePlugin("tail.dll", size, 1);
+    auto small = dir.writePlugin("small.dll", 100, 2);
+    {
+        PluginManifestCache cache;
+        cache.load(dir.cacheFile, "sl-1.0");
+        SL_REQUIRE(cache.update(head, makeConfig(1, "head", 0)));
+        SL_REQUIRE(cache.update(tail, makeConfig(2, "tail", 0)));
+        SL_REQUIRE(cache.update(small, makeConfig(3, "small", 0)));
+        SL_REQUIRE(cache.save());
+    }
+
+    // Header rebuilt with a new timestamp, signature block replaced, tiny binary patched
+    PluginDir::patchByte(head, 64);
+    PluginDir::patchByte(tail, size - 1);
+    PluginDir::patchByte(small, 50);
+
+    PluginManifestCache cache;
+    SL_REQUIRE(cache.load(dir.cacheFile, "sl-1.0"));
+    PluginManifest manifest{};
+    SL_EXPECT(!cache.find(head, manifest));
+    SL_EXPECT(!cache.find(tail, manifest));
+    SL_EXPECT(!cache.find(small, manifest));
+}
+
+SL_TEST(pluginManifestCacheInvalidatedEntryIsDropped)
+{
+    PluginDir dir("pluginManifestCacheInvalidatedEntryIsDropped");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin);
+
+    auto modTime = std::filesystem::last_write_time(plugin);
+    dir.writePlugin("sl.test.dll", 8192);
+    {
+        PluginManifestCache cache;
+        SL_REQUIRE(cache.load(dir.cacheFile, "sl-1.0"));
+        PluginManifest manifest{};
+        SL_EXPECT(!cache.find(plugin, manifest));
+        SL_REQUIRE(cache.save());
+    }
+
+    // Putting the old binary back must not resurrect the stale entry
+    dir.writePlugin("sl.test.dll", 4096);
+    std::filesystem::last_write_time(plugin, modTime);
+    SL_EXPECT(!isCached(dir, plugin));
+}
+
+SL_TEST(pluginManifestCacheUpdateReplacesEntry)
+{
+    PluginDir dir("pluginManifestCacheUpdateReplacesEntry");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin);
+
+    dir.writePlugin("sl.test.dll", 4096, 1);
+    std::filesystem::last_write_time(plugin, std::filesystem::last_write_time(plugin) + std::chrono::seconds(10));
+    {
+        PluginManifestCache cache;
+        SL_REQUIRE(cache.load(dir.cacheFile, "sl-1.0"));
+        PluginManifest manifest{};
+        SL_EXPECT(!cache.find(plugin, manifest));
+        auto config = makeConfig(1, "sl.test", 10);
+        config["version"]["build"] = 16;
+        config.erase("hooks");
+        SL_REQUIRE(cache.update(plugin, config));
+        SL_REQUIRE(cache.save());
+    }
+
+    PluginManifestCache cache;
+    SL_REQUIRE(cache.load(dir.cacheFile, "sl-1.0"));
+    PluginManifest manifest{};
+    SL_REQUIRE(cache.find(plugin, manifest));
+    SL_EXPECT(manifest.version.build == 16);
+    SL_EXPECT(!manifest.hasHooks);
+}
+
+SL_TEST(pluginManifestCacheDeletedPlugin)
+{
+    PluginDir dir("pluginManifestCacheDeletedPlugin");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin);
+    std::filesystem::remove(plugin);
+    SL_EXPECT(!isCached(dir, plugin));
+}
+
+SL_TEST(pluginManifestCacheInterposerVersionChange)
+{
+    PluginDir dir("pluginManifestCacheInterposerVersionChange");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin, "sl-1.0");
+    SL_EXPECT(isCached(dir, plugin, "sl-1.0"));
+    SL_EXPECT(!isCached(dir, plugin, "sl-1.1"));
+
+    // Rewritten for the new interposer once anything is cached again
+    populate(dir, plugin, "sl-1.1");
+    SL_EXPECT(isCached(dir, plugin, "sl-1.1"));
+    SL_EXPECT(!isCached(dir, plugin, "sl-1.0"));
+}
+
+SL_TEST(pluginManifestCacheFormatChange)
+{
+    PluginDir dir("pluginManifestCacheFormatChange");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin);
+
+    auto cache = json::parse(PluginDir::readFile(dir.cacheFile));
+    cache["format"] = kManifestCacheFormat - 1;
+    auto text = cache.dump();
+    PluginDir::writeFile(dir.cacheFile, std::vector<uint8_t>(text.begin(), text.end()));
+    SL_EXPECT(!isCached(dir, plugin));
+}
+
+SL_TEST(pluginManifestCacheCorruptFile)
+{
+    PluginDir dir("pluginManifestCacheCorruptFile");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    populate(dir, plugin);
+    auto valid = PluginDir::readFile(dir.cacheFile);
+    SL_REQUIRE(valid.size() > 16);
+
+    // Torn write, garbage, empty file and an entry missing a field
+    auto missingField = json::parse(valid);
+    missingField["plugins"][0].erase("digest");
+    auto missingText = missingField.dump();
+    std::vector<std::vector<uint8_t>> corrupt = {
+        std::vector<uint8_t>(valid.begin(), valid.begin() + valid.size() / 2),
+        std::vector<uint8_t>(256, 0xcd),
+        {},
+        std::vector<uint8_t>(missingText.begin(), missingText.end()),
+    };
+    for (auto& contents : corrupt)
+    {
+        PluginDir::writeFile(dir.cacheFile, contents);
+        {
+            PluginManifestCache cache;
+            SL_EXPECT(!cache.load(dir.cacheFile, "sl-1.0"));
+            PluginManifest manifest{};
+            SL_EXPECT(!cache.find(plugin, manifest));
+            // Plugin is parsed again and the cache heals itself
+            SL_REQUIRE(cache.update(plugin, makeConfig(1, "sl.test", 10)));
+            SL_REQUIRE(cache.save());
+        }
+        SL_EXPECT(isCached(dir, plugin));
+    }
+}
+
+SL_TEST(pluginManifestCacheUnusedEntriesDropped)
+{
+    PluginDir dir("pluginManifestCacheUnusedEntriesDropped");
+    auto a = dir.writePlugin("a.dll", 4096);
+    auto b = dir.writePlugin("b.dll", 4096, 1);
+    {
+        PluginManifestCache cache;
+        cache.load(dir.cacheFile, "sl-1.0");
+        SL_REQUIRE(cache.update(a, makeConfig(1, "a", 0)));
+        SL_REQUIRE(cache.update(b, makeConfig(2, "b", 0)));
+        SL_REQUIRE(cache.save());
+    }
+    {
+        // Plugin 'b' is no longer discovered
+        PluginManifestCache cache;
+        SL_REQUIRE(cache.load(dir.cacheFile, "sl-1.0"));
+        PluginManifest manifest{};
+        SL_REQUIRE(cache.find(a, manifest));
+        SL_REQUIRE(cache.save());
+    }
+    SL_EXPECT(isCached(dir, a));
+    SL_EXPECT(!isCached(dir, b));
+}
+
+SL_TEST(pluginManifestCacheRejectsIncompleteConfig)
+{
+    PluginDir dir("pluginManifestCacheRejectsIncompleteConfig");
+    auto plugin = dir.writePlugin("sl.test.dll", 4096);
+    auto empty = dir.writePlugin("empty.dll", 0);
+
+    PluginManifestCache cache;
+    cache.load(dir.cacheFile, "sl-1.0");
+    auto config = makeConfig(1, "sl.test", 10);
+    config.erase("version");
+    SL_EXPECT(!cache.update(plugin, config));
+    SL_EXPECT(!cache.update(empty, makeConfig(1, "sl.test", 10)));
+    SL_EXPECT(!cache.update(dir.dir / "missing.dll", makeConfig(1, "sl.test", 10)));
+    PluginManifest manifest{};
+    SL_EXPECT(!cache.find(plugin, manifest));
+}
@@ -0,0 +1,236 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <thread>
+#include <filesystem>
+
+#include "source/tests/test.h"
+// Built into the tests directly, the profiler is part of the Windows only interposer project
+#include "source/core/sl.log/profiler.cpp"
+#include "external/json/include/nlohmann/json.hpp"
+
+using namespace sl;
+using json = nlohmann::json;
+
+namespace
+{
+
+//! Exports the trace to a temp file and parses it back
+struct Trace
+{
+    std::filesystem::path path;
+    json events;
+
+    Trace(const char* name)
+    {
+        auto dir = std::filesystem::temp_directory_path() / "sl.tests";
+        std::filesystem::create_directories(dir);
+        path = dir / (std::string(name) + ".json");
+    }
+    ~Trace()
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    bool write()
+    {
+        if (!profiler::getInterface()->exportTrace(path.wstring().c_str()))
+        {
+            return false;
+        }
+        file::MappedView text(path.wstring().c_str());
+        auto trace = json::parse(text.begin(), text.end());
+        if (trace.at("displayTimeUnit") != "ms") return false;
+        events = trace.at("traceEvents");
+        return events.is_array();
+    }
+
+    std::vector<json> named(const char* name) const
+    {
+        std::vector<json> result;
+        for (auto& e : events)
+        {
+            if (e.at("name") == name) result.push_back(e);
+        }
+        return result;
+    }
+};
+
+//! Every test starts with an empty, enabled profiler
+profiler::IProfiler* startProfiler()
+{
+    auto p = profiler::getInterface();
+    p->clear();
+    p->setEnabled(true);
+    return p;
+}
+
+}
+
+SL_TEST(profilerSingleInstance)
+{
+    constexpr uint32_t kThreads = 8;
+    profiler::IProfiler* instances[kThreads]{};
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kThreads; i++)
+    {
+        threads.emplace_back([&instances, i]() { instances[i] = profiler::getInterface(); });
+    }
+    for (auto& t : threads) t.join();
+    for (auto p : instances)
+    {
+        SL_EXPECT(p && p == instances[0]);
+    }
+}
+
+SL_TEST(profilerChromeTraceFormat)
+{
+    auto p = startProfiler();
+    {
+        SL_PROFILE_SCOPE("outer");
+        {
+            SL_PROFILE_SCOPE("inner");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    std::thread([]() { SL_PROFILE_SCOPE("worker"); }).join();
+
+    Trace trace("profilerChromeTraceFormat");
+    SL_REQUIRE(trace.write());
+    SL_REQUIRE(trace.events.size() == 3);
+    for (auto& e : trace.events)
+    {
+        SL_EXPECT(e.at("ph") == "X");
+        SL_EXPECT(e.at("cat") == "sl");
+        SL_EXPECT(e.at("pid").get<uint32_t>() == profiler::getCurrentProcessId());
+        SL_EXPECT(e.at("ts").is_number_integer() && e.at("dur").get<int64_t>() >= 0);
+    }
+
+    auto outer = trace.named("outer");
+    auto inner = trace.named("inner");
+    auto worker = trace.named("worker");
+    SL_REQUIRE(outer.size() == 1 && inner.size() == 1 && worker.size() == 1);
+    // Nested scopes are contained in their parent, viewers rely on that to build the flame graph
+    auto outerBegin = outer[0]["ts"].get<int64_t>(), innerBegin = inner[0]["ts"].get<int64_t>();
+    SL_EXPECT(innerBegin >= outerBegin);
+    SL_EXPECT(innerBegin + inner[0]["dur"].get<int64_t>() <= outerBegin + outer[0]["dur"].get<int64_t>());
+    SL_EXPECT(inner[0]["dur"].get<int64_t>() >= 2000);
+    SL_EXPECT(outer[0]["tid"] == inner[0]["tid"]);
+    SL_EXPECT(worker[0]["tid"] != outer[0]["tid"]);
+    p->setEnabled(false);
+}
+
+SL_TEST(profilerEscapesNames)
+{
+    auto p = startProfiler();
+    auto now = extra::timer::getTicks();
+    p->recordEvent("quote\" back\\slash", now, now);
+    p->recordEvent("tab\tnewline\n", now, now);
+    p->recordEvent(nullptr, now, now);
+    std::string longName(100, 'x');
+    p->recordEvent(longName.c_str(), now, now);
+
+    Trace trace("profilerEscapesNames");
+    SL_REQUIRE(trace.write());
+    SL_EXPECT(trace.named("quote\" back\\slash").size() == 1);
+    // Control characters are replaced, the file stays valid JSON
+    SL_EXPECT(trace.named("tab newline ").size() == 1);
+    SL_EXPECT(trace.named("unknown").size() == 1);
+    SL_EXPECT(trace.named(std::string(profiler::kMaxEventNameLength - 1, 'x').c_str()).size() == 1);
+    p->setEnabled(false);
+}
+
+SL_TEST(profilerDropsEventsWhenFull)
+{
+    auto p = startProfiler();
+    auto now = extra::timer::getTicks();
+    uint32_t capacity = profiler::kEventsPerChunk * profiler::kMaxChunksPerThread;
+    for (uint32_t i = 0; i < capacity + 100; i++)
+    {
+        p->recordEvent("event", now, now + 1);
+    }
+    Trace trace("profilerDropsEventsWhenFull");
+    SL_REQUIRE(trace.write());
+    SL_EXPECT(trace.events.size() == capacity);
+    p->setEnabled(false);
+}
+
+SL_TEST(profilerClearAndShutdown)
+{
+    auto p = startProfiler();
+    auto now = extra::timer::getTicks();
+    p->recordEvent("before clear", now, now);
+    p->clear();
+    p->recordEvent("after clear", now, now);
+    {
+        Trace trace("profilerClearAndShutdown");
+        SL_REQUIRE(trace.write());
+        SL_EXPECT(trace.events.size() == 1 && trace.named("after clear").size() == 1);
+    }
+
+    // Interface survives 'destroyInterface', nothing is recorded until enabled again as on a second slInit
+    profiler::destroyInterface();
+    SL_EXPECT(profiler::getInterface() == p);
+    SL_EXPECT(!p->isEnabled());
+    p->recordEvent("after shutdown", now, now);
+    {
+        Trace trace("profilerClearAndShutdown");
+        SL_REQUIRE(trace.write());
+        SL_EXPECT(trace.events.empty());
+    }
+    p->setEnabled(true);
+    p->recordEvent("reinitialized", now, now);
+    {
+        Trace trace("profilerClearAndShutdown");
+        SL_REQUIRE(trace.write());
+        SL_EXPECT(trace.events.size() == 1 && trace.named("reinitialized").size() == 1);
+    }
+    p->setEnabled(false);
+}
+
+SL_TEST(profilerShutdownWhileRecording)
+{
+    auto p = startProfiler();
+    std::atomic<bool> done{};
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            while (!done.load())
+            {
+                auto now = extra::timer::getTicks();
+                p->recordEvent("busy", now, now);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    profiler::destroyInterface();
+    done = true;
+    for (auto& t : threads) t.join();
+
+    Trace trace("profilerShutdownWhileRecording");
+    SL_REQUIRE(trace.write());
+    SL_EXPECT(trace.events.empty());
+}
@@ -0,0 +1,131 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdarg>
+#include <vector>
+#include <chrono>
+
+#ifndef SL_WINDOWS
+#include <memory>
+
+//! Stand-ins for Windows and Vulkan types named by chi headers
+//!
+//! Tests only exercise API independent code, nothing is ever called through these.
+enum VkResult : int {};
+struct IUnknown
+{
+    virtual long QueryInterface(const void* riid, void** object) = 0;
+    virtual unsigned long AddRef() = 0;
+    virtual unsigned long Release() = 0;
+};
+struct RECT
+{
+    long left, top, right, bottom;
+};
+#endif
+
+namespace sl
+{
+namespace test
+{
+
+using PFunTest = void(void);
+
+struct TestCase
+{
+    const char* name;
+    PFunTest* func;
+};
+
+inline std::vector<TestCase>& getTests()
+{
+    static std::vector<TestCase> s_tests;
+    return s_tests;
+}
+
+inline uint32_t& getFailureCount()
+{
+    static uint32_t s_failures;
+    return s_failures;
+}
+
+struct Registrar
+{
+    Registrar(const char* name, PFunTest* func) { getTests().push_back({ name, func }); }
+};
+
+inline void fail(const char* file, int line, const char* expr)
+{
+    printf("  %s(%d): check failed '%s'\n", file, line, expr);
+    getFailureCount()++;
+}
+
+//! Benchmarks are tests named '<component>Benchmark...', they print their measurements and only
+//! check what holds on any machine. Run 'sl.tests Benchmark' on a release build to compare numbers.
+inline void report(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    printf("  ");
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+}
+
+//! Keeps a result alive so the measured code is not optimized away
+inline void keep(uint64_t value)
+{
+    static volatile uint64_t s_sink;
+    s_sink = s_sink + value;
+}
+
+//! Average nanoseconds per 'func(i)' call over 'iterations' calls
+template<typename F>
+double measureNs(uint32_t iterations, F&& func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        func(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return iterations ? elapsed.count() / iterations : 0.0;
+}
+
+}
+}
+
+//! Test names must be unique per file, prefix them with the component so they can be filtered
+#define SL_TEST(name) \
+    static void name(); \
+    static sl::test::Registrar s_registrar_##name(#name, &name); \
+    static void name()
+
+//! Records the failure and carries on
+#define SL_EXPECT(expr) { if (!(expr)) { sl::test::fail(__FILE__, __LINE__, #expr); } }
+//! Records the failure and leaves the test, for checks the rest of the test depends on
+#define SL_REQUIRE(expr) { if (!(expr)) { sl::test::fail(__FILE__, __LINE__, #expr); return; } }
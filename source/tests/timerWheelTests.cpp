@@ -0,0 +1,198 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "source/tests/test.h"
+#include "source/core/sl.thread/timerWheel.h"
+
+using namespace sl::thread;
+
+namespace
+{
+
+constexpr uint64_t kStartTimeMs = 12345;
+
+//! Steps the clock one millisecond at a time so every callback can check it fired exactly on time
+void step(ManualTimerClock& clock, TimerWheel& wheel, uint64_t ms)
+{
+    for (uint64_t i = 0; i < ms; i++)
+    {
+        clock.advance(1);
+        wheel.advance();
+    }
+}
+
+}
+
+SL_TEST(timerWheelOneShotFiresOnTime)
+{
+    ManualTimerClock clock;
+    clock.set(kStartTimeMs);
+    TimerWheel wheel(nullptr, 0, &clock);
+
+    // Delays around the boundaries of the first three levels
+    std::vector<uint64_t> fired;
+    for (uint64_t delay : { 1ull, 255ull, 256ull, 257ull, 65535ull, 65536ull, 70001ull })
+    {
+        wheel.scheduleOnce(delay, [&fired, &clock, delay]()->void
+        {
+            SL_EXPECT(clock.getTimeMs() - kStartTimeMs == delay);
+            fired.push_back(delay);
+        });
+    }
+    SL_EXPECT(wheel.getTimerCount() == 7);
+    step(clock, wheel, 70001);
+    SL_EXPECT(fired.size() == 7);
+    SL_EXPECT(std::is_sorted(fired.begin(), fired.end()));
+    SL_EXPECT(wheel.getTimerCount() == 0);
+}
+
+SL_TEST(timerWheelFarTimerDoesNotFireEarly)
+{
+    ManualTimerClock clock;
+    clock.set(kStartTimeMs);
+    TimerWheel wheel(nullptr, 0, &clock);
+
+    // Top level of the wheel, timer has to cascade down through every level
+    const uint64_t delay = 20000000;
+    uint32_t count = 0;
+    wheel.scheduleOnce(delay, [&count]()->void { count++; });
+    while (clock.getTimeMs() - kStartTimeMs < delay - 1000)
+    {
+        clock.advance(997);
+        wheel.advance();
+    }
+    SL_EXPECT(count == 0);
+    step(clock, wheel, kStartTimeMs + delay - clock.getTimeMs() - 1);
+    SL_EXPECT(count == 0);
+    step(clock, wheel, 1);
+    SL_EXPECT(count == 1);
+}
+
+SL_TEST(timerWheelPeriodicDoesNotDriftOrCatchUp)
+{
+    ManualTimerClock clock;
+    clock.set(kStartTimeMs);
+    TimerWheel wheel(nullptr, 0, &clock);
+
+    std::vector<uint64_t> fired;
+    wheel.schedulePeriodic(100, [&fired, &clock]()->void { fired.push_back(clock.getTimeMs() - kStartTimeMs); });
+    step(clock, wheel, 1000);
+    SL_REQUIRE(fired.size() == 10);
+    for (size_t i = 0; i < fired.size(); i++)
+    {
+        SL_EXPECT(fired[i] == (i + 1) * 100);
+    }
+
+    // Late service fires once, missed periods are skipped and the phase is kept
+    fired.clear();
+    clock.advance(550);
+    wheel.advance();
+    SL_EXPECT(fired.size() == 1);
+    step(clock, wheel, 49);
+    SL_EXPECT(fired.size() == 1);
+    step(clock, wheel, 1);
+    SL_EXPECT(fired.size() == 2 && fired.back() == 1600);
+    step(clock, wheel, 100);
+    SL_EXPECT(fired.size() == 3 && fired.back() == 1700);
+}
+
+SL_TEST(timerWheelCancel)
+{
+    ManualTimerClock clock;
+    clock.set(kStartTimeMs);
+    TimerWheel wheel(nullptr, 0, &clock);
+
+    uint32_t count = 0;
+    auto once = wheel.scheduleOnce(10, [&count]()->void { count++; });
+    auto periodic = wheel.schedulePeriodic(10, [&count]()->void { count++; });
+    SL_EXPECT(wheel.cancel(once));
+    SL_EXPECT(!wheel.cancel(once));
+    SL_EXPECT(wheel.cancel(periodic));
+    SL_EXPECT(!wheel.cancel(kInvalidTimerId));
+    SL_EXPECT(wheel.getTimerCount() == 0);
+    step(clock, wheel, 100);
+    SL_EXPECT(count == 0);
+
+    // Slot is recycled, stale id must not cancel the new timer
+    auto reused = wheel.scheduleOnce(10, [&count]()->void { count++; });
+    SL_EXPECT(reused != once && reused != periodic);
+    SL_EXPECT(!wheel.cancel(once));
+    step(clock, wheel, 10);
+    SL_EXPECT(count == 1);
+    SL_EXPECT(!wheel.cancel(reused));
+}
+
+SL_TEST(timerWheelCancelExpiredPeriodic)
+{
+    ManualTimerClock clock;
+    clock.set(kStartTimeMs);
+    TimerWheel wheel(nullptr, 0, &clock);
+
+    // Both expire on the same tick, first one cancels the second which is already in the expired batch
+    uint32_t first = 0, second = 0;
+    TimerId secondId{};
+    wheel.schedulePeriodic(10, [&]()->void
+    {
+        first++;
+        if (first == 2)
+        {
+            SL_EXPECT(wheel.cancel(secondId));
+        }
+    });
+    secondId = wheel.schedulePeriodic(10, [&second]()->void { second++; });
+    step(clock, wheel, 10);
+    SL_EXPECT(first == 1 && second == 1);
+    step(clock, wheel, 10);
+    SL_EXPECT(first == 2);
+    SL_EXPECT(second == 1);
+    step(clock, wheel, 100);
+    SL_EXPECT(second == 1);
+}
+
+SL_TEST(timerWheelScheduleFromCallback)
+{
+    ManualTimerClock clock;
+    clock.set(kStartTimeMs);
+    TimerWheel wheel(nullptr, 0, &clock);
+
+    uint64_t firedAt = 0;
+    wheel.scheduleOnce(5, [&]()->void
+    {
+        wheel.scheduleOnce(5, [&]()->void { firedAt = clock.getTimeMs() - kStartTimeMs; });
+    });
+    step(clock, wheel, 20);
+    SL_EXPECT(firedAt == 10);
+}
+
+SL_TEST(timerWheelServiceThread)
+{
+    TimerWheel wheel(L"sl.tests.timers", 0);
+    std::atomic<uint32_t> count{};
+    auto id = wheel.schedulePeriodic(5, [&count]()->void { count++; });
+    for (uint32_t i = 0; i < 1000 && count < 3; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    SL_EXPECT(count >= 3);
+    SL_EXPECT(wheel.cancel(id));
+}
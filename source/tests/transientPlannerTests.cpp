@@ -0,0 +1,305 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <map>
+#include <random>
+#include <climits>
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/transientPlanner.h"
+
+using namespace sl::chi;
+
+namespace
+{
+
+//! Declares copies the way sl.common does for volatile tags
+//!
+//! A copy lives from the point its tag is set until the same tag is set again,
+//! use points advance on every declaration and retirement. Plans after each
+//! declaration since copies are needed right away.
+struct VolatileTags
+{
+    TransientPlanner planner;
+    std::map<uint64_t, uint32_t> handles;
+    uint32_t point{};
+
+    void beginFrame()
+    {
+        planner.clear();
+        handles.clear();
+        point = 0;
+    }
+
+    uint32_t setTag(uint64_t uid, uint64_t key, uint64_t size)
+    {
+        auto it = handles.find(uid);
+        if (it != handles.end())
+        {
+            planner.setLastUse(it->second, point++);
+        }
+        auto handle = planner.add({ key, size, point++, UINT_MAX });
+        handles[uid] = handle;
+        planner.plan();
+        return handle;
+    }
+};
+
+struct TagDesc
+{
+    uint32_t type;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytesPerPixel;
+
+    uint64_t key() const { return ((uint64_t)width << 40) | ((uint64_t)height << 16) | bytesPerPixel; }
+    uint64_t size() const { return (uint64_t)width * height * bytesPerPixel; }
+};
+
+}
+
+SL_TEST(transientPlannerAliasesDisjointLifetimes)
+{
+    TransientPlanner planner;
+    planner.add({ 1, 100, 0, 2 });
+    planner.add({ 1, 100, 3, 5 });
+    planner.add({ 1, 100, 2, 4 });
+    planner.add({ 2, 50, 0, 9 });
+    SL_REQUIRE(planner.plan());
+    SL_EXPECT(planner.getSlot(0) == planner.getSlot(1));
+    SL_EXPECT(planner.getSlot(2) != planner.getSlot(0));
+    SL_EXPECT(planner.getSlot(3) != planner.getSlot(0) && planner.getSlot(3) != planner.getSlot(2));
+    SL_EXPECT(planner.getSlots().size() == 3);
+    SL_EXPECT(planner.getRequestedBytes() == 350);
+    SL_EXPECT(planner.getAllocatedBytes() == 250);
+    SL_EXPECT(planner.getSlot(4) == TransientPlanner::kInvalidSlot);
+}
+
+SL_TEST(transientPlannerSlotTakesLargestSize)
+{
+    TransientPlanner planner;
+    planner.add({ 1, 100, 0, 1 });
+    planner.add({ 1, 300, 2, 3 });
+    SL_REQUIRE(planner.plan());
+    SL_REQUIRE(planner.getSlots().size() == 1);
+    SL_EXPECT(planner.getSlots()[0].size == 300);
+}
+
+SL_TEST(transientPlannerRejectsInvalidRanges)
+{
+    TransientPlanner planner;
+    planner.add({ 1, 1, 5, 4 });
+    SL_EXPECT(!planner.plan());
+    planner.clear();
+    SL_EXPECT(planner.plan());
+    SL_EXPECT(planner.getSlots().empty());
+    SL_EXPECT(planner.getRequestCount() == 0);
+}
+
+SL_TEST(transientPlannerRandomIsValidAndOptimal)
+{
+    std::mt19937 rng(42);
+    TransientPlanner planner;
+    for (uint32_t iteration = 0; iteration < 500; iteration++)
+    {
+        planner.clear();
+        uint32_t count = uint32_t(rng() % 40);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t first = uint32_t(rng() % 20);
+            planner.add({ rng() % 3, 64, first, first + uint32_t(rng() % 6) });
+        }
+        SL_REQUIRE(planner.plan());
+
+        // Overlapping lifetimes never share a slot, slots are never shared across keys
+        for (uint32_t i = 0; i < count; i++)
+        {
+            for (uint32_t j = i + 1; j < count; j++)
+            {
+                auto& a = planner.getRequest(i);
+                auto& b = planner.getRequest(j);
+                bool overlap = a.key == b.key && !(a.lastUse < b.firstUse || b.lastUse < a.firstUse);
+                if (overlap) SL_EXPECT(planner.getSlot(i) != planner.getSlot(j));
+                if (planner.getSlot(i) == planner.getSlot(j)) SL_EXPECT(a.key == b.key);
+            }
+        }
+
+        // Slots per key match the largest number of lifetimes overlapping at any point
+        std::map<uint64_t, uint32_t> maxOverlap;
+        std::map<uint64_t, uint32_t> slots;
+        for (uint64_t key = 0; key < 3; key++)
+        {
+            for (uint32_t t = 0; t < 30; t++)
+            {
+                uint32_t overlapping = 0;
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    auto& r = planner.getRequest(i);
+                    if (r.key == key && r.firstUse <= t && t <= r.lastUse) overlapping++;
+                }
+                maxOverlap[key] = std::max(maxOverlap[key], overlapping);
+            }
+        }
+        for (auto& slot : planner.getSlots())
+        {
+            SL_EXPECT(slot.index == slots[slot.key]);
+            slots[slot.key]++;
+        }
+        for (uint64_t key = 0; key < 3; key++)
+        {
+            SL_EXPECT(slots[key] == maxOverlap[key]);
+        }
+    }
+}
+
+SL_TEST(transientPlannerIsStable)
+{
+    TransientPlanner planner;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        planner.add({ i % 2, 1, i, i + 1 });
+    }
+    SL_REQUIRE(planner.plan());
+    std::vector<uint32_t> first;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        first.push_back(planner.getSlot(i));
+    }
+    // Next frame declares the same resources
+    planner.clear();
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        planner.add({ i % 2, 1, i, i + 1 });
+    }
+    SL_REQUIRE(planner.plan());
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        SL_EXPECT(planner.getSlot(i) == first[i]);
+    }
+}
+
+SL_TEST(transientPlannerIncrementalDeclarations)
+{
+    // Volatile tag copies plan after each declaration, all live until the end of the frame.
+    // Pool resources are found by key and index so those must not change for earlier requests.
+    TransientPlanner planner;
+    std::vector<uint32_t> assigned;
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        planner.add({ i % 3, 64, i, UINT_MAX });
+        SL_REQUIRE(planner.plan());
+        for (uint32_t j = 0; j < assigned.size(); j++)
+        {
+            auto& slot = planner.getSlots()[planner.getSlot(j)];
+            SL_EXPECT(slot.key == planner.getRequest(j).key);
+            SL_EXPECT(slot.index == assigned[j]);
+        }
+        assigned.push_back(planner.getSlots()[planner.getSlot(i)].index);
+    }
+    // Nothing aliases
+    SL_EXPECT(planner.getSlots().size() == 12);
+}
+
+SL_TEST(transientPlannerRetiredLifetimesAlias)
+{
+    VolatileTags tags;
+    tags.beginFrame();
+    auto a = tags.setTag(1, 7, 64);
+    auto b = tags.setTag(2, 7, 64);
+    auto slotA = tags.planner.getSlots()[tags.planner.getSlot(a)].index;
+    auto slotB = tags.planner.getSlots()[tags.planner.getSlot(b)].index;
+    SL_EXPECT(slotA != slotB);
+
+    // Tag 1 set again, its previous copy is free for anything declared from now on
+    auto c = tags.setTag(1, 7, 64);
+    SL_EXPECT(tags.planner.getSlots()[tags.planner.getSlot(a)].index == slotA);
+    SL_EXPECT(tags.planner.getSlots()[tags.planner.getSlot(b)].index == slotB);
+    SL_EXPECT(tags.planner.getSlots()[tags.planner.getSlot(c)].index == slotA);
+    SL_EXPECT(tags.planner.getSlots().size() == 2);
+
+    // Tag 2 is still live so a new tag cannot take its copy
+    auto d = tags.setTag(3, 7, 64);
+    SL_EXPECT(tags.planner.getSlot(d) != tags.planner.getSlot(b));
+    SL_EXPECT(tags.planner.getSlot(d) != tags.planner.getSlot(c));
+}
+
+SL_TEST(transientPlannerBenchmarkVolatileTags)
+{
+    // Stereo rendering evaluating upscaling per eye on the same viewport, then frame generation
+    // on the output, every tag is volatile (only valid now) so all of them are copied
+    const TagDesc eye[] =
+    {
+        { 0, 1920, 1920, 4 },   // depth
+        { 1, 1920, 1920, 4 },   // motion vectors
+        { 2, 1920, 1920, 8 },   // color
+        { 3, 1, 1, 4 },         // exposure
+    };
+    const TagDesc output[] =
+    {
+        { 0, 3840, 3840, 4 },   // depth
+        { 1, 3840, 3840, 4 },   // motion vectors
+        { 4, 3840, 3840, 4 },   // hudless
+        { 5, 3840, 3840, 4 },   // UI color and alpha
+    };
+    constexpr uint32_t kEyes = 2;
+
+    VolatileTags tags;
+    auto frame = [&tags, &eye, &output](uint32_t)
+    {
+        tags.beginFrame();
+        for (uint32_t e = 0; e < kEyes; e++)
+        {
+            for (auto& t : eye)
+            {
+                tags.setTag(t.type, t.key(), t.size());
+            }
+        }
+        for (auto& t : output)
+        {
+            tags.setTag(((uint64_t)1 << 32) | t.type, t.key(), t.size());
+        }
+    };
+    auto ns = sl::test::measureNs(1000, frame);
+
+    uint64_t eyeBytes = 0, outputBytes = 0;
+    for (auto& t : eye) eyeBytes += t.size();
+    for (auto& t : output) outputBytes += t.size();
+    SL_EXPECT(tags.planner.getRequestedBytes() == kEyes * eyeBytes + outputBytes);
+    // Second eye reuses the copies made for the first one
+    SL_EXPECT(tags.planner.getAllocatedBytes() == eyeBytes + outputBytes);
+
+    // Without retiring every copy lives until the end of the frame
+    TransientPlanner unbounded;
+    for (uint32_t i = 0; i < tags.planner.getRequestCount(); i++)
+    {
+        auto r = tags.planner.getRequest(i);
+        r.lastUse = UINT_MAX;
+        unbounded.add(r);
+    }
+    SL_REQUIRE(unbounded.plan());
+    SL_EXPECT(unbounded.getAllocatedBytes() == tags.planner.getRequestedBytes());
+
+    sl::test::report("%u copies, %.1fMB requested, %.1fMB allocated, %.1fMB without lifetimes, %.2fus per frame",
+        tags.planner.getRequestCount(), tags.planner.getRequestedBytes() / 1048576.0, tags.planner.getAllocatedBytes() / 1048576.0,
+        unbounded.getAllocatedBytes() / 1048576.0, ns / 1000.0);
+}
@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/transitionBatch.h"
+
+using namespace sl::chi;
+
+namespace
+{
+
+using State = ResourceState;
+
+const Resource kA = (Resource)0x1000;
+const Resource kB = (Resource)0x2000;
+
+bool matches(const ResourceTransition& tr, Resource resource, State from, State to, uint32_t subresource = kAllSubResources)
+{
+    return tr.resource == resource && tr.from == from && tr.to == to && tr.subresource == subresource;
+}
+
+}
+
+SL_TEST(transitionBatchKeepsOrder)
+{
+    TransitionBatch batch;
+    SL_EXPECT(batch.empty());
+    // Reverse of the previous copy followed by the next one, as volatile tags do
+    batch.add({ kA, State::eTextureRead, State::eCopySource });
+    batch.add({ kB, State::eCopySource, State::eStorageRW });
+    SL_REQUIRE(batch.getCount() == 2);
+    SL_EXPECT(matches(batch.getTransitions()[0], kA, State::eCopySource, State::eTextureRead));
+    SL_EXPECT(matches(batch.getTransitions()[1], kB, State::eStorageRW, State::eCopySource));
+    SL_EXPECT(batch.getRequestedCount() == 2);
+
+    batch.clear();
+    SL_EXPECT(batch.empty());
+    SL_EXPECT(batch.getRequestedCount() == 0);
+}
+
+SL_TEST(transitionBatchChainsAndReverts)
+{
+    TransitionBatch batch;
+    batch.add({ kA, State::eTextureRead, State::eStorageRW });
+    batch.add({ kA, State::eStorageRW, State::eTextureRead });
+    SL_EXPECT(batch.empty());
+    SL_EXPECT(batch.getRequestedCount() == 2);
+
+    // Intermediate state is never observed
+    batch.add({ kA, State::eTextureRead, State::eStorageRW });
+    batch.add({ kA, State::eCopySource, State::eTextureRead });
+    SL_REQUIRE(batch.getCount() == 1);
+    SL_EXPECT(matches(batch.getTransitions()[0], kA, State::eStorageRW, State::eCopySource));
+}
+
+SL_TEST(transitionBatchDropsCompatibleStates)
+{
+    TransitionBatch batch;
+    // Read only access is already covered by read/write
+    batch.add({ kA, State::eStorageRW, State::eStorageRead });
+    batch.add({ kA, State::eTextureRead, State::eTextureRead });
+    SL_EXPECT(batch.empty());
+
+    batch.add({ kB, State::eCopySource, State::eTextureRead });
+    batch.add({ kB, State::eCopySource, State::eTextureRead });
+    SL_EXPECT(batch.getCount() == 1);
+    SL_EXPECT(batch.getRequestedCount() == 4);
+}
+
+SL_TEST(transitionBatchSubresources)
+{
+    TransitionBatch batch;
+    batch.add({ kA, State::eCopySource, State::eTextureRead, 0 });
+    batch.add({ kA, State::eCopySource, State::eTextureRead, 1 });
+    batch.add({ kA, State::eTextureRead, State::eCopySource, 0 });
+    SL_REQUIRE(batch.getCount() == 1);
+    SL_EXPECT(matches(batch.getTransitions()[0], kA, State::eTextureRead, State::eCopySource, 1));
+
+    // A transition of all subresources cannot be folded past
+    batch.clear();
+    batch.add({ kA, State::eCopySource, State::eTextureRead, 0 });
+    batch.add({ kA, State::eStorageRW, State::eTextureRead });
+    batch.add({ kA, State::eTextureRead, State::eCopySource, 0 });
+    SL_EXPECT(batch.getCount() == 3);
+}
+
+SL_TEST(transitionBatchWholeResourceBarriers)
+{
+    TransitionBatch batch;
+    batch.setWholeResourceBarriers(true);
+    batch.add({ kA, State::eCopySource, State::eTextureRead, 0 });
+    batch.add({ kA, State::eCopySource, State::eTextureRead, 1 });
+    batch.add({ kA, State::eCopySource, State::eTextureRead, 2 });
+    SL_REQUIRE(batch.getCount() == 1);
+    SL_EXPECT(matches(batch.getTransitions()[0], kA, State::eTextureRead, State::eCopySource));
+    SL_EXPECT(batch.getRequestedCount() == 3);
+}
@@ -0,0 +1,231 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <map>
+#include <cstring>
+#include <algorithm>
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/uploadAllocator.h"
+
+using namespace sl::chi;
+
+namespace
+{
+
+struct FakeBuffer
+{
+    int id{};
+};
+
+using Allocator = UploadAllocator<FakeBuffer>;
+
+//! Upload pages backed by host memory, tracks everything in flight and checks nothing was overwritten
+struct FakeUploadHeap
+{
+    struct InFlight
+    {
+        int buffer;
+        uint64_t offset;
+        uint64_t size;
+        uint64_t fence;
+        uint8_t value;
+    };
+
+    std::map<int, std::vector<uint8_t>> memory;
+    std::vector<InFlight> inFlight;
+    int created{};
+    int destroyed{};
+    uint8_t value = 1;
+
+    std::unique_ptr<Allocator> allocator;
+
+    FakeUploadHeap(uint64_t pageSize, uint32_t maxFreePages = 8)
+    {
+        allocator = std::make_unique<Allocator>(
+            [this](uint64_t size, FakeBuffer& buffer, uint8_t*& mapped)
+            {
+                buffer.id = created++;
+                memory[buffer.id].resize((size_t)size);
+                mapped = memory[buffer.id].data();
+                return true;
+            },
+            [this](FakeBuffer buffer)
+            {
+                destroyed++;
+                memory.erase(buffer.id);
+            }, pageSize, maxFreePages);
+    }
+
+    bool allocate(uint64_t size, uint64_t alignment, uint64_t fence, Allocator::Allocation& allocation)
+    {
+        if (!allocator->allocate(size, alignment, fence, allocation)) return false;
+        memset(allocation.cpu, value, (size_t)size);
+        inFlight.push_back({ allocation.buffer.id, allocation.offset, size, fence, value });
+        value = value == 255 ? 1 : value + 1;
+        return true;
+    }
+
+    //! Returns number of allocations whose data changed while the GPU could still read it
+    uint32_t countCorrupted()
+    {
+        uint32_t corrupted = 0;
+        for (auto& f : inFlight)
+        {
+            auto it = memory.find(f.buffer);
+            if (it == memory.end() || it->second.size() < f.offset + f.size)
+            {
+                corrupted++;
+                continue;
+            }
+            for (uint64_t i = 0; i < f.size; i++)
+            {
+                if (it->second[f.offset + i] != f.value)
+                {
+                    corrupted++;
+                    break;
+                }
+            }
+        }
+        return corrupted;
+    }
+
+    void complete(uint64_t fence)
+    {
+        allocator->setCompletedValue(fence);
+        inFlight.erase(std::remove_if(inFlight.begin(), inFlight.end(), [fence](const InFlight& f) { return f.fence <= fence; }), inFlight.end());
+    }
+};
+
+}
+
+SL_TEST(uploadAllocatorPacksAligned)
+{
+    FakeUploadHeap heap(4096);
+    Allocator::Allocation a{}, b{}, c{};
+    SL_REQUIRE(heap.allocate(10, 256, 1, a));
+    SL_REQUIRE(heap.allocate(300, 256, 1, b));
+    SL_REQUIRE(heap.allocate(4, 16, 1, c));
+    SL_EXPECT(a.offset == 0);
+    SL_EXPECT(b.offset == 256);
+    SL_EXPECT(c.offset == 560);
+    SL_EXPECT(a.buffer.id == b.buffer.id && b.buffer.id == c.buffer.id);
+    SL_EXPECT(b.cpu == a.cpu + 256);
+    SL_EXPECT(heap.allocator->getPageCount() == 1);
+}
+
+SL_TEST(uploadAllocatorNeverOverwritesInFlight)
+{
+    FakeUploadHeap heap(4096);
+    const uint64_t kLatency = 3;
+    uint32_t failed = 0;
+    for (uint64_t frame = 1; frame <= 200; frame++)
+    {
+        // Occasional spikes and allocations larger than a page
+        uint32_t count = frame % 50 == 0 ? 200 : 10 + frame % 7;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Allocator::Allocation allocation{};
+            if (!heap.allocate(16 + (i * 37) % 300, 256, frame, allocation) || allocation.offset % 256) failed++;
+        }
+        if (frame % 60 == 0)
+        {
+            Allocator::Allocation allocation{};
+            if (!heap.allocate(10000, 256, frame, allocation)) failed++;
+        }
+        SL_EXPECT(heap.countCorrupted() == 0);
+        if (frame > kLatency)
+        {
+            heap.complete(frame - kLatency);
+        }
+    }
+    SL_EXPECT(failed == 0);
+    // Pages from spikes are given back once completed, only the free list and the open page remain
+    heap.complete(200);
+    SL_EXPECT(heap.allocator->getPageCount() <= 8 + 1);
+}
+
+SL_TEST(uploadAllocatorGrowsWhenGPUStalls)
+{
+    FakeUploadHeap heap(4096, 2);
+    for (uint64_t frame = 1; frame <= 10; frame++)
+    {
+        for (uint32_t i = 0; i < 50; i++)
+        {
+            Allocator::Allocation allocation{};
+            SL_REQUIRE(heap.allocate(256, 256, frame, allocation));
+        }
+    }
+    SL_EXPECT(heap.countCorrupted() == 0);
+    auto stalled = heap.allocator->getPageCount();
+    SL_EXPECT(stalled >= 10 * 50 * 256 / 4096);
+
+    // Once the GPU catches up only a few free pages are kept
+    heap.complete(10);
+    Allocator::Allocation allocation{};
+    SL_REQUIRE(heap.allocate(256, 256, 11, allocation));
+    SL_EXPECT(heap.allocator->getPageCount() <= 3);
+    SL_EXPECT(heap.destroyed > 0);
+}
+
+SL_TEST(uploadAllocatorDedicatedPages)
+{
+    FakeUploadHeap heap(1024);
+    Allocator::Allocation small{}, large{};
+    SL_REQUIRE(heap.allocate(64, 64, 1, small));
+    SL_REQUIRE(heap.allocate(5000, 256, 1, large));
+    SL_EXPECT(large.offset == 0);
+    SL_EXPECT(large.buffer.id != small.buffer.id);
+    SL_EXPECT(heap.memory[large.buffer.id].size() >= 5000);
+    // Dedicated page does not close the open one
+    Allocator::Allocation next{};
+    SL_REQUIRE(heap.allocate(64, 64, 1, next));
+    SL_EXPECT(next.buffer.id == small.buffer.id && next.offset == 64);
+
+    heap.complete(1);
+    SL_REQUIRE(heap.allocate(1000, 64, 2, next));
+    SL_EXPECT(heap.memory.find(large.buffer.id) == heap.memory.end());
+}
+
+SL_TEST(uploadAllocatorCreateFailure)
+{
+    Allocator allocator([](uint64_t, FakeBuffer&, uint8_t*&) { return false; }, [](FakeBuffer) {}, 1024);
+    Allocator::Allocation allocation{};
+    SL_EXPECT(!allocator.allocate(16, 16, 1, allocation));
+    SL_EXPECT(!allocator.allocate(4096, 16, 1, allocation));
+    SL_EXPECT(allocator.getPageCount() == 0);
+}
+
+SL_TEST(uploadAllocatorDestroyReleasesEverything)
+{
+    FakeUploadHeap heap(1024);
+    for (uint64_t frame = 1; frame <= 20; frame++)
+    {
+        Allocator::Allocation allocation{};
+        SL_REQUIRE(heap.allocate(frame * 100, 16, frame, allocation));
+    }
+    heap.allocator->destroy();
+    SL_EXPECT(heap.allocator->getPageCount() == 0);
+    SL_EXPECT(heap.destroyed == heap.created);
+    SL_EXPECT(heap.memory.empty());
+}
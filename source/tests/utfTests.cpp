@@ -0,0 +1,164 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+#include <random>
+
+#include "source/tests/test.h"
+#include "source/core/sl.extra/utf.h"
+
+using namespace sl::extra;
+
+namespace
+{
+
+std::string encodeUtf8(const std::u32string& cps)
+{
+    std::string out;
+    for (auto c : cps)
+    {
+        if (c < 0x80) out += (char)c;
+        else if (c < 0x800) out += { (char)(0xc0 | (c >> 6)), (char)(0x80 | (c & 0x3f)) };
+        else if (c < 0x10000) out += { (char)(0xe0 | (c >> 12)), (char)(0x80 | ((c >> 6) & 0x3f)), (char)(0x80 | (c & 0x3f)) };
+        else out += { (char)(0xf0 | (c >> 18)), (char)(0x80 | ((c >> 12) & 0x3f)), (char)(0x80 | ((c >> 6) & 0x3f)), (char)(0x80 | (c & 0x3f)) };
+    }
+    return out;
+}
+
+std::wstring encodeUtf16(const std::u32string& cps)
+{
+    std::wstring out;
+    for (auto c : cps)
+    {
+        if (c < 0x10000) out += (wchar_t)c;
+        else out += { (wchar_t)(0xd800 + ((c - 0x10000) >> 10)), (wchar_t)(0xdc00 + ((c - 0x10000) & 0x3ff)) };
+    }
+    return out;
+}
+
+}
+
+SL_TEST(utfRoundTripsAllEncodedLengths)
+{
+    // One, two, three and four byte sequences, long enough to mix with the vectorized ASCII path
+    std::u32string cps = U"C:/Program Files/Game/plugins/\u00e9\u00df\u4e2d\u6587\U0001F600.dll";
+    auto u8 = encodeUtf8(cps);
+    auto u16 = encodeUtf16(cps);
+    SL_EXPECT(utf8ToUtf16(u8.c_str()) == u16);
+    SL_EXPECT(utf16ToUtf8(u16.c_str()) == u8);
+    SL_EXPECT(utf8ToUtf16("") == L"");
+    SL_EXPECT(utf16ToUtf8(nullptr) == "");
+}
+
+SL_TEST(utfAcceptsFullCodePointsInWideChar)
+{
+    // With 32-bit wchar_t a single unit takes four UTF-8 bytes, the output must be sized for it
+    std::wstring wide;
+    if (sizeof(wchar_t) == 4)
+    {
+        wide = std::wstring(3, (wchar_t)0x1F600);
+    }
+    else
+    {
+        wide = encodeUtf16(U"\U0001F600\U0001F600\U0001F600");
+    }
+    std::string expected;
+    for (uint32_t i = 0; i < 3; i++) expected += "\xf0\x9f\x98\x80";
+    SL_EXPECT(utf16ToUtf8(wide.c_str()) == expected);
+}
+
+SL_TEST(utfReportsAndReplacesInvalidInput)
+{
+    struct Case
+    {
+        const char* input;
+        size_t size;
+    };
+    // Overlong, truncated, lone continuation, encoded surrogate and above U+10FFFF
+    for (auto c : { Case{ "\xc0\xaf", 2 }, Case{ "\xe4\xb8", 2 }, Case{ "\x80", 1 }, Case{ "\xed\xa0\x80", 3 }, Case{ "\xf4\x90\x80\x80", 4 } })
+    {
+        wchar_t out[8]{};
+        bool valid = true;
+        auto n = utf::utf8ToUtf16(c.input, c.size, out, 8, &valid);
+        SL_EXPECT(!valid);
+        SL_EXPECT(n >= 1 && out[0] == (wchar_t)utf::kReplacementChar);
+    }
+
+    // Unpaired surrogates
+    for (auto w : { std::wstring{ (wchar_t)0xd800, L'a' }, std::wstring{ (wchar_t)0xdc00 } })
+    {
+        char out[16]{};
+        bool valid = true;
+        auto n = utf::utf16ToUtf8(w.data(), w.size(), out, sizeof(out), &valid);
+        SL_EXPECT(!valid);
+        SL_EXPECT(n >= 3 && std::string(out, 3) == "\xef\xbf\xbd");
+    }
+}
+
+SL_TEST(utfSizeQueryAndTruncation)
+{
+    std::string u8 = encodeUtf8(U"abcdefghijklmnopqrstuvwxyz\U0001F600");
+    auto required = utf::utf8ToUtf16(u8.data(), u8.size(), nullptr, 0);
+    SL_EXPECT(required == 28);
+
+    // A short buffer is never overrun and the full size is still reported
+    wchar_t out[10];
+    out[9] = L'#';
+    SL_EXPECT(utf::utf8ToUtf16(u8.data(), u8.size(), out, 9) == 28);
+    SL_EXPECT(out[9] == L'#');
+    SL_EXPECT(std::wstring(out, 9) == L"abcdefghi");
+
+    auto wide = encodeUtf16(U"abcdefghijklmnopqrstuvwxyz\U0001F600");
+    SL_EXPECT(utf::utf16ToUtf8(wide.data(), wide.size(), nullptr, 0) == u8.size());
+}
+
+SL_TEST(utfRandomRoundTrip)
+{
+    std::mt19937 rng(5);
+    for (uint32_t it = 0; it < 5000; it++)
+    {
+        std::u32string cps;
+        auto n = rng() % 40;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint32_t c;
+            switch (rng() % 5)
+            {
+                case 0: c = 1 + rng() % 0x7f; break;
+                case 1: c = rng() % 0x800; break;
+                case 2: c = rng() % 0x10000; break;
+                case 3: c = 0x10000 + rng() % 0x100000; break;
+                default: c = 'a' + rng() % 26; break;
+            }
+            if (!c || (c >= 0xd800 && c <= 0xdfff)) c = 'z';
+            cps += c;
+        }
+        auto u8 = encodeUtf8(cps);
+        auto u16 = encodeUtf16(cps);
+        bool valid = false;
+        std::wstring w(u8.size(), L'\0');
+        w.resize(utf::utf8ToUtf16(u8.data(), u8.size(), w.data(), w.size(), &valid));
+        SL_EXPECT(valid);
+        SL_EXPECT(w == u16);
+        SL_EXPECT(utf16ToUtf8(w.c_str()) == u8);
+    }
+}
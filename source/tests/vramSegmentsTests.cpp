@@ -0,0 +1,163 @@
+/*
+* Copyright (c) 2022-2023 NVIDIA CORPORATION. All rights reserved
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+
+
+#include <thread>
+#include <vector>
+
+#include "source/tests/test.h"
+#include "source/platforms/sl.chi/vramSegments.h"
+
+using namespace sl::chi;
+
+SL_TEST(vramSegmentsInternIsStable)
+{
+    VRAMSegmentTable t;
+    SL_EXPECT(t.getCount() == 1);
+    SL_EXPECT(std::string(t.getName(VRAMSegmentTable::kGlobal)) == kGlobalVRAMSegment);
+    SL_EXPECT(t.find("sl.dlss") == VRAMSegmentTable::kInvalid);
+
+    auto a = t.intern("sl.dlss");
+    auto b = t.intern("sl.reflex");
+    SL_EXPECT(a == 1 && b == 2);
+    SL_EXPECT(t.intern("sl.dlss") == a);
+    SL_EXPECT(t.find("sl.reflex") == b);
+    SL_EXPECT(std::string(t.getName(a)) == "sl.dlss");
+    SL_EXPECT(t.getCount() == 3);
+}
+
+SL_TEST(vramSegmentsTracksBytesAndPeak)
+{
+    VRAMSegmentTable t;
+    auto id = t.intern("pool");
+    t.allocate(id, 100);
+    t.allocate(id, 50);
+    SL_EXPECT(t.getBytes(id) == 150);
+    SL_EXPECT(t.getAllocCount(id) == 2);
+    t.free(id, 100);
+    SL_EXPECT(t.getBytes(id) == 50);
+    SL_EXPECT(t.getAllocCount(id) == 1);
+    SL_EXPECT(t.getPeakBytes(id) == 150);
+    // Other segments are not affected
+    SL_EXPECT(t.getBytes(VRAMSegmentTable::kGlobal) == 0);
+
+    // Freed in a different segment than allocated, clamps at zero
+    t.free(id, 1000);
+    t.free(id, ~0ull);
+    SL_EXPECT(t.getBytes(id) == 0);
+    SL_EXPECT(t.getAllocCount(id) == 0);
+    SL_EXPECT(t.getPeakBytes(id) == 150);
+}
+
+SL_TEST(vramSegmentsSnapshot)
+{
+    VRAMSegmentTable t;
+    auto id = t.intern("pool");
+    t.allocate(VRAMSegmentTable::kGlobal, 10);
+    t.allocate(id, 20);
+    t.allocate(id, 30);
+    t.free(id, 20);
+
+    std::vector<VRAMSegmentInfo> s;
+    t.getSnapshot(s);
+    SL_REQUIRE(s.size() == 2);
+    SL_EXPECT(s[0].name == kGlobalVRAMSegment);
+    SL_EXPECT(s[0].currentBytes == 10 && s[0].allocCount == 1);
+    SL_EXPECT(s[1].name == "pool");
+    SL_EXPECT(s[1].allocCount == 1);
+    SL_EXPECT(s[1].currentBytes == 30);
+    SL_EXPECT(s[1].peakBytes == 50);
+}
+
+SL_TEST(vramSegmentsConcurrentUpdates)
+{
+    VRAMSegmentTable t;
+    constexpr uint32_t kThreads = 8;
+    constexpr uint32_t kIterations = 20000;
+    const char* names[] = { "seg0", "seg1", "seg2", "seg3" };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kThreads; i++)
+    {
+        threads.emplace_back([&t, &names, i]()
+        {
+            for (uint32_t n = 0; n < kIterations; n++)
+            {
+                auto id = t.intern(names[(i + n) % 4]);
+                t.allocate(id, 64);
+                t.allocate(VRAMSegmentTable::kGlobal, 1);
+                t.free(id, 64);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<VRAMSegmentInfo> s;
+    t.getSnapshot(s);
+    SL_REQUIRE(s.size() == 5);
+    SL_EXPECT(s[0].name == kGlobalVRAMSegment);
+    SL_EXPECT(s[0].currentBytes == kThreads * kIterations);
+    SL_EXPECT(s[0].allocCount == kThreads * kIterations);
+    for (uint32_t i = 1; i < 5; i++)
+    {
+        SL_EXPECT(s[i].currentBytes == 0);
+        SL_EXPECT(s[i].allocCount == 0);
+        SL_EXPECT(s[i].peakBytes >= 64 && s[i].peakBytes <= 64 * kThreads);
+    }
+    for (auto name : names)
+    {
+        SL_EXPECT(t.find(name) != VRAMSegmentTable::kInvalid);
+    }
+}
+
+SL_TEST(vramSegmentsLimit)
+{
+    VRAMSegmentTable t;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        auto name = "seg" + std::to_string(i);
+        auto id = t.intern(name.c_str());
+        SL_EXPECT((i + 1 < VRAMSegmentTable::kMaxSegments) == (id != VRAMSegmentTable::kInvalid));
+    }
+    SL_EXPECT(t.getCount() == VRAMSegmentTable::kMaxSegments);
+    // Existing names still resolve once full
+    SL_EXPECT(t.intern("seg0") == 1);
+}
+
+SL_TEST(vramSegmentsResetKeepsNames)
+{
+    VRAMSegmentTable t;
+    auto id = t.intern("pool");
+    t.allocate(id, 100);
+    t.allocate(VRAMSegmentTable::kGlobal, 100);
+    t.reset();
+    SL_EXPECT(t.getBytes(id) == 0);
+    SL_EXPECT(t.getPeakBytes(id) == 0);
+    SL_EXPECT(t.getAllocCount(id) == 0);
+    SL_EXPECT(t.getBytes(VRAMSegmentTable::kGlobal) == 0);
+    SL_EXPECT(t.find("pool") == id);
+    SL_EXPECT(t.getCount() == 2);
+}